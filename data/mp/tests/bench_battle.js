@@ -0,0 +1,5 @@
+// Battle benchmark: the target selection benchmark, with a thousand droids on each side.
+
+include("targeting.js");
+
+ARMY_SIZE = 1000;
@@ -0,0 +1,36 @@
+// Target selection benchmark: each player gets a large army of armed droids
+// that run into each other, so that most of the game time is spent choosing targets.
+
+var ARMY_SIZE = 150;
+
+function spawnArmy()
+{
+	var pos = startPositions[me];
+	var side = Math.ceil(Math.sqrt(ARMY_SIZE));
+	for (var i = 0; i < ARMY_SIZE; ++i)
+	{
+		var x = Math.min(Math.max(pos.x - (side >> 1) + i % side, 1), mapWidth - 2);
+		var y = Math.min(Math.max(pos.y - (side >> 1) + Math.floor(i / side), 1), mapHeight - 2);
+		addDroid(me, x, y, "Benchmark", "Body5REC", "HalfTrack", "", "", "MG3Mk1");
+	}
+}
+
+function attack()
+{
+	var enemy = startPositions[(me + 1) % startPositions.length];
+	var droids = enumDroid(me);
+	for (var i = 0; i < droids.length; ++i)
+	{
+		if (droids[i].order != DORDER_SCOUT)
+		{
+			orderDroidLoc(droids[i], DORDER_SCOUT, enemy.x, enemy.y);
+		}
+	}
+}
+
+function eventStartLevel()
+{
+	spawnArmy();
+	attack();
+	setTimer("attack", 5000);
+}
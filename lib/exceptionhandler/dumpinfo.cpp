@@ -371,6 +371,6 @@ void addDumpInfo(const char *inbuffer)
 
 void dbgDumpInit(int argc, const char **argv, const char *packageVersion)
 {
-	debug_register_callback(&debug_exceptionhandler_data, nullptr, nullptr, nullptr);
+	debug_register_synchronous_callback(&debug_exceptionhandler_data, nullptr);
 	createHeader(argc, argv, packageVersion);
 }
@@ -31,6 +31,7 @@
 #include <time.h>
 #include "string_ext.h"
 #include "wzapp.h"
+#include <atomic>
 #include <map>
 #include <string>
 
@@ -39,6 +40,10 @@
 #endif //WZ_OS_LINUX
 
 #define MAX_LEN_LOG_LINE 512
+/// Messages per second a single debug() call site may output, further messages are counted and dropped
+#define MAX_CALL_SITE_RATE 100
+/// Messages which may wait for the writer thread, further messages are dropped until it catches up
+#define MAX_QUEUED_MESSAGES 10000
 
 char last_called_script_event[MAX_EVENT_NAME_LEN];
 UDWORD traceID = -1;
@@ -94,11 +99,46 @@ static const char *code_part_names[] =
 	"last"
 };
 
-static char inputBuffer[2][MAX_LEN_LOG_LINE];
-static bool useInputBuffer1 = false;
+/// A formatted message on its way to the debug callbacks.
+struct DEBUG_MESSAGE
+{
+	DEBUG_MESSAGE *next;
+	code_part part;             ///< LOG_LAST for object traces, which are output as they are
+	int line;
+	const char *function;
+	time_t time;
+	WZ_SEMAPHORE *flushed;      ///< If not NULL, this is not a message, and the writer posts it when reaching it
+	char text[MAX_LEN_LOG_LINE];
+};
+
+/// Number of messages from a debug() call site in the current second.
+struct CALL_SITE_RATE
+{
+	time_t second;
+	unsigned count;
+	unsigned suppressed;
+};
+
 static bool debug_flush_stderr = false;
+static bool debug_format_json = false;
 
+// Only used by whichever thread writes the messages.
 static std::map<std::string, int> warning_list;	// only used for LOG_WARNING
+static std::map<std::pair<std::string, int>, CALL_SITE_RATE> callSiteRates;
+static char lastFunction[MAX_LEN_LOG_LINE];
+static int lastLine = -1;
+static char lastText[MAX_LEN_LOG_LINE];
+
+// The writer thread, and the queue of messages for it. The queue is a lock-free stack, newest message first,
+// which the writer takes all at once.
+static WZ_THREAD *writerThread = nullptr;
+static WZ_SEMAPHORE *writerSemaphore = nullptr;
+static std::atomic<bool> writerRunning(false);
+static std::atomic<bool> writerQuit(false);
+static WZ_DECL_THREAD bool onWriterThread = false;  ///< Whether this is the writer thread, which can't wait for itself
+static std::atomic<DEBUG_MESSAGE *> messageQueue(nullptr);
+static std::atomic<unsigned> queuedMessages(0);
+static std::atomic<unsigned> droppedMessages(0);
 
 /**
  * Convert code_part names to enum. Case insensitive.
@@ -281,8 +321,8 @@ void debug_init()
 	enabled_debug[LOG_INFO] = true;
 	enabled_debug[LOG_FATAL] = true;
 	enabled_debug[LOG_POPUP] = true;
-	inputBuffer[0][0] = '\0';
-	inputBuffer[1][0] = '\0';
+	lastFunction[0] = '\0';
+	lastText[0] = '\0';
 #ifdef DEBUG
 	enabled_debug[LOG_WARNING] = true;
 #endif
@@ -293,6 +333,8 @@ void debug_exit()
 {
 	debug_callback *curCallback = callbackRegistry, * tmpCallback = nullptr;
 
+	debugStopThread();
+
 	while (curCallback)
 	{
 		if (curCallback->exit)
@@ -304,11 +346,12 @@ void debug_exit()
 		curCallback = tmpCallback;
 	}
 	warning_list.clear();
+	callSiteRates.clear();
 	callbackRegistry = nullptr;
 }
 
 
-void debug_register_callback(debug_callback_fn callback, debug_callback_init init, debug_callback_exit exit, void *data)
+static void registerCallback(debug_callback_fn callback, debug_callback_init init, debug_callback_exit exit, void *data, bool synchronous)
 {
 	debug_callback *curCallback = callbackRegistry, * tmpCallback = nullptr;
 
@@ -319,6 +362,7 @@ void debug_register_callback(debug_callback_fn callback, debug_callback_init ini
 	tmpCallback->init = init;
 	tmpCallback->exit = exit;
 	tmpCallback->data = data;
+	tmpCallback->synchronous = synchronous;
 
 	if (tmpCallback->init
 	    && !tmpCallback->init(&tmpCallback->data))
@@ -342,6 +386,32 @@ void debug_register_callback(debug_callback_fn callback, debug_callback_init ini
 	curCallback->next = tmpCallback;
 }
 
+void debug_register_callback(debug_callback_fn callback, debug_callback_init init, debug_callback_exit exit, void *data)
+{
+	registerCallback(callback, init, exit, data, false);
+}
+
+void debug_register_synchronous_callback(debug_callback_fn callback, void *data)
+{
+	registerCallback(callback, nullptr, nullptr, data, true);
+}
+
+
+bool debugSetFormat(const char *str)
+{
+	if (strcasecmp(str, "text") == 0)
+	{
+		debug_format_json = false;
+		return true;
+	}
+	if (strcasecmp(str, "json") == 0)
+	{
+		debug_format_json = true;
+		return true;
+	}
+	return false;
+}
+
 
 bool debug_enable_switch(const char *str)
 {
@@ -358,7 +428,7 @@ bool debug_enable_switch(const char *str)
 	return (part != LOG_LAST);
 }
 
-/** Send the given string to all debug callbacks.
+/** Send the given string to all debug callbacks, except synchronous ones.
  *
  *  @param str The string to send to debug callbacks.
  */
@@ -369,189 +439,494 @@ static void printToDebugCallbacks(const char *const str)
 	// Loop over all callbacks, invoking them with the given data string
 	for (curCallback = callbackRegistry; curCallback != nullptr; curCallback = curCallback->next)
 	{
-		curCallback->callback(&curCallback->data, str);
+		if (!curCallback->synchronous)
+		{
+			curCallback->callback(&curCallback->data, str);
+		}
 	}
 }
 
-void _realObjTrace(int id, const char *function, const char *str, ...)
+/// Append str to json, escaped for use inside a JSON string.
+static void appendJsonString(std::string &json, const char *str)
 {
-	char vaBuffer[MAX_LEN_LOG_LINE];
+	for (const char *c = str; *c != '\0'; ++c)
+	{
+		switch (*c)
+		{
+		case '"':
+			json += "\\\"";
+			break;
+		case '\\':
+			json += "\\\\";
+			break;
+		case '\n':
+			json += "\\n";
+			break;
+		case '\t':
+			json += "\\t";
+			break;
+		default:
+			if ((unsigned char)*c < 0x20)
+			{
+				json += astringf("\\u%04x", (unsigned char)*c);
+			}
+			else
+			{
+				json += *c;
+			}
+			break;
+		}
+	}
+}
+
+/// Format a line which is not a debug() message, such as an object trace, or a note about suppressed messages.
+static std::string formatNotice(const char *notice)
+{
+	if (!debug_format_json)
+	{
+		return notice;
+	}
+	std::string json = "{\"notice\":\"";
+	appendJsonString(json, notice);
+	json += "\"}";
+	return json;
+}
+
+/// Output a line which is not a debug() message.
+static void printNotice(const char *notice)
+{
+	printToDebugCallbacks(formatNotice(notice).c_str());
+}
+
+/// Format a debug() message, noting that further warnings like it are suppressed if furtherSuppressed.
+static std::string formatMessage(const DEBUG_MESSAGE &msg, bool furtherSuppressed)
+{
+	if (msg.part == LOG_LAST)
+	{
+		return formatNotice(msg.text);
+	}
+
+	if (debug_format_json)
+	{
+		std::string json = astringf("{\"part\":\"%s\",\"time\":%lld,\"function\":\"", code_part_names[msg.part], (long long)msg.time);
+		appendJsonString(json, msg.function);
+		json += astringf("\",\"line\":%d,\"message\":\"", msg.line);
+		appendJsonString(json, msg.text);
+		json += furtherSuppressed ? "\",\"furtherSuppressed\":true}" : "\"}";
+		return json;
+	}
+
+	char ourtime[15];		//HH:MM:SS
 	char outputBuffer[MAX_LEN_LOG_LINE];
-	va_list ap;
 
-	va_start(ap, str);
-	vssprintf(vaBuffer, str, ap);
-	va_end(ap);
+	strftime(ourtime, sizeof(ourtime), "%I:%M:%S", localtime(&msg.time));
 
-	ssprintf(outputBuffer, "[%6d]: [%s] %s", id, function, vaBuffer);
-	printToDebugCallbacks(outputBuffer);
+	// Assemble the outputBuffer:
+	ssprintf(outputBuffer, "%-8s|%s: [%s:%d] %s%s", code_part_names[msg.part], ourtime, msg.function, msg.line, msg.text,
+	         furtherSuppressed ? " (**Further warnings of this type are suppressed.)" : "");
+	return outputBuffer;
 }
 
-// Thread local to prevent a race condition on read and write to this buffer if multiple
-// threads log errors. This means we will not be reporting any errors to console from threads
-// other than main. If we want to fix this, make sure accesses are protected by a mutex.
-static WZ_DECL_THREAD char errorStore[512];
-static WZ_DECL_THREAD bool errorWaiting = false;
-const char *debugLastError()
+static void printRepeated(unsigned repeated, unsigned prev)
 {
-	if (errorWaiting)
+	char notice[MAX_LEN_LOG_LINE];
+
+	if (repeated > 2)
 	{
-		errorWaiting = false;
-		return errorStore;
+		ssprintf(notice, "last message repeated %u times (total %u repeats)", repeated - prev, repeated);
 	}
 	else
 	{
-		return nullptr;
+		ssprintf(notice, "last message repeated %u times", repeated - prev);
 	}
+	printNotice(notice);
 }
 
-void _debug(int line, code_part part, const char *function, const char *str, ...)
+/// Returns true if the call site of msg already output MAX_CALL_SITE_RATE messages this second.
+static bool callSiteRateLimited(const DEBUG_MESSAGE &msg)
+{
+	if (msg.part == LOG_FATAL || msg.part == LOG_POPUP)
+	{
+		return false;
+	}
+
+	CALL_SITE_RATE &rate = callSiteRates[std::make_pair(std::string(msg.function), msg.line)];
+	if (rate.second != msg.time)
+	{
+		if (rate.suppressed > 0)
+		{
+			char notice[MAX_LEN_LOG_LINE];
+			ssprintf(notice, "%u messages from [%s:%d] suppressed", rate.suppressed, msg.function, msg.line);
+			printNotice(notice);
+		}
+		rate.second = msg.time;
+		rate.count = 0;
+		rate.suppressed = 0;
+	}
+	if (++rate.count > MAX_CALL_SITE_RATE)
+	{
+		++rate.suppressed;
+		return true;
+	}
+	return false;
+}
+
+/**
+ * Output a message to the debug callbacks, unless it repeats the last message or an earlier warning, or comes from
+ * a call site that is flooding the log. Only called by one thread at a time.
+ */
+static void writeMessage(const DEBUG_MESSAGE &msg)
 {
-	va_list ap;
-	static char outputBuffer[MAX_LEN_LOG_LINE];
 	static unsigned int repeated = 0; /* times current message repeated */
 	static unsigned int next = 2;     /* next total to print update */
 	static unsigned int prev = 0;     /* total on last update */
 
-	va_start(ap, str);
-	vssprintf(outputBuffer, str, ap);
-	va_end(ap);
+	if (msg.part == LOG_LAST)
+	{
+		printNotice(msg.text);
+		return;
+	}
 
-	if (part == LOG_WARNING)
+	if (msg.part == LOG_WARNING)
 	{
 		std::pair<std::map<std::string, int>::iterator, bool> ret;
-		ret = warning_list.insert(std::pair<std::string, int>(std::string(function) + "-" + std::string(outputBuffer), line));
-		if (ret.second)
-		{
-			ssprintf(inputBuffer[useInputBuffer1 ? 1 : 0], "[%s:%d] %s (**Further warnings of this type are suppressed.)", function, line, outputBuffer);
-		}
-		else
+		ret = warning_list.insert(std::pair<std::string, int>(std::string(msg.function) + "-" + std::string(msg.text), msg.line));
+		if (!ret.second)
 		{
 			return;	// don't bother adding any more
 		}
 	}
-	else
-	{
-		ssprintf(inputBuffer[useInputBuffer1 ? 1 : 0], "[%s:%d] %s", function, line, outputBuffer);
-	}
 
-	if (sstrcmp(inputBuffer[0], inputBuffer[1]) == 0)
+	if (msg.line == lastLine && strcmp(msg.function, lastFunction) == 0 && strcmp(msg.text, lastText) == 0)
 	{
 		// Received again the same line
 		repeated++;
 		if (repeated == next)
 		{
-			if (repeated > 2)
-			{
-				ssprintf(outputBuffer, "last message repeated %u times (total %u repeats)", repeated - prev, repeated);
-			}
-			else
-			{
-				ssprintf(outputBuffer, "last message repeated %u times", repeated - prev);
-			}
-			printToDebugCallbacks(outputBuffer);
+			printRepeated(repeated, prev);
 			prev = repeated;
 			next *= 2;
 		}
+		return;
 	}
-	else
+
+	// Received another line, cleanup the old
+	if (repeated > 0 && repeated != prev && repeated != 1)
 	{
-		// Received another line, cleanup the old
-		if (repeated > 0 && repeated != prev && repeated != 1)
+		/* just repeat the previous message when only one repeat occurred */
+		printRepeated(repeated, prev);
+	}
+	repeated = 0;
+	next = 2;
+	prev = 0;
+	sstrcpy(lastFunction, msg.function);
+	lastLine = msg.line;
+	sstrcpy(lastText, msg.text);
+
+	if (callSiteRateLimited(msg))
+	{
+		return;
+	}
+
+	printToDebugCallbacks(formatMessage(msg, msg.part == LOG_WARNING).c_str());
+}
+
+/// Send msg to the synchronous callbacks, on the calling thread.
+static void printToSynchronousCallbacks(const DEBUG_MESSAGE &msg)
+{
+	static wz::mutex mutex;
+	std::string line;
+
+	for (debug_callback *curCallback = callbackRegistry; curCallback != nullptr; curCallback = curCallback->next)
+	{
+		if (curCallback->synchronous)
 		{
-			/* just repeat the previous message when only one repeat occurred */
-			if (repeated > 2)
+			if (line.empty())
 			{
-				ssprintf(outputBuffer, "last message repeated %u times (total %u repeats)", repeated - prev, repeated);
+				line = formatMessage(msg, false);
 			}
-			else
-			{
-				ssprintf(outputBuffer, "last message repeated %u times", repeated - prev);
-			}
-			printToDebugCallbacks(outputBuffer);
+			std::lock_guard<wz::mutex> lock(mutex);
+			curCallback->callback(&curCallback->data, line.c_str());
+		}
+	}
+}
+
+/// Write everything in the queue, oldest message first.
+static void writeQueue()
+{
+	DEBUG_MESSAGE *msg = messageQueue.exchange(nullptr, std::memory_order_acquire);
+	DEBUG_MESSAGE *ordered = nullptr;
+
+	// The queue is newest first, so reverse it.
+	while (msg != nullptr)
+	{
+		DEBUG_MESSAGE *next = msg->next;
+		msg->next = ordered;
+		ordered = msg;
+		msg = next;
+	}
+
+	while (ordered != nullptr)
+	{
+		DEBUG_MESSAGE *next = ordered->next;
+		if (ordered->flushed != nullptr)
+		{
+			wzSemaphorePost(ordered->flushed);
 		}
-		repeated = 0;
-		next = 2;
-		prev = 0;
+		else
+		{
+			writeMessage(*ordered);
+		}
+		delete ordered;
+		--queuedMessages;
+		ordered = next;
+	}
+
+	const unsigned dropped = droppedMessages.exchange(0);
+	if (dropped > 0)
+	{
+		char notice[MAX_LEN_LOG_LINE];
+		ssprintf(notice, "%u messages dropped, the debug log could not keep up", dropped);
+		printNotice(notice);
+	}
+}
+
+static int debugWriterThreadFunc(WZ_DECL_UNUSED void *data)
+{
+	bool quit = false;
+
+	onWriterThread = true;
+	while (!quit)
+	{
+		wzSemaphoreWait(writerSemaphore);
+		// Checked before taking the queue, so everything queued before quitting is still written.
+		quit = writerQuit;
+		writeQueue();
 	}
+	return 0;
+}
+
+/// Hand a copy of msg to the writer thread. Lock-free, and safe to call from any thread.
+static void pushMessage(const DEBUG_MESSAGE &msg)
+{
+	DEBUG_MESSAGE *node = new DEBUG_MESSAGE(msg);
+
+	++queuedMessages;
+	node->next = messageQueue.load(std::memory_order_relaxed);
+	while (!messageQueue.compare_exchange_weak(node->next, node, std::memory_order_release, std::memory_order_relaxed))
+	{}
+	if (node->next == nullptr)
+	{
+		// The writer takes the whole queue at once, so only needs waking up when the queue was empty.
+		wzSemaphorePost(writerSemaphore);
+	}
+}
+
+static void queueMessage(const DEBUG_MESSAGE &msg)
+{
+	printToSynchronousCallbacks(msg);
+	if (!writerRunning)
+	{
+		writeMessage(msg);
+		return;
+	}
+	if (queuedMessages >= MAX_QUEUED_MESSAGES && msg.part != LOG_FATAL)
+	{
+		if (msg.part != LOG_ERROR && msg.part != LOG_WARNING)
+		{
+			++droppedMessages;
+			return;
+		}
+		// Never drop errors and warnings, wait for the writer to catch up instead.
+		debugFlush();
+	}
+	pushMessage(msg);
+}
+
+void debugStartThread()
+{
+	if (writerThread != nullptr)
+	{
+		return;
+	}
+	static bool flushAtExit = false;
+	if (!flushAtExit)
+	{
+		// Don't lose queued messages when something calls exit().
+		atexit(debugFlush);
+		flushAtExit = true;
+	}
+	writerQuit = false;
+	writerSemaphore = wzSemaphoreCreate(0);
+	writerThread = wzThreadCreate(debugWriterThreadFunc, nullptr);
+	wzThreadStart(writerThread);
+	writerRunning = true;
+}
+
+void debugStopThread()
+{
+	if (writerThread == nullptr)
+	{
+		return;
+	}
+	writerQuit = true;
+	wzSemaphorePost(writerSemaphore);  // Wake up the thread, so it can quit.
+	wzThreadJoin(writerThread);
+	writerThread = nullptr;
+	writerRunning = false;
+	writeQueue();  // Anything queued while the thread was quitting.
+	wzSemaphoreDestroy(writerSemaphore);
+	writerSemaphore = nullptr;
+}
+
+void debugFlush()
+{
+	if (!writerRunning || onWriterThread)
+	{
+		return;
+	}
+
+	DEBUG_MESSAGE marker;
+	marker.part = LOG_LAST;
+	marker.line = 0;
+	marker.function = "";
+	marker.time = 0;
+	marker.flushed = wzSemaphoreCreate(0);
+	marker.text[0] = '\0';
+	pushMessage(marker);
+	wzSemaphoreWait(marker.flushed);
+	wzSemaphoreDestroy(marker.flushed);
+}
+
+void _realObjTrace(int id, const char *function, const char *str, ...)
+{
+	char vaBuffer[MAX_LEN_LOG_LINE];
+	DEBUG_MESSAGE msg;
+	va_list ap;
 
-	if (!repeated)
+	va_start(ap, str);
+	vssprintf(vaBuffer, str, ap);
+	va_end(ap);
+
+	msg.part = LOG_LAST;
+	msg.line = 0;
+	msg.function = function;
+	msg.time = time(nullptr);
+	msg.flushed = nullptr;
+	ssprintf(msg.text, "[%6d]: [%s] %s", id, function, vaBuffer);
+	queueMessage(msg);
+}
+
+// Thread local to prevent a race condition on read and write to this buffer if multiple
+// threads log errors. This means we will not be reporting any errors to console from threads
+// other than main. If we want to fix this, make sure accesses are protected by a mutex.
+static WZ_DECL_THREAD char errorStore[512];
+static WZ_DECL_THREAD bool errorWaiting = false;
+const char *debugLastError()
+{
+	if (errorWaiting)
 	{
-		time_t rawtime;
-		struct tm *timeinfo;
-		char ourtime[15];		//HH:MM:SS
+		errorWaiting = false;
+		return errorStore;
+	}
+	else
+	{
+		return nullptr;
+	}
+}
 
-		time(&rawtime);
-		timeinfo = localtime(&rawtime);
-		strftime(ourtime, 15, "%I:%M:%S", timeinfo);
+void _debug(int line, code_part part, const char *function, const char *str, ...)
+{
+	static WZ_DECL_THREAD bool lastWasStoredError = false;  // Like repeated messages, repeated errors are only stored once
+	DEBUG_MESSAGE msg;
+	va_list ap;
+
+	// Only format here, the writer thread does the rest.
+	msg.part = part;
+	msg.line = line;
+	msg.function = function;
+	msg.time = time(nullptr);
+	msg.flushed = nullptr;
+	va_start(ap, str);
+	vssprintf(msg.text, str, ap);
+	va_end(ap);
 
-		// Assemble the outputBuffer:
-		ssprintf(outputBuffer, "%-8s|%s: %s", code_part_names[part], ourtime, useInputBuffer1 ? inputBuffer[1] : inputBuffer[0]);
+	queueMessage(msg);
+
+	if (part != LOG_ERROR && part != LOG_FATAL && part != LOG_POPUP)
+	{
+		lastWasStoredError = false;
+		return;
+	}
 
-		printToDebugCallbacks(outputBuffer);
+	char callerBuffer[MAX_LEN_LOG_LINE];
+	ssprintf(callerBuffer, "[%s:%d] %s", function, line, msg.text);
 
-		if (part == LOG_ERROR)
+	if (part == LOG_ERROR)
+	{
+		// used to signal user that there was a error condition, and to check the logs.
+		if (!lastWasStoredError || strcmp(errorStore, callerBuffer) != 0)
 		{
-			// used to signal user that there was a error condition, and to check the logs.
-			sstrcpy(errorStore, useInputBuffer1 ? inputBuffer[1] : inputBuffer[0]);
+			sstrcpy(errorStore, callerBuffer);
 			errorWaiting = true;
 		}
+		lastWasStoredError = true;
+		return;
+	}
+	lastWasStoredError = false;
 
-		// Throw up a dialog box for users since most don't have a clue to check the dump file for information. Use for (duh) Fatal errors, that force us to terminate the game.
-		if (part == LOG_FATAL)
+	// Throw up a dialog box for users since most don't have a clue to check the dump file for information. Use for (duh) Fatal errors, that force us to terminate the game.
+	if (part == LOG_FATAL)
+	{
+		debugFlush();  // Make sure the log has everything, before we terminate.
+		if (wzIsFullscreen())
 		{
-			if (wzIsFullscreen())
-			{
-				wzToggleFullscreen();
-			}
+			wzToggleFullscreen();
+		}
 #if defined(WZ_OS_WIN)
-			char wbuf[512];
-			ssprintf(wbuf, "%s\n\nPlease check the file (%s) in your configuration directory for more details. \
-				\nDo not forget to upload the %s file, WZdebuginfo.txt and the warzone2100.rpt files in your bug reports at http://developer.wz2100.net/newticket!", useInputBuffer1 ? inputBuffer[1] : inputBuffer[0], WZ_DBGFile, WZ_DBGFile);
-			MessageBoxA(NULL, wbuf, "Warzone has terminated unexpectedly", MB_OK | MB_ICONERROR);
+		char wbuf[512];
+		ssprintf(wbuf, "%s\n\nPlease check the file (%s) in your configuration directory for more details. \
+			\nDo not forget to upload the %s file, WZdebuginfo.txt and the warzone2100.rpt files in your bug reports at http://developer.wz2100.net/newticket!", callerBuffer, WZ_DBGFile, WZ_DBGFile);
+		MessageBoxA(NULL, wbuf, "Warzone has terminated unexpectedly", MB_OK | MB_ICONERROR);
 #elif defined(WZ_OS_MAC)
-			int clickedIndex = \
-			                   cocoaShowAlert("Warzone has quit unexpectedly.",
-			                                  "Please check your logs and attach them along with a bug report. Thanks!",
-			                                  2, "Show Log Files & Open Bug Reporter", "Ignore", NULL);
-			if (clickedIndex == 0)
+		int clickedIndex = \
+		                   cocoaShowAlert("Warzone has quit unexpectedly.",
+		                                  "Please check your logs and attach them along with a bug report. Thanks!",
+		                                  2, "Show Log Files & Open Bug Reporter", "Ignore", NULL);
+		if (clickedIndex == 0)
+		{
+			cocoaOpenURL("http://developer.wz2100.net/newticket");
+			if (WZDebugfilename == NULL)
+			{
+				cocoaShowAlert("Unable to open debug log.",
+				               "The debug log subsystem has not yet been initialised.",
+				               2, "Continue", NULL);
+			}
+			else
 			{
-				cocoaOpenURL("http://developer.wz2100.net/newticket");
-				if (WZDebugfilename == NULL)
-				{
-					cocoaShowAlert("Unable to open debug log.",
-					               "The debug log subsystem has not yet been initialised.",
-					               2, "Continue", NULL);
-				}
-				else
-				{
-					cocoaSelectFileInFinder(WZDebugfilename);
-				}
-				cocoaOpenUserCrashReportFolder();
+				cocoaSelectFileInFinder(WZDebugfilename);
 			}
+			cocoaOpenUserCrashReportFolder();
+		}
 #else
-			const char *popupBuf = useInputBuffer1 ? inputBuffer[1] : inputBuffer[0];
-			wzFatalDialog(popupBuf);
+		wzFatalDialog(callerBuffer);
 #endif
-		}
+	}
 
-		// Throw up a dialog box for windows users since most don't have a clue to check the stderr.txt file for information
-		// This is a popup dialog used for times when the error isn't fatal, but we still need to notify user what is going on.
-		if (part == LOG_POPUP)
-		{
+	// Throw up a dialog box for windows users since most don't have a clue to check the stderr.txt file for information
+	// This is a popup dialog used for times when the error isn't fatal, but we still need to notify user what is going on.
+	if (part == LOG_POPUP)
+	{
 #if defined(WZ_OS_WIN)
-			char wbuf[512];
-			ssprintf(wbuf, "A non fatal error has occurred.\n\n%s\n\n", useInputBuffer1 ? inputBuffer[1] : inputBuffer[0]);
-			MessageBoxA(NULL,
-			            wbuf,
-			            "Warzone has detected a problem.", MB_OK | MB_ICONINFORMATION);
+		char wbuf[512];
+		ssprintf(wbuf, "A non fatal error has occurred.\n\n%s\n\n", callerBuffer);
+		MessageBoxA(NULL,
+		            wbuf,
+		            "Warzone has detected a problem.", MB_OK | MB_ICONINFORMATION);
 #elif defined(WZ_OS_MAC)
-			cocoaShowAlert("Warzone has detected a problem.", inputBuffer[useInputBuffer1 ? 1 : 0], 0, "OK", NULL);
+		cocoaShowAlert("Warzone has detected a problem.", callerBuffer, 0, "OK", NULL);
 #endif
-		}
-
 	}
-	useInputBuffer1 = !useInputBuffer1; // Swap buffers
 }
 
 void _debugBacktrace(code_part part)
@@ -571,11 +946,6 @@ void _debugBacktrace(code_part part)
 #endif
 }
 
-bool debugPartEnabled(code_part codePart)
-{
-	return enabled_debug[codePart];
-}
-
 void debugDisableAssert()
 {
 	assertEnabled = false;
@@ -65,13 +65,14 @@ extern bool assertEnabled;
 #endif
 
 
-/** Deals with failure in an assert. Expression is (re-)evaluated for output in the assert() call. */
+/** Deals with failure in an assert. Expression is (re-)evaluated for output in the assert() call.
+ *  The log is flushed first, since the debugger or a crash may stop the process before the writer thread gets to it. */
 #define ASSERT_FAILURE(expr, expr_string, location_description, function, ...) \
 	( \
 	  (void)_debug(__LINE__, LOG_INFO, function, __VA_ARGS__), \
 	  (void)_debug(__LINE__, LOG_INFO, function, "Assert in Warzone: %s (%s), last script event: '%s'", \
 	               location_description, expr_string, last_called_script_event), \
-	  ( assertEnabled ? (void)wz_assert(expr) : (void)0 )\
+	  ( assertEnabled ? (debugFlush(), (void)wz_assert(expr)) : (void)0 )\
 	)
 
 /**
@@ -203,6 +204,7 @@ struct debug_callback
 	debug_callback_init init; /// Setup function
 	debug_callback_exit exit; /// Cleaning function
 	void *data;  /// Used to pass data to the above functions. Eg a filename or handle.
+	bool synchronous;  /// Called by the thread calling debug(), see debug_register_synchronous_callback()
 };
 
 /**
@@ -217,6 +219,32 @@ void debug_init();
  */
 void debug_exit();
 
+/**
+ * Start the debug writer thread. From then on, debug() only formats the message and queues it, and the writer
+ * thread passes it to the callbacks, so that slow callbacks don't hold up the game loop or the path thread.
+ *
+ * Register all callbacks before calling this. Until then, messages are output on the calling thread.
+ */
+void debugStartThread();
+
+/**
+ * Write any queued messages, and stop the debug writer thread. Called by debug_exit().
+ */
+void debugStopThread();
+
+/**
+ * Wait until the writer thread has output everything queued so far. Does nothing on the writer thread itself.
+ */
+void debugFlush();
+
+/**
+ * Set the format of the debug output, "text" (the default) for human readable lines, or "json" for one JSON
+ * object per line.
+ *
+ * \return false if the format is not known.
+ */
+bool debugSetFormat(const char *str);
+
 /**
  * Have the stderr output callback flush its output before returning.
  *
@@ -237,6 +265,16 @@ const char *debugLastError();
  */
 void debug_register_callback(debug_callback_fn callback, debug_callback_init init, debug_callback_exit exit, void *data);
 
+/**
+ * Register a callback to be called on every call to debug(), by the thread calling debug() rather than the debug
+ * writer thread, so that it has every message logged before a crash. Repeated messages are not suppressed.
+ * The callback must be quick. It is never called by two threads at once.
+ *
+ * \param	callback	Function which does the output
+ * \param	data		Data to be passed to the callback (optional, may be NULL)
+ */
+void debug_register_synchronous_callback(debug_callback_fn callback, void *data);
+
 void debug_callback_file(void **data, const char *outputBuffer);
 bool debug_callback_file_init(void **data);
 void debug_callback_file_exit(void **data);
@@ -260,10 +298,10 @@ bool debug_enable_switch(const char *str);
  *
  * Only outputs if debugging of part was formerly enabled with debug_enable_switch.
  */
-#define debug(part, ...) do { if (enabled_debug[part]) _debug(__LINE__, part, __FUNCTION__, __VA_ARGS__); } while(0)
+#define debug(part, ...) do { if (unlikely(enabled_debug[part])) _debug(__LINE__, part, __FUNCTION__, __VA_ARGS__); } while(0)
 void _debug(int line, code_part part, const char *function, const char *str, ...) WZ_DECL_FORMAT(printf, 4, 5);
 
-#define debugBacktrace(part, ...) do { if (enabled_debug[part]) { _debug(__LINE__, part, __FUNCTION__, __VA_ARGS__); _debugBacktrace(part); }} while(0)
+#define debugBacktrace(part, ...) do { if (unlikely(enabled_debug[part])) { _debug(__LINE__, part, __FUNCTION__, __VA_ARGS__); _debugBacktrace(part); }} while(0)
 void _debugBacktrace(code_part part);
 
 /** Global to keep track of which game object to trace. */
@@ -292,8 +330,11 @@ void debug_MEMCHKON();
 void debug_MEMSTATS();
 #endif
 
-/** Checks if a particular debub flag was enabled */
-bool debugPartEnabled(code_part codePart);
+/** Checks if a particular debub flag was enabled. Cheap, use it to skip preparing output nobody will see. */
+static inline bool debugPartEnabled(code_part codePart)
+{
+	return enabled_debug[codePart];
+}
 
 void debugDisableAssert();
 
@@ -29,6 +29,9 @@ WZ_DECL_NONNULL(1) PHYSFS_file *openLoadFile(const char *fileName, bool hard_fai
 /*! Open a file for writing */
 WZ_DECL_NONNULL(1) PHYSFS_file *openSaveFile(const char *fileName);
 
+/** Whether the file exists for loadFile, which also loads from the open savegame archive. */
+WZ_DECL_NONNULL(1) bool fileExists(const char *pFileName);
+
 /** Load the file with name pointed to by pFileName into a memory buffer. */
 WZ_DECL_NONNULL(1) bool loadFile(const char *pFileName, char **ppFileData, UDWORD *pFileSize);
 
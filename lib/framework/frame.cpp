@@ -32,6 +32,8 @@
 
 #include "frameresource.h"
 #include "input.h"
+#include "jsonreader.h"
+#include "savearchive.h"
 
 /************************************************************************************
  *
@@ -125,6 +127,10 @@ void frameShutDown()
 	// Shutdown the resource stuff
 	debug(LOG_NEVER, "No more resources!");
 	resShutDown();
+	JsonReader::clearScannedFiles();
+
+	saveArchiveWait();
+	saveArchiveClose();
 }
 
 void setMouseWarp(bool value)
@@ -166,6 +172,32 @@ PHYSFS_file *openLoadFile(const char *fileName, bool hard_fail)
 ***************************************************************************/
 static bool loadFile2(const char *pFileName, char **ppFileData, UDWORD *pFileSize, bool AllocateMem, bool hard_fail)
 {
+	if (saveArchiveCovers(pFileName))
+	{
+		QByteArray data;
+		if (!saveArchiveRead(pFileName, &data))
+		{
+			if (hard_fail)
+			{
+				ASSERT(false, "file %s could not be opened from the savegame archive", pFileName);
+			}
+			return false;
+		}
+		if (AllocateMem)
+		{
+			*ppFileData = (char *)malloc(data.size() + 1);
+		}
+		else if ((UDWORD)data.size() >= *pFileSize)
+		{
+			debug(LOG_ERROR, "No room for file %s, buffer is too small! Got: %d Need: %d", pFileName, *pFileSize, data.size());
+			return false;
+		}
+		memcpy(*ppFileData, data.constData(), data.size());
+		(*ppFileData)[data.size()] = 0;
+		*pFileSize = data.size();
+		return true;
+	}
+
 	if (PHYSFS_isDirectory(pFileName))
 	{
 		return false;
@@ -264,6 +296,11 @@ bool saveFile(const char *pFileName, const char *pFileData, UDWORD fileSize)
 	PHYSFS_file *pfile;
 	PHYSFS_uint32 size = fileSize;
 
+	if (saveArchiveWrite(pFileName, pFileData, fileSize))
+	{
+		return true;
+	}
+
 	debug(LOG_WZ, "We are to write (%s) of size %d", pFileName, fileSize);
 	pfile = openSaveFile(pFileName);
 	if (!pfile)
@@ -297,6 +334,15 @@ bool saveFile(const char *pFileName, const char *pFileData, UDWORD fileSize)
 	return true;
 }
 
+bool fileExists(const char *pFileName)
+{
+	if (saveArchiveCovers(pFileName))
+	{
+		return saveArchiveContains(pFileName);
+	}
+	return PHYSFS_exists(pFileName);
+}
+
 bool loadFile(const char *pFileName, char **ppFileData, UDWORD *pFileSize)
 {
 	return loadFile2(pFileName, ppFileData, pFileSize, true, true);
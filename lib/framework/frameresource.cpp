@@ -25,10 +25,17 @@
  */
 #include "frameresource.h"
 
+#include <map>
+#include <string>
+#include <vector>
+
+#include <QtCore/QElapsedTimer>
+
 #include "string_ext.h"
 
 #include "file.h"
 #include "resly.h"
+#include "wzapp.h"
 
 // Local prototypes
 static RES_TYPE *psResTypes = nullptr;
@@ -46,6 +53,51 @@ static void ResetResourceFile();
 // callback to resload screen.
 static RESLOAD_CALLBACK resLoadCallback = nullptr;
 
+/** Number of threads reading resource files ahead of the loaders. */
+#define RES_PREFETCH_THREADS	2
+/** Maximum number of files read ahead of the one being processed, to bound memory use. */
+#define RES_PREFETCH_AHEAD		32
+
+/// A file listed in the res file, waiting to be loaded
+struct RES_PENDING
+{
+	RES_TYPE	*psType;
+	std::string	file;					///< ID from the res file
+	std::string	fileName;				///< Full (possibly translated) file name
+};
+
+/// A file read or decoded by the prefetch threads
+struct RES_BUFFER
+{
+	char		*pBuffer = nullptr;		///< File contents, zero terminated; NULL if not read
+	UDWORD		size = 0;
+	bool		decoded = false;		///< Whether the decode function of the type has been run
+	void		*pDecoded = nullptr;	///< What the decode function returned
+	qint64		readTime = 0;			///< Nanoseconds taken to read or decode the file
+};
+
+/// State shared with the prefetch threads
+struct RES_PREFETCH
+{
+	std::vector<wz::packaged_task<RES_BUFFER()>> *tasks;
+	size_t		next = 0;				///< Next task to run
+	bool		abort = false;
+	wz::mutex	mutex;
+	WZ_SEMAPHORE	*window;			///< Number of files that may still be read ahead
+};
+
+/// Time spent on all files of a resource type
+struct RES_TIMING
+{
+	unsigned	count = 0;
+	uint64_t	bytes = 0;
+	qint64		readTime = 0;			///< Nanoseconds spent reading or decoding, on the prefetch threads
+	qint64		loadTime = 0;			///< Nanoseconds spent in the load functions, on the main thread
+};
+
+// Files listed by the res file being parsed; NULL if not in resLoad
+static std::vector<RES_PENDING> *psResPending = nullptr;
+
 
 /* next four used in HashPJW */
 #define	BITS_IN_int		32
@@ -179,6 +231,9 @@ void resSetBaseDir(const char *pResDir)
 	sstrcpy(aResDir, pResDir);
 }
 
+// Forward declarations
+static bool resLoadPending(std::vector<RES_PENDING> &pending, const char *pResFile);
+
 /* Parse the res file */
 bool resLoad(const char *pResFile, SDWORD blockID)
 {
@@ -201,17 +256,26 @@ bool resLoad(const char *pResFile, SDWORD blockID)
 		return false;
 	}
 
-	// and parse it
+	// and parse it, which only lists the files to load
+	std::vector<RES_PENDING> pending;
+	psResPending = &pending;
 	res_set_extra(&input);
 	if (res_parse() != 0)
 	{
 		debug(LOG_FATAL, "Failed to parse %s", pResFile);
 		retval = false;
 	}
+	psResPending = nullptr;
 
 	res_lex_destroy();
 	PHYSFS_close(input.input.physfsfile);
 
+	// Load whatever was listed before any parse error, like loading during the parse used to
+	if (!resLoadPending(pending, pResFile))
+	{
+		retval = false;
+	}
+
 	return retval;
 }
 
@@ -246,6 +310,9 @@ bool resAddBufferLoad(const char *pType, RES_BUFFERLOAD buffLoad, RES_FREE relea
 
 	psT->buffLoad = buffLoad;
 	psT->fileLoad = nullptr;
+	psT->decode = nullptr;
+	psT->commit = nullptr;
+	psT->discard = nullptr;
 	psT->release = release;
 
 	psT->psNext = psResTypes;
@@ -262,6 +329,28 @@ bool resAddFileLoad(const char *pType, RES_FILELOAD fileLoad, RES_FREE release)
 
 	psT->buffLoad = nullptr;
 	psT->fileLoad = fileLoad;
+	psT->decode = nullptr;
+	psT->commit = nullptr;
+	psT->discard = nullptr;
+	psT->release = release;
+
+	psT->psNext = psResTypes;
+	psResTypes = psT;
+
+	return true;
+}
+
+
+/* Add decode and commit functions for a file type */
+bool resAddDecodeLoad(const char *pType, RES_DECODE decode, RES_COMMIT commit, RES_FREE discard, RES_FREE release)
+{
+	RES_TYPE	*psT = resAlloc(pType);
+
+	psT->buffLoad = nullptr;
+	psT->fileLoad = nullptr;
+	psT->decode = decode;
+	psT->commit = commit;
+	psT->discard = discard;
 	psT->release = release;
 
 	psT->psNext = psResTypes;
@@ -349,7 +438,7 @@ static SDWORD FindEmptyResourceFile()
 
 
 // Get a resource data file ... either loads it or just returns a pointer
-static bool RetreiveResourceFile(char *ResourceName, RESOURCEFILE **NewResource)
+static bool RetreiveResourceFile(const char *ResourceName, RESOURCEFILE **NewResource)
 {
 	SDWORD ResID;
 	RESOURCEFILE *ResData;
@@ -459,19 +548,12 @@ static void makeLocaleFile(char *fileName, size_t maxlen)  // given string must
 }
 
 
-/*!
- * Call the load function (registered in data.c)
- * for this filetype
- */
-bool resLoadFile(const char *pType, const char *pFile)
+/// Find the resource type with the given name
+static RES_TYPE *resFindType(const char *pType)
 {
-	RES_TYPE	*psT = nullptr;
-	void		*pData = nullptr;
-	RES_DATA	*psRes = nullptr;
-	char		aFileName[PATH_MAX];
-	UDWORD HashedName, HashedType = HashString(pType);
+	RES_TYPE	*psT;
+	UDWORD		HashedType = HashString(pType);
 
-	// Find the resource-type
 	for (psT = psResTypes; psT != nullptr; psT = psT->psNext)
 	{
 		if (psT->HashedType == HashedType)
@@ -480,12 +562,119 @@ bool resLoadFile(const char *pType, const char *pFile)
 			break;
 		}
 	}
+	return psT;
+}
 
-	if (psT == nullptr)
+/// Create the name of the file to load for a resource in the current resource directory
+static bool resMakeFileName(const char *pFile, char *aFileName, size_t maxlen)
+{
+	if (strlen(aCurrResDir) + strlen(pFile) + 1 >= maxlen)
 	{
-		debug(LOG_WZ, "resLoadFile: Unknown type: %s", pType);
+		debug(LOG_ERROR, "resLoadFile: Filename too long!! %s%s", aCurrResDir, pFile);
 		return false;
 	}
+	strlcpy(aFileName, aCurrResDir, maxlen);
+	strlcat(aFileName, pFile, maxlen);
+
+	makeLocaleFile(aFileName, maxlen);  // check for translated file
+	return true;
+}
+
+/*!
+ * Read a whole file on a prefetch thread.
+ * Failures are silent here, the file is read again by resLoadFileData to report them.
+ */
+static RES_BUFFER resReadFile(const char *pFileName)
+{
+	QElapsedTimer	timer;
+	RES_BUFFER		buffer;
+
+	timer.start();
+	PHYSFS_file *pfile = PHYSFS_openRead(pFileName);
+	if (pfile == nullptr)
+	{
+		return buffer;
+	}
+	PHYSFS_sint64 filesize = PHYSFS_fileLength(pfile);
+	if (filesize >= 0)
+	{
+		buffer.pBuffer = (char *)malloc(filesize + 1);
+		if (buffer.pBuffer != nullptr && PHYSFS_read(pfile, buffer.pBuffer, 1, filesize) == filesize)
+		{
+			buffer.pBuffer[filesize] = 0;
+			buffer.size = filesize;
+		}
+		else
+		{
+			free(buffer.pBuffer);
+			buffer.pBuffer = nullptr;
+		}
+	}
+	PHYSFS_close(pfile);
+	buffer.readTime = timer.nsecsElapsed();
+	return buffer;
+}
+
+/*!
+ * Run the decode function of a file's type, on a prefetch thread.
+ */
+static RES_BUFFER resDecodeFile(RES_TYPE *psT, const char *pFileName, const char *pFile)
+{
+	QElapsedTimer	timer;
+	RES_BUFFER		buffer;
+
+	timer.start();
+	buffer.pDecoded = psT->decode(pFileName, pFile);
+	buffer.decoded = true;
+	buffer.readTime = timer.nsecsElapsed();
+	return buffer;
+}
+
+/// Free what was read or decoded for a file that won't be loaded
+static void resFreeBuffer(RES_TYPE *psT, RES_BUFFER *psBuffer)
+{
+	free(psBuffer->pBuffer);
+	psBuffer->pBuffer = nullptr;
+	if (psBuffer->pDecoded != nullptr && psT->discard != nullptr)
+	{
+		psT->discard(psBuffer->pDecoded);
+	}
+	psBuffer->pDecoded = nullptr;
+}
+
+/// Run the file read tasks in order, staying at most RES_PREFETCH_AHEAD files ahead of the main thread
+static void resPrefetchThread(RES_PREFETCH *psPrefetch)
+{
+	for (;;)
+	{
+		wzSemaphoreWait(psPrefetch->window);
+
+		psPrefetch->mutex.lock();
+		size_t task = psPrefetch->next;
+		bool stop = psPrefetch->abort || task >= psPrefetch->tasks->size();
+		if (!stop)
+		{
+			++psPrefetch->next;
+		}
+		psPrefetch->mutex.unlock();
+
+		if (stop)
+		{
+			return;
+		}
+		(*psPrefetch->tasks)[task]();
+	}
+}
+
+/*!
+ * Call the load function (registered in data.c) for a file.
+ * \param psBuffer the file contents if already read or decoded, which are freed or committed
+ */
+static bool resLoadFileData(RES_TYPE *psT, const char *pFile, const char *aFileName, RES_BUFFER *psBuffer)
+{
+	void		*pData = nullptr;
+	RES_DATA	*psRes = nullptr;
+	UDWORD		HashedName;
 
 	// Check for duplicates
 	HashedName = HashStringIgnoreCase(pFile);
@@ -498,30 +687,48 @@ bool resLoadFile(const char *pType, const char *pFile)
 			      pFile, HashedName, psT->aType);
 			// assume that they are actually both the same and silently fail
 			// lovely little hack to allow some files to be loaded from disk (believe it or not!).
+			resFreeBuffer(psT, psBuffer);
 			return true;
 		}
 	}
 
-	// Create the file name
-	if (strlen(aCurrResDir) + strlen(pFile) + 1 >= PATH_MAX)
-	{
-		debug(LOG_ERROR, "resLoadFile: Filename too long!! %s%s", aCurrResDir, pFile);
-		return false;
-	}
-	sstrcpy(aFileName, aCurrResDir);
-	sstrcat(aFileName, pFile);
-
-	makeLocaleFile(aFileName, sizeof(aFileName));  // check for translated file
-
 	SetLastResourceFilename(pFile); // Save the filename in case any routines need it
 
 	// load the resource
-	if (psT->buffLoad)
+	if (psT->commit)
+	{
+		if (!psBuffer->decoded)
+		{
+			*psBuffer = resDecodeFile(psT, aFileName, pFile);
+		}
+
+		// The commit function owns the decoded data now
+		const bool committed = psT->commit(psBuffer->pDecoded, aFileName, &pData);
+		psBuffer->pDecoded = nullptr;
+		if (!committed)
+		{
+			ASSERT(false, "The load function for resource type \"%s\" failed for file \"%s\"", psT->aType, pFile);
+			if (psT->release != nullptr)
+			{
+				psT->release(pData);
+			}
+			return false;
+		}
+	}
+	else if (psT->buffLoad)
 	{
 		RESOURCEFILE *Resource;
+		RESOURCEFILE Prefetched;
 
+		if (psBuffer->pBuffer != nullptr)
+		{
+			Prefetched.pBuffer = psBuffer->pBuffer;
+			Prefetched.size = psBuffer->size;
+			Prefetched.type = RESFILETYPE_LOADED;
+			Resource = &Prefetched;
+		}
 		// Load the file in a buffer
-		if (!RetreiveResourceFile(aFileName, &Resource))
+		else if (!RetreiveResourceFile(aFileName, &Resource))
 		{
 			debug(LOG_ERROR, "resLoadFile: Unable to retreive resource - %s", aFileName);
 			return false;
@@ -530,7 +737,7 @@ bool resLoadFile(const char *pType, const char *pFile)
 		// Now process the buffer data
 		if (!psT->buffLoad(Resource->pBuffer, Resource->size, &pData))
 		{
-			ASSERT(false, "The load function for resource type \"%s\" failed for file \"%s\"", pType, pFile);
+			ASSERT(false, "The load function for resource type \"%s\" failed for file \"%s\"", psT->aType, pFile);
 			FreeResourceFile(Resource);
 			if (psT->release != nullptr)
 			{
@@ -543,10 +750,12 @@ bool resLoadFile(const char *pType, const char *pFile)
 	}
 	else if (psT->fileLoad)
 	{
+		free(psBuffer->pBuffer);
+
 		// Process data directly from file
 		if (!psT->fileLoad(aFileName, &pData))
 		{
-			ASSERT(false, "The load function for resource type \"%s\" failed for file \"%s\"", pType, pFile);
+			ASSERT(false, "The load function for resource type \"%s\" failed for file \"%s\"", psT->aType, pFile);
 			if (psT->release != nullptr)
 			{
 				psT->release(pData);
@@ -578,6 +787,144 @@ bool resLoadFile(const char *pType, const char *pFile)
 	return true;
 }
 
+/*!
+ * Load the files listed by a res file, in order.
+ * The files are read, or decoded for types split into decode and commit functions, by a pool of threads ahead of
+ * the main thread, which only runs the load and commit functions, since those may create textures or touch game
+ * state. The commits run in the order of the res file, each after its own decode, so a file can rely on anything
+ * listed before it having been loaded; decode functions only read their own file.
+ */
+static bool resLoadPending(std::vector<RES_PENDING> &pending, const char *pResFile)
+{
+	std::vector<wz::packaged_task<RES_BUFFER()>> tasks;
+	std::vector<wz::future<RES_BUFFER>> buffers;
+	std::map<std::string, RES_TIMING> timings;
+	std::vector<wz::thread> threads;
+	RES_PREFETCH prefetch;
+	QElapsedTimer totalTimer, loadTimer;
+	qint64 slowestTime = -1;
+	const char *slowestFile = "";
+	bool retval = true;
+	size_t i, loaded;
+
+	if (pending.empty())
+	{
+		return true;
+	}
+	totalTimer.start();
+
+	tasks.reserve(pending.size());
+	buffers.reserve(pending.size());
+	for (const RES_PENDING &entry : pending)
+	{
+		// Only the buffer load functions can use the file contents, and decode functions read the file themselves
+		RES_TYPE *psT = entry.psType;
+		const std::string fileName = entry.fileName, file = entry.file;
+		tasks.emplace_back([psT, fileName, file]() -> RES_BUFFER {
+			if (psT->decode)
+			{
+				return resDecodeFile(psT, fileName.c_str(), file.c_str());
+			}
+			return psT->buffLoad ? resReadFile(fileName.c_str()) : RES_BUFFER();
+		});
+		buffers.push_back(tasks.back().get_future());
+	}
+
+	prefetch.tasks = &tasks;
+	prefetch.window = wzSemaphoreCreate(RES_PREFETCH_AHEAD);
+	for (i = 0; i < RES_PREFETCH_THREADS && i < tasks.size(); ++i)
+	{
+		threads.emplace_back(resPrefetchThread, &prefetch);
+	}
+
+	for (loaded = 0; loaded < pending.size() && retval; ++loaded)
+	{
+		const RES_PENDING &entry = pending[loaded];
+		RES_BUFFER buffer = buffers[loaded].get();
+		wzSemaphorePost(prefetch.window);
+
+		loadTimer.start();
+		const UDWORD size = buffer.size;
+		retval = resLoadFileData(entry.psType, entry.file.c_str(), entry.fileName.c_str(), &buffer);
+
+		RES_TIMING &timing = timings[entry.psType->aType];
+		const qint64 loadTime = loadTimer.nsecsElapsed();
+		timing.count++;
+		timing.bytes += size;
+		timing.readTime += buffer.readTime;
+		timing.loadTime += loadTime;
+		if (buffer.readTime + loadTime > slowestTime)
+		{
+			slowestTime = buffer.readTime + loadTime;
+			slowestFile = entry.file.c_str();
+		}
+	}
+
+	// Stop the prefetch threads, they may be waiting for room to read ahead
+	prefetch.mutex.lock();
+	prefetch.abort = true;
+	prefetch.mutex.unlock();
+	for (i = 0; i < threads.size(); ++i)
+	{
+		wzSemaphorePost(prefetch.window);
+	}
+	for (wz::thread &thread : threads)
+	{
+		thread.join();
+	}
+	wzSemaphoreDestroy(prefetch.window);
+
+	// Free anything read ahead of a failed load
+	for (; loaded < prefetch.next; ++loaded)
+	{
+		RES_BUFFER buffer = buffers[loaded].get();
+		resFreeBuffer(pending[loaded].psType, &buffer);
+	}
+
+	debug(LOG_WZ, "resLoad: %s took %lld ms, slowest file %s (%lld ms)", pResFile,
+	      (long long)(totalTimer.nsecsElapsed() / 1000000), slowestFile, (long long)(slowestTime / 1000000));
+	for (const auto &timing : timings)
+	{
+		debug(LOG_WZ, "resLoad:   %-10s %4u files %8llu KiB, read %5lld ms, load %5lld ms", timing.first.c_str(), timing.second.count,
+		      (unsigned long long)(timing.second.bytes / 1024), (long long)(timing.second.readTime / 1000000), (long long)(timing.second.loadTime / 1000000));
+	}
+
+	return retval;
+}
+
+/*!
+ * Call the load function (registered in data.c)
+ * for this filetype
+ */
+bool resLoadFile(const char *pType, const char *pFile)
+{
+	char		aFileName[PATH_MAX];
+
+	// Find the resource-type
+	RES_TYPE *psT = resFindType(pType);
+	if (psT == nullptr)
+	{
+		debug(LOG_WZ, "resLoadFile: Unknown type: %s", pType);
+		return false;
+	}
+
+	// Create the file name
+	if (!resMakeFileName(pFile, aFileName, sizeof(aFileName)))
+	{
+		return false;
+	}
+
+	// While parsing a res file, only note what to load
+	if (psResPending != nullptr)
+	{
+		psResPending->push_back(RES_PENDING{psT, pFile, aFileName});
+		return true;
+	}
+
+	RES_BUFFER buffer;
+	return resLoadFileData(psT, pFile, aFileName, &buffer);
+}
+
 /* Return the resource for a type and hashedname */
 void *resGetDataFromHash(const char *pType, UDWORD HashedID)
 {
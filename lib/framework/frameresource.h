@@ -39,6 +39,14 @@ typedef bool (*RES_FILELOAD)(const char *pFile, void **pData);
 /** Function pointer for releasing a resource loaded by the above functions. */
 typedef void (*RES_FREE)(void *pData);
 
+/** Function pointer for the thread safe part of loading a file, which may run on a prefetch thread ahead of the
+ *  main thread. It must not use anything the main thread changes, and returns what it decoded, or NULL on failure. */
+typedef void *(*RES_DECODE)(const char *pFile, const char *pID);
+
+/** Function pointer for finishing loading a file on the main thread, from what RES_DECODE returned for it.
+ *  It takes ownership of pDecoded, which is NULL if decoding failed. */
+typedef bool (*RES_COMMIT)(void *pDecoded, const char *pFile, void **pData);
+
 /** callback type for resload display callback. */
 typedef void (*RESLOAD_CALLBACK)();
 
@@ -71,6 +79,10 @@ struct RES_TYPE
 	UDWORD	HashedType;				// hashed version of the name of the id - // a null hashedtype indicates end of list
 
 	RES_FILELOAD	fileLoad;		// This isn't really used any more ?
+
+	RES_DECODE		decode;			// routine to decode a file on any thread, if it can be split from loading
+	RES_COMMIT		commit;			// routine to finish loading what decode returned, on the main thread
+	RES_FREE		discard;		// routine to free what decode returned if it is never committed
 	RES_TYPE       *psNext;
 };
 
@@ -106,6 +118,10 @@ WZ_DECL_NONNULL(1) bool resAddBufferLoad(const char *pType, RES_BUFFERLOAD buffL
 /** Add a file name load and release function for a file type. */
 WZ_DECL_NONNULL(1) bool resAddFileLoad(const char *pType, RES_FILELOAD fileLoad, RES_FREE release);
 
+/** Add decode, commit and release functions for a file type, so files of the type are decoded on the prefetch
+ *  threads and only committed on the main thread. */
+WZ_DECL_NONNULL(1, 2, 3) bool resAddDecodeLoad(const char *pType, RES_DECODE decode, RES_COMMIT commit, RES_FREE discard, RES_FREE release);
+
 /** Call the load function for a file. */
 WZ_DECL_NONNULL(1, 2) bool resLoadFile(const char *pType, const char *pFile);
 
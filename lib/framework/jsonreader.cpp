@@ -0,0 +1,952 @@
+/*
+	This file is part of Warzone 2100.
+	Copyright (C) 2005-2017  Warzone 2100 Project
+
+	Warzone 2100 is free software; you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation; either version 2 of the License, or
+	(at your option) any later version.
+
+	Warzone 2100 is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with Warzone 2100; if not, write to the Free Software
+	Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301 USA
+*/
+/** @file
+ *  Read only JSON files of named entries, see jsonreader.h.
+ */
+
+#include <QtCore/QJsonArray>
+#include <QtCore/QJsonDocument>
+#include <QtCore/QJsonObject>
+#include <algorithm>
+#include <ctype.h>
+#include <errno.h>
+#include <math.h>
+#include <memory>
+#include <string>
+#include <unordered_map>
+
+// Get platform defines before checking for them.
+// Qt headers MUST come before platform specific stuff!
+#include "jsonreader.h"
+#include "file.h"
+#include "wzconfig.h"
+
+struct KEY_TABLE
+{
+	std::unordered_map<std::string, unsigned> ids;
+	std::vector<const char *> names;  ///< Point to the keys of ids, which never move.
+};
+
+static KEY_TABLE &keyTable()
+{
+	static KEY_TABLE table;
+	return table;
+}
+
+static unsigned internKey(std::string &&name)
+{
+	KEY_TABLE &table = keyTable();
+	auto found = table.ids.find(name);
+	if (found != table.ids.end())
+	{
+		return found->second;
+	}
+	auto inserted = table.ids.emplace(std::move(name), (unsigned)table.names.size()).first;
+	table.names.push_back(inserted->first.c_str());
+	return inserted->second;
+}
+
+JsonKey::JsonKey(const char *name)
+	: id(internKey(std::string(name)))
+{}
+
+JsonKey::JsonKey(const char *name, size_t length)
+	: id(internKey(std::string(name, length)))
+{}
+
+JsonKey::JsonKey(const QString &name)
+	: id(internKey(name.toStdString()))
+{}
+
+const char *JsonKey::name() const
+{
+	return keyTable().names[id];
+}
+
+/*******************************************************************************
+*		Parsing
+*******************************************************************************/
+
+static const char *skipSpace(const char *pos, const char *end)
+{
+	while (pos != end && (*pos == ' ' || *pos == '\t' || *pos == '\n' || *pos == '\r'))
+	{
+		++pos;
+	}
+	return pos;
+}
+
+static int hexDigit(char c)
+{
+	return c >= '0' && c <= '9' ? c - '0' : c >= 'a' && c <= 'f' ? c - 'a' + 10 : c >= 'A' && c <= 'F' ? c - 'A' + 10 : -1;
+}
+
+static bool parseHex4(const char *pos, const char *end, unsigned *code)
+{
+	if (end - pos < 4)
+	{
+		return false;
+	}
+	*code = 0;
+	for (int i = 0; i < 4; ++i)
+	{
+		int digit = hexDigit(pos[i]);
+		if (digit < 0)
+		{
+			return false;
+		}
+		*code = *code << 4 | digit;
+	}
+	return true;
+}
+
+static void appendUtf8(std::string &out, unsigned code)
+{
+	if (code < 0x80)
+	{
+		out += (char)code;
+	}
+	else if (code < 0x800)
+	{
+		out += (char)(0xC0 | code >> 6);
+		out += (char)(0x80 | (code & 0x3F));
+	}
+	else if (code < 0x10000)
+	{
+		out += (char)(0xE0 | code >> 12);
+		out += (char)(0x80 | (code >> 6 & 0x3F));
+		out += (char)(0x80 | (code & 0x3F));
+	}
+	else
+	{
+		out += (char)(0xF0 | code >> 18);
+		out += (char)(0x80 | (code >> 12 & 0x3F));
+		out += (char)(0x80 | (code >> 6 & 0x3F));
+		out += (char)(0x80 | (code & 0x3F));
+	}
+}
+
+/// Returns the UTF-8 characters of a string with escapes, which have been checked by parseString.
+static std::string unescape(const char *begin, const char *end)
+{
+	std::string out;
+	out.reserve(end - begin);
+	for (const char *pos = begin; pos != end; ++pos)
+	{
+		if (*pos != '\\')
+		{
+			out += *pos;
+			continue;
+		}
+		switch (*++pos)
+		{
+		case 'b': out += '\b'; break;
+		case 'f': out += '\f'; break;
+		case 'n': out += '\n'; break;
+		case 'r': out += '\r'; break;
+		case 't': out += '\t'; break;
+		case 'u':
+			{
+				unsigned code = 0, low = 0;
+				parseHex4(pos + 1, end, &code);
+				pos += 4;
+				if (code >= 0xD800 && code < 0xDC00 && end - pos > 6 && pos[1] == '\\' && pos[2] == 'u'
+				    && parseHex4(pos + 3, end, &low) && low >= 0xDC00 && low < 0xE000)
+				{
+					code = 0x10000 + ((code - 0xD800) << 10) + (low - 0xDC00);
+					pos += 6;
+				}
+				else if (code >= 0xD800 && code < 0xE000)
+				{
+					code = 0xFFFD;  // Unpaired surrogate, like QString::fromUtf16.
+				}
+				appendUtf8(out, code);
+				break;
+			}
+		default: out += *pos; break;  // '"', '\\' or '/'.
+		}
+	}
+	return out;
+}
+
+/// Parses the string at pos, giving its characters without the quotes, and moves pos past it.
+static bool parseString(const char *&pos, const char *end, const char **begin, const char **stringEnd, bool *escaped)
+{
+	*escaped = false;
+	*begin = ++pos;
+	for (; pos != end; ++pos)
+	{
+		if (*pos == '"')
+		{
+			*stringEnd = pos++;
+			return true;
+		}
+		if ((unsigned char)*pos < 0x20)
+		{
+			return false;
+		}
+		if (*pos == '\\')
+		{
+			*escaped = true;
+			if (++pos == end)
+			{
+				return false;
+			}
+			unsigned code;
+			if (*pos == 'u')
+			{
+				if (!parseHex4(pos + 1, end, &code))
+				{
+					return false;
+				}
+				pos += 4;
+			}
+			else if (strchr("\"\\/bfnrt", *pos) == nullptr || *pos == '\0')
+			{
+				return false;
+			}
+		}
+	}
+	return false;
+}
+
+static bool parseNumber(const char *&pos, const char *end, double *number)
+{
+	bool negative = pos != end && *pos == '-';
+	pos += negative;
+	if (pos == end || *pos < '0' || *pos > '9')
+	{
+		return false;
+	}
+	// Keep the first 18 significant digits, which fit in a uint64_t, and count the rest in the exponent.
+	uint64_t mantissa = 0;
+	int digits = 0, exponent = 0;
+	if (*pos == '0')
+	{
+		++pos;
+	}
+	else
+	{
+		for (; pos != end && *pos >= '0' && *pos <= '9'; ++pos)
+		{
+			if (digits < 18)
+			{
+				mantissa = mantissa * 10 + (*pos - '0');
+				digits += mantissa != 0;
+			}
+			else
+			{
+				++exponent;
+			}
+		}
+	}
+	if (pos != end && *pos == '.')
+	{
+		if (++pos == end || *pos < '0' || *pos > '9')
+		{
+			return false;
+		}
+		for (; pos != end && *pos >= '0' && *pos <= '9'; ++pos)
+		{
+			if (digits < 18)
+			{
+				mantissa = mantissa * 10 + (*pos - '0');
+				digits += mantissa != 0;
+				--exponent;
+			}
+		}
+	}
+	if (pos != end && (*pos == 'e' || *pos == 'E'))
+	{
+		++pos;
+		bool negativeExponent = pos != end && *pos == '-';
+		pos += pos != end && (*pos == '-' || *pos == '+');
+		if (pos == end || *pos < '0' || *pos > '9')
+		{
+			return false;
+		}
+		int explicitExponent = 0;
+		for (; pos != end && *pos >= '0' && *pos <= '9'; ++pos)
+		{
+			explicitExponent = std::min(explicitExponent * 10 + (*pos - '0'), 100000);
+		}
+		exponent += negativeExponent ? -explicitExponent : explicitExponent;
+	}
+	// Dividing by an exact power of ten rounds correctly, unlike multiplying by an inexact one.
+	*number = exponent < 0 ? mantissa / pow(10.0, -exponent) : mantissa * pow(10.0, exponent);
+	if (negative)
+	{
+		*number = -*number;
+	}
+	return true;
+}
+
+bool jsonParseValue(const char *&pos, const char *end, JsonValue *value);
+
+/// Calls member(keyBegin, keyEnd, escaped, value) for each member of the object text, with the characters of the
+/// key, until member returns false. Doesn't intern the keys, so it is thread safe.
+template <typename Function>
+static bool forEachRawMember(const char *begin, const char *end, Function &&member)
+{
+	const char *pos = skipSpace(begin + 1, end);
+	if (pos != end && *pos == '}')
+	{
+		return true;
+	}
+	while (pos != end && *pos == '"')
+	{
+		const char *keyBegin, *keyEnd;
+		bool escaped;
+		JsonValue value;
+		if (!parseString(pos, end, &keyBegin, &keyEnd, &escaped))
+		{
+			return false;
+		}
+		pos = skipSpace(pos, end);
+		if (pos == end || *pos++ != ':' || !jsonParseValue(pos, end, &value))
+		{
+			return false;
+		}
+		if (!member(keyBegin, keyEnd, escaped, value))
+		{
+			return true;
+		}
+		pos = skipSpace(pos, end);
+		if (pos != end && *pos == '}')
+		{
+			return true;
+		}
+		if (pos == end || *pos != ',')
+		{
+			return false;
+		}
+		pos = skipSpace(pos + 1, end);
+	}
+	return false;
+}
+
+static JsonKey makeKey(const char *keyBegin, const char *keyEnd, bool escaped)
+{
+	return escaped ? JsonKey(unescape(keyBegin, keyEnd).c_str()) : JsonKey(keyBegin, keyEnd - keyBegin);
+}
+
+/// Calls member(key, value) for each member of the object text, until member returns false.
+template <typename Function>
+static bool forEachMember(const char *begin, const char *end, Function &&member)
+{
+	return forEachRawMember(begin, end, [&member](const char *keyBegin, const char *keyEnd, bool escaped, const JsonValue & value) {
+		return member(makeKey(keyBegin, keyEnd, escaped), value);
+	});
+}
+
+/// Calls element(value) for each element of the array text.
+template <typename Function>
+static bool forEachElement(const char *begin, const char *end, Function &&element)
+{
+	const char *pos = skipSpace(begin + 1, end);
+	if (pos != end && *pos == ']')
+	{
+		return true;
+	}
+	while (true)
+	{
+		JsonValue value;
+		if (!jsonParseValue(pos, end, &value))
+		{
+			return false;
+		}
+		element(value);
+		pos = skipSpace(pos, end);
+		if (pos != end && *pos == ']')
+		{
+			return true;
+		}
+		if (pos == end || *pos++ != ',')
+		{
+			return false;
+		}
+	}
+}
+
+/// Moves pos past the object or array at pos. Its contents are checked when it is read.
+static bool skipCompound(const char *&pos, const char *end)
+{
+	int depth = 0;
+	while (pos != end)
+	{
+		switch (*pos)
+		{
+		case '"':
+			{
+				const char *begin, *stringEnd;
+				bool escaped;
+				if (!parseString(pos, end, &begin, &stringEnd, &escaped))
+				{
+					return false;
+				}
+				continue;
+			}
+		case '{':
+		case '[':
+			++depth;
+			break;
+		case '}':
+		case ']':
+			if (--depth == 0)
+			{
+				++pos;
+				return true;
+			}
+			break;
+		}
+		++pos;
+	}
+	return false;
+}
+
+static bool parseLiteral(const char *&pos, const char *end, const char *literal)
+{
+	size_t length = strlen(literal);
+	if ((size_t)(end - pos) < length || strncmp(pos, literal, length) != 0)
+	{
+		return false;
+	}
+	pos += length;
+	return true;
+}
+
+/// Parses the value at pos, after any white space, and moves pos past it.
+bool jsonParseValue(const char *&pos, const char *end, JsonValue *value)
+{
+	pos = skipSpace(pos, end);
+	if (pos == end)
+	{
+		return false;
+	}
+	value->mBegin = pos;
+	switch (*pos)
+	{
+	case '{':
+		value->mType = JsonValue::Object;
+		break;
+	case '[':
+		value->mType = JsonValue::Array;
+		break;
+	case '"':
+		value->mType = JsonValue::String;
+		return parseString(pos, end, &value->mBegin, &value->mEnd, &value->mEscaped);
+	case 't':
+		value->mType = JsonValue::Bool;
+		value->mNumber = 1;
+		return parseLiteral(pos, end, "true");
+	case 'f':
+		value->mType = JsonValue::Bool;
+		value->mNumber = 0;
+		return parseLiteral(pos, end, "false");
+	case 'n':
+		value->mType = JsonValue::Null;
+		return parseLiteral(pos, end, "null");
+	default:
+		value->mType = JsonValue::Number;
+		return parseNumber(pos, end, &value->mNumber);
+	}
+	if (!skipCompound(pos, end))
+	{
+		return false;
+	}
+	value->mEnd = pos;
+	return true;
+}
+
+/*******************************************************************************
+*		Values
+*******************************************************************************/
+
+JsonValue::JsonValue(const char *value)
+	: mType(String)
+	, mBegin(value)
+	, mEnd(value + strlen(value))
+{}
+
+/// Like qRound64.
+static int64_t roundNumber(double number)
+{
+	return number >= 0.0 ? int64_t(number + 0.5) : int64_t(number - double(int64_t(number - 1)) + 0.5) + int64_t(number - 1);
+}
+
+/// Like QString::toLongLong and toULongLong, which QVariant uses to convert strings.
+static int64_t stringToInteger(const std::string &string, bool allowNegative)
+{
+	const char *pos = string.c_str();
+	while (isspace((unsigned char)*pos))
+	{
+		++pos;
+	}
+	bool negative = *pos == '-';
+	if ((negative && !allowNegative) || (!isdigit((unsigned char)pos[*pos == '-' || *pos == '+'])))
+	{
+		return 0;
+	}
+	char *end;
+	errno = 0;
+	int64_t integer = allowNegative ? strtoll(pos, &end, 10) : (int64_t)strtoull(pos, &end, 10);
+	while (isspace((unsigned char)*end))
+	{
+		++end;
+	}
+	return *end == '\0' && errno == 0 ? integer : 0;
+}
+
+static std::string utf8String(const char *begin, const char *end, bool escaped)
+{
+	return escaped ? unescape(begin, end) : std::string(begin, end);
+}
+
+int JsonValue::toInt() const
+{
+	switch (mType)
+	{
+	case Bool:
+	case Number: return (int)roundNumber(mNumber);
+	case String: return (int)stringToInteger(utf8String(mBegin, mEnd, mEscaped), true);
+	default: return 0;
+	}
+}
+
+unsigned JsonValue::toUInt() const
+{
+	switch (mType)
+	{
+	case Bool:
+	case Number: return (unsigned)roundNumber(mNumber);
+	case String: return (unsigned)stringToInteger(utf8String(mBegin, mEnd, mEscaped), false);
+	default: return 0;
+	}
+}
+
+bool JsonValue::toBool() const
+{
+	switch (mType)
+	{
+	case Bool:
+	case Number: return mNumber != 0;
+	case String:
+		{
+			QString string = toString().toLower();
+			return !(string.isEmpty() || string == "0" || string == "false");
+		}
+	default: return false;
+	}
+}
+
+double JsonValue::toDouble() const
+{
+	switch (mType)
+	{
+	case Bool:
+	case Number: return mNumber;
+	case String: return toString().toDouble();
+	default: return 0;
+	}
+}
+
+QString JsonValue::toString() const
+{
+	switch (mType)
+	{
+	case Bool: return mNumber != 0 ? "true" : "false";
+	case Number:
+		{
+			// The shortest text that reads back the same, like QVariant.
+			QString text;
+			for (int precision = 1; precision <= 17; ++precision)
+			{
+				text = QString::number(mNumber, 'g', precision);
+				if (text.toDouble() == mNumber)
+				{
+					break;
+				}
+			}
+			return text;
+		}
+	case String:
+		if (mEscaped)
+		{
+			return QString::fromStdString(unescape(mBegin, mEnd));
+		}
+		return QString::fromUtf8(mBegin, mEnd - mBegin);
+	default: return QString();
+	}
+}
+
+QStringList JsonValue::toStringList() const
+{
+	QStringList list;
+	if (mType == String)
+	{
+		list.push_back(toString());
+	}
+	else if (mType == Array)
+	{
+		forEachElement(mBegin, mEnd, [&list](const JsonValue & element) {
+			list.push_back(element.toString());
+		});
+	}
+	return list;
+}
+
+std::vector<JsonValue> JsonValue::toList() const
+{
+	std::vector<JsonValue> list;
+	if (mType == Array)
+	{
+		forEachElement(mBegin, mEnd, [&list](const JsonValue & element) {
+			list.push_back(element);
+		});
+	}
+	return list;
+}
+
+QJsonValue JsonValue::toJson() const
+{
+	switch (mType)
+	{
+	case Null: return QJsonValue(QJsonValue::Null);
+	case Bool: return QJsonValue(mNumber != 0);
+	case Number: return QJsonValue(mNumber);
+	case String: return QJsonValue(toString());
+	case Array: return QJsonDocument::fromJson(QByteArray(mBegin, mEnd - mBegin)).array();
+	case Object: return QJsonDocument::fromJson(QByteArray(mBegin, mEnd - mBegin)).object();
+	default: return QJsonValue(QJsonValue::Undefined);
+	}
+}
+
+JsonValue JsonValue::member(const JsonKey &key) const
+{
+	JsonValue found;
+	if (mType == Object)
+	{
+		// Later members replace earlier ones with the same key, like in QJsonDocument.
+		forEachMember(mBegin, mEnd, [&](const JsonKey & memberKey, const JsonValue & value) {
+			if (memberKey == key)
+			{
+				found = value;
+			}
+			return true;
+		});
+	}
+	return found;
+}
+
+/*******************************************************************************
+*		Reader
+*******************************************************************************/
+
+/// The jsondiffs of mods for fileName.
+static std::vector<std::string> findDiffs(const char *fileName)
+{
+	std::vector<std::string> diffs;
+	char **diffList = PHYSFS_enumerateFiles("diffs");
+	for (char **i = diffList; *i != nullptr; i++)
+	{
+		std::string diff = std::string("diffs/") + *i + "/" + fileName;
+		if (PHYSFS_exists(diff.c_str()))
+		{
+			diffs.push_back(diff);
+		}
+	}
+	PHYSFS_freeList(diffList);
+	return diffs;
+}
+
+/// Identifies the contents of fileName and its diffs without reading them, or returns an empty string if it can't.
+static std::string sourceStamps(const char *fileName, const std::vector<std::string> &diffs)
+{
+	std::string stamps;
+	for (size_t i = 0; i <= diffs.size(); ++i)
+	{
+		const char *source = i == 0 ? fileName : diffs[i - 1].c_str();
+		const char *dir = PHYSFS_getRealDir(source);
+		PHYSFS_sint64 modTime = PHYSFS_getLastModTime(source);
+		PHYSFS_file *file = PHYSFS_openRead(source);
+		if (dir == nullptr || modTime < 0 || file == nullptr)
+		{
+			if (file != nullptr)
+			{
+				PHYSFS_close(file);
+			}
+			return std::string();
+		}
+		stamps += astringf("%s:%s:%lld:%lld\n", dir, source, (long long)modTime, (long long)PHYSFS_fileLength(file));
+		PHYSFS_close(file);
+	}
+	return stamps;
+}
+
+std::unordered_map<std::string, JsonReader::SCANNED> &JsonReader::scannedFiles()
+{
+	static std::unordered_map<std::string, SCANNED> files;
+	return files;
+}
+
+/// A member of the top level object, with its key not interned yet.
+struct RAW_MEMBER
+{
+	const char *keyBegin, *keyEnd;
+	bool escaped;
+	JsonValue value;
+};
+
+struct JsonReader::DECODED
+{
+	std::string name;
+	std::string sources;
+	QByteArray text;
+	std::vector<RAW_MEMBER> members;
+};
+
+/// Files decoded ahead of being read, by name.
+static std::unordered_map<std::string, std::unique_ptr<JsonReader::DECODED>> decodedFiles;
+
+JsonReader::DECODED *JsonReader::decode(const QString &fileName)
+{
+	std::unique_ptr<DECODED> decoded(new DECODED);
+	decoded->name = fileName.toStdString();
+	const char *name = decoded->name.c_str();
+	const std::vector<std::string> diffs = findDiffs(name);
+	decoded->sources = sourceStamps(name, diffs);
+	if (!diffs.empty() || decoded->sources.empty())
+	{
+		return nullptr;
+	}
+
+	PHYSFS_file *file = PHYSFS_openRead(name);
+	if (file == nullptr)
+	{
+		return nullptr;
+	}
+	const PHYSFS_sint64 size = PHYSFS_fileLength(file);
+	if (size >= 0)
+	{
+		decoded->text.resize(size);
+	}
+	const bool read = size >= 0 && PHYSFS_read(file, decoded->text.data(), 1, size) == size;
+	PHYSFS_close(file);
+	if (!read)
+	{
+		return nullptr;
+	}
+
+	const char *pos = decoded->text.constData(), *end = pos + decoded->text.size();
+	JsonValue document;
+	bool valid = jsonParseValue(pos, end, &document) && skipSpace(pos, end) == end && document.isObject();
+	valid = valid && forEachRawMember(document.mBegin, document.mEnd, [&decoded](const char *keyBegin, const char *keyEnd, bool escaped, const JsonValue & value) {
+		decoded->members.push_back(RAW_MEMBER{keyBegin, keyEnd, escaped, value});
+		return true;
+	});
+	// Leave reporting invalid files to the JsonReader
+	return valid ? decoded.release() : nullptr;
+}
+
+void JsonReader::commit(DECODED *decoded)
+{
+	if (decoded != nullptr)
+	{
+		decodedFiles[decoded->name].reset(decoded);
+	}
+}
+
+void JsonReader::discard(DECODED *decoded)
+{
+	delete decoded;
+}
+
+void JsonReader::clearScannedFiles()
+{
+	scannedFiles().clear();
+	decodedFiles.clear();
+}
+
+JsonReader::JsonReader(const QString &fileName)
+	: mFileName(fileName)
+{
+	mTimer.start();
+	mGroups.resize(1);
+	const QByteArray name = fileName.toUtf8();
+	const std::vector<std::string> diffs = findDiffs(name.constData());
+	const std::string sources = sourceStamps(name.constData(), diffs);
+	SCANNED &cached = scannedFiles()[name.constData()];
+	if (!sources.empty() && cached.sources == sources)
+	{
+		mText = cached.text;
+		mGroups[0].members = cached.members;
+		mAlreadyScanned = true;
+		return;
+	}
+
+	auto decoded = decodedFiles.find(name.constData());
+	if (decoded != decodedFiles.end())
+	{
+		// Read ahead, only the keys are left to intern
+		std::unique_ptr<DECODED> file = std::move(decoded->second);
+		decodedFiles.erase(decoded);
+		if (!sources.empty() && file->sources == sources)
+		{
+			mText = file->text;
+			for (const RAW_MEMBER &member : file->members)
+			{
+				mGroups[0].members.emplace_back(makeKey(member.keyBegin, member.keyEnd, member.escaped), member.value);
+			}
+			cached.sources = sources;
+			cached.text = mText;
+			cached.members = mGroups[0].members;
+			return;
+		}
+	}
+
+	if (!diffs.empty())
+	{
+		// Rare, so leave merging the diffs to WzConfig.
+		WzConfig ini(fileName, WzConfig::ReadOnlyAndRequired);
+		mText = QJsonDocument(ini.object()).toJson(QJsonDocument::Compact);
+	}
+	else
+	{
+		char *data;
+		UDWORD size;
+		if (!PHYSFS_exists(name.constData()) || !loadFile(name.constData(), &data, &size))
+		{
+			debug(LOG_FATAL, "Missing required file %s", name.constData());
+			abort();
+		}
+		mText = QByteArray(data, size);
+		free(data);
+	}
+
+	const char *pos = mText.constData(), *end = pos + mText.size();
+	JsonValue document;
+	bool valid = jsonParseValue(pos, end, &document) && skipSpace(pos, end) == end && document.isObject();
+	valid = valid && forEachMember(document.mBegin, document.mEnd, [this](const JsonKey & key, const JsonValue & value) {
+		mGroups[0].members.emplace_back(key, value);
+		return true;
+	});
+	if (!valid)
+	{
+		ASSERT(false, "JSON document from %s is invalid near line %d", name.constData(), (int)std::count(mText.constData(), pos, '\n') + 1);
+		mGroups[0].members.clear();
+		return;
+	}
+	cached.sources = sources;
+	cached.text = mText;
+	cached.members = mGroups[0].members;
+}
+
+JsonReader::~JsonReader()
+{
+	debug(LOG_WZ, "Read %s%s in %.1f ms", mFileName.toUtf8().constData(), mAlreadyScanned ? ", already scanned" : "", mTimer.nsecsElapsed() / 1e6);
+}
+
+const JsonReader::MEMBER *JsonReader::find(const JsonKey &key) const
+{
+	// Later members replace earlier ones with the same key, like in QJsonDocument.
+	const std::vector<MEMBER> &members = mGroups.back().members;
+	for (auto member = members.rbegin(); member != members.rend(); ++member)
+	{
+		if (member->key == key)
+		{
+			return &*member;
+		}
+	}
+	return nullptr;
+}
+
+QStringList JsonReader::childGroups() const
+{
+	// Later members replace earlier ones with the same key, like in QJsonDocument.
+	std::unordered_map<unsigned, bool> isObject;
+	for (const MEMBER &member : mGroups.back().members)
+	{
+		isObject[member.key.id] = member.value.isObject();
+	}
+	QStringList keys;
+	for (const auto &key : isObject)
+	{
+		if (key.second)
+		{
+			keys.push_back(QString::fromUtf8(keyTable().names[key.first]));
+		}
+	}
+	keys.sort();
+	return keys;
+}
+
+QStringList JsonReader::childKeys() const
+{
+	QStringList keys;
+	for (const MEMBER &member : mGroups.back().members)
+	{
+		keys.push_back(QString::fromUtf8(member.key.name()));
+	}
+	keys.sort();
+	keys.erase(std::unique(keys.begin(), keys.end()), keys.end());
+	return keys;
+}
+
+bool JsonReader::contains(const JsonKey &key) const
+{
+	return find(key) != nullptr;
+}
+
+JsonValue JsonReader::value(const JsonKey &key, const JsonValue &defaultValue) const
+{
+	const MEMBER *member = find(key);
+	return member != nullptr ? member->value : defaultValue;
+}
+
+QJsonValue JsonReader::json(const JsonKey &key, const QJsonValue &defaultValue) const
+{
+	const MEMBER *member = find(key);
+	return member != nullptr ? member->value.toJson() : defaultValue;
+}
+
+bool JsonReader::beginGroup(const JsonKey &key)
+{
+	const MEMBER *member = find(key);
+	const JsonValue value = member != nullptr ? member->value : JsonValue();
+	mGroups.emplace_back();
+	GROUP &group = mGroups.back();
+	group.name = QString::fromUtf8(key.name());
+	if (member == nullptr)
+	{
+		return false;
+	}
+	ASSERT_OR_RETURN(true, value.isObject(), "%s: beginGroup() on non-object key \"%s\"", mFileName.toUtf8().constData(), key.name());
+	bool valid = forEachMember(value.mBegin, value.mEnd, [&group](const JsonKey & memberKey, const JsonValue & memberValue) {
+		group.members.emplace_back(memberKey, memberValue);
+		return true;
+	});
+	ASSERT(valid, "%s: Invalid JSON in \"%s\"", mFileName.toUtf8().constData(), key.name());
+	return true;
+}
+
+void JsonReader::endGroup()
+{
+	ASSERT_OR_RETURN(, mGroups.size() > 1, "An endGroup() too much!");
+	mGroups.pop_back();
+}
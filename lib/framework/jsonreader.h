@@ -0,0 +1,185 @@
+/*
+	This file is part of Warzone 2100.
+	Copyright (C) 2005-2017  Warzone 2100 Project
+
+	Warzone 2100 is free software; you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation; either version 2 of the License, or
+	(at your option) any later version.
+
+	Warzone 2100 is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with Warzone 2100; if not, write to the Free Software
+	Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301 USA
+*/
+/** @file
+ *  Read only JSON files of named entries, such as the stats, without building a QJsonDocument.
+ *
+ *  The file is scanned once, and every value is kept as a span of its text. Only the members of the group being
+ *  read are split up, nested objects and arrays are scanned past until asked for. Keys are interned, so looking
+ *  up a member only compares integers. JsonReader has the read only part of the WzConfig interface, and values
+ *  convert like the QVariants WzConfig::value returns.
+ *
+ *  Files read stay scanned in memory until shutdown, so reading them again, such as on every game start, skips
+ *  loading, merging and scanning them, as long as the files and diffs they came from have not changed. This is only
+ *  a cache of the scanned text, kept in memory for the life of the process. Nothing is written to disk, and the
+ *  tables the loaders build are not kept, so the first start reads everything and every start builds the tables.
+ */
+
+#ifndef __INCLUDED_LIB_FRAMEWORK_JSONREADER_H__
+#define __INCLUDED_LIB_FRAMEWORK_JSONREADER_H__
+
+#include <QtCore/QByteArray>
+#include <QtCore/QElapsedTimer>
+#include <QtCore/QJsonValue>
+#include <QtCore/QStringList>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+/// An interned object key: keys with the same name are equal. Not thread safe.
+class JsonKey
+{
+public:
+	JsonKey(const char *name);
+	JsonKey(const char *name, size_t length);
+	JsonKey(const QString &name);
+
+	bool operator ==(const JsonKey &other) const
+	{
+		return id == other.id;
+	}
+
+	const char *name() const;
+
+	unsigned id;
+};
+
+/// The JsonKey for a string literal, interned the first time it is used only.
+#define JSON_KEY(name) ([]() -> const JsonKey & { static const JsonKey key(name); return key; }())
+
+/// A value in the text being read, or a default value. Converts like QJsonValue::toVariant().
+class JsonValue
+{
+public:
+	enum Type { Undefined, Null, Bool, Number, String, Array, Object };
+
+	JsonValue() {}
+	JsonValue(bool value) : mType(Bool), mNumber(value) {}
+	JsonValue(int value) : mType(Number), mNumber(value) {}
+	JsonValue(const char *value);
+
+	Type type() const
+	{
+		return mType;
+	}
+	bool isUndefined() const
+	{
+		return mType == Undefined;
+	}
+	bool isObject() const
+	{
+		return mType == Object;
+	}
+
+	int toInt() const;
+	unsigned toUInt() const;
+	bool toBool() const;
+	double toDouble() const;
+	QString toString() const;
+	QStringList toStringList() const;
+	/// The elements of an Array value, empty for other values.
+	std::vector<JsonValue> toList() const;
+	QJsonValue toJson() const;
+
+	/// The member key of an object value, undefined if there is none.
+	JsonValue member(const JsonKey &key) const;
+
+private:
+	Type mType = Undefined;
+	double mNumber = 0;               ///< Number, or 1 or 0 for Bool.
+	const char *mBegin = nullptr;     ///< Text of an Array or Object, or the characters of a String.
+	const char *mEnd = nullptr;
+	bool mEscaped = false;            ///< Whether the characters of a String have escapes.
+
+	friend bool jsonParseValue(const char *&pos, const char *end, JsonValue *value);
+	friend class JsonReader;
+};
+
+class JsonReader
+{
+public:
+	/// Reads fileName, with the jsondiffs of mods merged in. The file is required, like WzConfig::ReadOnlyAndRequired.
+	JsonReader(const QString &fileName);
+	~JsonReader();
+
+	/// The keys with object values in the current group, sorted like QJsonObject::keys().
+	QStringList childGroups() const;
+	QStringList childKeys() const;
+	bool contains(const JsonKey &key) const;
+	JsonValue value(const JsonKey &key, const JsonValue &defaultValue = JsonValue()) const;
+	QJsonValue json(const JsonKey &key, const QJsonValue &defaultValue = QJsonValue()) const;
+
+	bool beginGroup(const JsonKey &key);
+	void endGroup();
+
+	QString fileName() const
+	{
+		return mFileName;
+	}
+
+	QString group() const
+	{
+		return mGroups.back().name;
+	}
+
+	/// A file read and scanned ahead of being read by a JsonReader.
+	struct DECODED;
+
+	/// Reads and scans fileName without using anything the main thread changes, so it can run on any thread. Returns
+	/// NULL if the file can't be read ahead, such as when mods have jsondiffs for it.
+	static DECODED *decode(const QString &fileName);
+	/// Has the next JsonReader of the file use what decode() read, if the file hasn't changed since. Takes ownership.
+	static void commit(DECODED *decoded);
+	static void discard(DECODED *decoded);
+
+	/// Frees the files kept scanned, and the files decoded ahead that were never read.
+	static void clearScannedFiles();
+
+private:
+	struct MEMBER
+	{
+		MEMBER(const JsonKey &key, const JsonValue &value) : key(key), value(value) {}
+
+		JsonKey key;
+		JsonValue value;
+	};
+	struct GROUP
+	{
+		QString name;
+		std::vector<MEMBER> members;
+	};
+
+	/// A file read before. Its members point into its text, which copies share.
+	struct SCANNED
+	{
+		std::string sources;  ///< Where the file and its diffs came from, with their sizes and modification times.
+		QByteArray text;
+		std::vector<MEMBER> members;
+	};
+
+	static std::unordered_map<std::string, SCANNED> &scannedFiles();
+	const MEMBER *find(const JsonKey &key) const;
+
+	QString mFileName;
+	QByteArray mText;
+	std::vector<GROUP> mGroups;  ///< The top level, then the groups begun.
+	bool mAlreadyScanned = false;
+	QElapsedTimer mTimer;
+};
+
+#endif // __INCLUDED_LIB_FRAMEWORK_JSONREADER_H__
@@ -0,0 +1,506 @@
+/*
+	This file is part of Warzone 2100.
+	Copyright (C) 2005-2017  Warzone 2100 Project
+
+	Warzone 2100 is free software; you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation; either version 2 of the License, or
+	(at your option) any later version.
+
+	Warzone 2100 is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with Warzone 2100; if not, write to the Free Software
+	Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301 USA
+*/
+/** @file
+ *  Savegame archive, see savearchive.h.
+ *
+ *  The collected chunks share nothing with the game state, so they can be converted to binary JSON, compressed and
+ *  written on a thread, while the game goes on. Building the JSON objects still happens on the game thread, by the
+ *  savegame writers. The archive is written to a temporary file, which then replaces the old archive, so that a
+ *  crash while writing leaves the old archive rather than half of a new one.
+ *
+ *  Layout, all numbers 32 bit little endian unless noted:
+ *    header: "wzsa", version, number of chunks
+ *    for each chunk: flags, offset from the start of the archive, size, uncompressed size,
+ *                    16 bit length of the name, name
+ *    chunk data, each chunk starting 8 byte aligned, as binary JSON has to be aligned
+ */
+
+#include <QtCore/QElapsedTimer>
+#include <QtCore/QFile>
+#include <QtCore/QJsonDocument>
+
+#include "frame.h"
+#include "file.h"
+#include "savearchive.h"
+#include "wzapp.h"
+
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+#define SAVE_ARCHIVE_VERSION 1
+/// Chunks smaller than this are not worth compressing
+#define SAVE_CHUNK_COMPRESS_MIN 1024
+/// zlib level, saving fast matters more than saving a few more bytes
+#define SAVE_CHUNK_COMPRESS_LEVEL 1
+
+enum
+{
+	SAVE_CHUNK_COMPRESSED = 1,  ///< Compressed with qCompress
+	SAVE_CHUNK_JSON = 2,        ///< Qt binary JSON, not the text that was saved
+};
+
+/// A file being collected
+struct SAVE_CHUNK
+{
+	std::string name;
+	uint32_t flags;
+	uint32_t rawSize;
+	QByteArray data;
+	QJsonObject json;   ///< For SAVE_CHUNK_JSON, converted to data when writing
+};
+
+/// A file in the open archive
+struct ARCHIVE_CHUNK
+{
+	uint32_t flags;
+	uint32_t offset;
+	uint32_t size;
+	uint32_t rawSize;
+};
+
+static bool collecting = false;
+static std::string collectDir;  ///< With a trailing '/'
+static std::vector<SAVE_CHUNK> collectedChunks;
+
+static wz::thread writerThread;
+static bool writing = false;    ///< Whether writerThread is writing an archive
+static bool writeResult = true; ///< Set by writerThread
+
+static std::string openDir;     ///< With a trailing '/', empty if no archive is open
+static std::unique_ptr<QFile> openFile;
+static QByteArray openBuffer;   ///< The archive, if it could not be mapped
+static const uint8_t *openData = nullptr;
+static uint32_t openSize = 0;
+static std::map<std::string, ARCHIVE_CHUNK> openChunks;
+
+static std::string archiveDir(const char *dirName)
+{
+	std::string dir = dirName;
+	if (dir.empty() || dir[dir.size() - 1] != '/')
+	{
+		dir += '/';
+	}
+	return dir;
+}
+
+/// Returns the name of fileName relative to dir, or nullptr if fileName is not in dir.
+static const char *nameInDir(const std::string &dir, const char *fileName)
+{
+	if (dir.empty() || strncmp(fileName, dir.c_str(), dir.size()) != 0)
+	{
+		return nullptr;
+	}
+	const char *name = fileName + dir.size();
+	while (*name == '/')
+	{
+		++name;
+	}
+	return *name != '\0' ? name : nullptr;
+}
+
+static uint32_t align8(uint32_t offset)
+{
+	return (offset + 7) & ~7u;
+}
+
+static void appendU16(QByteArray &out, uint16_t value)
+{
+	const char bytes[2] = {char(value), char(value >> 8)};
+	out.append(bytes, sizeof(bytes));
+}
+
+static void appendU32(QByteArray &out, uint32_t value)
+{
+	const char bytes[4] = {char(value), char(value >> 8), char(value >> 16), char(value >> 24)};
+	out.append(bytes, sizeof(bytes));
+}
+
+static uint16_t readU16(const uint8_t *data)
+{
+	return data[0] | data[1] << 8;
+}
+
+static uint32_t readU32(const uint8_t *data)
+{
+	return data[0] | data[1] << 8 | data[2] << 16 | (uint32_t)data[3] << 24;
+}
+
+/// Replaces to with from, both relative to the write directory.
+static bool replaceFile(const std::string &from, const std::string &to)
+{
+	const QString writeDir = QString::fromUtf8(PHYSFS_getWriteDir()) + PHYSFS_getDirSeparator();
+	const QString realFrom = writeDir + QString::fromUtf8(from.c_str());
+	const QString realTo = writeDir + QString::fromUtf8(to.c_str());
+#if defined(WZ_OS_WIN)
+	return MoveFileExW((LPCWSTR)realFrom.utf16(), (LPCWSTR)realTo.utf16(), MOVEFILE_REPLACE_EXISTING) != 0;
+#else
+	return rename(realFrom.toLocal8Bit().constData(), realTo.toLocal8Bit().constData()) == 0;
+#endif
+}
+
+/// Compresses the chunks that are worth it, and writes them as an archive. Only touches its arguments.
+static bool writeArchive(const std::string &fileName, std::vector<SAVE_CHUNK> &chunks)
+{
+	uint32_t tableSize = 12;
+	for (SAVE_CHUNK &chunk : chunks)
+	{
+		if (chunk.flags & SAVE_CHUNK_JSON)
+		{
+			chunk.data = QJsonDocument(chunk.json).toBinaryData();
+			chunk.json = QJsonObject();
+		}
+		chunk.rawSize = chunk.data.size();
+		if (chunk.data.size() >= SAVE_CHUNK_COMPRESS_MIN)
+		{
+			QByteArray compressed = qCompress(chunk.data, SAVE_CHUNK_COMPRESS_LEVEL);
+			if (compressed.size() < chunk.data.size() / 8 * 7)
+			{
+				chunk.data = compressed;
+				chunk.flags |= SAVE_CHUNK_COMPRESSED;
+			}
+		}
+		tableSize += 18 + chunk.name.size();
+	}
+
+	QByteArray out;
+	out.append("wzsa", 4);
+	appendU32(out, SAVE_ARCHIVE_VERSION);
+	appendU32(out, chunks.size());
+	uint32_t offset = align8(tableSize);
+	for (const SAVE_CHUNK &chunk : chunks)
+	{
+		appendU32(out, chunk.flags);
+		appendU32(out, offset);
+		appendU32(out, chunk.data.size());
+		appendU32(out, chunk.rawSize);
+		appendU16(out, chunk.name.size());
+		out.append(chunk.name.data(), chunk.name.size());
+		offset = align8(offset + chunk.data.size());
+	}
+	out.reserve(offset);
+	for (const SAVE_CHUNK &chunk : chunks)
+	{
+		out.append(QByteArray(align8(out.size()) - out.size(), '\0'));
+		out.append(chunk.data);
+	}
+	const std::string tempName = fileName + ".tmp";
+	if (!saveFile(tempName.c_str(), out.constData(), out.size()))
+	{
+		return false;
+	}
+	if (!replaceFile(tempName, fileName))
+	{
+		debug(LOG_ERROR, "Could not replace %s with %s", fileName.c_str(), tempName.c_str());
+		PHYSFS_delete(tempName.c_str());
+		return false;
+	}
+	return true;
+}
+
+/// Runs on writerThread.
+static void writeArchiveThread(std::string fileName, std::vector<SAVE_CHUNK> *chunks)
+{
+	QElapsedTimer timer;
+	timer.start();
+	writeResult = writeArchive(fileName, *chunks);
+	delete chunks;
+	debug(LOG_SAVE, "Wrote %s in the background in %.1f ms", fileName.c_str(), timer.nsecsElapsed() / 1e6);
+}
+
+void saveArchiveBegin(const char *dirName)
+{
+	const std::string dir = archiveDir(dirName);
+	saveArchiveWait();
+	if (dir == openDir)
+	{
+		saveArchiveClose();  // Don't overwrite the archive while it is mapped.
+	}
+	collecting = true;
+	collectDir = dir;
+	collectedChunks.clear();
+}
+
+bool saveArchiveEnd()
+{
+	ASSERT_OR_RETURN(false, collecting, "Not collecting a savegame archive");
+	collecting = false;
+	std::vector<SAVE_CHUNK> chunks;
+	chunks.swap(collectedChunks);
+	return writeArchive(collectDir + SAVE_ARCHIVE_NAME, chunks);
+}
+
+void saveArchiveEndInBackground()
+{
+	ASSERT_OR_RETURN(, collecting, "Not collecting a savegame archive");
+	collecting = false;
+	std::vector<SAVE_CHUNK> *chunks = new std::vector<SAVE_CHUNK>;
+	chunks->swap(collectedChunks);
+	writing = true;
+	writerThread = wz::thread(writeArchiveThread, collectDir + SAVE_ARCHIVE_NAME, chunks);
+}
+
+bool saveArchiveWait()
+{
+	if (!writing)
+	{
+		return true;
+	}
+	writerThread.join();
+	writing = false;
+	if (!writeResult)
+	{
+		debug(LOG_ERROR, "Writing the savegame archive in the background failed");
+	}
+	return writeResult;
+}
+
+void saveArchiveAbort()
+{
+	collecting = false;
+	collectedChunks.clear();
+}
+
+static bool collectChunk(const char *fileName, QByteArray data, const QJsonObject &json, uint32_t flags)
+{
+	const char *name = collecting ? nameInDir(collectDir, fileName) : nullptr;
+	if (name == nullptr)
+	{
+		return false;
+	}
+	SAVE_CHUNK chunk;
+	chunk.name = name;
+	chunk.flags = flags;
+	chunk.rawSize = data.size();
+	chunk.data = data;
+	chunk.json = json;
+	for (SAVE_CHUNK &existing : collectedChunks)
+	{
+		if (existing.name == chunk.name)
+		{
+			existing = chunk;  // Saved twice, the last one counts.
+			return true;
+		}
+	}
+	collectedChunks.push_back(chunk);
+	return true;
+}
+
+bool saveArchiveWrite(const char *fileName, const char *data, size_t size)
+{
+	return collectChunk(fileName, QByteArray(data, size), QJsonObject(), 0);
+}
+
+bool saveArchiveWriteJson(const char *fileName, const QJsonObject &object)
+{
+	return collectChunk(fileName, QByteArray(), object, SAVE_CHUNK_JSON);
+}
+
+static bool readTable(const char *fileName)
+{
+	if (openSize < 12 || memcmp(openData, "wzsa", 4) != 0)
+	{
+		debug(LOG_ERROR, "%s is not a savegame archive", fileName);
+		return false;
+	}
+	const uint32_t version = readU32(openData + 4);
+	if (version != SAVE_ARCHIVE_VERSION)
+	{
+		debug(LOG_ERROR, "%s: Unsupported savegame archive version %u", fileName, version);
+		return false;
+	}
+	const uint32_t count = readU32(openData + 8);
+	uint32_t pos = 12;
+	for (uint32_t i = 0; i < count; ++i)
+	{
+		if (openSize - pos < 18)
+		{
+			debug(LOG_ERROR, "%s: Truncated chunk table", fileName);
+			return false;
+		}
+		ARCHIVE_CHUNK chunk;
+		chunk.flags = readU32(openData + pos);
+		chunk.offset = readU32(openData + pos + 4);
+		chunk.size = readU32(openData + pos + 8);
+		chunk.rawSize = readU32(openData + pos + 12);
+		const uint16_t nameLength = readU16(openData + pos + 16);
+		pos += 18;
+		if (openSize - pos < nameLength || chunk.offset > openSize || chunk.size > openSize - chunk.offset)
+		{
+			debug(LOG_ERROR, "%s: Bad chunk %u", fileName, i);
+			return false;
+		}
+		openChunks[std::string((const char *)openData + pos, nameLength)] = chunk;
+		pos += nameLength;
+	}
+	return true;
+}
+
+bool saveArchiveOpen(const char *dirName)
+{
+	const std::string dir = archiveDir(dirName);
+	if (dir == openDir)
+	{
+		return true;
+	}
+	saveArchiveClose();
+	saveArchiveWait();  // It might be this archive being written.
+
+	const std::string fileName = dir + SAVE_ARCHIVE_NAME;
+	if (!PHYSFS_exists(fileName.c_str()))
+	{
+		return false;
+	}
+	// Map the archive if it is a real file, else load all of it.
+	const char *realDir = PHYSFS_getRealDir(fileName.c_str());
+	if (realDir != nullptr)
+	{
+		openFile.reset(new QFile(QString::fromUtf8(realDir) + PHYSFS_getDirSeparator() + QString::fromUtf8(fileName.c_str())));
+		if (openFile->open(QIODevice::ReadOnly) && openFile->size() > 0 && openFile->size() < UINT32_MAX)
+		{
+			openSize = openFile->size();
+			openData = openFile->map(0, openSize);
+		}
+	}
+	if (openData == nullptr)
+	{
+		openFile.reset();
+		char *data;
+		UDWORD size;
+		if (!loadFile(fileName.c_str(), &data, &size))
+		{
+			return false;
+		}
+		openBuffer = QByteArray(data, size);
+		free(data);
+		openData = (const uint8_t *)openBuffer.constData();
+		openSize = size;
+	}
+	if (!readTable(fileName.c_str()))
+	{
+		saveArchiveClose();
+		return false;
+	}
+	openDir = dir;
+	debug(LOG_SAVE, "Opened %s, with %u files%s", fileName.c_str(), (unsigned)openChunks.size(), openFile ? ", mapped" : "");
+	return true;
+}
+
+void saveArchiveClose()
+{
+	openChunks.clear();
+	if (openFile && openData != nullptr)
+	{
+		openFile->unmap(const_cast<uint8_t *>(openData));
+	}
+	openFile.reset();
+	openBuffer.clear();
+	openData = nullptr;
+	openSize = 0;
+	openDir.clear();
+}
+
+bool saveArchiveCovers(const char *fileName)
+{
+	return nameInDir(openDir, fileName) != nullptr;
+}
+
+static const ARCHIVE_CHUNK *findChunk(const char *fileName)
+{
+	const char *name = nameInDir(openDir, fileName);
+	if (name == nullptr)
+	{
+		return nullptr;
+	}
+	std::map<std::string, ARCHIVE_CHUNK>::const_iterator i = openChunks.find(name);
+	return i != openChunks.end() ? &i->second : nullptr;
+}
+
+bool saveArchiveContains(const char *fileName)
+{
+	return findChunk(fileName) != nullptr;
+}
+
+/// Gets the uncompressed chunk, which refers to the mapped archive if it was not compressed.
+static bool readChunk(const char *fileName, QByteArray *data, uint32_t *flags)
+{
+	const ARCHIVE_CHUNK *chunk = findChunk(fileName);
+	if (chunk == nullptr)
+	{
+		return false;
+	}
+	const uint8_t *raw = openData + chunk->offset;
+	if (chunk->flags & SAVE_CHUNK_COMPRESSED)
+	{
+		*data = qUncompress(raw, chunk->size);
+	}
+	else
+	{
+		*data = QByteArray::fromRawData((const char *)raw, chunk->size);
+	}
+	if ((uint32_t)data->size() != chunk->rawSize)
+	{
+		debug(LOG_ERROR, "%s: Corrupt chunk in savegame archive", fileName);
+		return false;
+	}
+	*flags = chunk->flags;
+	return true;
+}
+
+bool saveArchiveRead(const char *fileName, QByteArray *data)
+{
+	uint32_t flags;
+	if (!readChunk(fileName, data, &flags))
+	{
+		return false;
+	}
+	if (flags & SAVE_CHUNK_JSON)
+	{
+		*data = QJsonDocument::fromBinaryData(*data).toJson();
+	}
+	else
+	{
+		data->detach();  // Must not refer to the archive after it is closed.
+	}
+	return true;
+}
+
+bool saveArchiveReadJson(const char *fileName, QJsonObject *object)
+{
+	QByteArray data;
+	uint32_t flags;
+	if (!readChunk(fileName, &data, &flags))
+	{
+		return false;
+	}
+	if (!(flags & SAVE_CHUNK_JSON))
+	{
+		// Saved as text, by something other than WzConfig.
+		QJsonParseError error;
+		QJsonDocument doc = QJsonDocument::fromJson(data, &error);
+		ASSERT_OR_RETURN(false, doc.isObject(), "JSON document in %s is invalid: %s", fileName, error.errorString().toUtf8().constData());
+		*object = doc.object();
+		return true;
+	}
+	QJsonDocument doc = QJsonDocument::fromBinaryData(data);
+	ASSERT_OR_RETURN(false, doc.isObject(), "Binary JSON in %s is invalid", fileName);
+	*object = doc.object();
+	return true;
+}
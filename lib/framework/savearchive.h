@@ -0,0 +1,67 @@
+/*
+	This file is part of Warzone 2100.
+	Copyright (C) 2005-2017  Warzone 2100 Project
+
+	Warzone 2100 is free software; you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation; either version 2 of the License, or
+	(at your option) any later version.
+
+	Warzone 2100 is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with Warzone 2100; if not, write to the Free Software
+	Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301 USA
+*/
+/** @file
+ *  Savegame archive: all the files of a savegame directory in one file, SAVE_ARCHIVE_NAME in that directory.
+ *
+ *  The archive has a header and a table of chunks, one per file, followed by the chunk data. JSON files are stored
+ *  in the Qt binary JSON format, and large chunks are compressed one by one. Archives are memory mapped for loading.
+ *
+ *  While an archive is being collected, saveFile and WzConfig hand it the files saved to its directory, instead of
+ *  writing them. While an archive is open, loadFile and WzConfig read the files in its directory from it.
+ */
+
+#ifndef __INCLUDED_LIB_FRAMEWORK_SAVEARCHIVE_H__
+#define __INCLUDED_LIB_FRAMEWORK_SAVEARCHIVE_H__
+
+#include <QtCore/QByteArray>
+#include <QtCore/QJsonObject>
+
+#define SAVE_ARCHIVE_NAME "save.wzs"
+
+/// Start collecting the files saved to dirName, to write them as one archive with saveArchiveEnd.
+void saveArchiveBegin(const char *dirName);
+/// Write the collected files as dirName/SAVE_ARCHIVE_NAME, and stop collecting.
+bool saveArchiveEnd();
+/// Like saveArchiveEnd, but converts, compresses and writes the collected files on a thread, without waiting for it.
+/// The JSON objects have already been built by then, only turning them into binary JSON happens on the thread.
+void saveArchiveEndInBackground();
+/// Wait until the archive being written in the background, if any, has been written. Returns false if it failed.
+bool saveArchiveWait();
+/// Stop collecting, without writing anything.
+void saveArchiveAbort();
+
+/// Open dirName/SAVE_ARCHIVE_NAME for loading, closing any other open archive. Returns false if there is none.
+bool saveArchiveOpen(const char *dirName);
+void saveArchiveClose();
+
+/// Whether fileName is in the directory of the open archive, in which case only the archive has its files.
+bool saveArchiveCovers(const char *fileName);
+/// Whether the open archive has fileName.
+bool saveArchiveContains(const char *fileName);
+/// Gets the contents of fileName from the open archive. JSON files are converted back to text.
+bool saveArchiveRead(const char *fileName, QByteArray *data);
+/// Gets the JSON object in fileName from the open archive.
+bool saveArchiveReadJson(const char *fileName, QJsonObject *object);
+
+/// Hands a file being saved to the archive being collected. Returns false if not collecting fileName.
+bool saveArchiveWrite(const char *fileName, const char *data, size_t size);
+/// Hands a JSON file being saved to the archive being collected. Returns false if not collecting fileName.
+bool saveArchiveWriteJson(const char *fileName, const QJsonObject &object);
+
+#endif // __INCLUDED_LIB_FRAMEWORK_SAVEARCHIVE_H__
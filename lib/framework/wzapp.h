@@ -181,4 +181,36 @@ namespace wz
 
 #endif
 
+#include <algorithm>
+#include <atomic>
+#include <vector>
+
+/**
+ * Call function(i) for each i from 0 to count, on this thread and up to extraThreads others, and wait for them.
+ * Indices are handed out one at a time, so uneven pieces of work still share the threads well.
+ */
+template <typename Function>
+void wzParallelFor(int count, int extraThreads, const Function &function)
+{
+	std::atomic<int> next(0);
+	auto work = [&next, count, &function]()
+	{
+		for (int i = next++; i < count; i = next++)
+		{
+			function(i);
+		}
+	};
+
+	std::vector<wz::thread> threads;
+	for (int i = 0; i < std::min(count - 1, extraThreads); ++i)
+	{
+		threads.emplace_back(work);
+	}
+	work();
+	for (wz::thread &thread : threads)
+	{
+		thread.join();
+	}
+}
+
 #endif
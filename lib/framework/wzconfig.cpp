@@ -30,15 +30,19 @@
 // Qt headers MUST come before platform specific stuff!
 #include "wzconfig.h"
 #include "file.h"
+#include "savearchive.h"
 
 WzConfig::~WzConfig()
 {
 	if (mWarning == ReadAndWrite)
 	{
 		ASSERT(mObjStack.empty(), "Some json groups have not been closed, stack size %d.", mObjStack.size());
-		QJsonDocument doc(mObj);
-		QByteArray json = doc.toJson();
-		saveFile(mFilename.toUtf8().constData(), json.constData(), json.size());
+		if (!saveArchiveWriteJson(mFilename.toUtf8().constData(), mObj))
+		{
+			QJsonDocument doc(mObj);
+			QByteArray json = doc.toJson();
+			saveFile(mFilename.toUtf8().constData(), json.constData(), json.size());
+		}
 	}
 	debug(LOG_SAVE, "%s %s", mWarning == ReadAndWrite? "Saving" : "Closing", mFilename.toUtf8().constData());
 }
@@ -73,6 +77,16 @@ WzConfig::WzConfig(const QString &name, WzConfig::warning warning, QObject *pare
 	mStatus = true;
 	mWarning = warning;
 
+	if (saveArchiveCovers(name.toUtf8().constData()))
+	{
+		// Savegame files are never diffed.
+		if (warning != ReadAndWrite && !saveArchiveReadJson(name.toUtf8().constData(), &mObj))
+		{
+			mStatus = false;
+			ASSERT(warning != ReadOnlyAndRequired, "Missing required file %s", name.toUtf8().constData());
+		}
+		return;
+	}
 	if (!PHYSFS_exists(name.toUtf8().constData()))
 	{
 		if (warning == ReadOnly)
@@ -86,6 +86,12 @@ public:
 	void setValue(const QString &key, const QVariant &value);
 	void set(const QString &key, const QJsonValue &value);
 
+	/// The JSON object of the current group.
+	const QJsonObject &object() const
+	{
+		return mObj;
+	}
+
 	QString group()
 	{
 		return mName;
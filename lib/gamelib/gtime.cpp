@@ -31,10 +31,25 @@
 #include "gtime.h"
 #include "src/multiplay.h"
 #include "lib/netplay/netplay.h"
+#include "lib/netplay/netreplay.h"
 
 
 #include <time.h>
 
+/// Width of the buckets of the needed latency histograms, in ms.
+#define LATENESS_BUCKET_MS 10
+/// Enough buckets to cover the largest latency, which is a second. Larger latencies are counted in the last bucket.
+#define LATENESS_BUCKETS 110
+/// The histograms are halved every this many ticks, so that they follow changes in the connections.
+#define LATENESS_DECAY_TICKS 100
+/// The percentile of GAME_GAME_TIME messages that the wanted latency should have been enough for.
+#define LATENESS_PERCENTILE 95
+
+/// How many ticks behind real time the game must be, to tick several times in a row without rendering in between.
+#define CATCHUP_MIN_TICKS 3
+/// Most ticks in a row while catching up, before rendering anyway.
+#define CATCHUP_MAX_TICKS 10
+
 
 /* See header file for documentation */
 UDWORD gameTime = 0, deltaGameTime = 0, graphicsTime = 0, deltaGraphicsTime = 0, realTime = 0, deltaRealTime = 0;
@@ -52,6 +67,9 @@ static uint32_t prevRealTime;
   **/
 static UDWORD	stopCount;
 
+/// Whether gameTimeSetUnthrottled was called.
+static bool unthrottled = false;
+
 static uint32_t gameQueueTime[MAX_PLAYERS];
 static uint32_t gameQueueCheckTime[MAX_PLAYERS];
 static uint32_t gameQueueCheckCrc[MAX_PLAYERS];
@@ -64,6 +82,17 @@ static uint16_t discreteChosenLatency = GAME_TICKS_PER_UPDATE;
 static uint16_t wantedLatency = GAME_TICKS_PER_UPDATE;
 static uint16_t wantedLatencies[MAX_PLAYERS];
 
+/// Histograms of the latency each player's GAME_GAME_TIME needed to arrive before we wanted to tick.
+static unsigned latenessHistogram[MAX_PLAYERS][LATENESS_BUCKETS];
+static unsigned latenessTicks = 0;
+/// When we got the GAME_GAME_TIME needed for the next tick from each player, 0 if not yet.
+static uint32_t playerReadyTime[MAX_PLAYERS];
+
+static unsigned consecutiveTicks = 0;
+static bool catchingUp = false;
+static uint32_t stallStartTime = 0;  ///< When we started waiting for other players, 0 if not waiting.
+static GAME_TIME_STATS stats;
+
 static void updateLatency(void);
 
 static std::string listToString(char const *format, char const *separator, uint32_t const *begin, uint32_t const *end)
@@ -110,7 +139,15 @@ void gameTimeInit(void)
 	for (player = 0; player != MAX_PLAYERS; ++player)
 	{
 		wantedLatencies[player] = 0;
+		playerReadyTime[player] = 0;
 	}
+	memset(latenessHistogram, 0, sizeof(latenessHistogram));
+	latenessTicks = 0;
+
+	consecutiveTicks = 0;
+	catchingUp = false;
+	stallStartTime = 0;
+	stats = GAME_TIME_STATS();
 
 	// Don't let syncDebug from previous games cause a desynch dump at gameTime 102.
 	resetSyncDebug();
@@ -175,7 +212,17 @@ void gameTimeUpdate(bool mayUpdate)
 
 	uint32_t newGraphicsTime = graphicsTime + newDeltaGraphicsTime;
 
-	if (newGraphicsTime > gameTime && !mayUpdate)
+	if (gameTimeIsUnthrottled())
+	{
+		// Play as fast as possible, instead of in real time.
+		newGraphicsTime = gameTime + 1;
+		newDeltaGraphicsTime = newGraphicsTime - graphicsTime;
+	}
+
+	// After a hitch, tick several times in a row without rendering in between, to catch up with real time quickly.
+	const bool mayCatchUp = newGraphicsTime >= gameTime + CATCHUP_MIN_TICKS * GAME_TICKS_PER_UPDATE && consecutiveTicks < CATCHUP_MAX_TICKS;
+
+	if (newGraphicsTime > gameTime && !mayUpdate && !mayCatchUp)
 	{
 		newGraphicsTime = gameTime;
 		newDeltaGraphicsTime = newGraphicsTime - graphicsTime;
@@ -194,11 +241,16 @@ void gameTimeUpdate(bool mayUpdate)
 
 		debug(LOG_SYNC, "Waiting for other players. gameTime = %u, player times are {%s}", gameTime, listToString("%u", ", ", gameQueueTime, gameQueueTime + game.maxPlayers).c_str());
 
+		if (stallStartTime == 0)
+		{
+			stallStartTime = currTime;
+		}
 		for (unsigned player = 0; player < game.maxPlayers; ++player)
 		{
 			if (!checkPlayerGameTime(player))
 			{
 				NETsetPlayerConnectionStatus(CONNECTIONSTATUS_WAITING_FOR_PLAYER, player);
+				stats.stallPlayer = player;
 				break;  // GAME_GAME_TIME is processed serially, so don't know if waiting for more players.
 			}
 		}
@@ -211,6 +263,27 @@ void gameTimeUpdate(bool mayUpdate)
 		deltaGameTime = GAME_TICKS_PER_UPDATE;
 		gameTime += deltaGameTime;
 
+		if (stallStartTime != 0)
+		{
+			stats.lastStallTime = currTime - stallStartTime;
+			stats.stallTime += stats.lastStallTime;
+			++stats.stalls;
+			stallStartTime = 0;
+		}
+		++consecutiveTicks;
+		if (!mayUpdate)
+		{
+			// Only ticking because of catching up.
+			if (!catchingUp)
+			{
+				catchingUp = true;
+				stats.lastCatchUpTicks = 0;
+				++stats.catchUps;
+			}
+			++stats.lastCatchUpTicks;
+			++stats.catchUpTicks;
+		}
+
 		updateLatency();
 		if (crcError)
 		{
@@ -227,6 +300,9 @@ void gameTimeUpdate(bool mayUpdate)
 
 		// Update prevRealTime, since graphicsTime changed.
 		prevRealTime      = currTime;
+
+		consecutiveTicks = 0;
+		catchingUp = false;
 	}
 
 	// Pre-calculate fraction used in timeAdjustedIncrement
@@ -276,6 +352,65 @@ Rational gameTimeGetMod()
 	return modifier;
 }
 
+void gameTimeSetUnthrottled(bool newUnthrottled)
+{
+	unthrottled = newUnthrottled;
+}
+
+bool gameTimeIsUnthrottled()
+{
+	return unthrottled || NETisReplay();
+}
+
+/// Sets latency to the latency, in ms, which would have been enough for LATENESS_PERCENTILE percent of the GAME_GAME_TIME
+/// messages of the player to arrive in time. Returns false if we haven't waited for the player yet.
+static bool latenessPercentile(unsigned player, int *latency)
+{
+	unsigned total = 0;
+	for (unsigned bucket = 0; bucket < LATENESS_BUCKETS; ++bucket)
+	{
+		total += latenessHistogram[player][bucket];
+	}
+	if (total == 0)
+	{
+		return false;
+	}
+
+	const unsigned wanted = (total * LATENESS_PERCENTILE + 99) / 100;
+	unsigned count = 0;
+	unsigned bucket = 0;
+	for (; bucket < LATENESS_BUCKETS - 1; ++bucket)
+	{
+		count += latenessHistogram[player][bucket];
+		if (count >= wanted)
+		{
+			break;
+		}
+	}
+	*latency = (bucket + 1) * LATENESS_BUCKET_MS;  // The end of the bucket.
+	return true;
+}
+
+GAME_TIME_STATS gameTimeGetStats()
+{
+	GAME_TIME_STATS ret = stats;
+	ret.latency = discreteChosenLatency;
+	ret.wantedLatency = wantedLatency;
+	if (stallStartTime != 0)
+	{
+		ret.lastStallTime = wzGetTicks() - stallStartTime;
+	}
+	for (unsigned player = 0; player < MAX_PLAYERS; ++player)
+	{
+		int latency;
+		if (latenessPercentile(player, &latency))
+		{
+			ret.playerLateness[player] = latency - discreteChosenLatency;
+		}
+	}
+	return ret;
+}
+
 bool gameTimeIsStopped(void)
 {
 	return stopCount != 0;
@@ -287,6 +422,7 @@ void gameTimeStop(void)
 	stopCount += 1;
 
 	graphicsTimeFraction = 0.f;
+	stallStartTime = 0;  // Don't count the pause as waiting for other players.
 }
 
 /* Call this to restart the game timer after a call to gameTimeStop */
@@ -322,12 +458,45 @@ void getTimeComponents(unsigned time, int *hours, int *minutes, int *seconds, in
 	*hours = time;
 }
 
+/// Add the latency which each other player's GAME_GAME_TIME for this tick needed to arrive in time to their histograms.
+/// The latency is measured when the message arrives, since the chosen latency may have changed by the time it is used.
+static void updateLateness()
+{
+	const uint32_t now = wzGetTicks();
+
+	for (unsigned player = 0; player < game.maxPlayers; ++player)
+	{
+		if (updateWantedTime != 0 && NetPlay.players[player].allocated && !myResponsibility(player) && playerReadyTime[player] != 0)
+		{
+			const int neededLatency = (int)(playerReadyTime[player] - updateWantedTime) + discreteChosenLatency;
+			const int bucket = clip(neededLatency / LATENESS_BUCKET_MS, 0, LATENESS_BUCKETS - 1);
+			++latenessHistogram[player][bucket];
+		}
+		// If we already have what we need for the next tick, it was there before we could want to tick.
+		playerReadyTime[player] = checkPlayerGameTime(player) ? now : 0;
+	}
+
+	if (++latenessTicks >= LATENESS_DECAY_TICKS)
+	{
+		for (unsigned player = 0; player < MAX_PLAYERS; ++player)
+		{
+			for (unsigned bucket = 0; bucket < LATENESS_BUCKETS; ++bucket)
+			{
+				latenessHistogram[player][bucket] /= 2;
+			}
+		}
+		latenessTicks = 0;
+	}
+}
+
 static void updateLatency()
 {
 	uint16_t maxWantedLatency = 0;
 	unsigned player;
 	uint16_t prevDiscreteChosenLatency = discreteChosenLatency;
 
+	updateLateness();
+
 	// Find out what latency has been agreed on, next.
 	for (player = 0; player < game.maxPlayers; ++player)
 	{
@@ -346,9 +515,21 @@ static void updateLatency()
 		debug(LOG_SYNC, "Adjusting latency %d -> %d", prevDiscreteChosenLatency, discreteChosenLatency);
 	}
 
-	// We want the chosen latency to increase by how much our update was delayed waiting for others, or to decrease by how long after we got the messages from others that it was time to tick. Plus a tiny 10ms buffer.
+	// We want the latency which would have been enough for our update not to be delayed waiting for others.
+	// Rather than following the last update only, use the latency that the latest player usually needs, so a single late message doesn't add input delay, and a connection that is often late gets enough of it.
 	// We will send this number to others.
-	wantedLatency = clip((int)(discreteChosenLatency + updateReadyTime - updateWantedTime + 10), 0, UINT16_MAX);
+	int neededLatency = (int)(updateReadyTime - updateWantedTime) + discreteChosenLatency;
+	bool haveNeededLatency = false;
+	for (player = 0; player < game.maxPlayers; ++player)
+	{
+		int playerLatency;
+		if (NetPlay.players[player].allocated && !myResponsibility(player) && latenessPercentile(player, &playerLatency))
+		{
+			neededLatency = haveNeededLatency ? std::max(neededLatency, playerLatency) : playerLatency;
+			haveNeededLatency = true;
+		}
+	}
+	wantedLatency = clip(neededLatency, 0, UINT16_MAX);
 
 	// Reset the times, ready to be set again.
 	updateReadyTime = 0;
@@ -394,10 +575,16 @@ void recvPlayerGameTime(NETQUEUE queue)
 	syncDebug("GAME_GAME_TIME p%d;lat%u,ct%u,crc%04X,wlat%u", queue.index, latencyTicks, checkTime, checkCrc, wantedLatencies[queue.index]);
 
 	gameQueueTime[queue.index] = checkTime + latencyTicks * GAME_TICKS_PER_UPDATE;  // gameTime when future messages shall be processed.
+	if (playerReadyTime[queue.index] == 0 && checkPlayerGameTime(queue.index))
+	{
+		playerReadyTime[queue.index] = wzGetTicks();  // This is the time this player let us tick.
+	}
 
 	gameQueueCheckTime[queue.index] = checkTime;
 	gameQueueCheckCrc[queue.index] = checkCrc;
-	if (!checkDebugSync(checkTime, checkCrc))
+	const bool syncOk = checkDebugSync(checkTime, checkCrc);
+	NETreplaySyncChecked(checkTime, syncOk);
+	if (!syncOk)
 	{
 		crcError = true;
 		if (NetPlay.players[queue.index].allocated)
@@ -99,6 +99,30 @@ void gameTimeSetMod(Rational mod);
 /** Get the current time modifier. */
 Rational gameTimeGetMod();
 
+/// Run the game time as fast as the game state can be updated, instead of in real time. Used for benchmarks.
+void gameTimeSetUnthrottled(bool unthrottled);
+
+/// Whether the game time runs as fast as possible, either for a benchmark or while playing back a replay.
+bool gameTimeIsUnthrottled();
+
+/// How the game time has been kept in step with the other players. Times are in ms.
+struct GAME_TIME_STATS
+{
+	unsigned latency = 0;                   ///< Agreed delay before orders are executed
+	unsigned wantedLatency = 0;             ///< Delay we asked the others for
+	unsigned stalls = 0;                    ///< Times the game time stopped, waiting for GAME_GAME_TIME from other players
+	unsigned stallTime = 0;                 ///< Total time spent waiting for other players
+	unsigned lastStallTime = 0;             ///< Length of the last (or current) wait
+	unsigned stallPlayer = 0;               ///< Player last waited for
+	unsigned catchUps = 0;                  ///< Times the game ticked several times in a row without rendering, after a hitch
+	unsigned catchUpTicks = 0;              ///< Total ticks run to catch up
+	unsigned lastCatchUpTicks = 0;          ///< Ticks run in the last catch up
+	int playerLateness[MAX_PLAYERS] = {};   ///< How late GAME_GAME_TIME from each player usually is, negative if early
+};
+
+/// Returns the latency and stall statistics of the current game.
+GAME_TIME_STATS gameTimeGetStats();
+
 /**
  * Returns the game time, modulo the time period, scaled to 0..requiredRange.
  * For instance getModularScaledGameTime(4096,256) will return a number that cycles through the values
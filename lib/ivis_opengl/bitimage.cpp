@@ -64,6 +64,13 @@ struct ImageMerge
 	std::vector<int> pages;  // List of page sizes, normally all pageSize, unless an image is too large for a normal page.
 };
 
+/// An image list file with its images put on texture pages, which still have to be uploaded.
+struct IMAGEFILE_DECODED
+{
+	IMAGEFILE *imageFile;
+	std::vector<iV_Image> pages;
+};
+
 ImageDef *iV_GetImage(const QString &filename)
 {
 	if (!images.contains(filename))
@@ -138,7 +145,7 @@ inline void ImageMerge::arrange()
 	}
 }
 
-IMAGEFILE *iV_LoadImageFile(const char *fileName)
+IMAGEFILE_DECODED *iV_DecodeImageFile(const char *fileName)
 {
 	// Find the directory of images.
 	std::string imageDir = fileName;
@@ -202,8 +209,6 @@ IMAGEFILE *iV_LoadImageFile(const char *fileName)
 		numImages++;
 		ptr += temp;
 		while (ptr < pFileData + pFileSize && *ptr++ != '\n') {} // skip rest of line
-
-		images.insert(tmpName, ImageDef);
 	}
 	free(pFileData);
 
@@ -212,7 +217,10 @@ IMAGEFILE *iV_LoadImageFile(const char *fileName)
 	pageLayout.arrange();  // Arrange all the images onto texture pages (attempt to do so with as few pages as possible).
 	imageFile->pages.resize(pageLayout.pages.size());
 
-	std::vector<iV_Image> ivImages(pageLayout.pages.size());
+	IMAGEFILE_DECODED *decoded = new IMAGEFILE_DECODED;
+	decoded->imageFile = imageFile;
+	decoded->pages.resize(pageLayout.pages.size());
+	std::vector<iV_Image> &ivImages = decoded->pages;
 
 	for (unsigned p = 0; p < pageLayout.pages.size(); ++p)
 	{
@@ -272,14 +280,27 @@ IMAGEFILE *iV_LoadImageFile(const char *fileName)
 		fclose(f);
 	}*/
 
+	return decoded;
+}
+
+IMAGEFILE *iV_CommitImageFile(IMAGEFILE_DECODED *decoded, const char *fileName)
+{
+	IMAGEFILE *imageFile = decoded->imageFile;
+
+	for (const auto &name : imageFile->imageNames)
+	{
+		images.insert(QString::fromStdString(name.first), &imageFile->imageDefs[name.second]);
+	}
+
 	// Upload texture pages and free image data.
-	for (unsigned p = 0; p < pageLayout.pages.size(); ++p)
+	for (unsigned p = 0; p < decoded->pages.size(); ++p)
 	{
 		char arbitraryName[256];
 		ssprintf(arbitraryName, "%s-%03u", fileName, p);
-		// Now we can set imageFile->pages[p].id. This free()s the ivImages[p].bmp array!
-		imageFile->pages[p].id = pie_AddTexPage(&ivImages[p], arbitraryName, false);
+		// Now we can set imageFile->pages[p].id. This free()s the decoded->pages[p].bmp array!
+		imageFile->pages[p].id = pie_AddTexPage(&decoded->pages[p], arbitraryName, false);
 	}
+	delete decoded;
 
 	// duplicate some data, since we want another access point to these data structures now, FIXME
 	for (unsigned i = 0; i < imageFile->imageDefs.size(); i++)
@@ -293,6 +314,22 @@ IMAGEFILE *iV_LoadImageFile(const char *fileName)
 	return imageFile;
 }
 
+void iV_DiscardImageFile(IMAGEFILE_DECODED *decoded)
+{
+	for (iV_Image &page : decoded->pages)
+	{
+		free(page.bmp);
+	}
+	delete decoded->imageFile;
+	delete decoded;
+}
+
+IMAGEFILE *iV_LoadImageFile(const char *fileName)
+{
+	IMAGEFILE_DECODED *decoded = iV_DecodeImageFile(fileName);
+	return decoded != nullptr ? iV_CommitImageFile(decoded, fileName) : nullptr;
+}
+
 void iV_FreeImageFile(IMAGEFILE *imageFile)
 {
 	// so when we get here, it is time to redo everything. will clean this up later. TODO.
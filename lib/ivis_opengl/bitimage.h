@@ -50,8 +50,16 @@ static inline WZ_DECL_PURE short iV_GetImageYOffset(const IMAGEFILE *ImageFile,
 	return Image(ImageFile, ID).yOffset();
 }
 
+struct IMAGEFILE_DECODED;
+
 ImageDef *iV_GetImage(const QString &filename);
 IMAGEFILE *iV_LoadImageFile(const char *FileData);
+/// Reads an image list file and its images, and arranges them on texture pages. Thread safe.
+IMAGEFILE_DECODED *iV_DecodeImageFile(const char *fileName);
+/// Uploads the texture pages of a decoded image list file and makes its images available, freeing decoded.
+IMAGEFILE *iV_CommitImageFile(IMAGEFILE_DECODED *decoded, const char *fileName);
+/// Frees a decoded image list file that won't be committed.
+void iV_DiscardImageFile(IMAGEFILE_DECODED *decoded);
 void iV_FreeImageFile(IMAGEFILE *ImageFile);
 
 #endif
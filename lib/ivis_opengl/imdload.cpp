@@ -24,10 +24,12 @@
  * Load IMD (.pie) files
  */
 
+#include <QtCore/QElapsedTimer>
 #include <QtCore/QMap>
 #include <QtCore/QString>
 
 #include "lib/framework/frame.h"
+#include "lib/framework/crc.h"
 #include "lib/framework/string_ext.h"
 #include "lib/framework/frameresource.h"
 #include "lib/framework/fixedpoint.h"
@@ -43,9 +45,67 @@
 // Scale animation numbers from int to float
 #define INT_SCALE       1000
 
+// Binary cache of processed model levels, in the write directory
+#define IMD_CACHE_DIR		"cache/models/"
+#define IMD_CACHE_MAGIC		0x434d5a57	// "WZMC"
+#define IMD_CACHE_VERSION	1
+
 typedef QMap<QString, iIMDShape *> MODELMAP;
 static MODELMAP models;
 
+// Levels of the model being parsed, serialised for the cache, last level first; NULL if not caching
+static std::vector<QByteArray> *imdCacheLevels = nullptr;
+
+// Load time statistics
+static int modelLoadDepth = 0;
+static int modelLoadCount = 0;
+static int modelCacheCount = 0;
+static qint64 modelLoadTime = 0;
+
+/// Reads values back from a model cache file
+struct IMD_CACHE_READER
+{
+	const char *pos;
+	const char *end;
+
+	template <typename T>
+	bool read(T *data, size_t count = 1)
+	{
+		if ((size_t)(end - pos) < sizeof(T) * count)
+		{
+			return false;
+		}
+		memcpy(data, pos, sizeof(T) * count);
+		pos += sizeof(T) * count;
+		return true;
+	}
+
+	bool readString(std::string *str)
+	{
+		uint32_t len;
+		if (!read(&len) || (size_t)(end - pos) < len)
+		{
+			return false;
+		}
+		str->assign(pos, len);
+		pos += len;
+		return true;
+	}
+};
+
+template <typename T>
+static void imdCacheWrite(QByteArray &out, const T *data, size_t count = 1)
+{
+	out.append((const char *)data, sizeof(T) * count);
+}
+
+static void imdCacheWriteString(QByteArray &out, const std::string &str)
+{
+	uint32_t len = str.size();
+	imdCacheWrite(out, &len);
+	out.append(str.data(), len);
+}
+
 static iIMDShape *iV_ProcessIMD(const QString &filename, const char **ppFileData, const char *FileDataEnd);
 
 iIMDShape::iIMDShape()
@@ -111,6 +171,11 @@ static void iV_IMDRelease(iIMDShape *s)
 
 void modelShutdown()
 {
+	debug(LOG_3D, "Loaded %d models (%d from cache) in %lld ms", modelLoadCount, modelCacheCount, (long long)(modelLoadTime / 1000000));
+	modelLoadCount = 0;
+	modelCacheCount = 0;
+	modelLoadTime = 0;
+
 	for (MODELMAP::iterator i = models.begin(); i != models.end(); i = models.erase(i))
 	{
 		iV_IMDRelease(i.value());
@@ -130,7 +195,18 @@ static bool tryLoad(const QString &path, const QString &filename)
 			return false;
 		}
 		fileEnd = pFileData + size;
+		QElapsedTimer timer;
+		timer.start();
+		modelLoadDepth++;	// models can load animation models, only count the outermost
+		const char *pFileStart = pFileData;
 		iIMDShape *s = iV_ProcessIMD(filename, (const char **)&pFileData, fileEnd);
+		free((void *)pFileStart);
+		modelLoadDepth--;
+		if (modelLoadDepth == 0)
+		{
+			modelLoadTime += timer.nsecsElapsed();
+		}
+		modelLoadCount++;
 		if (s)
 		{
 			models.insert(filename, s);
@@ -657,6 +733,232 @@ static inline int addVertex(iIMDShape *s, int i, const iIMDPoly *p, int frameidx
 	return vertexCount - 1;
 }
 
+/// Upload the vertex data built for a level to OpenGL and clear it
+static void _imd_upload_level(iIMDShape *s)
+{
+	glGenBuffers(VBO_COUNT, s->buffers);
+	glBindBuffer(GL_ARRAY_BUFFER, s->buffers[VBO_VERTEX]);
+	glBufferData(GL_ARRAY_BUFFER, vertices.size() * sizeof(GLfloat), vertices.constData(), GL_STATIC_DRAW);
+	glBindBuffer(GL_ARRAY_BUFFER, s->buffers[VBO_NORMAL]);
+	glBufferData(GL_ARRAY_BUFFER, normals.size() * sizeof(GLfloat), normals.constData(), GL_STATIC_DRAW);
+	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, s->buffers[VBO_INDEX]);
+	glBufferData(GL_ELEMENT_ARRAY_BUFFER, indices.size() * sizeof(uint16_t), indices.constData(), GL_STATIC_DRAW);
+	glBindBuffer(GL_ARRAY_BUFFER, s->buffers[VBO_TEXCOORD]);
+	glBufferData(GL_ARRAY_BUFFER, texcoords.size() * sizeof(GLfloat), texcoords.constData(), GL_STATIC_DRAW);
+	glBindBuffer(GL_ARRAY_BUFFER, 0); // unbind
+
+	indices.resize(0);
+	vertices.resize(0);
+	texcoords.resize(0);
+	normals.resize(0);
+}
+
+/// Serialise a parsed level, including the vertex data built for it, for the model cache
+static QByteArray _imd_cache_level(const iIMDShape *s, const std::string &vertexShader, const std::string &fragmentShader)
+{
+	QByteArray out;
+	uint32_t count;
+
+	imdCacheWriteString(out, vertexShader);
+	imdCacheWriteString(out, fragmentShader);
+	imdCacheWrite(out, &s->npoints);
+	imdCacheWrite(out, s->points, s->npoints);
+	imdCacheWrite(out, &s->min);
+	imdCacheWrite(out, &s->max);
+	imdCacheWrite(out, &s->ocen);
+	imdCacheWrite(out, &s->radius);
+	imdCacheWrite(out, &s->sradius);
+	imdCacheWrite(out, &s->numFrames);
+	imdCacheWrite(out, &s->animInterval);
+	imdCacheWrite(out, &s->npolys);
+	for (unsigned i = 0; i < s->npolys; i++)
+	{
+		const iIMDPoly *poly = &s->polys[i];
+
+		imdCacheWrite(out, &poly->flags);
+		imdCacheWrite(out, &poly->zcentre);
+		imdCacheWrite(out, &poly->normal);
+		imdCacheWrite(out, poly->pindex, 3);
+		imdCacheWrite(out, &poly->texAnim);
+		// Texture animation frames are counted from the level, see _imd_load_polys
+		count = poly->texCoord == nullptr ? 0 : (poly->flags & iV_IMD_TEXANIM) ? s->numFrames * 3 : 3;
+		imdCacheWrite(out, &count);
+		imdCacheWrite(out, poly->texCoord, count);
+	}
+	imdCacheWrite(out, &s->nconnectors);
+	imdCacheWrite(out, s->connectors, s->nconnectors);
+	imdCacheWrite(out, &s->objanimtime);
+	imdCacheWrite(out, &s->objanimcycles);
+	imdCacheWrite(out, &s->objanimframes);
+	imdCacheWrite(out, s->objanimdata.data(), s->objanimdata.size());
+	count = vertices.size();
+	imdCacheWrite(out, &count);
+	imdCacheWrite(out, vertices.constData(), vertices.size());
+	imdCacheWrite(out, normals.constData(), normals.size());
+	count = texcoords.size();
+	imdCacheWrite(out, &count);
+	imdCacheWrite(out, texcoords.constData(), texcoords.size());
+	count = indices.size();
+	imdCacheWrite(out, &count);
+	imdCacheWrite(out, indices.constData(), indices.size());
+	return out;
+}
+
+/// Read a level written by _imd_cache_level into s, and upload its vertex data
+static bool _imd_load_cached_level(const QString &filename, IMD_CACHE_READER &in, iIMDShape *s)
+{
+	std::string vertexShader, fragmentShader;
+	uint32_t count;
+
+	if (!in.readString(&vertexShader) || !in.readString(&fragmentShader) || !in.read(&s->npoints))
+	{
+		return false;
+	}
+	s->points = (Vector3f *)malloc(sizeof(Vector3f) * s->npoints);
+	if (!in.read(s->points, s->npoints) || !in.read(&s->min) || !in.read(&s->max) || !in.read(&s->ocen)
+	    || !in.read(&s->radius) || !in.read(&s->sradius) || !in.read(&s->numFrames) || !in.read(&s->animInterval)
+	    || !in.read(&s->npolys))
+	{
+		s->npolys = 0;
+		return false;
+	}
+	s->polys = (iIMDPoly *)calloc(s->npolys, sizeof(iIMDPoly));
+	for (unsigned i = 0; i < s->npolys; i++)
+	{
+		iIMDPoly *poly = &s->polys[i];
+
+		if (!in.read(&poly->flags) || !in.read(&poly->zcentre) || !in.read(&poly->normal) || !in.read(poly->pindex, 3)
+		    || !in.read(&poly->texAnim) || !in.read(&count))
+		{
+			return false;
+		}
+		if (count > 0)
+		{
+			poly->texCoord = (Vector2f *)malloc(sizeof(*poly->texCoord) * count);
+			if (!in.read(poly->texCoord, count))
+			{
+				return false;
+			}
+		}
+	}
+	if (!in.read(&s->nconnectors))
+	{
+		s->nconnectors = 0;
+		return false;
+	}
+	s->connectors = (Vector3i *)malloc(sizeof(Vector3i) * s->nconnectors);
+	if (!in.read(s->connectors, s->nconnectors) || !in.read(&s->objanimtime) || !in.read(&s->objanimcycles)
+	    || !in.read(&s->objanimframes))
+	{
+		return false;
+	}
+	s->objanimdata.resize(s->objanimframes);
+	if (!in.read(s->objanimdata.data(), s->objanimdata.size()) || !in.read(&count))
+	{
+		return false;
+	}
+	vertices.resize(count);
+	normals.resize(count);
+	if (!in.read(vertices.data(), count) || !in.read(normals.data(), count) || !in.read(&count))
+	{
+		return false;
+	}
+	texcoords.resize(count);
+	if (!in.read(texcoords.data(), count) || !in.read(&count))
+	{
+		return false;
+	}
+	indices.resize(count);
+	if (!in.read(indices.data(), count))
+	{
+		return false;
+	}
+
+	if (!vertexShader.empty())
+	{
+		std::vector<std::string> uniform_names { "colour", "teamcolour", "stretch", "tcmask", "fogEnabled", "normalmap",
+		                                         "specularmap", "ecmEffect", "alphaTest", "graphicsCycle", "ModelViewProjectionMatrix" };
+		s->shaderProgram = pie_LoadShader(filename.toUtf8().constData(), vertexShader.c_str(), fragmentShader.c_str(), uniform_names);
+	}
+	_imd_upload_level(s);
+	return true;
+}
+
+/*!
+ * Load all levels of a model from its cache file
+ * \return the first level, or NULL if the cache is missing, stale or corrupt
+ */
+static iIMDShape *_imd_load_cache(const QString &filename, const Sha256 &hash)
+{
+	const QString cacheName = IMD_CACHE_DIR + filename + ".bin";
+	char *pCacheData = nullptr;
+	UDWORD size = 0;
+	uint32_t magic, version, nlevels;
+	Sha256 cacheHash;
+	iIMDShape *shape = nullptr;
+
+	if (!PHYSFS_exists(cacheName.toUtf8().constData()) || !loadFile(cacheName.toUtf8().constData(), &pCacheData, &size))
+	{
+		return nullptr;
+	}
+	IMD_CACHE_READER in = {pCacheData, pCacheData + size};
+	if (in.read(&magic) && magic == IMD_CACHE_MAGIC && in.read(&version) && version == IMD_CACHE_VERSION
+	    && in.read(cacheHash.bytes, Sha256::Bytes) && cacheHash == hash && in.read(&nlevels))
+	{
+		iIMDShape **ppNext = &shape;
+		for (unsigned i = 0; i < nlevels; i++)
+		{
+			*ppNext = new iIMDShape;
+			memset((*ppNext)->buffers, 0, sizeof((*ppNext)->buffers));
+			(*ppNext)->objanimframes = 0;
+			if (!_imd_load_cached_level(filename, in, *ppNext))
+			{
+				iV_IMDRelease(shape);
+				shape = nullptr;
+				indices.resize(0);
+				vertices.resize(0);
+				texcoords.resize(0);
+				normals.resize(0);
+				break;
+			}
+			ppNext = &(*ppNext)->next;
+		}
+	}
+	free(pCacheData);
+	return shape;
+}
+
+/// Write the levels of a model serialised while parsing it to its cache file
+static void _imd_save_cache(const QString &filename, const Sha256 &hash, const std::vector<QByteArray> &levels)
+{
+	const QString cacheName = IMD_CACHE_DIR + filename + ".bin";
+	const uint32_t magic = IMD_CACHE_MAGIC, version = IMD_CACHE_VERSION, nlevels = levels.size();
+	QByteArray out;
+
+	imdCacheWrite(out, &magic);
+	imdCacheWrite(out, &version);
+	imdCacheWrite(out, hash.bytes, Sha256::Bytes);
+	imdCacheWrite(out, &nlevels);
+	// The last level was parsed first
+	for (auto level = levels.rbegin(); level != levels.rend(); ++level)
+	{
+		out.append(*level);
+	}
+
+	(void) PHYSFS_mkdir(IMD_CACHE_DIR);
+	PHYSFS_file *fileHandle = PHYSFS_openWrite(cacheName.toUtf8().constData());
+	if (fileHandle == nullptr)
+	{
+		debug(LOG_3D, "Could not write model cache %s: %s", cacheName.toUtf8().constData(), PHYSFS_getLastError());
+		return;
+	}
+	if (PHYSFS_write(fileHandle, out.constData(), 1, out.size()) != out.size())
+	{
+		debug(LOG_3D, "Could not write model cache %s: %s", cacheName.toUtf8().constData(), PHYSFS_getLastError());
+	}
+	PHYSFS_close(fileHandle);
+}
+
 /*!
  * Load shape levels recursively
  * \param ppFileData Pointer to the data (usualy read from a file)
@@ -673,6 +975,7 @@ static iIMDShape *_imd_load_level(const QString &filename, const char **ppFileDa
 	int cnt = 0, n = 0, i;
 	iIMDShape *s = nullptr;
 	float dummy;
+	std::string vertexShader, fragmentShader;
 
 	if (nlevels == 0)
 	{
@@ -705,6 +1008,8 @@ static iIMDShape *_imd_load_level(const QString &filename, const char **ppFileDa
 		std::vector<std::string> uniform_names { "colour", "teamcolour", "stretch", "tcmask", "fogEnabled", "normalmap",
 		                                         "specularmap", "ecmEffect", "alphaTest", "graphicsCycle", "ModelViewProjectionMatrix" };
 		s->shaderProgram = pie_LoadShader(filename.toUtf8().constData(), vertex, fragment, uniform_names);
+		vertexShader = vertex;
+		fragmentShader = fragment;
 		pFileData += cnt;
 	}
 
@@ -793,7 +1098,6 @@ static iIMDShape *_imd_load_level(const QString &filename, const char **ppFileDa
 	}
 
 	// FINALLY, massage the data into what can stream directly to OpenGL
-	glGenBuffers(VBO_COUNT, s->buffers);
 	vertexCount = 0;
 	for (int k = 0; k < MAX(1, s->numFrames); k++)
 	{
@@ -808,20 +1112,11 @@ static iIMDShape *_imd_load_level(const QString &filename, const char **ppFileDa
 			indices.append(addVertex(s, 2, pPolys, k));
 		}
 	}
-	glBindBuffer(GL_ARRAY_BUFFER, s->buffers[VBO_VERTEX]);
-	glBufferData(GL_ARRAY_BUFFER, vertices.size() * sizeof(GLfloat), vertices.constData(), GL_STATIC_DRAW);
-	glBindBuffer(GL_ARRAY_BUFFER, s->buffers[VBO_NORMAL]);
-	glBufferData(GL_ARRAY_BUFFER, normals.size() * sizeof(GLfloat), normals.constData(), GL_STATIC_DRAW);
-	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, s->buffers[VBO_INDEX]);
-	glBufferData(GL_ELEMENT_ARRAY_BUFFER, indices.size() * sizeof(uint16_t), indices.constData(), GL_STATIC_DRAW);
-	glBindBuffer(GL_ARRAY_BUFFER, s->buffers[VBO_TEXCOORD]);
-	glBufferData(GL_ARRAY_BUFFER, texcoords.size() * sizeof(GLfloat), texcoords.constData(), GL_STATIC_DRAW);
-	glBindBuffer(GL_ARRAY_BUFFER, 0); // unbind
-
-	indices.resize(0);
-	vertices.resize(0);
-	texcoords.resize(0);
-	normals.resize(0);
+	if (imdCacheLevels != nullptr)
+	{
+		imdCacheLevels->push_back(_imd_cache_level(s, vertexShader, fragmentShader));
+	}
+	_imd_upload_level(s);
 
 	*ppFileData = pFileData;
 
@@ -837,6 +1132,7 @@ static iIMDShape *_imd_load_level(const QString &filename, const char **ppFileDa
 // ppFileData is incremented to the end of the file on exit!
 static iIMDShape *iV_ProcessIMD(const QString &filename, const char **ppFileData, const char *FileDataEnd)
 {
+	const char *pFileStart = *ppFileData;
 	const char *pFileData = *ppFileData;
 	char buffer[PATH_MAX], texfile[PATH_MAX], normalfile[PATH_MAX], specfile[PATH_MAX];
 	int cnt, nlevels;
@@ -1061,7 +1357,26 @@ static iIMDShape *iV_ProcessIMD(const QString &filename, const char **ppFileData
 		return nullptr;
 	}
 
-	shape = _imd_load_level(filename, &pFileData, FileDataEnd, nlevels, imd_version, level);
+	// The levels are most of the file, use the cached result of parsing them if the file did not change
+	const Sha256 hash = sha256Sum(pFileStart, FileDataEnd - pFileStart);
+	shape = _imd_load_cache(filename, hash);
+	if (shape != nullptr)
+	{
+		modelCacheCount++;
+		pFileData = FileDataEnd;
+	}
+	else
+	{
+		std::vector<QByteArray> cacheLevels;
+
+		imdCacheLevels = &cacheLevels;
+		shape = _imd_load_level(filename, &pFileData, FileDataEnd, nlevels, imd_version, level);
+		imdCacheLevels = nullptr;
+		if (shape != nullptr)
+		{
+			_imd_save_cache(filename, hash, cacheLevels);
+		}
+	}
 	if (shape == nullptr)
 	{
 		debug(LOG_ERROR, "%s: Unsuccessful", filename.toUtf8().constData());
@@ -59,7 +59,8 @@ struct iIMDShape;
 /***************************************************************************/
 void pie_Draw3DShape(iIMDShape *shape, int frame, int team, PIELIGHT colour, int pieFlag, int pieFlagData, const glm::mat4 &modelView);
 
-void pie_GetResetCounts(unsigned int *pPieCount, unsigned int *pPolyCount);
+/// Gets and resets the numbers of shapes, polygons, model draw calls and model state setups since the last call.
+void pie_GetResetCounts(unsigned int *pPieCount, unsigned int *pPolyCount, unsigned int *pDrawCount, unsigned int *pStateCount);
 
 /** Setup stencil shadows and OpenGL lighting. */
 void pie_BeginLighting(const Vector3f &light);
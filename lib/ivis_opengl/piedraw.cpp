@@ -62,6 +62,8 @@ static GLenum ss_op_depth_pass_back = GL_DECR;
 
 static unsigned int pieCount = 0;
 static unsigned int polyCount = 0;
+static unsigned int drawCount = 0;   ///< Model draw calls.
+static unsigned int stateCount = 0;  ///< Shader, texture and buffer setups for model draw calls.
 static bool shadows = false;
 static GLfloat lighting0[LIGHT_MAX][4];
 
@@ -169,12 +171,46 @@ static void pie_Draw3DButton(iIMDShape *shape, PIELIGHT teamcolour, const glm::m
 	glDrawElements(GL_TRIANGLES, shape->npolys * 3, GL_UNSIGNED_SHORT, nullptr);
 	disableArrays();
 	polyCount += shape->npolys;
+	++drawCount;
+	++stateCount;
 	pie_DeactivateShader();
 	pie_SetDepthBufferStatus(DEPTH_CMP_ALWAYS_WRT_ON);
 }
 
-static void pie_Draw3DShape2(const iIMDShape *shape, int frame, PIELIGHT colour, PIELIGHT teamcolour, int pieFlag, int pieFlagData, glm::mat4 const &matrix)
+/// Whether a and b can be drawn with the same state, changing only their colours and matrices in between.
+static bool pie_SameShapeState(const SHAPE &a, const SHAPE &b)
 {
+	return a.shape == b.shape && a.frame == b.frame && a.flag == b.flag && a.stretch == b.stretch;
+}
+
+/// Orders the opaque shapes so that those which can be drawn with the same state are next to each other. ECM shapes
+/// are blended, so they go last.
+static bool pie_ShapeStateLess(const SHAPE &a, const SHAPE &b)
+{
+	if ((a.flag & pie_ECM) != (b.flag & pie_ECM))
+	{
+		return (a.flag & pie_ECM) == 0;
+	}
+	if (a.shape != b.shape)
+	{
+		return a.shape < b.shape;
+	}
+	if (a.frame != b.frame)
+	{
+		return a.frame < b.frame;
+	}
+	if (a.flag != b.flag)
+	{
+		return a.flag < b.flag;
+	}
+	return a.stretch < b.stretch;
+}
+
+/// Draws the shapes from begin to end, which must all have the same state, setting up the state once.
+static void pie_Draw3DShapes(const SHAPE *begin, const SHAPE *end)
+{
+	const iIMDShape *shape = begin->shape;
+	const int pieFlag = begin->flag;
 	bool light = true;
 
 	/* Set fog status */
@@ -188,16 +224,15 @@ static void pie_Draw3DShape2(const iIMDShape *shape, int frame, PIELIGHT colour,
 	}
 
 	/* Set tranlucency */
+	const bool alphaFromFlagData = pieFlag & (pie_ADDITIVE | pie_TRANSLUCENT);
 	if (pieFlag & pie_ADDITIVE)
 	{
 		pie_SetRendMode(REND_ADDITIVE);
-		colour.byte.a = (UBYTE)pieFlagData;
 		light = false;
 	}
 	else if (pieFlag & pie_TRANSLUCENT)
 	{
 		pie_SetRendMode(REND_ALPHA);
-		colour.byte.a = (UBYTE)pieFlagData;
 		light = false;
 	}
 	else if (pieFlag & pie_PREMULTIPLIED)
@@ -222,8 +257,16 @@ static void pie_Draw3DShape2(const iIMDShape *shape, int frame, PIELIGHT colour,
 	glm::vec4 diffuse(lighting0[LIGHT_DIFFUSE][0], lighting0[LIGHT_DIFFUSE][1], lighting0[LIGHT_DIFFUSE][2], lighting0[LIGHT_DIFFUSE][3]);
 	glm::vec4 specular(lighting0[LIGHT_SPECULAR][0], lighting0[LIGHT_SPECULAR][1], lighting0[LIGHT_SPECULAR][2], lighting0[LIGHT_SPECULAR][3]);
 
+	PIELIGHT colour = begin->colour;
+	if (alphaFromFlagData)
+	{
+		colour.byte.a = (UBYTE)begin->flag_data;
+	}
+
+	pie_SetShaderStretchDepth(begin->stretch);
+	const glm::mat4 perspective = pie_PerspectiveGet();
 	SHADER_MODE mode = shape->shaderProgram == SHADER_NONE ? light ? SHADER_COMPONENT : SHADER_NOLIGHT : shape->shaderProgram;
-	pie_internal::SHADER_PROGRAM &program = pie_ActivateShaderDeprecated(mode, shape, teamcolour, colour, matrix, pie_PerspectiveGet(),
+	pie_internal::SHADER_PROGRAM &program = pie_ActivateShaderDeprecated(mode, shape, begin->teamcolour, colour, begin->matrix, perspective,
 		glm::vec4(currentSunPosition, 0.f), sceneColor, ambient, diffuse, specular);
 
 	if (program.locations.size() >= 9)
@@ -231,21 +274,45 @@ static void pie_Draw3DShape2(const iIMDShape *shape, int frame, PIELIGHT colour,
 
 	pie_SetTexturePage(shape->texpage);
 
-	frame %= std::max<int>(1, shape->numFrames);
+	const int frame = begin->frame % std::max<int>(1, shape->numFrames);
 
 	enableArray(shape->buffers[VBO_VERTEX], program.locVertex, 3, GL_FLOAT, false, 0, 0);
 	enableArray(shape->buffers[VBO_NORMAL], program.locNormal, 3, GL_FLOAT, false, 0, 0);
 	enableArray(shape->buffers[VBO_TEXCOORD], program.locTexCoord, 2, GL_FLOAT, false, 0, 0);
 	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, shape->buffers[VBO_INDEX]);
-	glDrawElements(GL_TRIANGLES, shape->npolys * 3, GL_UNSIGNED_SHORT, BUFFER_OFFSET(frame * shape->npolys * 3 * sizeof(uint16_t)));
-	disableArrays();
+	++stateCount;
 
-	polyCount += shape->npolys;
+	for (const SHAPE *instance = begin; instance != end; ++instance)
+	{
+		if (instance != begin)
+		{
+			colour = instance->colour;
+			if (alphaFromFlagData)
+			{
+				colour.byte.a = (UBYTE)instance->flag_data;
+			}
+			pie_SetShaderInstance(program, instance->teamcolour, colour, instance->matrix, perspective);
+		}
+		glDrawElements(GL_TRIANGLES, shape->npolys * 3, GL_UNSIGNED_SHORT, BUFFER_OFFSET(frame * shape->npolys * 3 * sizeof(uint16_t)));
+		polyCount += shape->npolys;
+		++drawCount;
+	}
+	disableArrays();
 
 	pie_SetShaderEcmEffect(false);
 	pie_DeactivateShader();
 }
 
+/// Draws shapes, in runs of shapes with the same state.
+static void pie_Draw3DShapeList(const std::vector<SHAPE> &list)
+{
+	for (size_t begin = 0, end; begin < list.size(); begin = end)
+	{
+		for (end = begin + 1; end < list.size() && pie_SameShapeState(list[begin], list[end]); ++end) {}
+		pie_Draw3DShapes(&list[begin], &list[0] + end);
+	}
+}
+
 static inline bool edgeLessThan(EDGE const &e1, EDGE const &e2)
 {
 	if (e1.from != e2.from)
@@ -544,22 +611,14 @@ void pie_RemainingPasses()
 	{
 		pie_DrawShadows();
 	}
-	// Draw models
-	// TODO, sort list to reduce state changes
+	// Draw models, grouped to reduce state changes
 	GL_DEBUG("Remaining passes - opaque models");
-	for (SHAPE const &shape : shapes)
-	{
-		pie_SetShaderStretchDepth(shape.stretch);
-		pie_Draw3DShape2(shape.shape, shape.frame, shape.colour, shape.teamcolour, shape.flag, shape.flag_data, shape.matrix);
-	}
-	// Draw translucent models last
+	std::sort(shapes.begin(), shapes.end(), pie_ShapeStateLess);
+	pie_Draw3DShapeList(shapes);
+	// Draw translucent models last, in the order queued
 	// TODO, sort list by Z order to do translucency correctly
 	GL_DEBUG("Remaining passes - translucent models");
-	for (SHAPE const &shape : tshapes)
-	{
-		pie_SetShaderStretchDepth(shape.stretch);
-		pie_Draw3DShape2(shape.shape, shape.frame, shape.colour, shape.teamcolour, shape.flag, shape.flag_data, shape.matrix);
-	}
+	pie_Draw3DShapeList(tshapes);
 	pie_SetShaderStretchDepth(0);
 	pie_DeactivateShader();
 	tshapes.clear();
@@ -567,13 +626,17 @@ void pie_RemainingPasses()
 	GL_DEBUG("Remaining passes - done");
 }
 
-void pie_GetResetCounts(unsigned int *pPieCount, unsigned int *pPolyCount)
+void pie_GetResetCounts(unsigned int *pPieCount, unsigned int *pPolyCount, unsigned int *pDrawCount, unsigned int *pStateCount)
 {
 	*pPieCount  = pieCount;
 	*pPolyCount = polyCount;
+	*pDrawCount = drawCount;
+	*pStateCount = stateCount;
 
 	pieCount = 0;
 	polyCount = 0;
+	drawCount = 0;
+	stateCount = 0;
 }
 
 // GL 2.0 1-pass version
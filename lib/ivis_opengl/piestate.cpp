@@ -554,6 +554,15 @@ pie_internal::SHADER_PROGRAM &pie_ActivateShaderDeprecated(SHADER_MODE shaderMod
 	return program;
 }
 
+void pie_SetShaderInstance(pie_internal::SHADER_PROGRAM &program, PIELIGHT teamcolour, PIELIGHT colour, const glm::mat4 &ModelView, const glm::mat4 &Proj)
+{
+	glUniform4fv(program.locations[0], 1, &pal_PIELIGHTtoVec4(colour)[0]);
+	glUniform4fv(program.locations[1], 1, &pal_PIELIGHTtoVec4(teamcolour)[0]);
+	glUniformMatrix4fv(program.locations[10], 1, GL_FALSE, glm::value_ptr(ModelView));
+	glUniformMatrix4fv(program.locations[11], 1, GL_FALSE, glm::value_ptr(Proj * ModelView));
+	glUniformMatrix4fv(program.locations[12], 1, GL_FALSE, glm::value_ptr(glm::transpose(glm::inverse(ModelView))));
+}
+
 void pie_SetDepthBufferStatus(DEPTH_MODE depthMode)
 {
 	switch (depthMode)
@@ -47,6 +47,7 @@ static float font_colour[4] = {1.f, 1.f, 1.f, 1.f};
 #include "hb.h"
 #include "hb-ft.h"
 #include "ft2build.h"
+#include <list>
 #include <unordered_map>
 #include <memory>
 
@@ -130,6 +131,10 @@ struct FTFace
 
 	RasterizedGlyph get(uint32_t codePoint, Vector2i subpixeloffset64)
 	{
+		FT_Vector delta;
+		delta.x = subpixeloffset64.x;
+		delta.y = subpixeloffset64.y;
+		FT_Set_Transform(m_face, nullptr, &delta);
 		FT_Error error = FT_Load_Glyph(m_face,
 			codePoint, // the glyph_index in the font file
 			FT_LOAD_NO_HINTING // by default hb load fonts without hinting
@@ -158,6 +163,19 @@ struct FTFace
 		return g;
 	}
 
+	/// The glyph at a horizontal subpixel offset, which must be a multiple of GLYPH_SUBPIXEL_STEP. Each glyph is
+	/// only rendered once per offset.
+	const RasterizedGlyph &getCached(uint32_t codePoint, int32_t subpixelX64)
+	{
+		const uint64_t key = (uint64_t)codePoint << 8 | subpixelX64;
+		auto found = m_glyphs.find(key);
+		if (found == m_glyphs.end())
+		{
+			found = m_glyphs.emplace(key, get(codePoint, Vector2i(subpixelX64, 0))).first;
+		}
+		return found->second;
+	}
+
 	GlyphMetrics getGlyphMetrics(uint32_t codePoint, Vector2i subpixeloffset64)
 	{
 		FT_Vector delta;
@@ -192,6 +210,7 @@ struct FTFace
 
 private:
 	FT_Face m_face;
+	std::unordered_map<uint64_t, RasterizedGlyph> m_glyphs;  ///< Rendered glyphs, by glyph index and subpixel offset.
 };
 
 struct FTlib
@@ -220,11 +239,26 @@ struct TextRun
 		text(t), language(l), script(s), direction(d) {}
 };
 
-struct ShapedText
+/// Glyphs are rendered at quarter pixel horizontal offsets, in 26.6 fixed point.
+#define GLYPH_SUBPIXEL_STEP 16
+/// Shaped runs kept for reuse, enough for the text of a few screens.
+#define SHAPED_RUN_CACHE_SIZE 1024
+
+/// A shaped string, with the glyphs placed and their bounds in pixels.
+struct ShapedRun
 {
-	std::unique_ptr<unsigned char[]> texture;
-	uint32_t width;
-	uint32_t height;
+	struct Glyph
+	{
+		uint32_t codePoint;
+		int32_t subpixelX64;      ///< Offset the glyph is rendered at, a multiple of GLYPH_SUBPIXEL_STEP.
+		Vector2i pixelPosition;   ///< Top left of the rendered glyph.
+	};
+
+	std::vector<Glyph> glyphs;
+	int32_t min_x = 0;
+	int32_t min_y = 0;
+	uint32_t width = 0;
+	uint32_t height = 0;
 };
 
 // Note:
@@ -246,95 +280,50 @@ struct TextShaper
 
 	std::tuple<uint32_t, uint32_t> getTextMetrics(const TextRun& text, FTFace &face)
 	{
-		const std::vector<HarfbuzzPosition> &shapingResult = shapeText(text, face);
-		if (shapingResult.empty())
-			return std::make_tuple(0, 0);
-
-		int32_t min_x;
-		int32_t max_x;
-		int32_t min_y;
-		int32_t max_y;
-
-		std::tie(min_x, max_x, min_y, max_y) = std::accumulate(shapingResult.begin(), shapingResult.end(), std::make_tuple(1000, -1000, 1000, -1000),
-			[&face] (const std::tuple<int32_t, int32_t, int32_t, int32_t> &bounds, const HarfbuzzPosition &g) {
-			RasterizedGlyph glyph = face.get(g.codepoint, g.penPosition % 64);
-			int32_t x0 = g.penPosition.x / 64 + glyph.bearing_x;
-			int32_t y0 = g.penPosition.y / 64 - glyph.bearing_y;
-			return std::make_tuple(
-				std::min(x0, std::get<0>(bounds)),
-				std::max(static_cast<int32_t>(x0 + glyph.width), std::get<1>(bounds)),
-				std::min(y0, std::get<2>(bounds)),
-				std::max(static_cast<int32_t>(y0 + glyph.height), std::get<3>(bounds))
-				);
-			});
-
-		return std::make_tuple(max_x - min_x + 1, max_y - min_y + 1);
+		const ShapedRun &run = getShapedRun(text, face);
+		return std::make_tuple(run.width, run.height);
 	}
 
 	std::tuple<std::unique_ptr<unsigned char[]>, uint32_t, uint32_t, int32_t, int32_t> drawText(const TextRun& text, FTFace &face)
 	{
-		const std::vector<HarfbuzzPosition> &shapingResult = shapeText(text, face);
+		const ShapedRun &run = getShapedRun(text, face);
 
-		if (shapingResult.empty())
+		if (run.glyphs.empty())
 		{
 			return std::make_tuple(nullptr, 0, 0, 0, 0);
 		}
 
-		int32_t min_x = 1000;
-		int32_t max_x = -1000;
-		int32_t min_y = 1000;
-		int32_t max_y = -1000;
-
-		// build glyphes
-		struct glyphRaster
-		{
-			std::unique_ptr<unsigned char[]> buffer;
-			Vector2i pixelPosition;
-			Vector2i size;
-			uint32_t pitch;
-
-			glyphRaster(std::unique_ptr<unsigned char[]> &&b, Vector2i &&p, Vector2i &&s, uint32_t _pitch)
-				: buffer(std::move(b)), pixelPosition(p), size(s), pitch(_pitch) {}
-		};
-
-		std::vector<glyphRaster> glyphs;
-		std::transform(shapingResult.begin(), shapingResult.end(), std::back_inserter(glyphs),
-			[&] (const HarfbuzzPosition &g) {
-			RasterizedGlyph glyph = face.get(g.codepoint, g.penPosition % 64);
-			int32_t x0 = g.penPosition.x / 64 + glyph.bearing_x;
-			int32_t y0 = g.penPosition.y / 64 - glyph.bearing_y;
-			min_x = std::min(x0, min_x);
-			max_x = std::max(static_cast<int32_t>(x0 + glyph.width), max_x);
-			min_y = std::min(y0, min_y);
-			max_y = std::max(static_cast<int32_t>(y0 + glyph.height), max_y);
-			return glyphRaster(std::move(glyph.buffer), Vector2i(x0, y0), Vector2i(glyph.width, glyph.height), glyph.pitch);
-			});
-
-		uint32_t width = max_x - min_x + 1;
-		uint32_t height = max_y - min_y + 1;
-
+		const uint32_t width = run.width;
+		const uint32_t height = run.height;
 		std::unique_ptr<unsigned char[]> stringTexture(new unsigned char[4 * width * height]);
 		memset(stringTexture.get(), 0, 4 * width * height);
 
-		std::for_each(glyphs.begin(), glyphs.end(),
-			[&](const glyphRaster &g)
+		for (const ShapedRun::Glyph &g : run.glyphs)
+		{
+			const RasterizedGlyph &glyph = face.getCached(g.codePoint, g.subpixelX64);
+			const uint32_t i0 = g.pixelPosition.y - run.min_y;
+			const uint32_t j0 = g.pixelPosition.x - run.min_x;
+			for (uint32_t i = 0; i < glyph.height; ++i)
 			{
-				for (int i = 0; i < g.size.y; ++i)
+				uint8_t const *src = &glyph.buffer[i * glyph.pitch];
+				uint8_t *dst = &stringTexture[4 * ((i0 + i) * width + j0)];
+				for (uint32_t j = 0; j < glyph.width; ++j, src += 3, dst += 4)
 				{
-					uint32_t i0 = g.pixelPosition.y - min_y;
-					for (int j = 0; j < g.size.x; ++j)
-					{
-						uint32_t j0 = g.pixelPosition.x - min_x;
-						uint8_t const *src = &g.buffer[i * g.pitch + 3 * j];
-						uint8_t *dst = &stringTexture[4 * ((i0 + i) * width + j + j0)];
-						dst[0] = std::min(dst[0] + src[0], 255);
-						dst[1] = std::min(dst[1] + src[1], 255);
-						dst[2] = std::min(dst[2] + src[2], 255);
-						dst[3] = std::min(dst[3] + ((src[0] * 77 + src[1] * 150 + src[2] * 29) >> 8), 255);
-					}
+					dst[0] = std::min(dst[0] + src[0], 255);
+					dst[1] = std::min(dst[1] + src[1], 255);
+					dst[2] = std::min(dst[2] + src[2], 255);
+					dst[3] = std::min(dst[3] + ((src[0] * 77 + src[1] * 150 + src[2] * 29) >> 8), 255);
 				}
-			});
-		return std::make_tuple(std::move(stringTexture), width, height, min_x, min_y);
+			}
+		}
+		return std::make_tuple(std::move(stringTexture), width, height, run.min_x, run.min_y);
+	}
+
+	/// Forget the shaped runs, such as when the faces they were shaped with go away.
+	void clear()
+	{
+		m_runs.clear();
+		m_runIndex.clear();
 	}
 
 public:
@@ -380,6 +369,67 @@ public:
 		};
 		return glyphes;
 	}
+
+	/// The shaped run of text in face, shaped once and then kept while it is used.
+	const ShapedRun &getShapedRun(const TextRun& text, FTFace &face)
+	{
+		const FTFace *facePointer = &face;
+		std::string key(reinterpret_cast<const char *>(&facePointer), sizeof(facePointer));
+		key.append(text.text);
+		auto found = m_runIndex.find(key);
+		if (found != m_runIndex.end())
+		{
+			// Most recently used first.
+			m_runs.splice(m_runs.begin(), m_runs, found->second);
+			return found->second->second;
+		}
+
+		if (m_runs.size() >= SHAPED_RUN_CACHE_SIZE)
+		{
+			m_runIndex.erase(m_runs.back().first);
+			m_runs.pop_back();
+		}
+		m_runs.emplace_front(key, layOut(shapeText(text, face), face));
+		m_runIndex.emplace(std::move(key), m_runs.begin());
+		return m_runs.front().second;
+	}
+
+private:
+	ShapedRun layOut(const std::vector<HarfbuzzPosition> &shapingResult, FTFace &face)
+	{
+		ShapedRun run;
+		if (shapingResult.empty())
+		{
+			return run;
+		}
+
+		int32_t min_x = 1000;
+		int32_t max_x = -1000;
+		int32_t min_y = 1000;
+		int32_t max_y = -1000;
+		for (const HarfbuzzPosition &g : shapingResult)
+		{
+			// Whole pixels, rounding down, and the rest rounded down to a subpixel step.
+			const int32_t subpixelX64 = (g.penPosition.x & 63) & ~(GLYPH_SUBPIXEL_STEP - 1);
+			const RasterizedGlyph &glyph = face.getCached(g.codepoint, subpixelX64);
+			const int32_t x0 = (g.penPosition.x >> 6) + glyph.bearing_x;
+			const int32_t y0 = g.penPosition.y / 64 - glyph.bearing_y;
+			min_x = std::min(x0, min_x);
+			max_x = std::max(static_cast<int32_t>(x0 + glyph.width), max_x);
+			min_y = std::min(y0, min_y);
+			max_y = std::max(static_cast<int32_t>(y0 + glyph.height), max_y);
+			run.glyphs.push_back({g.codepoint, subpixelX64, Vector2i(x0, y0)});
+		}
+		run.min_x = min_x;
+		run.min_y = min_y;
+		run.width = max_x - min_x + 1;
+		run.height = max_y - min_y + 1;
+		return run;
+	}
+
+	typedef std::list<std::pair<std::string, ShapedRun>> RunList;
+	RunList m_runs;                                                 ///< Most recently used first.
+	std::unordered_map<std::string, RunList::iterator> m_runIndex;  ///< Keyed on the face and the text.
 };
 
 /***************************************************************************/
@@ -430,19 +480,82 @@ static FTFace &getFTFace(iV_fonts FontID)
 	}
 }
 
-static GLuint textureID = 0;
 static GLuint pbo = 0;
 
+/// Strings drawn recently, kept as textures so drawing them again, such as every frame, does not upload them again.
+#define STRING_TEXTURE_CACHE_SIZE 64
+
+struct StringTexture
+{
+	GLuint id = 0;
+	uint32_t width = 0;
+	uint32_t height = 0;
+	int32_t xoffset = 0;
+	int32_t yoffset = 0;
+};
+
+typedef std::list<std::pair<std::string, StringTexture>> StringTextureList;
+static StringTextureList stringTextures;                                                ///< Most recently used first.
+static std::unordered_map<std::string, StringTextureList::iterator> stringTextureIndex;  ///< Keyed on the font and the string.
+
+static const StringTexture &getStringTexture(const char *string, iV_fonts fontID)
+{
+	std::string key(1, (char)fontID);
+	key.append(string);
+	auto found = stringTextureIndex.find(key);
+	if (found != stringTextureIndex.end())
+	{
+		stringTextures.splice(stringTextures.begin(), stringTextures, found->second);
+		return found->second->second;
+	}
+
+	StringTexture entry;
+	if (stringTextures.size() >= STRING_TEXTURE_CACHE_SIZE)
+	{
+		// Reuse the texture of the least recently drawn string.
+		entry.id = stringTextures.back().second.id;
+		stringTextureIndex.erase(stringTextures.back().first);
+		stringTextures.pop_back();
+	}
+	else
+	{
+		glGenTextures(1, &entry.id);
+		glBindTexture(GL_TEXTURE_2D, entry.id);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+	}
+
+	TextRun tr(string, "en", HB_SCRIPT_COMMON, HB_DIRECTION_LTR);
+	std::unique_ptr<unsigned char[]> texture;
+	std::tie(texture, entry.width, entry.height, entry.xoffset, entry.yoffset) = getShaper().drawText(tr, getFTFace(fontID));
+	if (entry.width > 0 && entry.height > 0)
+	{
+		glBindTexture(GL_TEXTURE_2D, entry.id);
+		glBindBuffer(GL_PIXEL_UNPACK_BUFFER, pbo);
+		glBufferData(GL_PIXEL_UNPACK_BUFFER, 4 * entry.width * entry.height, texture.get(), GL_STREAM_DRAW);
+		glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, entry.width, entry.height, 0, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+		glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+	}
+
+	stringTextures.emplace_front(key, entry);
+	stringTextureIndex.emplace(std::move(key), stringTextures.begin());
+	return stringTextures.front().second;
+}
+
+static void clearStringTextures()
+{
+	for (const auto &entry : stringTextures)
+	{
+		glDeleteTextures(1, &entry.second.id);
+	}
+	stringTextures.clear();
+	stringTextureIndex.clear();
+}
+
 void iV_TextInit()
 {
-	pie_SetTexturePage(TEXPAGE_EXTERN);
-	glGenTextures(1, &textureID);
-	glBindTexture(GL_TEXTURE_2D, textureID);
-	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
-	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
-	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
-	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
-	glBindTexture(GL_TEXTURE_2D, 0);
 	glGenBuffers(1, &pbo);
 	regular = new FTFace(getGlobalFTlib().lib, "fonts/DejaVuSans.ttf", 12 * 64, DPI, DPI);
 	bold = new FTFace(getGlobalFTlib().lib, "fonts/DejaVuSans-Bold.ttf", 21 * 64, DPI, DPI);
@@ -453,6 +566,8 @@ void iV_TextInit()
 
 void iV_TextShutdown()
 {
+	clearStringTextures();
+	getShaper().clear();
 	delete regular;
 	delete medium;
 	delete bold;
@@ -465,7 +580,6 @@ void iV_TextShutdown()
 	small = nullptr;
 	smallBold = nullptr;
 	glDeleteBuffers(1, &pbo);
-	glDeleteTextures(1, &textureID);
 }
 
 unsigned int iV_GetTextWidth(const char *string, iV_fonts fontID)
@@ -682,21 +796,12 @@ void iV_DrawTextRotated(const char *string, float XPos, float YPos, float rotati
 	color.vector[2] = font_colour[2] * 255.f;
 	color.vector[3] = font_colour[3] * 255.f;
 
-	TextRun tr(string, "en", HB_SCRIPT_COMMON, HB_DIRECTION_LTR);
-	uint32_t width, height;
-	std::unique_ptr<unsigned char[]> texture;
-	int32_t xoffset, yoffset;
-	std::tie(texture, width, height, xoffset, yoffset) = getShaper().drawText(tr, getFTFace(fontID));
-	if (width > 0 && height > 0)
+	const StringTexture &texture = getStringTexture(string, fontID);
+	if (texture.width > 0 && texture.height > 0)
 	{
 		pie_SetTexturePage(TEXPAGE_EXTERN);
-		glBindTexture(GL_TEXTURE_2D, textureID);
-		glBindBuffer(GL_PIXEL_UNPACK_BUFFER, pbo);
-		glBufferData(GL_PIXEL_UNPACK_BUFFER, 4 * width * height, texture.get(), GL_STREAM_DRAW);
-		glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, width, height, 0, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
-		glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
 		glDisable(GL_CULL_FACE);
-		iV_DrawImageText(textureID, Vector2i(XPos, YPos), Vector2i(xoffset, yoffset), Vector2i(width, height), rotation, REND_TEXT, color);
+		iV_DrawImageText(texture.id, Vector2i(XPos, YPos), Vector2i(texture.xoffset, texture.yoffset), Vector2i(texture.width, texture.height), rotation, REND_TEXT, color);
 		glEnable(GL_CULL_FACE);
 	}
 }
@@ -149,6 +149,11 @@ void NETlogPacket(uint8_t type, uint32_t size, bool received)
 	packetsize[received][type] += size;
 }
 
+unsigned NETgetMessageStatistic(uint8_t type, bool sent)
+{
+	return packetsize[!sent][type];
+}
+
 bool NETlogEntry(const char *str, UDWORD a, UDWORD b)
 {
 	static const char star_line[] = "************************************************************\n";
@@ -43,6 +43,7 @@
 
 #include "netplay.h"
 #include "netlog.h"
+#include "netreplay.h"
 #include "netsocket.h"
 
 #include <miniupnpc/miniwget.h>
@@ -1890,6 +1891,31 @@ checkMessages:
 	return false;
 }
 
+/// Read replayed messages into the game queues, until there is one for the given player. Quits at the end of the replay.
+static bool NETreplayFeed(unsigned player)
+{
+	static NetMessage message;
+	uint8_t messagePlayer;
+
+	while (NETreplayLoadNetMessage(&message, &messagePlayer))
+	{
+		NETinsertMessageFromNet(NETgameQueue(messagePlayer), &message);
+		if (messagePlayer == player)
+		{
+			return true;
+		}
+	}
+
+	static bool quitting = false;
+	if (!quitting)
+	{
+		debug(LOG_INFO, "End of replay reached at gameTime %u", gameTime);
+		wzQuit();
+		quitting = true;
+	}
+	return false;
+}
+
 bool NETrecvGame(NETQUEUE *queue, uint8_t *type)
 {
 	for (unsigned current = 0; current < MAX_PLAYERS; ++current)
@@ -1897,12 +1923,13 @@ bool NETrecvGame(NETQUEUE *queue, uint8_t *type)
 		*queue = NETgameQueue(current);
 		while (!checkPlayerGameTime(current))  // Check for any messages that are scheduled to be read now.
 		{
-			if (!NETisMessageReady(*queue))
+			if (!NETisMessageReady(*queue) && !(NETisReplay() && NETreplayFeed(current)))
 			{
 				return false;  // Still waiting for messages from this player, and all players should process messages in the same order. Will have to freeze the game while waiting.
 			}
 
 			*type = NETgetMessage(*queue)->type;
+			NETreplaySaveNetMessage(NETgetMessage(*queue), current);
 
 			if (*type == GAME_GAME_TIME)
 			{
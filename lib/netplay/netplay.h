@@ -292,6 +292,7 @@ void NETdiscoverUPnPDevices();
 
 enum NetStatisticType {NetStatisticRawBytes, NetStatisticUncompressedBytes, NetStatisticPackets};
 unsigned NETgetStatistic(NetStatisticType type, bool sent, bool isTotal = false);     // Return some statistic. Call regularly for good results.
+unsigned NETgetMessageStatistic(uint8_t type, bool sent);                                 ///< Total bytes of messages of the given type, before compression.
 
 void NETplayerKicked(UDWORD index);			// Cleanup after player has been kicked
 
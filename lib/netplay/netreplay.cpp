@@ -0,0 +1,236 @@
+/*
+	This file is part of Warzone 2100.
+	Copyright (C) 2005-2017  Warzone 2100 Project
+
+	Warzone 2100 is free software; you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation; either version 2 of the License, or
+	(at your option) any later version.
+
+	Warzone 2100 is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with Warzone 2100; if not, write to the Free Software
+	Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301 USA
+*/
+/**
+ * @file netreplay.cpp
+ *
+ * Replays contain the game queue messages of a game, in the order in which they were processed,
+ * which is enough to run the same game again, since the game state only changes through them.
+ *
+ * File format: "WZREPLAY", version, settings and random seed, then for each message the player
+ * byte followed by the message as sent over the network, ending with a REPLAY_END player byte.
+ */
+
+#include "lib/framework/frame.h"
+#include "lib/framework/wzapp.h"
+#include "lib/gamelib/gtime.h"
+
+#include <physfs.h>
+
+#include "netreplay.h"
+#include "netqueue.h"
+
+#define REPLAY_MAGIC		"WZREPLAY"
+#define REPLAY_VERSION		1
+#define REPLAY_END			0xFF			///< Player byte ending the message list
+#define REPLAY_BUFFER_SIZE	(64 * 1024)		///< PhysFS buffer, so that messages are not written one at a time
+
+static PHYSFS_file *replaySaveHandle = nullptr;
+static PHYSFS_file *replayLoadHandle = nullptr;
+
+// Playback statistics
+static uint32_t replayLoadStartTime = 0;
+static uint32_t replayMessages = 0;
+static uint32_t replaySyncChecks = 0;
+static uint32_t replaySyncErrors = 0;
+static uint32_t replayLastCheckTime = 0;
+
+bool NETreplaySaveStart(const char *filename, const std::string &settings, uint32_t randomSeed)
+{
+	ASSERT_OR_RETURN(false, replaySaveHandle == nullptr, "Already recording a replay");
+
+	replaySaveHandle = PHYSFS_openWrite(filename);
+	if (replaySaveHandle == nullptr)
+	{
+		debug(LOG_ERROR, "Could not create replay %s: %s", filename, PHYSFS_getLastError());
+		return false;
+	}
+	PHYSFS_setBuffer(replaySaveHandle, REPLAY_BUFFER_SIZE);
+
+	if (PHYSFS_write(replaySaveHandle, REPLAY_MAGIC, 1, strlen(REPLAY_MAGIC)) != (PHYSFS_sint64)strlen(REPLAY_MAGIC)
+	    || !PHYSFS_writeUBE32(replaySaveHandle, REPLAY_VERSION)
+	    || !PHYSFS_writeUBE32(replaySaveHandle, settings.size())
+	    || PHYSFS_write(replaySaveHandle, settings.data(), 1, settings.size()) != (PHYSFS_sint64)settings.size()
+	    || !PHYSFS_writeUBE32(replaySaveHandle, randomSeed))
+	{
+		debug(LOG_ERROR, "Could not write replay %s: %s", filename, PHYSFS_getLastError());
+		PHYSFS_close(replaySaveHandle);
+		replaySaveHandle = nullptr;
+		return false;
+	}
+	debug(LOG_NET, "Recording replay %s", filename);
+	return true;
+}
+
+void NETreplaySaveNetMessage(const NetMessage *message, uint8_t player)
+{
+	if (replaySaveHandle == nullptr)
+	{
+		return;
+	}
+
+	uint8_t *data = message->rawDataDup();
+	size_t len = message->rawLen();
+	if (PHYSFS_write(replaySaveHandle, &player, 1, 1) != 1 || PHYSFS_write(replaySaveHandle, data, 1, len) != (PHYSFS_sint64)len)
+	{
+		debug(LOG_ERROR, "Could not write replay, stopping: %s", PHYSFS_getLastError());
+		PHYSFS_close(replaySaveHandle);
+		replaySaveHandle = nullptr;
+	}
+	delete[] data;
+}
+
+bool NETreplaySaveStop()
+{
+	if (replaySaveHandle == nullptr)
+	{
+		return false;
+	}
+
+	uint8_t end = REPLAY_END;
+	bool ok = PHYSFS_write(replaySaveHandle, &end, 1, 1) == 1;
+	ok = PHYSFS_close(replaySaveHandle) && ok;
+	replaySaveHandle = nullptr;
+	if (!ok)
+	{
+		debug(LOG_ERROR, "Could not finish replay: %s", PHYSFS_getLastError());
+	}
+	return ok;
+}
+
+bool NETreplayLoadStart(const char *filename, std::string *settings, uint32_t *randomSeed)
+{
+	char magic[sizeof(REPLAY_MAGIC) - 1];
+	uint32_t version = 0, settingsSize = 0;
+
+	ASSERT_OR_RETURN(false, replayLoadHandle == nullptr, "Already playing a replay");
+
+	replayLoadHandle = PHYSFS_openRead(filename);
+	if (replayLoadHandle == nullptr)
+	{
+		debug(LOG_ERROR, "Could not open replay %s: %s", filename, PHYSFS_getLastError());
+		return false;
+	}
+	PHYSFS_setBuffer(replayLoadHandle, REPLAY_BUFFER_SIZE);
+
+	if (PHYSFS_read(replayLoadHandle, magic, 1, sizeof(magic)) != (PHYSFS_sint64)sizeof(magic) || memcmp(magic, REPLAY_MAGIC, sizeof(magic)) != 0
+	    || !PHYSFS_readUBE32(replayLoadHandle, &version) || version != REPLAY_VERSION
+	    || !PHYSFS_readUBE32(replayLoadHandle, &settingsSize))
+	{
+		debug(LOG_ERROR, "%s is not a replay, or has an unsupported version (%u)", filename, version);
+		PHYSFS_close(replayLoadHandle);
+		replayLoadHandle = nullptr;
+		return false;
+	}
+	settings->resize(settingsSize);
+	if (PHYSFS_read(replayLoadHandle, &(*settings)[0], 1, settingsSize) != settingsSize
+	    || !PHYSFS_readUBE32(replayLoadHandle, randomSeed))
+	{
+		debug(LOG_ERROR, "Replay %s is truncated", filename);
+		PHYSFS_close(replayLoadHandle);
+		replayLoadHandle = nullptr;
+		return false;
+	}
+
+	replayLoadStartTime = wzGetTicks();
+	replayMessages = 0;
+	replaySyncChecks = 0;
+	replaySyncErrors = 0;
+	replayLastCheckTime = 0;
+	debug(LOG_NET, "Playing replay %s", filename);
+	return true;
+}
+
+bool NETreplayLoadNetMessage(NetMessage *message, uint8_t *player)
+{
+	uint8_t header[2];
+
+	if (replayLoadHandle == nullptr)
+	{
+		return false;
+	}
+
+	// Player and type
+	if (PHYSFS_read(replayLoadHandle, header, 1, 2) != 2 || header[0] == REPLAY_END)
+	{
+		return false;
+	}
+
+	// A uint32_t takes at most 5 bytes, anything longer is a corrupt replay
+	uint32_t len = 0;
+	bool moreBytes = true;
+	for (unsigned n = 0; moreBytes; ++n)
+	{
+		uint8_t b;
+		if (n >= 5)
+		{
+			debug(LOG_ERROR, "Bad message length in replay");
+			return false;
+		}
+		if (PHYSFS_read(replayLoadHandle, &b, 1, 1) != 1)
+		{
+			return false;
+		}
+		moreBytes = decode_uint32_t(b, len, n);
+	}
+
+	ASSERT_OR_RETURN(false, header[0] < MAX_PLAYERS, "Bad player %u in replay", header[0]);
+	*player = header[0];
+	message->type = header[1];
+	message->data.resize(len);
+	if (len > 0 && PHYSFS_read(replayLoadHandle, &message->data[0], 1, len) != len)
+	{
+		debug(LOG_ERROR, "Replay is truncated");
+		return false;
+	}
+	++replayMessages;
+	return true;
+}
+
+void NETreplaySyncChecked(uint32_t checkTime, bool ok)
+{
+	if (replayLoadHandle == nullptr)
+	{
+		return;
+	}
+
+	++replaySyncChecks;
+	replaySyncErrors += !ok;
+	replayLastCheckTime = MAX(replayLastCheckTime, checkTime);
+}
+
+void NETreplayLoadStop()
+{
+	if (replayLoadHandle == nullptr)
+	{
+		return;
+	}
+
+	PHYSFS_close(replayLoadHandle);
+	replayLoadHandle = nullptr;
+
+	const uint32_t wallTime = MAX(wzGetTicks() - replayLoadStartTime, 1u);
+	const uint32_t ticks = replayLastCheckTime / GAME_TICKS_PER_UPDATE;
+	debug(replaySyncErrors != 0 ? LOG_ERROR : LOG_INFO, "Replay: %u messages, %u game ticks in %u ms (%.1f ticks/s), %u of %u sync checks failed",
+	      replayMessages, ticks, wallTime, ticks * 1000.0 / wallTime, replaySyncErrors, replaySyncChecks);
+}
+
+bool NETisReplay()
+{
+	return replayLoadHandle != nullptr;
+}
@@ -0,0 +1,50 @@
+/*
+	This file is part of Warzone 2100.
+	Copyright (C) 2005-2017  Warzone 2100 Project
+
+	Warzone 2100 is free software; you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation; either version 2 of the License, or
+	(at your option) any later version.
+
+	Warzone 2100 is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with Warzone 2100; if not, write to the Free Software
+	Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301 USA
+*/
+/** @file
+ *  Recording and playback of the game queue messages of a game.
+ */
+
+#ifndef _netreplay_h
+#define _netreplay_h
+
+#include "lib/framework/frame.h"
+
+#include <string>
+
+class NetMessage;
+
+/// Start recording the game queue messages of a game; settings are whatever is needed to start the same game again.
+WZ_DECL_NONNULL(1) bool NETreplaySaveStart(const char *filename, const std::string &settings, uint32_t randomSeed);
+/// Record a game queue message, in the order in which the game processes them.
+WZ_DECL_NONNULL(1) void NETreplaySaveNetMessage(const NetMessage *message, uint8_t player);
+/// Finish the replay being recorded, if any.
+bool NETreplaySaveStop();
+
+/// Start playing back a replay, returning the settings and random seed it was recorded with.
+WZ_DECL_NONNULL(1, 2, 3) bool NETreplayLoadStart(const char *filename, std::string *settings, uint32_t *randomSeed);
+/// Read the next recorded game queue message. Returns false at the end of the replay.
+WZ_DECL_NONNULL(1, 2) bool NETreplayLoadNetMessage(NetMessage *message, uint8_t *player);
+/// Note the result of comparing a recorded game state CRC against ours.
+void NETreplaySyncChecked(uint32_t checkTime, bool ok);
+/// Stop playing back the replay, if any, and log how it went.
+void NETreplayLoadStop();
+/// Whether the game queues are being fed from a replay, instead of by the players.
+bool NETisReplay();
+
+#endif // _netreplay_h
@@ -177,6 +177,7 @@ void eventReset(void)
 void eventShutDown(void)
 {
 	eventReset();
+	interpResetProfile();
 
 	if (asCreateFuncs)
 	{
@@ -328,7 +329,7 @@ bool eventNewContext(SCRIPT_CODE *psCode, CONTEXT_RELEASE release,
 {
 	SCRIPT_CONTEXT	*psContext;
 	SDWORD		val, storeIndex, arrayNum, arraySize;
-	UDWORD		i, j;
+	UDWORD		i, j, numVals;
 	INTERP_TYPE	type;
 	VAL_CHUNK	*psNewChunk;
 
@@ -342,6 +343,7 @@ bool eventNewContext(SCRIPT_CODE *psCode, CONTEXT_RELEASE release,
 	psContext->triggerCount = 0;
 	psContext->release = release;
 	psContext->psGlobals = nullptr;
+	psContext->ppsGlobalVals = nullptr;
 	psContext->id = -1;		// only used by the save game
 	val = psCode->numGlobals + psCode->arraySize - 1;
 	arrayNum = psCode->numArrays - 1;
@@ -466,6 +468,20 @@ bool eventNewContext(SCRIPT_CODE *psCode, CONTEXT_RELEASE release,
 		psNewChunk->psNext = psContext->psGlobals;
 		psContext->psGlobals = psNewChunk;
 	}
+
+	// Remember where each value lives, so that the interpreter does not have to walk the chunks on every access
+	numVals = psCode->numGlobals + psCode->arraySize;
+	psContext->ppsGlobalVals = (INTERP_VAL **)malloc(sizeof(INTERP_VAL *) * MAX(numVals, 1));
+	psNewChunk = psContext->psGlobals;
+	for (i = 0; i < numVals; i++)
+	{
+		if (i > 0 && i % CONTEXT_VALS == 0)
+		{
+			psNewChunk = psNewChunk->psNext;
+		}
+		psContext->ppsGlobalVals[i] = psNewChunk->asVals + i % CONTEXT_VALS;
+	}
+
 	psContext->psNext = psContList;
 	psContList = psContext;
 
@@ -615,6 +631,8 @@ void eventRemoveContext(SCRIPT_CONTEXT *psContext)
 		free(psCChunk);
 	}
 	psContext->psGlobals = nullptr;
+	free(psContext->ppsGlobalVals);
+	psContext->ppsGlobalVals = nullptr;
 
 	// Remove it from the context list
 	if (psContext == psContList)
@@ -51,6 +51,7 @@ struct SCRIPT_CONTEXT
 {
 	SCRIPT_CODE		*psCode;		// The actual script to run
 	VAL_CHUNK		*psGlobals;		// The objects copy of the global variables
+	INTERP_VAL		**ppsGlobalVals;	// Where each global variable and array element lives in psGlobals
 	SDWORD			triggerCount;	// Number of currently active triggers
 	CONTEXT_RELEASE		release;		// Whether to release the context when there are no triggers
 	SWORD			id;
@@ -25,6 +25,11 @@
  */
 
 /* Control the execution trace printf's */
+#include <algorithm>
+#include <map>
+
+#include <QtCore/QElapsedTimer>
+
 #include "lib/framework/frame.h"
 #include "interpreter.h"
 #include "stack.h"
@@ -159,6 +164,13 @@ static bool	interpTrace = false;
 static SCRIPT_CODE *psCurProg = nullptr;
 static bool bCurCallerIsEvent = false;
 
+/* Performance data, by program and event/trigger index */
+static std::map<std::pair<SCRIPT_CODE *, SDWORD>, INTERP_PROFILE> interpProfile;
+static bool interpProfileOn = false;	// whether anything is being measured at all
+static QElapsedTimer interpProfileTimer;
+static qint64 interpProfileFuncStart[MAX_FUNC_CALLS];		// when each function on the call stack was called
+static SDWORD interpProfileFuncInstructions[MAX_FUNC_CALLS];	// instruction count when each function was called
+
 /* Print out trace info if tracing is turned on */
 #define TRCPRINTF(...) do { if (interpTrace) { fprintf( stderr, __VA_ARGS__ ); } } while (false)
 
@@ -182,6 +194,41 @@ static bool bCurCallerIsEvent = false;
 	if (interpTrace) \
 		cpPrintVarFunc(x, data)
 
+/* Count the instruction at InstrPointer and look up its decoded opcode and data */
+#define INTERP_FETCH() \
+	if (instructionCount > INTERP_MAXINSTRUCTIONS) \
+	{ \
+		debug(LOG_ERROR, "interpRunScript: max instruction count exceeded - infinite loop ?"); \
+		goto exit_with_error; \
+	} \
+	instructionCount++; \
+	TRCPRINTF("%-6d  ", (int)(InstrPointer - psProg->pCode)); \
+	psInstr = &psProg->psDecoded[InstrPointer - psProg->pCode]; \
+	opcode = psInstr->opcode; \
+	data = psInstr->data
+
+/* With GCC and clang, each instruction jumps straight to the code for the next one, using the handler stored when
+ * the program was decoded, rather than going back round the loop and through the switch */
+#if defined(__GNUC__)
+#define INTERP_THREADED
+#endif
+
+#ifdef INTERP_THREADED
+#define INTERP_CASE(op)		case op: handle_##op
+#define INTERP_DEFAULT		default: handle_default
+#define INTERP_NEXT() \
+	if (InstrPointer < pCodeEnd) \
+	{ \
+		INTERP_FETCH(); \
+		goto *psInstr->handler; \
+	} \
+	break
+#else
+#define INTERP_CASE(op)		case op
+#define INTERP_DEFAULT		default
+#define INTERP_NEXT()		break
+#endif
+
 
 // true if the interpreter is currently running
 bool interpProcessorActive(void)
@@ -190,22 +237,13 @@ bool interpProcessorActive(void)
 }
 
 /* Find the value store for a global variable */
-static inline INTERP_VAL *interpGetVarData(VAL_CHUNK *psGlobals, UDWORD index)
+static inline INTERP_VAL *interpGetVarData(SCRIPT_CONTEXT *psContext, UDWORD index)
 {
-	VAL_CHUNK	*psChunk;
-
-	psChunk = psGlobals;
-	while (index >= CONTEXT_VALS)
-	{
-		index -= CONTEXT_VALS;
-		psChunk = psChunk->psNext;
-	}
-
-	return psChunk->asVals + index;
+	return psContext->ppsGlobalVals[index];
 }
 
 // get the array data for an array operation
-static bool interpGetArrayVarData(INTERP_VAL **pip, VAL_CHUNK *psGlobals, SCRIPT_CODE *psProg, INTERP_VAL **ppsVal)
+static bool interpGetArrayVarData(INTERP_VAL **pip, SCRIPT_CONTEXT *psContext, SCRIPT_CODE *psProg, INTERP_VAL **ppsVal)
 {
 	SDWORD		i, dimensions, vals[VAR_MAX_DIMENSIONS];
 	UBYTE		*elements;
@@ -261,7 +299,7 @@ static bool interpGetArrayVarData(INTERP_VAL **pip, VAL_CHUNK *psGlobals, SCRIPT
 	ASSERT_OR_RETURN(false, index <= psProg->arraySize, "Array indexes out of variable space (%d)", index);
 
 	// get the variable data
-	*ppsVal = interpGetVarData(psGlobals, psProg->psArrayInfo[base].base + index);
+	*ppsVal = interpGetVarData(psContext, psProg->psArrayInfo[base].base + index);
 
 	// update the instruction pointer
 	*pip += 1;
@@ -270,6 +308,61 @@ static bool interpGetArrayVarData(INTERP_VAL **pip, VAL_CHUNK *psGlobals, SCRIPT
 }
 
 
+// Record the time taken by a single run of an event, function or trigger
+static void interpProfileAdd(SCRIPT_CODE *psProg, INTERP_RUNTYPE runType, UDWORD index, qint64 nsecs, SDWORD instructions)
+{
+	// Events and functions share the same table, triggers get negative numbers
+	const SDWORD key = runType == IRT_TRIGGER ? -1 - (SDWORD)index : (SDWORD)index;
+	INTERP_PROFILE &profile = interpProfile[std::make_pair(psProg, key)];
+
+	if (profile.calls == 0)
+	{
+		// Names are only available when script debugging is enabled
+		profile.name = runType == IRT_TRIGGER ? eventGetTriggerID(psProg, index) : eventGetEventID(psProg, index);
+		if (profile.name == "N/A")
+		{
+			profile.name = (runType == IRT_TRIGGER ? "trigger " : "event ") + std::to_string(index);
+		}
+		profile.trigger = runType == IRT_TRIGGER;
+	}
+	profile.calls++;
+	profile.time += nsecs;
+	profile.worst = std::max<uint64_t>(profile.worst, nsecs);
+	profile.instructions += instructions;
+}
+
+std::vector<INTERP_PROFILE> interpGetProfile()
+{
+	std::vector<INTERP_PROFILE> result;
+
+	for (const auto &entry : interpProfile)
+	{
+		result.push_back(entry.second);
+	}
+	std::sort(result.begin(), result.end(), [](const INTERP_PROFILE &a, const INTERP_PROFILE &b) { return a.time > b.time; });
+	return result;
+}
+
+void interpResetProfile()
+{
+	interpProfile.clear();
+}
+
+void interpSetProfiling(bool enable)
+{
+	if (enable && !interpProfileOn)
+	{
+		interpResetProfile();
+		interpProfileTimer.start();
+	}
+	interpProfileOn = enable;
+}
+
+bool interpProfiling()
+{
+	return interpProfileOn;
+}
+
 // Initialise the interpreter
 bool interpInitialise(void)
 {
@@ -278,18 +371,94 @@ bool interpInitialise(void)
 	return true;
 }
 
+/* Decode every instruction of a program, so running it only has to look the decoded instruction up. Checks that
+ * only depend on the compiled code are done here once, instead of each time the instruction is run. */
+static void interpDecodeProgram(SCRIPT_CODE *psProg, const void *const *handlers, const void *unknownHandler)
+{
+	const UDWORD length = psProg->size / sizeof(INTERP_VAL);
+	INTERP_DECODED *psDecoded = (INTERP_DECODED *)malloc(sizeof(INTERP_DECODED) * MAX(length, 1u));
+	UDWORD i, size;
+
+	// Anything that isn't the start of an instruction is an error to run
+	for (i = 0; i < length; i++)
+	{
+		psDecoded[i].opcode = (OPCODE)(psProg->pCode[i].v.ival >> OPCODE_SHIFT);
+		psDecoded[i].data = psProg->pCode[i].v.ival & OPCODE_DATAMASK;
+		psDecoded[i].handler = unknownHandler;
+	}
+
+	for (i = 0; i < length; i += size)
+	{
+		const INTERP_VAL *psVal = &psProg->pCode[i];
+		const OPCODE opcode = psDecoded[i].opcode;
+
+		if ((unsigned)opcode > OP_TO_INT || aOpSize[opcode] <= 0 || i + aOpSize[opcode] > length)
+		{
+			// Left for the interpreter to complain about, if it ever gets here
+			size = 1;
+			continue;
+		}
+		size = aOpSize[opcode];
+		if (handlers != nullptr)
+		{
+			psDecoded[i].handler = handlers[opcode];
+		}
+
+		switch (opcode)
+		{
+		case OP_POP:
+		case OP_CALL:
+		case OP_EXIT:
+		case OP_TO_FLOAT:
+		case OP_TO_INT:
+			ASSERT(psVal->type == VAL_OPCODE, "wrong value type passed for %s: %d", scriptOpcodeToString(opcode), psVal->type);
+			break;
+		case OP_BINARYOP:
+		case OP_UNARYOP:
+		case OP_PUSHGLOBAL:
+		case OP_POPGLOBAL:
+		case OP_PUSHARRAYGLOBAL:
+		case OP_POPARRAYGLOBAL:
+		case OP_JUMPFALSE:
+		case OP_JUMP:
+		case OP_PAUSE:
+			ASSERT(psVal->type == VAL_PKOPCODE, "wrong value type passed for %s: %d", scriptOpcodeToString(opcode), psVal->type);
+			break;
+		case OP_VARCALL:
+			ASSERT(psVal->type == VAL_PKOPCODE, "wrong value type passed for OP_VARCALL: %d", psVal->type);
+			ASSERT(psVal[1].type == VAL_OBJ_GETSET, "wrong set/get function pointer type passed for OP_VARCALL: %d", psVal[1].type);
+			break;
+		case OP_PUSH:
+			ASSERT(interpCheckEquiv(psVal[1].type, (INTERP_TYPE)psDecoded[i].data),
+			       "wrong value type passed for OP_PUSH: %d, expected: %d", psVal[1].type, psDecoded[i].data);
+			break;
+		case OP_PUSHLOCALREF:
+			ASSERT(psVal[1].type == VAL_INT, "wrong value type passed for OP_PUSHLOCALREF: %d", psVal[1].type);
+			break;
+		case OP_FUNC:
+			ASSERT(psVal[1].type == VAL_EVENT, "wrong value type passed for OP_FUNC: %d", psVal[1].type);
+			break;
+		default:
+			break;
+		}
+	}
+
+	psProg->psDecoded = psDecoded;
+}
+
 /* Run a compiled script */
 bool interpRunScript(SCRIPT_CONTEXT *psContext, INTERP_RUNTYPE runType, UDWORD index, UDWORD offset)
 {
 	UDWORD			data;
 	OPCODE			opcode;
 	INTERP_VAL		sVal, *psVar, *InstrPointer;
-	VAL_CHUNK		*psGlobals;
+	INTERP_VAL		*psLocals = nullptr;	// local variables of the current event/function
 	UDWORD			numGlobals = 0;
 	INTERP_VAL		*pCodeStart, *pCodeEnd, *pCodeBase;
 	SCRIPT_FUNC		scriptFunc = nullptr;
 	SCRIPT_VARFUNC	scriptVarFunc = nullptr;
 	SCRIPT_CODE		*psProg;
+	const INTERP_DECODED *psInstr;
 	SDWORD			instructionCount = 0;
 
 	UDWORD			CurEvent = 0;
@@ -299,6 +468,8 @@ bool interpRunScript(SCRIPT_CONTEXT *psContext, INTERP_RUNTYPE runType, UDWORD i
 
 	ASSERT(psContext != nullptr, "Invalid context pointer");
 
+	const qint64 startTime = interpProfileOn ? interpProfileTimer.nsecsElapsed() : 0;
+
 	psProg = psContext->psCode;
 	psCurProg = psProg;		//remember for future use
 
@@ -314,6 +485,39 @@ bool interpRunScript(SCRIPT_CONTEXT *psContext, INTERP_RUNTYPE runType, UDWORD i
 	// note that the interpreter is running to stop recursive script calls
 	bInterpRunning = true;
 
+	if (psProg->psDecoded == nullptr)
+	{
+#ifdef INTERP_THREADED
+		const void *handlers[OP_TO_INT + 1];
+
+		std::fill(handlers, handlers + OP_TO_INT + 1, &&handle_default);
+		handlers[OP_PUSH] = &&handle_OP_PUSH;
+		handlers[OP_PUSHREF] = &&handle_OP_PUSHREF;
+		handlers[OP_POP] = &&handle_OP_POP;
+		handlers[OP_PUSHGLOBAL] = &&handle_OP_PUSHGLOBAL;
+		handlers[OP_POPGLOBAL] = &&handle_OP_POPGLOBAL;
+		handlers[OP_PUSHARRAYGLOBAL] = &&handle_OP_PUSHARRAYGLOBAL;
+		handlers[OP_POPARRAYGLOBAL] = &&handle_OP_POPARRAYGLOBAL;
+		handlers[OP_CALL] = &&handle_OP_CALL;
+		handlers[OP_VARCALL] = &&handle_OP_VARCALL;
+		handlers[OP_JUMP] = &&handle_OP_JUMP;
+		handlers[OP_JUMPFALSE] = &&handle_OP_JUMPFALSE;
+		handlers[OP_BINARYOP] = &&handle_OP_BINARYOP;
+		handlers[OP_UNARYOP] = &&handle_OP_UNARYOP;
+		handlers[OP_EXIT] = &&handle_OP_EXIT;
+		handlers[OP_PAUSE] = &&handle_OP_PAUSE;
+		handlers[OP_FUNC] = &&handle_OP_FUNC;
+		handlers[OP_POPLOCAL] = &&handle_OP_POPLOCAL;
+		handlers[OP_PUSHLOCAL] = &&handle_OP_PUSHLOCAL;
+		handlers[OP_PUSHLOCALREF] = &&handle_OP_PUSHLOCALREF;
+		handlers[OP_TO_FLOAT] = &&handle_OP_TO_FLOAT;
+		handlers[OP_TO_INT] = &&handle_OP_TO_INT;
+		interpDecodeProgram(psProg, handlers, &&handle_default);
+#else
+		interpDecodeProgram(psProg, nullptr, nullptr);
+#endif
+	}
+
 	// Reset the stack in case another script messed up
 	stackReset();
 
@@ -325,7 +529,7 @@ bool interpRunScript(SCRIPT_CONTEXT *psContext, INTERP_RUNTYPE runType, UDWORD i
 
 	/* Get the global variables */
 	numGlobals = psProg->numGlobals;
-	psGlobals = psContext->psGlobals;
+	ASSERT(psContext->ppsGlobalVals != nullptr || numGlobals + psProg->arraySize == 0, "Context has no variables");
 
 	bEvent = false;
 
@@ -398,6 +602,7 @@ bool interpRunScript(SCRIPT_CONTEXT *psContext, INTERP_RUNTYPE runType, UDWORD i
 	if (bEvent)
 	{
 		createVarEnvironment(psContext, CurEvent);
+		psLocals = varEnvironment[retStackCallDepth()];
 	}
 
 	while (!bStop)
@@ -405,20 +610,14 @@ bool interpRunScript(SCRIPT_CONTEXT *psContext, INTERP_RUNTYPE runType, UDWORD i
 		// Run the code
 		if (InstrPointer < pCodeEnd)// && opcode != OP_EXIT)
 		{
-			if (instructionCount > INTERP_MAXINSTRUCTIONS)
-			{
-				debug(LOG_ERROR, "interpRunScript: max instruction count exceeded - infinite loop ?");
-				goto exit_with_error;
-			}
-			instructionCount++;
-
-			TRCPRINTF("%-6d  ", (int)(InstrPointer - psProg->pCode));
-			opcode = (OPCODE)(InstrPointer->v.ival >> OPCODE_SHIFT);			//get opcode
-			data = (SDWORD)(InstrPointer->v.ival & OPCODE_DATAMASK);		//get data - only used with packed opcodes
+			INTERP_FETCH();
+#ifdef INTERP_THREADED
+			goto *psInstr->handler;
+#endif
 			switch (opcode)
 			{
 			/* Custom function call */
-			case OP_FUNC:
+			INTERP_CASE(OP_FUNC):
 				//debug( LOG_SCRIPT, "-OP_FUNC" );
 				//debug( LOG_SCRIPT, "OP_FUNC: remember event %d, ip=%d", CurEvent, (ip + 2) );
 
@@ -428,8 +627,6 @@ bool interpRunScript(SCRIPT_CONTEXT *psContext, INTERP_RUNTYPE runType, UDWORD i
 					return false;
 				}
 
-				ASSERT(((INTERP_VAL *)(InstrPointer + 1))->type == VAL_EVENT, "wrong value type passed for OP_FUNC: %d", ((INTERP_VAL *)(InstrPointer + 1))->type);
-
 				// get index of the new event
 				CurEvent = ((INTERP_VAL *)(InstrPointer + 1))->v.ival; //Current event = event to jump to
 
@@ -441,6 +638,12 @@ bool interpRunScript(SCRIPT_CONTEXT *psContext, INTERP_RUNTYPE runType, UDWORD i
 
 				// create new variable environment for this call
 				createVarEnvironment(psContext, CurEvent);
+				psLocals = varEnvironment[retStackCallDepth()];
+				if (interpProfileOn)
+				{
+					interpProfileFuncStart[retStackCallDepth()] = interpProfileTimer.nsecsElapsed();
+					interpProfileFuncInstructions[retStackCallDepth()] = instructionCount;
+				}
 
 				//Set new code execution boundaries
 				//----------------------------------
@@ -461,10 +664,10 @@ bool interpRunScript(SCRIPT_CONTEXT *psContext, INTERP_RUNTYPE runType, UDWORD i
 				//debug( LOG_SCRIPT, "-OP_FUNC: jumped to event %d; ip=%d, numLocalVars: %d", CurEvent, ip, psContext->psCode->numLocalVars[CurEvent] );
 				//debug( LOG_SCRIPT, "-END OP_FUNC" );
 
-				break;
+				INTERP_NEXT();
 
 			//handle local variables
-			case OP_PUSHLOCAL:
+			INTERP_CASE(OP_PUSHLOCAL):
 
 				//debug( LOG_SCRIPT, "OP_PUSHLOCAL");
 				//debug( LOG_SCRIPT, "OP_PUSHLOCAL, (CurEvent=%d, data =%d) num loc vars: %d; pushing: %d", CurEvent, data, psContext->psCode->numLocalVars[CurEvent], psContext->psCode->ppsLocalVarVal[CurEvent][data].v.ival);
@@ -477,15 +680,15 @@ bool interpRunScript(SCRIPT_CONTEXT *psContext, INTERP_RUNTYPE runType, UDWORD i
 
 				//debug(LOG_SCRIPT, "OP_PUSHLOCAL type: %d", psContext->psCode->ppsLocalVarVal[CurEvent][data].type);
 
-				if (!stackPush(&(varEnvironment[retStackCallDepth()][data])))
+				if (!stackPush(&psLocals[data]))
 				{
 					debug(LOG_ERROR, "interpRunScript: OP_PUSHLOCAL: push failed");
 					goto exit_with_error;
 				}
 
 				InstrPointer += aOpSize[opcode];
-				break;
-			case OP_POPLOCAL:
+				INTERP_NEXT();
+			INTERP_CASE(OP_POPLOCAL):
 
 				//debug( LOG_SCRIPT, "OP_POPLOCAL, event index: '%d', data: '%d'", CurEvent, data);
 				//debug( LOG_SCRIPT, "OP_POPLOCAL, numLocalVars: '%d'", psContext->psCode->numLocalVars[CurEvent]);
@@ -498,7 +701,7 @@ bool interpRunScript(SCRIPT_CONTEXT *psContext, INTERP_RUNTYPE runType, UDWORD i
 
 				//DbgMsg("OP_POPLOCAL type: %d, CurEvent=%d, data=%d", psContext->psCode->ppsLocalVarVal[CurEvent][data].type, CurEvent, data);
 
-				if (!stackPopType(&(varEnvironment[retStackCallDepth()][data])))
+				if (!stackPopType(&psLocals[data]))
 				{
 					debug(LOG_ERROR, "interpRunScript: OP_POPLOCAL: pop failed");
 					goto exit_with_error;
@@ -508,15 +711,12 @@ bool interpRunScript(SCRIPT_CONTEXT *psContext, INTERP_RUNTYPE runType, UDWORD i
 
 				InstrPointer += aOpSize[opcode];
 
-				break;
+				INTERP_NEXT();
 
-			case OP_PUSHLOCALREF:
+			INTERP_CASE(OP_PUSHLOCALREF):
 
 				// The type of the variable is stored in with the opcode
-				sVal.type = (INTERP_TYPE)(InstrPointer->v.ival & OPCODE_DATAMASK);
-
-				ASSERT(((INTERP_VAL *)(InstrPointer + 1))->type == VAL_INT,
-				       "wrong value type passed for OP_PUSHLOCALREF: %d", ((INTERP_VAL *)(InstrPointer + 1))->type);
+				sVal.type = (INTERP_TYPE)data;
 
 				/* get local var index */
 				data = ((INTERP_VAL *)(InstrPointer + 1))->v.ival;
@@ -528,7 +728,7 @@ bool interpRunScript(SCRIPT_CONTEXT *psContext, INTERP_RUNTYPE runType, UDWORD i
 				}
 
 				/* get local variable */
-				sVal.v.oval = &(varEnvironment[retStackCallDepth()][data]);
+				sVal.v.oval = &psLocals[data];
 
 				TRCPRINTOPCODE(opcode);
 				TRCPRINTVAL(sVal);
@@ -540,18 +740,9 @@ bool interpRunScript(SCRIPT_CONTEXT *psContext, INTERP_RUNTYPE runType, UDWORD i
 					goto exit_with_error;
 				}
 				InstrPointer += aOpSize[opcode];
-				break;
-
-			case OP_PUSH:
-				// The type of the value is stored in with the opcode
-				sVal.type = (INTERP_TYPE)(InstrPointer->v.ival & OPCODE_DATAMASK);
-
-				//ASSERT( ((INTERP_VAL *)(InstrPointer + 1))->type  == sVal.type,
-				//	"wrong value type passed for OP_PUSH: %d, expected: %d", ((INTERP_VAL *)(InstrPointer + 1))->type, sVal.type );
-
-				ASSERT(interpCheckEquiv(((INTERP_VAL *)(InstrPointer + 1))->type, sVal.type),
-				       "wrong value type passed for OP_PUSH: %d, expected: %d", ((INTERP_VAL *)(InstrPointer + 1))->type, sVal.type);
+				INTERP_NEXT();
 
+			INTERP_CASE(OP_PUSH):
 				/* copy value */
 				memcpy(&sVal, (INTERP_VAL *)(InstrPointer + 1), sizeof(INTERP_VAL));
 
@@ -565,13 +756,13 @@ bool interpRunScript(SCRIPT_CONTEXT *psContext, INTERP_RUNTYPE runType, UDWORD i
 					goto exit_with_error;
 				}
 				InstrPointer += aOpSize[opcode];
-				break;
-			case OP_PUSHREF:
+				INTERP_NEXT();
+			INTERP_CASE(OP_PUSHREF):
 				// The type of the variable is stored in with the opcode
-				sVal.type = (INTERP_TYPE)(InstrPointer->v.ival & OPCODE_DATAMASK);
+				sVal.type = (INTERP_TYPE)data;
 
 				// store pointer to INTERP_VAL
-				sVal.v.oval = interpGetVarData(psGlobals, ((INTERP_VAL *)(InstrPointer + 1))->v.ival);
+				sVal.v.oval = interpGetVarData(psContext, ((INTERP_VAL *)(InstrPointer + 1))->v.ival);
 
 				TRCPRINTOPCODE(opcode);
 				TRCPRINTVAL(sVal);
@@ -583,10 +774,8 @@ bool interpRunScript(SCRIPT_CONTEXT *psContext, INTERP_RUNTYPE runType, UDWORD i
 					goto exit_with_error;
 				}
 				InstrPointer += aOpSize[opcode];
-				break;
-			case OP_POP:
-				ASSERT(InstrPointer->type == VAL_OPCODE,
-				       "wrong value type passed for OP_POP: %d", InstrPointer->type);
+				INTERP_NEXT();
+			INTERP_CASE(OP_POP):
 
 				TRCPRINTOPCODE(opcode);
 				if (!stackPop(&sVal))
@@ -595,10 +784,8 @@ bool interpRunScript(SCRIPT_CONTEXT *psContext, INTERP_RUNTYPE runType, UDWORD i
 					goto exit_with_error;
 				}
 				InstrPointer += aOpSize[opcode];
-				break;
-			case OP_BINARYOP:
-				ASSERT(InstrPointer->type == VAL_PKOPCODE,
-				       "wrong value type passed for OP_BINARYOP: %d", InstrPointer->type);
+				INTERP_NEXT();
+			INTERP_CASE(OP_BINARYOP):
 
 				TRCPRINTOPCODE(data);
 				if (!stackBinaryOp((OPCODE)data))
@@ -609,10 +796,8 @@ bool interpRunScript(SCRIPT_CONTEXT *psContext, INTERP_RUNTYPE runType, UDWORD i
 				TRCPRINTSTACKTOP();
 				TRCPRINTF("\n");
 				InstrPointer += aOpSize[opcode];
-				break;
-			case OP_UNARYOP:
-				ASSERT(InstrPointer->type == VAL_PKOPCODE,
-				       "wrong value type passed for OP_UNARYOP: %d", InstrPointer->type);
+				INTERP_NEXT();
+			INTERP_CASE(OP_UNARYOP):
 
 				TRCPRINTOPCODE(data);
 				if (!stackUnaryOp((OPCODE)data))
@@ -623,11 +808,9 @@ bool interpRunScript(SCRIPT_CONTEXT *psContext, INTERP_RUNTYPE runType, UDWORD i
 				TRCPRINTSTACKTOP();
 				TRCPRINTF("\n");
 				InstrPointer += aOpSize[opcode];
-				break;
-			case OP_PUSHGLOBAL:
+				INTERP_NEXT();
+			INTERP_CASE(OP_PUSHGLOBAL):
 
-				ASSERT(InstrPointer->type == VAL_PKOPCODE,
-				       "wrong value type passed for OP_PUSHGLOBAL: %d", InstrPointer->type);
 
 				TRCPRINTF("PUSHGLOBAL  %d\n", data);
 				if (data >= numGlobals)
@@ -635,16 +818,14 @@ bool interpRunScript(SCRIPT_CONTEXT *psContext, INTERP_RUNTYPE runType, UDWORD i
 					debug(LOG_ERROR, "interpRunScript: variable index out of range");
 					goto exit_with_error;
 				}
-				if (!stackPush(interpGetVarData(psGlobals, data)))
+				if (!stackPush(interpGetVarData(psContext, data)))
 				{
 					debug(LOG_ERROR, "interpRunScript: could not do stack push");
 					goto exit_with_error;
 				}
 				InstrPointer += aOpSize[opcode];
-				break;
-			case OP_POPGLOBAL:
-				ASSERT(InstrPointer->type == VAL_PKOPCODE,
-				       "wrong value type passed for OP_POPGLOBAL: %d", InstrPointer->type);
+				INTERP_NEXT();
+			INTERP_CASE(OP_POPGLOBAL):
 
 				TRCPRINTF("POPGLOBAL   %d ", data);
 				TRCPRINTSTACKTOP();
@@ -654,19 +835,17 @@ bool interpRunScript(SCRIPT_CONTEXT *psContext, INTERP_RUNTYPE runType, UDWORD i
 					debug(LOG_ERROR, "interpRunScript: variable index out of range");
 					goto exit_with_error;
 				}
-				if (!stackPopType(interpGetVarData(psGlobals, data)))
+				if (!stackPopType(interpGetVarData(psContext, data)))
 				{
 					debug(LOG_ERROR, "interpRunScript: could not do stack pop");
 					goto exit_with_error;
 				}
 				InstrPointer += aOpSize[opcode];
-				break;
-			case OP_PUSHARRAYGLOBAL:
-				ASSERT(InstrPointer->type == VAL_PKOPCODE,
-				       "wrong value type passed for OP_PUSHARRAYGLOBAL: %d", InstrPointer->type);
+				INTERP_NEXT();
+			INTERP_CASE(OP_PUSHARRAYGLOBAL):
 
 				TRCPRINTOPCODE(opcode);
-				if (!interpGetArrayVarData(&InstrPointer, psGlobals, psProg, &psVar))
+				if (!interpGetArrayVarData(&InstrPointer, psContext, psProg, &psVar))
 				{
 					debug(LOG_ERROR, "interpRunScript: could not get array var data, CurEvent=%d", CurEvent);
 					goto exit_with_error;
@@ -677,13 +856,11 @@ bool interpRunScript(SCRIPT_CONTEXT *psContext, INTERP_RUNTYPE runType, UDWORD i
 					debug(LOG_ERROR, "interpRunScript: could not do stack push");
 					goto exit_with_error;
 				}
-				break;
-			case OP_POPARRAYGLOBAL:
-				ASSERT(InstrPointer->type == VAL_PKOPCODE,
-				       "wrong value type passed for OP_POPARRAYGLOBAL: %d", InstrPointer->type);
+				INTERP_NEXT();
+			INTERP_CASE(OP_POPARRAYGLOBAL):
 
 				TRCPRINTOPCODE(opcode);
-				if (!interpGetArrayVarData(&InstrPointer, psGlobals, psProg, &psVar))
+				if (!interpGetArrayVarData(&InstrPointer, psContext, psProg, &psVar))
 				{
 					debug(LOG_ERROR, "interpRunScript: could not get array var data");
 					goto exit_with_error;
@@ -695,11 +872,9 @@ bool interpRunScript(SCRIPT_CONTEXT *psContext, INTERP_RUNTYPE runType, UDWORD i
 					debug(LOG_ERROR, "interpRunScript: could not do pop stack of type");
 					goto exit_with_error;
 				}
-				break;
+				INTERP_NEXT();
 
-			case OP_JUMPFALSE:
-				ASSERT(InstrPointer->type == VAL_PKOPCODE,
-				       "wrong value type passed for OP_JUMPFALSE: %d", InstrPointer->type);
+			INTERP_CASE(OP_JUMPFALSE):
 
 				TRCPRINTF("JUMPFALSE   %d (%d)",
 				          (SWORD)data, (int)(InstrPointer - psProg->pCode + (SWORD)data));
@@ -725,10 +900,8 @@ bool interpRunScript(SCRIPT_CONTEXT *psContext, INTERP_RUNTYPE runType, UDWORD i
 					TRCPRINTF("\n");
 					InstrPointer += aOpSize[opcode];
 				}
-				break;
-			case OP_JUMP:
-				ASSERT(InstrPointer->type == VAL_PKOPCODE,
-				       "wrong value type passed for OP_JUMP: %d", InstrPointer->type);
+				INTERP_NEXT();
+			INTERP_CASE(OP_JUMP):
 
 				TRCPRINTF("JUMP        %d (%d)\n",
 				          (SWORD)data, (int)(InstrPointer - psProg->pCode + (SWORD)data));
@@ -739,12 +912,10 @@ bool interpRunScript(SCRIPT_CONTEXT *psContext, INTERP_RUNTYPE runType, UDWORD i
 					debug(LOG_ERROR, "interpRunScript: jump out of range");
 					goto exit_with_error;
 				}
-				break;
-			case OP_CALL:
+				INTERP_NEXT();
+			INTERP_CASE(OP_CALL):
 				//debug(LOG_SCRIPT, "OP_CALL");
 
-				ASSERT(InstrPointer->type == VAL_OPCODE,
-				       "wrong value type passed for OP_CALL: %d", InstrPointer->type);
 
 				scriptFunc = ((INTERP_VAL *)(InstrPointer + 1))->v.pFuncExtern;
 				TRCPRINTFUNC(scriptFunc);
@@ -758,18 +929,13 @@ bool interpRunScript(SCRIPT_CONTEXT *psContext, INTERP_RUNTYPE runType, UDWORD i
 				//debug(LOG_SCRIPT, "OP_CALL 2");
 				InstrPointer += aOpSize[opcode];
 				//debug(LOG_SCRIPT, "OP_CALL 3");
-				break;
-			case OP_VARCALL:
-				ASSERT(InstrPointer->type == VAL_PKOPCODE,
-				       "wrong value type passed for OP_VARCALL: %d", InstrPointer->type);
+				INTERP_NEXT();
+			INTERP_CASE(OP_VARCALL):
 
 				TRCPRINTOPCODE(opcode);
 				TRCPRINTVARFUNC(((INTERP_VAL *)(InstrPointer + 1))->v.pObjGetSet, data);
 				TRCPRINTF("(%d)\n", data);
 
-				ASSERT(((INTERP_VAL *)(InstrPointer + 1))->type == VAL_OBJ_GETSET,
-				       "wrong set/get function pointer type passed for OP_VARCALL: %d", ((INTERP_VAL *)(InstrPointer + 1))->type);
-
 				scriptVarFunc = ((INTERP_VAL *)(InstrPointer + 1))->v.pObjGetSet;
 				if (!scriptVarFunc(data))
 				{
@@ -777,17 +943,13 @@ bool interpRunScript(SCRIPT_CONTEXT *psContext, INTERP_RUNTYPE runType, UDWORD i
 					goto exit_with_error;
 				}
 				InstrPointer += aOpSize[opcode];
-				break;
-			case OP_EXIT:	/* end of function/event, "exit" or "return" statements */
-				ASSERT(InstrPointer->type == VAL_OPCODE,
-				       "wrong value type passed for OP_EXIT: %d", InstrPointer->type);
+				INTERP_NEXT();
+			INTERP_CASE(OP_EXIT):	/* end of function/event, "exit" or "return" statements */
 
 				// jump out of the code
 				InstrPointer = pCodeEnd;
-				break;
-			case OP_PAUSE:
-				ASSERT(InstrPointer->type == VAL_PKOPCODE,
-				       "wrong value type passed for OP_PAUSE: %d", InstrPointer->type);
+				INTERP_NEXT();
+			INTERP_CASE(OP_PAUSE):
 
 				TRCPRINTF("PAUSE       %d\n", data);
 				ASSERT(stackEmpty(),
@@ -802,10 +964,8 @@ bool interpRunScript(SCRIPT_CONTEXT *psContext, INTERP_RUNTYPE runType, UDWORD i
 				}
 				// now jump out of the event
 				InstrPointer = pCodeEnd;
-				break;
-			case OP_TO_FLOAT:
-				ASSERT(InstrPointer->type == VAL_OPCODE,
-				       "wrong value type passed for OP_TO_FLOAT: %d", InstrPointer->type);
+				INTERP_NEXT();
+			INTERP_CASE(OP_TO_FLOAT):
 
 				if (!stackCastTop(VAL_FLOAT))
 				{
@@ -813,10 +973,8 @@ bool interpRunScript(SCRIPT_CONTEXT *psContext, INTERP_RUNTYPE runType, UDWORD i
 					goto exit_with_error;
 				}
 				InstrPointer += aOpSize[opcode];
-				break;
-			case OP_TO_INT:
-				ASSERT(InstrPointer->type == VAL_OPCODE,
-				       "wrong value type passed for OP_TO_INT: %d", InstrPointer->type);
+				INTERP_NEXT();
+			INTERP_CASE(OP_TO_INT):
 
 				if (!stackCastTop(VAL_INT))
 				{
@@ -824,8 +982,8 @@ bool interpRunScript(SCRIPT_CONTEXT *psContext, INTERP_RUNTYPE runType, UDWORD i
 					goto exit_with_error;
 				}
 				InstrPointer += aOpSize[opcode];
-				break;
-			default:
+				INTERP_NEXT();
+			INTERP_DEFAULT:
 				debug(LOG_ERROR, "interpRunScript: unknown opcode: %d, type: %d", opcode, InstrPointer->type);
 				goto exit_with_error;
 				break;
@@ -837,6 +995,13 @@ bool interpRunScript(SCRIPT_CONTEXT *psContext, INTERP_RUNTYPE runType, UDWORD i
 
 			if (!retStackIsEmpty())		//There was a caller function before this one
 			{
+				if (interpProfileOn)
+				{
+					interpProfileAdd(psProg, IRT_EVENT, CurEvent,
+					                 interpProfileTimer.nsecsElapsed() - interpProfileFuncStart[retStackCallDepth()],
+					                 instructionCount - interpProfileFuncInstructions[retStackCallDepth()]);
+				}
+
 				// destroy current variable environment
 				destroyVarEnvironment(psContext, retStackCallDepth(), CurEvent);
 
@@ -846,6 +1011,7 @@ bool interpRunScript(SCRIPT_CONTEXT *psContext, INTERP_RUNTYPE runType, UDWORD i
 					debug(LOG_ERROR, "interpRunScript() - retStackPop() failed.");
 					return false;
 				}
+				psLocals = varEnvironment[retStackCallDepth()];
 
 				//remember last called event/index
 				strcpy(last_called_script_event, eventGetEventID(psProg, CurEvent));
@@ -901,6 +1067,11 @@ bool interpRunScript(SCRIPT_CONTEXT *psContext, INTERP_RUNTYPE runType, UDWORD i
 	psCurProg = nullptr;
 	TRCPRINTF("%-6d  EXIT\n", (int)(InstrPointer - psProg->pCode));
 
+	if (interpProfileOn)
+	{
+		interpProfileAdd(psProg, runType, index, interpProfileTimer.nsecsElapsed() - startTime, instructionCount);
+	}
+
 	bInterpRunning = false;
 	return true;
 
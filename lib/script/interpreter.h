@@ -25,6 +25,9 @@
 #ifndef _interp_h
 #define _interp_h
 
+#include <string>
+#include <vector>
+
 /* The type of function called by an OP_CALL */
 typedef bool (*SCRIPT_FUNC)();
 
@@ -287,11 +290,20 @@ struct TRIGGER_DATA
 	UDWORD			time;		// How often to check the trigger
 };
 
+/* An instruction of the compiled code, decoded once before the code is first run */
+struct INTERP_DECODED
+{
+	OPCODE			opcode;			// The opcode of the instruction
+	UDWORD			data;			// The data packed in with the opcode
+	const void		*handler;		// Where the interpreter handles the opcode, if it can jump there directly
+};
+
 /* A compiled script and its associated data */
 struct SCRIPT_CODE
 {
 	UDWORD			size;			// The size (in bytes) of the compiled code
 	INTERP_VAL		*pCode;			// Pointer to the compiled code
+	INTERP_DECODED	*psDecoded;		// The decoded instructions, by offset into pCode, NULL until first run
 
 	UWORD			numTriggers;	// The number of triggers
 	UWORD			numEvents;		// The number of events
@@ -330,6 +342,17 @@ enum INTERP_RUNTYPE
 };
 
 
+/* Performance data for an event, function or trigger */
+struct INTERP_PROFILE
+{
+	std::string		name;			// Event, function or trigger name
+	bool			trigger = false;	// Whether this is a trigger rather than an event or function
+	uint32_t		calls = 0;
+	uint64_t		time = 0;		// Total time taken in nanoseconds, including called functions
+	uint64_t		worst = 0;		// Longest single call in nanoseconds
+	uint64_t		instructions = 0;	// Total number of instructions executed
+};
+
 /* The size of each opcode */
 extern SDWORD aOpSize[];
 
@@ -345,4 +368,16 @@ extern bool interpProcessorActive();
 /* Output script call stack trace */
 extern void scrOutputCallTrace(code_part part);
 
+/* Start or stop measuring how long events, functions and triggers take */
+extern void interpSetProfiling(bool enable);
+
+/* Whether events, functions and triggers are being measured */
+extern bool interpProfiling();
+
+/* Get the performance data of everything run so far, most time consuming first */
+extern std::vector<INTERP_PROFILE> interpGetProfile();
+
+/* Forget all performance data */
+extern void interpResetProfile();
+
 #endif
@@ -93,6 +93,7 @@ void scriptFreeCode(SCRIPT_CODE *psCode)
 	free(psCode->ppsLocalVarVal);
 
 	free(psCode->pCode);
+	free(psCode->psDecoded);
 
 	free(psCode->pTriggerTab);
 	free(psCode->psTriggerData);
@@ -229,6 +229,7 @@ void script_debug(const char *pFormat, ...);
 		debug(LOG_ERROR, "Out of memory"); \
 		ALLOC_ERROR_ACTION; \
 	} \
+	(psProg)->psDecoded = NULL; \
 	if (numGlobs > 0) \
 	{ \
 		(psProg)->pGlobals = (INTERP_TYPE *)malloc(sizeof(INTERP_TYPE) * (numGlobs)); \
@@ -57,8 +57,10 @@
 
 #include "lib/framework/frame.h"
 #include "lib/framework/opengl.h"
+#include "lib/framework/wzapp.h"
 #include "sequence.h"
 #include "timer.h"
+#include "yuv.h"
 #include "lib/framework/math_ext.h"
 #include "lib/ivis_opengl/piestate.h"
 #include "lib/ivis_opengl/pieblitfunc.h"
@@ -69,6 +71,9 @@
 #include <glm/gtx/transform.hpp>
 #include "lib/ivis_opengl/pieclip.h"
 
+#include <QtCore/QElapsedTimer>
+#include <atomic>
+
 #include <theora/theora.h>
 #include <physfs.h>
 
@@ -79,15 +84,41 @@
 #include <AL/al.h>
 #endif
 
+/* Playback is split over two threads. The decoder thread reads the file, decodes the Theora packets and converts
+ * them to RGBA, and decodes the Vorbis packets to 16 bit PCM, into two small queues. It stops when both queues are
+ * full, so it keeps only a little ahead of playback. The main thread takes the audio chunks into OpenAL buffers, and
+ * shows the newest frame that is due by the audio clock, which is the position of the OpenAL source in the samples
+ * queued on it. Without audio, the wall clock is used instead.
+ */
+
+#define FRAME_QUEUE_SIZE		4	// decoded frames the decoder may get ahead of the screen
+#define AUDIO_QUEUE_SIZE		8	// decoded audio chunks the decoder may get ahead of the source
+#define AUDIO_CHUNKS_PER_SECOND	8
+#define AUDIO_BUFFERS			4	// OpenAL buffers used, filled before playback starts
+
+static_assert(AUDIO_BUFFERS <= AUDIO_QUEUE_SIZE, "Playback waits for a chunk for each buffer");
+
+struct VideoFrame
+{
+	uint32_t *rgba;			// frame_width * frame_height pixels, with a scanline after each row if using scanlines
+	double time;			// when to show it, in seconds from the start
+};
+
+struct AudioChunk
+{
+	ogg_int16_t *pcm;		// audioChunkSize bytes
+	int size;				// bytes used
+};
+
 // stick this in sequence.h perhaps?
 struct AudioData
 {
-	ALuint buffer1;			// buffer 1
-	ALuint buffer2;			// buffer 2
-	ALuint source;			// source
-	int totbufstarted;		// number of buffers started
-	int audiofd_fragsize;	// audio fragment size, used to calculate how big audiobuf is
-	int audiobuf_fill;		// how full our audio buffer is
+	ALuint allBuffers[AUDIO_BUFFERS];	// all the buffers
+	ALuint buffers[AUDIO_BUFFERS];	// buffers not queued on the source
+	int freeBuffers;				// number of buffers in buffers
+	ALuint source;					// source
+	bool output;					// whether the audio is played, else it is thrown away and the wall clock is used
+	ogg_int64_t samplesPlayed;		// samples in the buffers the source has finished with
 };
 
 struct VideoData
@@ -108,9 +139,8 @@ struct VideoData
 
 // for our audio structure
 static AudioData audiodata;
-static ALint sourcestate = 0;		//Source state information
 
-// for our video structure
+// for our video structure, only used by the decoder thread while it runs
 static VideoData videodata;
 
 /// are we playing a theora stream?
@@ -119,29 +149,44 @@ static int theora_p = 0;
 /// are we playing an ogg vorbis stream?
 static int vorbis_p = 0;
 
-static bool stateflag = false;
+static bool decodersReady = false;		// whether the theora and vorbis decoders have been initialised
 static bool videoplaying = false;
-static bool videobuf_ready = false;		// single frame video buffer ready for processing
-static bool audiobuf_ready = false;		// single 'frame' audio buffer ready for processing
+static bool playbackStarted = false;	// whether the first frame and audio were ready, and the clock runs
 
 // file handle
 static PHYSFS_file *fpInfile = nullptr;
 
-static uint32_t *RGBAframe = nullptr;					// texture buffer
-static ogg_int16_t *audiobuf = nullptr;			// audio buffer
-
-// For timing
-static double audioTime = 0;
+// The queues between the decoder thread and the main thread, protected by queueMutex. The decoder fills the slot after
+// the last queued one before it queues it, the main thread uses the first queued one until it pops it.
+static VideoFrame frameQueue[FRAME_QUEUE_SIZE];
+static int frameHead = 0;
+static int frameCount = 0;
+static AudioChunk audioQueue[AUDIO_QUEUE_SIZE];
+static int audioHead = 0;
+static int audioCount = 0;
+static bool decoderFinished = false;	// whether everything has been decoded and queued
+static double playerClock = 0;			// the clock of the main thread, for skipping the conversion of late frames
+static wz::mutex queueMutex;
+
+static WZ_THREAD *decoderThread = nullptr;
+static WZ_SEMAPHORE *decoderSemaphore = nullptr;	// posted when there is room in a queue, or to quit
+static WZ_SEMAPHORE *playerSemaphore = nullptr;		// posted when something is queued, or decoding finished
+static std::atomic<bool> decoderQuit(false);
+
+// Only used by the decoder thread while it runs.
+static int audioChunkSize = 0;			// bytes in each audio chunk
+static int audioFill = 0;				// bytes decoded into the audio chunk being filled
+static bool inputEnded = false;
+static bool audioDone = false;
+static bool videoDone = false;
+static int skipped = 0;					// frames decoded too late to be shown, and not converted
+static int64_t decodeTime = 0;			// nanoseconds spent decoding
+static int64_t convertTime = 0;			// nanoseconds spent converting frames to RGBA
+
+// For timing, when not using the audio clock
+static double clockBase = 0;
 
 static double videobuf_time = 0;
-static double sampletimeOffset = 0;
-static double basetime = -1;
-static double last_time;
-static double timer_expire;
-static bool timer_started = false;
-
-static ogg_int64_t audiobuf_granulepos = 0;	// time position of last sample
-static ogg_int64_t videobuf_granulepos = -1;	// time position of last video frame
 
 // frame & dropped frame counter
 static int frames = 0;
@@ -154,6 +199,7 @@ static GLfloat vertices[NUM_VERTICES][2];
 static GLfloat Scrnvidpos[3];
 
 static SCANLINE_MODE use_scanlines;
+static SCANLINE_MODE frameScanlines;	// scanlines in the frames of the video being played
 
 // Helper; just grab some more compressed bitstream and sync it for page extraction
 static int buffer_data(PHYSFS_file *in, ogg_sync_state *oy)
@@ -186,293 +232,409 @@ static int queue_page(ogg_page *page)
 	return 0;
 }
 
-// sets the frames number we are on
-static void seq_SetFrameNumber(int frame)
-{
-	frames = frame;
-}
-
-/// @TODO FIXME:  This routine can & will fail when sources are used up!
 static void open_audio(void)
 {
-	float volume = 1.0;
-
-	audiodata.audiofd_fragsize = (((videodata.vi.channels * 16) / 8) * videodata.vi.rate);
-	audiobuf = (ogg_int16_t *)malloc(audiodata.audiofd_fragsize);
+	audiodata.freeBuffers = 0;
+	audiodata.samplesPlayed = 0;
+	audiodata.output = false;
 
-	// FIX ME:  This call will fail, since we have, most likely, already
-	// used up all available sources late in the game!
-	// openal
+	// This fails if all sources are used, in which case the audio is thrown away.
 	alGenSources(1, &audiodata.source);
-	sound_GetError();	// on error, we *need* to free another source!
-
-	// Create an OpenAL buffer and fill it with the decoded data
-	alGenBuffers(1, &audiodata.buffer1);
-	sound_GetError();
-	alGenBuffers(1, &audiodata.buffer2);
-	sound_GetError();	// Log and clear error codes
+	if (sound_GetError() != AL_NO_ERROR)
+	{
+		debug(LOG_WARNING, "No OpenAL source for the video's audio");
+		audiodata.source = 0;
+		return;
+	}
 
-	audiodata.totbufstarted = 0;
+	alGenBuffers(AUDIO_BUFFERS, audiodata.allBuffers);
+	if (sound_GetError() != AL_NO_ERROR)
+	{
+		alDeleteSources(1, &audiodata.source);
+		audiodata.source = 0;
+		return;
+	}
+	memcpy(audiodata.buffers, audiodata.allBuffers, sizeof(audiodata.buffers));
+	audiodata.freeBuffers = AUDIO_BUFFERS;
+	audiodata.output = true;
 
 	// set the volume of the FMV based on the user's preferences
-	volume = sound_GetUIVolume();
-	alSourcef(audiodata.source, AL_GAIN, volume);
+	alSourcef(audiodata.source, AL_GAIN, sound_GetUIVolume());
 }
 
 /** Cleans up audio sources & buffers
  */
 static void audio_close(void)
 {
-	// NOTE: sources & buffers deleted in seq_Shutdown()
-	audiobuf_granulepos = 0;
-//	clear struct
-//	memset(&audiodata,0x0,sizeof(audiodata));
-	audiodata.audiobuf_fill = 0;
-	audiodata.audiofd_fragsize = 0;
-	audiodata.source = 0;
-	audiodata.buffer1 = audiodata.buffer2 = 0;
-	if (audiobuf)
+	if (audiodata.output)
 	{
-		free(audiobuf);
-		audiobuf = nullptr;
+		// Detach the queued buffers, so they can be deleted.
+		alSourceStop(audiodata.source);
+		alSourcei(audiodata.source, AL_BUFFER, 0);
+		alDeleteSources(1, &audiodata.source);
+		alDeleteBuffers(AUDIO_BUFFERS, audiodata.allBuffers);
+		sound_GetError();
 	}
+	audiodata.source = 0;
+	audiodata.freeBuffers = 0;
+	audiodata.output = false;
 }
 
-// Retrieves the current time with millisecond accuracy
-static double getTimeNow(void)
+const GLfloat texture_width = 1024.0f;
+const GLfloat texture_height = 1024.0f;
+
+/** Allocates memory to hold the decoded video frames and audio chunks
+ */
+static void allocateQueues(void)
 {
-	return Timer_getElapsedMilliSecs();
+	if (theora_p)
+	{
+		int size = videodata.ti.frame_width * videodata.ti.frame_height * 4;
+		if (frameScanlines)
+		{
+			size *= 2;
+		}
+		for (VideoFrame &frame : frameQueue)
+		{
+			frame.rgba = (uint32_t *)calloc(1, size);
+		}
+	}
+	if (vorbis_p)
+	{
+		audioChunkSize = videodata.vi.rate / AUDIO_CHUNKS_PER_SECOND * videodata.vi.channels * 2;
+		for (AudioChunk &chunk : audioQueue)
+		{
+			chunk.pcm = (ogg_int16_t *)malloc(audioChunkSize);
+		}
+	}
 }
 
-// get relative time since beginning playback, compensating for A/V drift
-static double getRelativeTime(void)
+static void deallocateQueues(void)
 {
-	if (basetime == -1)					// check to see if this is first time run
+	for (VideoFrame &frame : frameQueue)
+	{
+		free(frame.rgba);
+		frame.rgba = nullptr;
+	}
+	for (AudioChunk &chunk : audioQueue)
 	{
-		basetime = getTimeNow();
-		timer_expire = Timer_getElapsedMicroSecs();
-		timer_expire += (int)((videobuf_time - getTimeNow()) * 1000000.0);
-		timer_started = true;
+		free(chunk.pcm);
+		chunk.pcm = nullptr;
 	}
-	return ((getTimeNow() - basetime) * .001);
 }
 
-const GLfloat texture_width = 1024.0f;
-const GLfloat texture_height = 1024.0f;
-
-/** Allocates memory to hold the decoded video frame
- */
-static void Allocate_videoFrame(void)
+/// Converts a YUV420 frame to RGBA, adding the scanlines after each row.
+static void convertFrame(const yuv_buffer &yuv, uint32_t *rgba, int width, int height, SCANLINE_MODE scanlines)
 {
-	int size = videodata.ti.frame_width * videodata.ti.frame_height * 4;
-	if (use_scanlines)
+	const int pitch = scanlines ? width * 2 : width;
+	for (int row = 0; row < height; ++row)
 	{
-		size *= 2;
+		const unsigned char *y = yuv.y + row * yuv.y_stride;
+		const unsigned char *u = yuv.u + (row >> 1) * yuv.uv_stride;
+		const unsigned char *v = yuv.v + (row >> 1) * yuv.uv_stride;
+		uint32_t *out = rgba + row * pitch;
+
+		int x = 0;
+#ifdef SEQ_SSE2
+		x = convertRowSSE2(y, u, v, out, width);
+#endif
+		for (; x + 1 < width; x += 2)
+		{
+			// U and V are the same for both pixels.
+			const int U = u[x / 2] - 128;
+			const int V = v[x / 2] - 128;
+			out[x] = yuvToRGBA(y[x], U, V);
+			out[x + 1] = yuvToRGBA(y[x + 1], U, V);
+		}
+
+		if (scanlines == SCANLINES_50)
+		{
+			// halve the rgb values for a dimmed scanline
+			for (x = 0; x < width; ++x)
+			{
+				out[width + x] = (out[x] >> 1 & RGBmask) | Amask;
+			}
+		}
+		else if (scanlines == SCANLINES_BLACK)
+		{
+			for (x = 0; x < width; ++x)
+			{
+				out[width + x] = Amask;
+			}
+		}
 	}
+}
 
-	RGBAframe = (uint32_t *)malloc(size);
-	memset(RGBAframe, 0, size);
+/// The audio chunk to decode into, or nullptr if the queue is full.
+static AudioChunk *audioTail()
+{
+	std::lock_guard<wz::mutex> lock(queueMutex);
+	return audioCount < AUDIO_QUEUE_SIZE ? &audioQueue[(audioHead + audioCount) % AUDIO_QUEUE_SIZE] : nullptr;
 }
 
-static void deallocateVideoFrame(void)
+/// The frame to decode into, or nullptr if the queue is full.
+static VideoFrame *frameTail()
 {
-	if (RGBAframe)
+	std::lock_guard<wz::mutex> lock(queueMutex);
+	return frameCount < FRAME_QUEUE_SIZE ? &frameQueue[(frameHead + frameCount) % FRAME_QUEUE_SIZE] : nullptr;
+}
+
+static void pushAudio(AudioChunk *chunk)
+{
+	chunk->size = audioFill;
+	audioFill = 0;
 	{
-		free(RGBAframe);
+		std::lock_guard<wz::mutex> lock(queueMutex);
+		++audioCount;
 	}
+	wzSemaphorePost(playerSemaphore);
 }
 
-#ifndef __BIG_ENDIAN__
-const int Rshift = 0;
-const int Gshift = 8;
-const int Bshift = 16;
-const int Ashift = 24;
-// RGBmask is used only after right-shifting, so ignore the leftmost bit of each byte
-const int RGBmask = 0x007f7f7f;
-const int Amask = 0xff000000;
-#else
-const int Rshift = 24;
-const int Gshift = 16;
-const int Bshift = 8;
-const int Ashift = 0;
-const int RGBmask = 0x7f7f7f00;
-const int Amask = 0x000000ff;
-#endif
-#define Vclip( x )	( (x > 0) ? ((x < 255) ? x : 255) : 0 )
-// main routine to display video on screen.
-static void video_write(bool update)
+/// Decodes audio until chunk is full and queued. Returns false if more data is needed first.
+static bool decodeAudio(AudioChunk *chunk)
 {
-	unsigned int x = 0, y = 0;
-	const int video_width = videodata.ti.frame_width;
-	const int video_height = videodata.ti.frame_height;
-	// when using scanlines we need to double the height
-	const int height_factor = (use_scanlines ? 2 : 1);
-	yuv_buffer yuv;
-
-	if (update)
+	while (audioFill < audioChunkSize)
 	{
-		int rgb_offset = 0;
-		int y_offset = 0;
-		int uv_offset = 0;
-		const int half_width = video_width / 2;
-
-		theora_decode_YUVout(&videodata.td, &yuv);
-
-		// fill the RGBA buffer
-		for (y = 0; y < video_height; y++)
+		float **pcm;
+		const int ret = vorbis_synthesis_pcmout(&videodata.vd, &pcm);
+		if (ret > 0)
 		{
-			y_offset = y * yuv.y_stride;
-			uv_offset = (y >> 1) * yuv.uv_stride;
+			// we now have float pcm data in pcm
+			// going to convert that to int pcm in the chunk
+			const int channels = videodata.vi.channels;
+			const int samples = std::min(ret, (audioChunkSize - audioFill) / 2 / channels);
+			ogg_int16_t *out = chunk->pcm + audioFill / 2;
 
-			for (x = 0; x < half_width; x++)
+			for (int i = 0; i < samples; i++)
 			{
-				int Y = yuv.y[y_offset++] - 16;
-				const int U = yuv.u[uv_offset] - 128;
-				const int V = yuv.v[uv_offset++] - 128;
-
-				int A = 298 * Y;
-				const int C = 409 * V;
-
-				int R = Vclip((A + C + 128) >> 8);
-				int G = Vclip((A - 100 * U - (C >> 1) + 128) >> 8);
-				int B = Vclip((A + 516 * U + 128) >> 8);
-
-				uint32_t rgba = (R << Rshift) | (G << Gshift) | (B << Bshift) | (0xFF << Ashift);
-
-				RGBAframe[rgb_offset] = rgba;
-				if (use_scanlines == SCANLINES_50)
+				for (int j = 0; j < channels; j++)
 				{
-					// halve the rgb values for a dimmed scanline
-					RGBAframe[rgb_offset + video_width] = (rgba >> 1 & RGBmask) | Amask;
-				}
-				else if (use_scanlines == SCANLINES_BLACK)
-				{
-					RGBAframe[rgb_offset + video_width] = Amask;
-				}
-				rgb_offset++;
-
-				// second pixel, U and V (and thus C) are the same as before.
-				Y = yuv.y[y_offset++] - 16;
-				A = 298 * Y;
-
-				R = Vclip((A + C + 128) >> 8);
-				G = Vclip((A - 100 * U - (C >> 1) + 128) >> 8);
-				B = Vclip((A + 516 * U + 128) >> 8);
+					int val = nearbyint(pcm[j][i] * 32767.f);
 
-				rgba = (R << Rshift) | (G << Gshift) | (B << Bshift) | (0xFF << Ashift);
-				RGBAframe[rgb_offset] = rgba;
-				if (use_scanlines == SCANLINES_50)
-				{
-					// halve the rgb values for a dimmed scanline
-					RGBAframe[rgb_offset + video_width] = (rgba >> 1 & RGBmask) | Amask;
-				}
-				else if (use_scanlines == SCANLINES_BLACK)
-				{
-					RGBAframe[rgb_offset + video_width] = Amask;
+					if (val > 32767)
+					{
+						val = 32767;
+					}
+					else if (val < -32768)
+					{
+						val = -32768;
+					}
+					*out++ = val;
 				}
-				rgb_offset++;
 			}
-			if (use_scanlines)
+
+			vorbis_synthesis_read(&videodata.vd, samples);
+			audioFill += samples * channels * 2;
+		}
+		else
+		{
+			/* no pending audio; is there a pending packet to decode? */
+			ogg_packet op;
+			if (ogg_stream_packetout(&videodata.vo, &op) <= 0)
+			{
+				/* we need more data */
+				return false;
+			}
+			if (vorbis_synthesis(&videodata.vb, &op) == 0)
 			{
-				rgb_offset += video_width;
+				/* test for success! */
+				vorbis_synthesis_blockin(&videodata.vd, &videodata.vb);
 			}
 		}
+	}
+
+	pushAudio(chunk);
+	return true;
+}
 
-		videoGfx->updateTexture(RGBAframe, video_width, video_height * height_factor);
+/// Decodes the next packet into frame, and queues it. Returns false if more data is needed first.
+static bool decodeVideo(VideoFrame *frame)
+{
+	/* theora is one in, one out... */
+	ogg_packet op;
+	if (ogg_stream_packetout(&videodata.to, &op) <= 0)
+	{
+		return false;
 	}
+	theora_decode_packetin(&videodata.td, &op);
+	frame->time = theora_granule_time(&videodata.td, videodata.td.granulepos);
 
-	glDisable(GL_DEPTH_TEST);
-	glDepthMask(GL_FALSE);
+	// If the next frame is due already, this one will never be shown.
+	const double frameDuration = (double)videodata.ti.fps_denominator / videodata.ti.fps_numerator;
+	{
+		std::lock_guard<wz::mutex> lock(queueMutex);
+		if (frame->time + frameDuration < playerClock)
+		{
+			++skipped;
+			return true;
+		}
+	}
 
-	videoGfx->draw(
-		glm::ortho(0.f, static_cast<float>(pie_GetVideoBufferWidth()), static_cast<float>(pie_GetVideoBufferHeight()), 0.f) *
-		glm::translate(glm::vec3(Scrnvidpos[0], Scrnvidpos[1], Scrnvidpos[2]))
-	);
+	QElapsedTimer timer;
+	timer.start();
+	yuv_buffer yuv;
+	theora_decode_YUVout(&videodata.td, &yuv);
+	convertFrame(yuv, frame->rgba, videodata.ti.frame_width, videodata.ti.frame_height, frameScanlines);
+	convertTime += timer.nsecsElapsed();
+
+	{
+		std::lock_guard<wz::mutex> lock(queueMutex);
+		++frameCount;
+	}
+	wzSemaphorePost(playerSemaphore);
+	return true;
 }
 
-// FIXME: perhaps we should use wz's routine for audio?
-// loads up the audio buffers, and calculates audio sync time.
-static void audio_write(void)
+/**
+ * Decodes what there is room for in the queues, reading more of the file if needed.
+ * \return false if there is nothing to do until the main thread takes something from the queues.
+ */
+static bool decodeSome()
 {
-	ALint processed = 0;
-	ALint queued = 0;
+	bool progress = false;
+	bool needData = false;
+	QElapsedTimer timer;
+	timer.start();
 
-	alGetSourcei(audiodata.source, AL_BUFFERS_PROCESSED, &processed);
-	alGetSourcei(audiodata.source, AL_BUFFERS_QUEUED, &queued);
-	if ((audiodata.totbufstarted < 2 || processed) && audiodata.audiobuf_fill > 0)
+	if (vorbis_p && !audioDone)
 	{
-		// we have audiobuf_fill bytes of data
-		ALuint oldbuffer = 0;
+		if (AudioChunk *chunk = audioTail())
+		{
+			if (decodeAudio(chunk))
+			{
+				progress = true;
+			}
+			else if (inputEnded)
+			{
+				// Queue the last, partly filled chunk.
+				if (audioFill > 0)
+				{
+					pushAudio(chunk);
+				}
+				audioDone = true;
+			}
+			else
+			{
+				needData = true;
+			}
+		}
+	}
 
-		if (audiodata.totbufstarted == 0)
+	if (theora_p && !videoDone)
+	{
+		if (VideoFrame *frame = frameTail())
 		{
-			oldbuffer = audiodata.buffer1;
+			if (decodeVideo(frame))
+			{
+				progress = true;
+			}
+			else if (inputEnded)
+			{
+				videoDone = true;
+			}
+			else
+			{
+				needData = true;
+			}
 		}
-		else if (audiodata.totbufstarted == 1)
+	}
+	decodeTime += timer.nsecsElapsed();
+
+	if (!progress && needData)
+	{
+		/* no data yet for somebody.  Grab another page */
+		if (buffer_data(fpInfile, &videodata.oy) == 0)
 		{
-			oldbuffer = audiodata.buffer2;
+			inputEnded = true;
 		}
-		else
+		while (ogg_sync_pageout(&videodata.oy, &videodata.og) > 0)
 		{
-			ALint buffer_size = 0;
-			ogg_int64_t current_sample = 0;
-
-			alSourceUnqueueBuffers(audiodata.source, 1, &oldbuffer);
-			alGetBufferi(oldbuffer, AL_SIZE, &buffer_size);
-			// audio time sync
-			audioTime += (double) buffer_size / (videodata.vi.rate * videodata.vi.channels);
-			debug(LOG_VIDEO, "Audio sync");
-			current_sample = audiobuf_granulepos - audiodata.audiobuf_fill / 2 / videodata.vi.channels;
-			sampletimeOffset -= getTimeNow() - 1000 * current_sample / videodata.vi.rate;
+			queue_page(&videodata.og);
 		}
+		progress = true;
+	}
 
-		alBufferData(oldbuffer, (videodata.vi.channels == 1 ? AL_FORMAT_MONO16 : AL_FORMAT_STEREO16),
-		             audiobuf, audiodata.audiobuf_fill, videodata.vi.rate);
-
-		alSourceQueueBuffers(audiodata.source, 1, &oldbuffer);
-		audiodata.totbufstarted++;
-		if (audiodata.totbufstarted > 2)
+	if ((!vorbis_p || audioDone) && (!theora_p || videoDone))
+	{
 		{
-			audiodata.totbufstarted = 2;
+			std::lock_guard<wz::mutex> lock(queueMutex);
+			if (decoderFinished)
+			{
+				return false;
+			}
+			decoderFinished = true;
 		}
+		debug(LOG_VIDEO, "video decoded");
+		wzSemaphorePost(playerSemaphore);
+		return false;
+	}
+	return progress;
+}
 
-		if (sourcestate != AL_PLAYING)
+static int decoderThreadFunc(WZ_DECL_UNUSED void *data)
+{
+	while (!decoderQuit)
+	{
+		if (!decodeSome())
 		{
-			debug(LOG_VIDEO, "starting source\n");
-			alSourcePlay(audiodata.source);
+			wzSemaphoreWait(decoderSemaphore);
 		}
+	}
+	return 0;
+}
+
+static void startDecoder(void)
+{
+	decoderQuit = false;
+	decoderSemaphore = wzSemaphoreCreate(0);
+	playerSemaphore = wzSemaphoreCreate(0);
+	decoderThread = wzThreadCreate(decoderThreadFunc, nullptr);
+	wzThreadStart(decoderThread);
+}
 
-		audiobuf_ready = 0;
-		audiodata.audiobuf_fill = 0;
+static void stopDecoder(void)
+{
+	if (decoderThread == nullptr)
+	{
+		return;
 	}
+	decoderQuit = true;
+	wzSemaphorePost(decoderSemaphore);  // Wake up the thread, so it can quit.
+	wzThreadJoin(decoderThread);
+	decoderThread = nullptr;
+	wzSemaphoreDestroy(decoderSemaphore);
+	decoderSemaphore = nullptr;
+	wzSemaphoreDestroy(playerSemaphore);
+	playerSemaphore = nullptr;
 }
 
 static void seq_InitOgg(void)
 {
 	debug(LOG_VIDEO, "seq_InitOgg");
 
-	stateflag = false;
 	theora_p = 0;
 	vorbis_p = 0;
+	decodersReady = false;
 
 	videoplaying = false;
+	playbackStarted = false;
+
+	frameHead = frameCount = 0;
+	audioHead = audioCount = 0;
+	decoderFinished = false;
+	playerClock = 0;
 
-	/* single frame video buffering */
-	videobuf_ready = false;
-	videobuf_granulepos = -1;
+	audioChunkSize = 0;
+	audioFill = 0;
+	inputEnded = audioDone = videoDone = false;
+	skipped = 0;
+	decodeTime = convertTime = 0;
+
+	clockBase = 0;
 	videobuf_time = 0;
 	frames = 0;
 	dropped = 0;
 
-	/* single audio fragment audio buffering */
-	audiodata.audiobuf_fill = 0;
-	audiobuf_ready = false;
-
-	audiobuf_granulepos = 0;	/* time position of last sample */
-	audioTime = 0;
-
-	sampletimeOffset = 0;
-
 	/* start up Ogg stream synchronization layer */
 	ogg_sync_init(&videodata.oy);
 
@@ -480,26 +642,19 @@ static void seq_InitOgg(void)
 	vorbis_info_init(&videodata.vi);
 	vorbis_comment_init(&videodata.vc);
 
-	/* init supporting Theora structuretotbufstarteds needed in header parsing */
+	/* init supporting Theora structures needed in header parsing */
 	theora_comment_init(&videodata.tc);
 	theora_info_init(&videodata.ti);
 	Timer_Init();
-	Timer_start();
 }
 
-bool seq_Play(const char *filename)
+/// Opens filename, or novideo.ogg if that fails and fallback is set, and reads the headers. Call seq_Close after.
+static bool seq_Open(const char *filename, bool fallback, SCANLINE_MODE scanlines)
 {
 	int pp_level_max = 0;
 	int pp_level = 0;
 	ogg_packet op;
-
-	debug(LOG_VIDEO, "starting playback of: %s", filename);
-
-	if (videoplaying)
-	{
-		debug(LOG_VIDEO, "previous movie is not yet finished");
-		seq_Shutdown();
-	}
+	bool headersDone = false;
 
 	seq_InitOgg();
 
@@ -508,19 +663,16 @@ bool seq_Play(const char *filename)
 	{
 		info("unable to open '%s' for playback", filename);
 
-		fpInfile = PHYSFS_openRead("novideo.ogg");
+		fpInfile = fallback ? PHYSFS_openRead("novideo.ogg") : nullptr;
 		if (fpInfile == nullptr)
 		{
 			return false;
 		}
 	}
 
-	theora_p = 0;
-	vorbis_p = 0;
-
 	/* Ogg file open; parse the headers */
 	/* Only interested in Vorbis/Theora streams */
-	while (!stateflag)
+	while (!headersDone)
 	{
 		int ret = buffer_data(fpInfile, &videodata.oy);
 
@@ -538,7 +690,7 @@ bool seq_Play(const char *filename)
 			{
 				/* don't leak the page; get it into the appropriate stream */
 				queue_page(&videodata.og);
-				stateflag = 1;
+				headersDone = true;
 				break;
 			}
 
@@ -665,46 +817,261 @@ bool seq_Play(const char *filename)
 		vorbis_info_clear(&videodata.vi);
 		vorbis_comment_clear(&videodata.vc);
 	}
+	decodersReady = true;
 
-	/* open audio */
-	if (vorbis_p)
-	{
-		open_audio();
-	}
-
-	/* open video */
-	videoGfx = new GFX(GFX_TEXTURE, GL_TRIANGLE_STRIP, 2);
 	if (theora_p)
 	{
 		if (videodata.ti.frame_width > texture_width || videodata.ti.frame_height > texture_height)
 		{
 			debug(LOG_ERROR, "Video size too large, must be below %.gx%.g!",
 			      texture_width, texture_height);
-			delete videoGfx;
-			videoGfx = nullptr;
 			return false;
 		}
 		if (videodata.ti.pixelformat != OC_PF_420)
 		{
 			debug(LOG_ERROR, "Video not in YUV420 format!");
-			delete videoGfx;
-			videoGfx = nullptr;
 			return false;
 		}
-		char *blackframe = (char *)calloc(1, texture_width * texture_height * 4);
+	}
+
+	// disable scanlines if the video is too large for the texture or shown too small
+	frameScanlines = scanlines;
+	if (!theora_p || videodata.ti.frame_height * 2 > texture_height || vertices[3][1] < videodata.ti.frame_height * 2)
+	{
+		frameScanlines = SCANLINES_OFF;
+	}
+
+	allocateQueues();
+	return true;
+}
+
+/// Stops decoding, and frees everything seq_Open set up.
+static void seq_Close(void)
+{
+	stopDecoder();
+
+	if (vorbis_p)
+	{
+		ogg_stream_clear(&videodata.vo);
+		if (decodersReady)
+		{
+			vorbis_block_clear(&videodata.vb);
+			vorbis_dsp_clear(&videodata.vd);
+		}
+		vorbis_comment_clear(&videodata.vc);
+		vorbis_info_clear(&videodata.vi);
+	}
+
+	if (theora_p)
+	{
+		ogg_stream_clear(&videodata.to);
+		if (decodersReady)
+		{
+			theora_clear(&videodata.td);
+		}
+		theora_comment_clear(&videodata.tc);
+		theora_info_clear(&videodata.ti);
+	}
+	theora_p = 0;
+	vorbis_p = 0;
+	decodersReady = false;
+
+	ogg_sync_clear(&videodata.oy);
+
+	if (fpInfile)
+	{
+		PHYSFS_close(fpInfile);
+		fpInfile = nullptr;
+	}
+
+	deallocateQueues();
+}
+
+// main routine to display video on screen.
+static void video_write(const VideoFrame *frame)
+{
+	if (frame != nullptr)
+	{
+		// when using scanlines we need to double the height
+		const int height_factor = (frameScanlines ? 2 : 1);
+		videoGfx->updateTexture(frame->rgba, videodata.ti.frame_width, videodata.ti.frame_height * height_factor);
+	}
+
+	glDisable(GL_DEPTH_TEST);
+	glDepthMask(GL_FALSE);
+
+	videoGfx->draw(
+		glm::ortho(0.f, static_cast<float>(pie_GetVideoBufferWidth()), static_cast<float>(pie_GetVideoBufferHeight()), 0.f) *
+		glm::translate(glm::vec3(Scrnvidpos[0], Scrnvidpos[1], Scrnvidpos[2]))
+	);
+}
 
-		// disable scanlines if the video is too large for the texture or shown too small
-		if (videodata.ti.frame_height * 2 > texture_height || vertices[3][1] < videodata.ti.frame_height * 2)
+/// Moves decoded audio into the free buffers of the source, and restarts the source if it ran out.
+static void audio_write(void)
+{
+	if (!audiodata.output)
+	{
+		// Nowhere to play it, so throw it away.
+		bool popped;
+		{
+			std::lock_guard<wz::mutex> lock(queueMutex);
+			popped = audioCount > 0;
+			audioHead = (audioHead + audioCount) % AUDIO_QUEUE_SIZE;
+			audioCount = 0;
+		}
+		if (popped)
 		{
-			use_scanlines = SCANLINES_OFF;
+			wzSemaphorePost(decoderSemaphore);
 		}
+		return;
+	}
 
-		Allocate_videoFrame();
+	// Take back the buffers the source has finished with.
+	ALint processed = 0;
+	alGetSourcei(audiodata.source, AL_BUFFERS_PROCESSED, &processed);
+	while (processed-- > 0)
+	{
+		ALuint buffer = 0;
+		ALint size = 0;
+		alSourceUnqueueBuffers(audiodata.source, 1, &buffer);
+		alGetBufferi(buffer, AL_SIZE, &size);
+		audiodata.samplesPlayed += size / 2 / videodata.vi.channels;
+		audiodata.buffers[audiodata.freeBuffers++] = buffer;
+	}
+
+	bool popped = false;
+	while (audiodata.freeBuffers > 0)
+	{
+		const AudioChunk *chunk;
+		{
+			std::lock_guard<wz::mutex> lock(queueMutex);
+			chunk = audioCount > 0 ? &audioQueue[audioHead] : nullptr;
+		}
+		if (chunk == nullptr)
+		{
+			break;
+		}
+
+		const ALuint buffer = audiodata.buffers[--audiodata.freeBuffers];
+		alBufferData(buffer, (videodata.vi.channels == 1 ? AL_FORMAT_MONO16 : AL_FORMAT_STEREO16),
+		             chunk->pcm, chunk->size, videodata.vi.rate);
+		alSourceQueueBuffers(audiodata.source, 1, &buffer);
+
+		{
+			std::lock_guard<wz::mutex> lock(queueMutex);
+			audioHead = (audioHead + 1) % AUDIO_QUEUE_SIZE;
+			--audioCount;
+		}
+		popped = true;
+	}
+	if (popped)
+	{
+		wzSemaphorePost(decoderSemaphore);
+	}
+
+	ALint sourcestate = 0;
+	alGetSourcei(audiodata.source, AL_SOURCE_STATE, &sourcestate);
+	if (sourcestate != AL_PLAYING && audiodata.freeBuffers < AUDIO_BUFFERS)
+	{
+		debug(LOG_VIDEO, "starting source");
+		alSourcePlay(audiodata.source);
+	}
+	sound_GetError();
+}
+
+static bool audio_Playing(void)
+{
+	if (!audiodata.output)
+	{
+		return false;
+	}
+	ALint sourcestate = 0;
+	alGetSourcei(audiodata.source, AL_SOURCE_STATE, &sourcestate);
+	return sourcestate == AL_PLAYING;
+}
+
+/// Seconds since playback started, by the audio clock if the audio is being played, else by the wall clock.
+static double seq_Clock(void)
+{
+	if (audiodata.output)
+	{
+		ALint offset = 0;
+		alGetSourcei(audiodata.source, AL_SAMPLE_OFFSET, &offset);
+		return (double)(audiodata.samplesPlayed + offset) / videodata.vi.rate;
+	}
+	return clockBase + Timer_getElapsedMilliSecs() * .001;
+}
+
+/// Takes the newest frame that is due at now from the queue, dropping any older ones. Pop it when done with it.
+static const VideoFrame *seq_DueFrame(double now)
+{
+	const VideoFrame *frame = nullptr;
+	bool popped = false;
+	{
+		std::lock_guard<wz::mutex> lock(queueMutex);
+		while (frameCount > 1 && frameQueue[(frameHead + 1) % FRAME_QUEUE_SIZE].time <= now)
+		{
+			// running slow, so we skip this frame
+			frameHead = (frameHead + 1) % FRAME_QUEUE_SIZE;
+			--frameCount;
+			++dropped;
+			popped = true;
+		}
+		if (frameCount > 0 && frameQueue[frameHead].time <= now)
+		{
+			frame = &frameQueue[frameHead];
+		}
+	}
+	if (popped)
+	{
+		wzSemaphorePost(decoderSemaphore);
+	}
+	return frame;
+}
+
+static void seq_PopFrame(void)
+{
+	{
+		std::lock_guard<wz::mutex> lock(queueMutex);
+		frameHead = (frameHead + 1) % FRAME_QUEUE_SIZE;
+		--frameCount;
+	}
+	wzSemaphorePost(decoderSemaphore);
+}
+
+bool seq_Play(const char *filename)
+{
+	debug(LOG_VIDEO, "starting playback of: %s", filename);
+
+	if (videoplaying)
+	{
+		debug(LOG_VIDEO, "previous movie is not yet finished");
+		seq_Shutdown();
+	}
+
+	if (!seq_Open(filename, true, use_scanlines))
+	{
+		seq_Close();
+		return false;
+	}
+
+	/* open audio */
+	audiodata.output = false;
+	if (vorbis_p && !audio_Disabled())
+	{
+		open_audio();
+	}
+
+	/* open video */
+	videoGfx = new GFX(GFX_TEXTURE, GL_TRIANGLE_STRIP, 2);
+	if (theora_p)
+	{
+		char *blackframe = (char *)calloc(1, texture_width * texture_height * 4);
 		videoGfx->makeTexture(texture_width, texture_height, GL_LINEAR, GL_RGBA, blackframe);
 		free(blackframe);
 
 		// when using scanlines we need to double the height
-		const int height_factor = (use_scanlines ? 2 : 1);
+		const int height_factor = (frameScanlines ? 2 : 1);
 		const GLfloat vtwidth = (float)videodata.ti.frame_width / texture_width;
 		const GLfloat vtheight = (float)videodata.ti.frame_height * height_factor / texture_height;
 		GLfloat texcoords[NUM_VERTICES * 2] = { 0.0f, 0.0f, vtwidth, 0.0f, 0.0f, vtheight, vtwidth, vtheight };
@@ -716,7 +1083,7 @@ bool seq_Play(const char *filename)
 		we have a start frame for both.  This is not necessarily a valid
 		assumption in Ogg A/V streams! It will always be true of the
 		example_encoder (and most streams) though. */
-	sampletimeOffset = getTimeNow();
+	startDecoder();
 	videoplaying = true;
 	return true;
 }
@@ -732,175 +1099,67 @@ bool seq_Playing()
  */
 bool seq_Update()
 {
-	ogg_packet op;
-	int ret;
-	int i, j;
-	float   **pcm;
-	int count, maxsamples;
-
-	/* we want a video and audio frame ready to go at all times.  If
-		   we have to buffer incoming, buffer the compressed data (ie, let
-		   ogg do the buffering) */
 	if (!videoplaying)
 	{
 		debug(LOG_VIDEO, "no movie playing");
 		return false;
 	}
 
-	while (vorbis_p && !audiobuf_ready)
+	bool finished;
+	bool audioFinished;
 	{
-		/* if there's pending, decoded audio, grab it */
-		if ((ret = vorbis_synthesis_pcmout(&videodata.vd, &pcm)) > 0)
+		std::lock_guard<wz::mutex> lock(queueMutex);
+		/* if our buffers either don't exist or are ready to go,
+			   we can begin playback, same if we've run out of input */
+		if (!playbackStarted && (decoderFinished || ((!theora_p || frameCount > 0) && (!vorbis_p || audioCount >= AUDIO_BUFFERS))))
 		{
-			// we now have float pcm data in pcm
-			// going to convert that to int pcm in audiobuf
-			count = audiodata.audiobuf_fill / 2;
-			maxsamples = (audiodata.audiofd_fragsize - audiodata.audiobuf_fill) / 2 / videodata.vi.channels;
-
-			for (i = 0; i < ret && i < maxsamples; i++)
-			{
-				for (j = 0; j < videodata.vi.channels; j++)
-				{
-					int val = nearbyint(pcm[j][i] * 32767.f);
-
-					if (val > 32767)
-					{
-						val = 32767;
-					}
-					else if (val < -32768)
-					{
-						val = -32768;
-					}
-					audiobuf[count++] = val;
-				}
-			}
-
-			vorbis_synthesis_read(&videodata.vd, i);
-			audiodata.audiobuf_fill += i * videodata.vi.channels * 2;
-
-			if (audiodata.audiobuf_fill == audiodata.audiofd_fragsize)
-			{
-				audiobuf_ready = true;
-			}
-
-			if (videodata.vd.granulepos >= 0)
-			{
-				audiobuf_granulepos = videodata.vd.granulepos - ret + i;
-			}
-			else
-			{
-				audiobuf_granulepos += i;
-			}
-		}
-		else
-		{
-			/* no pending audio; is there a pending packet to decode? */
-			if (ogg_stream_packetout(&videodata.vo, &op) > 0)
-			{
-				if (vorbis_synthesis(&videodata.vb, &op) == 0)
-				{
-					/* test for success! */
-					vorbis_synthesis_blockin(&videodata.vd, &videodata.vb);
-				}
-			}
-			else
-			{
-				/* we need more data; break out to suck in another page */
-				break;
-			}
+			debug(LOG_VIDEO, "all buffers ready");
+			playbackStarted = true;
+			Timer_start();
 		}
+		audioFinished = decoderFinished && audioCount == 0;
+		finished = audioFinished && frameCount == 0;
 	}
-
-	while (theora_p && !videobuf_ready)
+	if (!playbackStarted)
 	{
-		/* theora is one in, one out... */
-		if (ogg_stream_packetout(&videodata.to, &op) > 0)
-		{
-			double now_time = 0;
-			double delay = 0;
-
-			theora_decode_packetin(&videodata.td, &op);
-			videobuf_granulepos = videodata.td.granulepos;
-			videobuf_time = theora_granule_time(&videodata.td, videobuf_granulepos);
-
-			now_time = getRelativeTime();
-			delay = videobuf_time - getRelativeTime();
-
-			if ((delay >= 0.0f) || (now_time - last_time >= 1.0f))
-			{
-				videobuf_ready = true;
-				seq_SetFrameNumber(seq_GetFrameNumber() + 1);
-			}
-			else
-			{
-				// running slow, so we skip this frame
-				dropped++;
-			}
-		}
-		else
-		{
-			break;
-		}
+		return true;
 	}
 
-	alGetSourcei(audiodata.source, AL_SOURCE_STATE, &sourcestate);
-
-	if (PHYSFS_eof(fpInfile)
-	    && !videobuf_ready
-	    && ((!audiobuf_ready && (audiodata.audiobuf_fill == 0)) || audio_Disabled())
-	    && sourcestate != AL_PLAYING
-	   )
-	{
-		video_write(false);
-		seq_Shutdown();
-		debug(LOG_VIDEO, "video finished");
-		return false;
-	}
+	/* top audio buffer off immediately */
+	audio_write();
 
-	if (!videobuf_ready || !audiobuf_ready)
+	// Once all the audio has been played, carry on by the wall clock.
+	if (audioFinished && audiodata.output && !audio_Playing())
 	{
-		/* no data yet for somebody.  Grab another page */
-		ret = buffer_data(fpInfile, &videodata.oy);
-		while (ogg_sync_pageout(&videodata.oy, &videodata.og) > 0)
-		{
-			queue_page(&videodata.og);
-		}
+		clockBase = seq_Clock();
+		Timer_start();
+		audio_close();
 	}
 
-	/* If playback has begun, top audio buffer off immediately. */
-	if (vorbis_p
-	    && stateflag
-	    // FIXME : it is possible to crash if people are playing with no sound.
-	    && !audio_Disabled())
+	const double now = seq_Clock();
 	{
-		// play the data in pcm
-		audio_write();
+		std::lock_guard<wz::mutex> lock(queueMutex);
+		playerClock = now;
 	}
 
-	/* are we at or past time for this video frame? */
-	if (stateflag && videobuf_ready && (videobuf_time <= getRelativeTime()))
+	/* are we at or past time for a video frame? */
+	const VideoFrame *frame = theora_p ? seq_DueFrame(now) : nullptr;
+	if (frame != nullptr)
 	{
-		video_write(true);
-		last_time = getRelativeTime();
-		videobuf_ready = false;
+		videobuf_time = frame->time;
+		++frames;
 	}
-	else if (stateflag)
+	video_write(frame);
+	if (frame != nullptr)
 	{
-		video_write(false);
+		seq_PopFrame();
 	}
 
-	/* if our buffers either don't exist or are ready to go,
-		   we can begin playback */
-	if ((!theora_p || videobuf_ready) && (!vorbis_p || audiobuf_ready) && !stateflag)
+	if (finished && frame == nullptr && !audio_Playing())
 	{
-		debug(LOG_VIDEO, "all buffers ready");
-		stateflag = true;
-	}
-
-	/* same if we've run out of input */
-	if (PHYSFS_eof(fpInfile))
-	{
-		stateflag = true;
+		seq_Shutdown();
+		debug(LOG_VIDEO, "video finished");
+		return false;
 	}
 
 	return true;
@@ -919,45 +1178,76 @@ void seq_Shutdown()
 	delete videoGfx;
 	videoGfx = nullptr;
 
-	if (vorbis_p)
-	{
-		ogg_stream_clear(&videodata.vo);
-		vorbis_block_clear(&videodata.vb);
-		vorbis_dsp_clear(&videodata.vd);
-		vorbis_comment_clear(&videodata.vc);
-		vorbis_info_clear(&videodata.vi);
+	audio_close();
+	seq_Close();
 
-		alDeleteSources(1, &audiodata.source);
-		alDeleteBuffers(1, &audiodata.buffer1);
-		alDeleteBuffers(1, &audiodata.buffer2);
+	videoplaying = false;
+	playbackStarted = false;
+	Timer_stop();
 
-		audio_close();
-	}
+	pie_SetTexturePage(-1);
+	debug(LOG_VIDEO, " **** frames = %d dropped = %d ****", frames, dropped + skipped);
+}
 
-	if (theora_p)
+bool seq_Benchmark(const char *filename, SEQ_BENCHMARK *result)
+{
+	ASSERT_OR_RETURN(false, !videoplaying, "Can't benchmark while a video is playing");
+
+	QElapsedTimer timer;
+	timer.start();
+	if (!seq_Open(filename, false, SCANLINES_OFF))
 	{
-		ogg_stream_clear(&videodata.to);
-		theora_clear(&videodata.td);
-		theora_comment_clear(&videodata.tc);
-		theora_info_clear(&videodata.ti);
-		deallocateVideoFrame();
+		seq_Close();
+		return false;
 	}
+	startDecoder();
 
-	ogg_sync_clear(&videodata.oy);
-
-	if (fpInfile)
+	// Take everything from the queues as soon as it is there.
+	int decoded = 0;
+	double lastFrameTime = 0;
+	while (true)
 	{
-		PHYSFS_close(fpInfile);
+		int taken;
+		bool finished;
+		{
+			std::lock_guard<wz::mutex> lock(queueMutex);
+			if (frameCount > 0)
+			{
+				lastFrameTime = frameQueue[(frameHead + frameCount - 1) % FRAME_QUEUE_SIZE].time;
+			}
+			decoded += frameCount;
+			taken = frameCount + audioCount;
+			frameHead = (frameHead + frameCount) % FRAME_QUEUE_SIZE;
+			frameCount = 0;
+			audioHead = (audioHead + audioCount) % AUDIO_QUEUE_SIZE;
+			audioCount = 0;
+			finished = decoderFinished;
+		}
+		if (taken > 0)
+		{
+			wzSemaphorePost(decoderSemaphore);
+		}
+		else if (finished)
+		{
+			break;
+		}
+		else
+		{
+			wzSemaphoreWait(playerSemaphore);
+		}
 	}
-
-	videoplaying = false;
-	Timer_stop();
-
-	audioTime = 0;
-	sampletimeOffset = last_time = timer_expire = timer_started = 0;
-	basetime = -1;
-	pie_SetTexturePage(-1);
-	debug(LOG_VIDEO, " **** frames = %d dropped = %d ****", frames, dropped);
+	const int64_t wallTime = timer.nsecsElapsed();
+	stopDecoder();
+
+	result->width = theora_p ? videodata.ti.frame_width : 0;
+	result->height = theora_p ? videodata.ti.frame_height : 0;
+	result->frames = decoded;
+	result->seconds = wallTime / 1e9;
+	result->decodeSeconds = decodeTime / 1e9;
+	result->convertSeconds = convertTime / 1e9;
+	result->videoSeconds = lastFrameTime;
+	seq_Close();
+	return true;
 }
 
 int seq_GetFrameNumber()
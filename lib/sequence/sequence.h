@@ -39,4 +39,18 @@ void seq_setScanlineMode(SCANLINE_MODE mode);
 SCANLINE_MODE seq_getScanlineMode();
 double seq_GetFrameTime();
 
+struct SEQ_BENCHMARK
+{
+	int width, height;      ///< Frame size, 0 if there is no video.
+	int frames;             ///< Frames decoded.
+	double seconds;         ///< Wall time taken.
+	double decodeSeconds;   ///< Time spent decoding on the decoder thread, including converting.
+	double convertSeconds;  ///< Time spent converting frames to RGBA.
+	double videoSeconds;    ///< Time of the last frame in the video.
+};
+
+/// Decodes the whole of filename as fast as possible, without showing it or playing the sound. Returns false if the
+/// file can't be played.
+bool seq_Benchmark(const char *filename, SEQ_BENCHMARK *result);
+
 #endif // __INCLUDED_LIB_SEQUENCE_SEQUENCE_H__
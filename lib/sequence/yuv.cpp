@@ -0,0 +1,81 @@
+/*
+	This file is part of Warzone 2100.
+	Copyright (C) 2008-2017  Warzone 2100 Project
+
+	Warzone 2100 is free software; you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation; either version 2 of the License, or
+	(at your option) any later version.
+
+	Warzone 2100 is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with Warzone 2100; if not, write to the Free Software
+	Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301 USA
+*/
+/** @file
+ *  YUV to RGBA conversion, see yuv.h.
+ */
+
+#include "lib/framework/frame.h"
+#include "yuv.h"
+
+#ifdef SEQ_SSE2
+#include <emmintrin.h>
+
+int convertRowSSE2(const unsigned char *y, const unsigned char *u, const unsigned char *v, uint32_t *out, int width)
+{
+	const __m128i zero = _mm_setzero_si128();
+	const __m128i yBias = _mm_set1_epi16(16);
+	const __m128i uvBias = _mm_set1_epi16(128);
+	const __m128i round = _mm_set1_epi32(128);
+	const __m128i alpha = _mm_set1_epi16(0xFF);
+	// Multipliers for pairs of Y and V or Y and U, and for V alone.
+	const __m128i coefR = _mm_setr_epi16(298, 409, 298, 409, 298, 409, 298, 409);
+	const __m128i coefG = _mm_setr_epi16(298, -100, 298, -100, 298, -100, 298, -100);
+	const __m128i coefB = _mm_setr_epi16(298, 516, 298, 516, 298, 516, 298, 516);
+	const __m128i coefC = _mm_setr_epi16(409, 0, 409, 0, 409, 0, 409, 0);
+
+	int x = 0;
+	for (; x + 8 <= width; x += 8)
+	{
+		int32_t u4, v4;
+		memcpy(&u4, u + x / 2, sizeof(u4));
+		memcpy(&v4, v + x / 2, sizeof(v4));
+		const __m128i U8 = _mm_cvtsi32_si128(u4);
+		const __m128i V8 = _mm_cvtsi32_si128(v4);
+
+		// Eight 16 bit values each, with each U and V used for two pixels.
+		const __m128i Y = _mm_sub_epi16(_mm_unpacklo_epi8(_mm_loadl_epi64((const __m128i *)(y + x)), zero), yBias);
+		const __m128i U = _mm_sub_epi16(_mm_unpacklo_epi8(_mm_unpacklo_epi8(U8, U8), zero), uvBias);
+		const __m128i V = _mm_sub_epi16(_mm_unpacklo_epi8(_mm_unpacklo_epi8(V8, V8), zero), uvBias);
+
+		// The first and last four pixels, as 32 bit values.
+		__m128i rgb[2][3];
+		for (int half = 0; half < 2; ++half)
+		{
+			const __m128i YV = half ? _mm_unpackhi_epi16(Y, V) : _mm_unpacklo_epi16(Y, V);
+			const __m128i YU = half ? _mm_unpackhi_epi16(Y, U) : _mm_unpacklo_epi16(Y, U);
+			const __m128i V0 = half ? _mm_unpackhi_epi16(V, zero) : _mm_unpacklo_epi16(V, zero);
+			const __m128i C = _mm_madd_epi16(V0, coefC);
+
+			rgb[half][0] = _mm_srai_epi32(_mm_add_epi32(_mm_madd_epi16(YV, coefR), round), 8);
+			rgb[half][1] = _mm_srai_epi32(_mm_add_epi32(_mm_sub_epi32(_mm_madd_epi16(YU, coefG), _mm_srai_epi32(C, 1)), round), 8);
+			rgb[half][2] = _mm_srai_epi32(_mm_add_epi32(_mm_madd_epi16(YU, coefB), round), 8);
+		}
+
+		// Clip to bytes, R and G in one register, B and A in another, then interleave them.
+		const __m128i RG = _mm_packus_epi16(_mm_packs_epi32(rgb[0][0], rgb[1][0]), _mm_packs_epi32(rgb[0][1], rgb[1][1]));
+		const __m128i BA = _mm_packus_epi16(_mm_packs_epi32(rgb[0][2], rgb[1][2]), alpha);
+		const __m128i rg = _mm_unpacklo_epi8(RG, _mm_srli_si128(RG, 8));
+		const __m128i ba = _mm_unpacklo_epi8(BA, _mm_srli_si128(BA, 8));
+		_mm_storeu_si128((__m128i *)(out + x), _mm_unpacklo_epi16(rg, ba));
+		_mm_storeu_si128((__m128i *)(out + x + 4), _mm_unpackhi_epi16(rg, ba));
+	}
+	return x;
+}
+#endif
+
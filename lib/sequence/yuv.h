@@ -0,0 +1,68 @@
+/*
+	This file is part of Warzone 2100.
+	Copyright (C) 2008-2017  Warzone 2100 Project
+
+	Warzone 2100 is free software; you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation; either version 2 of the License, or
+	(at your option) any later version.
+
+	Warzone 2100 is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with Warzone 2100; if not, write to the Free Software
+	Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301 USA
+*/
+/** @file
+ *  YUV to RGBA conversion of video frames, without anything else of the sequence player, so tests can check it.
+ */
+
+#ifndef __INCLUDED_LIB_SEQUENCE_YUV_H__
+#define __INCLUDED_LIB_SEQUENCE_YUV_H__
+
+#include "lib/framework/types.h"
+
+#if (defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)) && !defined(__BIG_ENDIAN__)
+#define SEQ_SSE2
+#endif
+
+#ifndef __BIG_ENDIAN__
+const int Rshift = 0;
+const int Gshift = 8;
+const int Bshift = 16;
+const int Ashift = 24;
+// RGBmask is used only after right-shifting, so ignore the leftmost bit of each byte
+const int RGBmask = 0x007f7f7f;
+const int Amask = 0xff000000;
+#else
+const int Rshift = 24;
+const int Gshift = 16;
+const int Bshift = 8;
+const int Ashift = 0;
+const int RGBmask = 0x7f7f7f00;
+const int Amask = 0x000000ff;
+#endif
+#define Vclip( x )	( (x > 0) ? ((x < 255) ? x : 255) : 0 )
+
+/// Converts a pixel, with U and V less 128, to RGBA.
+static inline uint32_t yuvToRGBA(int Y, int U, int V)
+{
+	const int A = 298 * (Y - 16);
+	const int C = 409 * V;
+
+	const int R = Vclip((A + C + 128) >> 8);
+	const int G = Vclip((A - 100 * U - (C >> 1) + 128) >> 8);
+	const int B = Vclip((A + 516 * U + 128) >> 8);
+
+	return (R << Rshift) | (G << Gshift) | (B << Bshift) | (0xFF << Ashift);
+}
+
+#ifdef SEQ_SSE2
+/// Converts eight pixels at a time, with the same results as yuvToRGBA. Returns how many pixels were converted.
+int convertRowSSE2(const unsigned char *y, const unsigned char *u, const unsigned char *v, uint32_t *out, int width);
+#endif
+
+#endif // __INCLUDED_LIB_SEQUENCE_YUV_H__
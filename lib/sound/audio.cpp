@@ -29,9 +29,16 @@
 #include "audio_id.h"
 #include "openal_error.h"
 #include "mixer.h"
+
+#include <algorithm>
+#include <vector>
+
 // defines
 #define NO_SAMPLE				- 2
 #define MAX_SAME_SAMPLES		2
+#define MAX_3D_VOICES			32		// 3D samples playing at once, quieter ones are culled beyond this, except looping ones
+#define MERGE_RADIUS			256		// a sample of a track started this close to another one ...
+#define MERGE_TIME				100		// ... this many ms after it is heard as the same sound, and not played
 
 // global variables
 static AUDIO_SAMPLE *g_psSampleList = nullptr;
@@ -41,6 +48,15 @@ static bool			g_bAudioPaused = false;
 static AUDIO_SAMPLE g_sPreviousSample;
 static int			g_iPreviousSampleTime = 0;
 
+// The samples in g_psSampleList by track ID, the 3D voices taken, and the 3D samples not played or stopped for the budget
+static std::vector<std::vector<AUDIO_SAMPLE *>> g_apsTrackSamples;
+static unsigned int	g_i3DVoices = 0;
+static unsigned int	g_iCulledVoices = 0;
+
+// Where the listener was, and the effects volume, when the sample positions were last updated
+static Vector3f		g_sLastPlayerPos(0.f, 0.f, 0.f);
+static float		g_fLastEffectsVolume = -1.f;
+
 /** Counts the number of samples in the SampleQueue
  *  \return the number of samples in the SampleQueue
  */
@@ -82,6 +98,14 @@ unsigned int audio_GetSampleListCount()
 
 	return count;
 }
+/** Counts the 3D samples not played, or stopped, to stay within the voice budget
+ *  \return the number of samples culled since the audio system started
+ */
+unsigned int audio_GetCulledVoiceCount()
+{
+	return g_iCulledVoices;
+}
+
 //*
 // =======================================================================================================================
 // =======================================================================================================================
@@ -155,6 +179,8 @@ bool audio_Shutdown(void)
 	// free sample heap
 	g_psSampleList = nullptr;
 	g_psSampleQueue = nullptr;
+	g_apsTrackSamples.clear();
+	g_i3DVoices = 0;
 
 	return bOK;
 }
@@ -282,6 +308,42 @@ static void audio_RemoveSample(AUDIO_SAMPLE **ppsSampleList, AUDIO_SAMPLE *psSam
 	psSample->psNext = nullptr;
 }
 
+/** Adds a sample which started playing to g_psSampleList, and indexes it by track
+ */
+static void audio_AddPlayingSample(AUDIO_SAMPLE *psSample)
+{
+	audio_AddSampleToHead(&g_psSampleList, psSample);
+
+	if (psSample->iTrack >= (SDWORD)g_apsTrackSamples.size())
+	{
+		g_apsTrackSamples.resize(psSample->iTrack + 1);
+	}
+	g_apsTrackSamples[psSample->iTrack].push_back(psSample);
+
+	if (psSample->b3D)
+	{
+		++g_i3DVoices;
+	}
+}
+
+/** Removes a sample from g_psSampleList, and its index, but doesn't free its memory
+ */
+static void audio_RemovePlayingSample(AUDIO_SAMPLE *psSample)
+{
+	audio_RemoveSample(&g_psSampleList, psSample);
+
+	std::vector<AUDIO_SAMPLE *> &samples = g_apsTrackSamples[psSample->iTrack];
+	std::vector<AUDIO_SAMPLE *>::iterator it = std::find(samples.begin(), samples.end(), psSample);
+	ASSERT_OR_RETURN(, it != samples.end(), "Sample of track %d not indexed", psSample->iTrack);
+	*it = samples.back();
+	samples.pop_back();
+
+	if (psSample->b3D && !psSample->bCulled)
+	{
+		--g_i3DVoices;
+	}
+}
+
 //*
 // =======================================================================================================================
 // =======================================================================================================================
@@ -530,7 +592,7 @@ static void audio_UpdateQueue(void)
 		return;
 	}
 
-	audio_AddSampleToHead(&g_psSampleList, psSample);
+	audio_AddPlayingSample(psSample);
 
 	// update last queue sound coords
 	if (psSample->x != SAMPLE_COORD_INVALID && psSample->y != SAMPLE_COORD_INVALID
@@ -568,6 +630,11 @@ void audio_Update()
 	sound_SetPlayerPos(playerPos);
 	sound_SetPlayerOrientation(angle);
 
+	// Gains only need computing again for samples which moved, unless the listener moved or the volume changed
+	const bool bListenerMoved = playerPos != g_sLastPlayerPos || sound_GetEffectsVolume() != g_fLastEffectsVolume;
+	g_sLastPlayerPos = playerPos;
+	g_fLastEffectsVolume = sound_GetEffectsVolume();
+
 	// loop through 3D sounds and remove if finished or update position
 	psSample = g_psSampleList;
 	while (psSample != nullptr)
@@ -576,7 +643,7 @@ void audio_Update()
 		if (psSample->bFinishedPlaying == true)
 		{
 			psSampleTemp = psSample->psNext;
-			audio_RemoveSample(&g_psSampleList, psSample);
+			audio_RemovePlayingSample(psSample);
 			free(psSample);
 			psSample = psSampleTemp;
 		}
@@ -594,8 +661,16 @@ void audio_Update()
 				}
 				else	// update sample position
 				{
-					audio_GetObjectPos(psSample->psObj, &psSample->x, &psSample->y, &psSample->z);
-					sound_SetObjectPosition(psSample);
+					SDWORD iX, iY, iZ;
+
+					audio_GetObjectPos(psSample->psObj, &iX, &iY, &iZ);
+					if (bListenerMoved || iX != psSample->x || iY != psSample->y || iZ != psSample->z)
+					{
+						psSample->x = iX;
+						psSample->y = iY;
+						psSample->z = iZ;
+						sound_SetObjectPosition(psSample);
+					}
 				}
 			}
 			// next sample
@@ -630,7 +705,7 @@ unsigned int audio_SetTrackVals(const char *fileName, bool loop, unsigned int vo
 //
 //
 // * audio_CheckSame3DTracksPlaying Reject samples if too many already playing in
-// * same area
+// * same area, or if one was just started at about the same place
 //
 
 //*
@@ -641,8 +716,7 @@ static bool audio_CheckSame3DTracksPlaying(SDWORD iTrack, SDWORD iX, SDWORD iY,
 {
 	//~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
 	SDWORD			iCount, iDx, iDy, iDz, iDistSq, iMaxDistSq, iRad;
-	AUDIO_SAMPLE	*psSample = nullptr;
-	bool			bOK = true;
+	bool			bMerge;
 	//~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
 
 	// return if audio not enabled
@@ -651,36 +725,93 @@ static bool audio_CheckSame3DTracksPlaying(SDWORD iTrack, SDWORD iX, SDWORD iY,
 		return true;
 	}
 
+	if (iTrack >= (SDWORD)g_apsTrackSamples.size())
+	{
+		return true;
+	}
+
 	iCount = 0;
+	iRad = sound_GetTrackAudibleRadius(iTrack);
+	iMaxDistSq = iRad * iRad;
+	// Looping samples are kept apart, each belongs to its own object
+	bMerge = !sound_TrackLooped(iTrack);
 
-	// loop through 3D sounds and check whether too many already in earshot
-	psSample = g_psSampleList;
-	while (psSample != nullptr)
+	// loop through 3D sounds of this track and check whether too many already in earshot
+	for (AUDIO_SAMPLE *psSample : g_apsTrackSamples[iTrack])
 	{
-		if (psSample->iTrack == iTrack)
+		if (!psSample->b3D || psSample->bCulled)
 		{
-			iDx = iX - psSample->x;
-			iDy = iY - psSample->y;
-			iDz = iZ - psSample->z;
-			iDistSq = (iDx * iDx) + (iDy * iDy) + (iDz * iDz);
-			iRad = sound_GetTrackAudibleRadius(iTrack);
-			iMaxDistSq = iRad * iRad;
-			if (iDistSq < iMaxDistSq)
-			{
-				iCount++;
-			}
+			continue;
+		}
 
-			if (iCount > MAX_SAME_SAMPLES)
-			{
-				bOK = false;
-				break;
-			}
+		iDx = iX - psSample->x;
+		iDy = iY - psSample->y;
+		iDz = iZ - psSample->z;
+		iDistSq = (iDx * iDx) + (iDy * iDy) + (iDz * iDz);
+		if (bMerge && iDistSq < MERGE_RADIUS * MERGE_RADIUS && realTime - psSample->iStartTime < MERGE_TIME)
+		{
+			return false;
+		}
+		if (iDistSq < iMaxDistSq)
+		{
+			iCount++;
 		}
 
-		psSample = psSample->psNext;
+		if (iCount > MAX_SAME_SAMPLES)
+		{
+			return false;
+		}
 	}
 
-	return bOK;
+	return true;
+}
+
+/** How much a 3D sample deserves a voice: how loud the listener hears it
+ */
+static float audio_VoiceScore(SDWORD iTrack, SDWORD iX, SDWORD iY, SDWORD iZ, const Vector3f &listener)
+{
+	const float dX = (float)iX - listener.x;
+	const float dY = (float)iY - listener.y;
+	const float dZ = (float)iZ - listener.z;
+	const float gain = 1.0f - sqrtf(dX * dX + dY * dY + dZ * dZ) * ATTENUATION_FACTOR;
+
+	return std::max(gain, 0.0f) * sound_GetTrackVolume(iTrack);
+}
+
+/** Frees a 3D voice for a new sample, by stopping the quietest 3D sample, if that is quieter than the new one
+ *  Looping samples are never stopped, as nothing would start them again.
+ *  \param fScore the audio_VoiceScore of the new sample
+ *  \return true if a voice was freed
+ */
+static bool audio_Free3DVoice(float fScore, const Vector3f &listener)
+{
+	AUDIO_SAMPLE	*psQuietest = nullptr;
+	float			fQuietest = fScore;
+
+	for (AUDIO_SAMPLE *psSample = g_psSampleList; psSample != nullptr; psSample = psSample->psNext)
+	{
+		if (!psSample->b3D || psSample->bCulled || psSample->bFinishedPlaying || sound_TrackLooped(psSample->iTrack))
+		{
+			continue;
+		}
+		const float fSampleScore = audio_VoiceScore(psSample->iTrack, psSample->x, psSample->y, psSample->z, listener);
+		if (fSampleScore < fQuietest)
+		{
+			psQuietest = psSample;
+			fQuietest = fSampleScore;
+		}
+	}
+	if (psQuietest == nullptr)
+	{
+		return false;
+	}
+
+	// audio_Update frees it once stopped
+	psQuietest->bCulled = true;
+	--g_i3DVoices;
+	++g_iCulledVoices;
+	sound_StopTrack(psQuietest);
+	return true;
 }
 
 //*
@@ -691,9 +822,7 @@ static bool audio_Play3DTrack(SDWORD iX, SDWORD iY, SDWORD iZ, int iTrack, SIMPL
 {
 	AUDIO_SAMPLE	*psSample;
 	// coordinates
-	float	listenerX = .0f, listenerY = .0f, listenerZ = .0f, dX, dY, dZ;
-	// calculation results
-	float	distance, gain;
+	Vector3f listener(0.f, 0.f, 0.f);
 	ALenum err;
 
 	// if audio not enabled return true to carry on game without audio
@@ -704,35 +833,31 @@ static bool audio_Play3DTrack(SDWORD iX, SDWORD iY, SDWORD iZ, int iTrack, SIMPL
 
 	if (audio_CheckSame3DTracksPlaying(iTrack, iX, iY, iZ) == false)
 	{
+		++g_iCulledVoices;
 		return false;
 	}
 
 	// compute distance
 	// NOTE, if this call fails, expect garbage
-	alGetListener3f(AL_POSITION, &listenerX, &listenerY, &listenerZ);
+	alGetListener3f(AL_POSITION, &listener.x, &listener.y, &listener.z);
 	err = sound_GetError();
 	if (err != AL_NO_ERROR)
 	{
 		return false;
 	}
-	dX = (float)iX - listenerX; // distances on all axis
-	dY = (float)iY - listenerY;
-	dZ = (float)iZ - listenerZ;
-	distance = sqrtf(dX * dX + dY * dY + dZ * dZ); // Pythagorean theorem
 
-	// compute gain
-	gain = (1.0 - (distance * ATTENUATION_FACTOR)) ;//* 1.0f * sfx3d_volume
-	if (gain > 1.0f)
-	{
-		gain = 1.0f;
-	}
-	if (gain < 0.0f)
+	// don't bother adding samples that we can't hear
+	const float fScore = audio_VoiceScore(iTrack, iX, iY, iZ, listener);
+	if (fScore == 0.0f)
 	{
-		gain = 0.0f;
+		++g_iCulledVoices;
+		return false;
 	}
-	// don't bother adding samples that we can't hear
-	if (gain == 0.0f)
+
+	// take a voice from a quieter sample, if there are none left, but always play looping samples, which only start once
+	if (g_i3DVoices >= MAX_3D_VOICES && !sound_TrackLooped(iTrack) && !audio_Free3DVoice(fScore, listener))
 	{
+		++g_iCulledVoices;
 		return false;
 	}
 
@@ -750,6 +875,8 @@ static bool audio_Play3DTrack(SDWORD iX, SDWORD iY, SDWORD iZ, int iTrack, SIMPL
 	psSample->y = iY;
 	psSample->z = iZ;
 	psSample->bFinishedPlaying = false;
+	psSample->b3D = true;
+	psSample->iStartTime = realTime;
 	psSample->psObj = psObj;
 	psSample->pCallback = pUserCallback;
 
@@ -761,7 +888,7 @@ static bool audio_Play3DTrack(SDWORD iX, SDWORD iY, SDWORD iZ, int iTrack, SIMPL
 		return false;
 	}
 
-	audio_AddSampleToHead(&g_psSampleList, psSample);
+	audio_AddPlayingSample(psSample);
 	return true;
 }
 
@@ -900,29 +1027,26 @@ AUDIO_STREAM *audio_PlayStream(const char *fileName, float volume, void (*onFini
 //
 void audio_StopObjTrack(SIMPLE_OBJECT *psObj, int iTrack)
 {
-	//~~~~~~~~~~~~~~~~~~~~~~
-	AUDIO_SAMPLE	*psSample;
-	//~~~~~~~~~~~~~~~~~~~~~~
-
 	// return if audio not enabled
 	if (g_bAudioEnabled == false)
 	{
 		return;
 	}
 
-	// find sample
-	psSample = g_psSampleList;
-	while (psSample != nullptr)
+	if (iTrack < 0 || iTrack >= (int)g_apsTrackSamples.size())
+	{
+		return;
+	}
+
+	// find sample among those of the track
+	for (AUDIO_SAMPLE *psSample : g_apsTrackSamples[iTrack])
 	{
 		// If track has been found stop it and return
-		if (psSample->psObj == psObj && psSample->iTrack == iTrack)
+		if (psSample->psObj == psObj)
 		{
 			sound_StopTrack(psSample);
 			return;
 		}
-
-		// get next sample from linked list
-		psSample = psSample->psNext;
 	}
 }
 
@@ -957,6 +1081,9 @@ void audio_PlayTrack(int iTrack)
 	// setup/initialize sample
 	psSample->iTrack = iTrack;
 	psSample->bFinishedPlaying = false;
+	psSample->b3D = false;
+	psSample->bCulled = false;
+	psSample->iStartTime = realTime;
 
 	// Zero callback stuff since we don't need/want it
 	psSample->pCallback = nullptr;
@@ -975,7 +1102,7 @@ void audio_PlayTrack(int iTrack)
 		return;
 	}
 
-	audio_AddSampleToHead(&g_psSampleList, psSample);
+	audio_AddPlayingSample(psSample);
 }
 
 //*
@@ -1164,7 +1291,7 @@ void audio_RemoveObj(SIMPLE_OBJECT const *psObj)
 			sound_RemoveActiveSample(toRemove);   //remove from global active list.
 
 			// Perform the actual task of destroying this sample
-			audio_RemoveSample(&g_psSampleList, toRemove);
+			audio_RemovePlayingSample(toRemove);
 			free(toRemove);
 
 			// Increment the deletion count
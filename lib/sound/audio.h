@@ -55,6 +55,7 @@ SDWORD audio_GetTrackID(const char *fileName);
 void audio_RemoveObj(SIMPLE_OBJECT const *psObj);
 unsigned int audio_GetSampleQueueCount();
 unsigned int audio_GetSampleListCount();
+unsigned int audio_GetCulledVoiceCount();
 unsigned int sound_GetActiveSamplesCount();
 
 #endif // __INCLUDED_LIB_SOUND_AUDIO_H__
@@ -0,0 +1,157 @@
+/*
+	This file is part of Warzone 2100.
+	Copyright (C) 2005-2017  Warzone 2100 Project
+
+	Warzone 2100 is free software; you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation; either version 2 of the License, or
+	(at your option) any later version.
+
+	Warzone 2100 is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with Warzone 2100; if not, write to the Free Software
+	Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301 USA
+*/
+/** @file
+ *  Sound decoding thread, see decodethread.h.
+ */
+
+#include "lib/framework/frame.h"
+#include "lib/framework/wzapp.h"
+
+#include <QtCore/QElapsedTimer>
+#include <atomic>
+
+#include "decodethread.h"
+#include "oggvorbis.h"
+
+// Jobs queued and not yet taken back. Both queues have room for all of them, so neither can overflow.
+#define DECODE_QUEUE_SIZE	64
+
+/// A fixed size queue, safe with one thread pushing and one other thread popping.
+struct DECODE_QUEUE
+{
+	DECODE_JOB              jobs[DECODE_QUEUE_SIZE];
+	std::atomic<unsigned>   head;   ///< Next job to pop, only written by the popping thread.
+	std::atomic<unsigned>   tail;   ///< Next free slot, only written by the pushing thread.
+};
+
+static DECODE_QUEUE requests;   // Frame thread to decode thread.
+static DECODE_QUEUE results;    // Decode thread to frame thread.
+static unsigned jobsInFlight = 0;
+
+static WZ_THREAD *decodeThread = nullptr;
+static WZ_SEMAPHORE *requestSemaphore = nullptr;  // Posted once per request, and once to quit.
+static WZ_SEMAPHORE *resultSemaphore = nullptr;   // Posted once per result.
+
+static void queuePush(DECODE_QUEUE &queue, const DECODE_JOB &job)
+{
+	const unsigned tail = queue.tail.load(std::memory_order_relaxed);
+	ASSERT(tail - queue.head.load(std::memory_order_acquire) < DECODE_QUEUE_SIZE, "Decode queue overflow");
+	queue.jobs[tail % DECODE_QUEUE_SIZE] = job;
+	queue.tail.store(tail + 1, std::memory_order_release);
+}
+
+static bool queuePop(DECODE_QUEUE &queue, DECODE_JOB *job)
+{
+	const unsigned head = queue.head.load(std::memory_order_relaxed);
+	if (head == queue.tail.load(std::memory_order_acquire))
+	{
+		return false;
+	}
+	*job = queue.jobs[head % DECODE_QUEUE_SIZE];
+	queue.head.store(head + 1, std::memory_order_release);
+	return true;
+}
+
+void sound_RunDecode(DECODE_JOB *job)
+{
+	QElapsedTimer timer;
+	timer.start();
+	job->result = sound_DecodeOggVorbis(job->decoder, job->bufferSize);
+	job->decodeTime = timer.nsecsElapsed();
+}
+
+static int decodeThreadFunc(WZ_DECL_UNUSED void *data)
+{
+	while (true)
+	{
+		wzSemaphoreWait(requestSemaphore);
+		DECODE_JOB job;
+		if (!queuePop(requests, &job))
+		{
+			// Every request posts once before the quit post, so an empty queue means quitting.
+			break;
+		}
+		sound_RunDecode(&job);
+		queuePush(results, job);
+		wzSemaphorePost(resultSemaphore);
+	}
+	return 0;
+}
+
+void sound_StartDecodeThread()
+{
+	if (decodeThread != nullptr)
+	{
+		return;
+	}
+	requestSemaphore = wzSemaphoreCreate(0);
+	resultSemaphore = wzSemaphoreCreate(0);
+	decodeThread = wzThreadCreate(decodeThreadFunc, nullptr);
+	wzThreadStart(decodeThread);
+}
+
+void sound_StopDecodeThread()
+{
+	if (decodeThread == nullptr)
+	{
+		return;
+	}
+	wzSemaphorePost(requestSemaphore);  // Wake up the thread, so it can quit.
+	wzThreadJoin(decodeThread);
+	decodeThread = nullptr;
+	wzSemaphoreDestroy(requestSemaphore);
+	requestSemaphore = nullptr;
+	wzSemaphoreDestroy(resultSemaphore);
+	resultSemaphore = nullptr;
+}
+
+bool sound_QueueDecode(const DECODE_JOB &job)
+{
+	if (decodeThread == nullptr || jobsInFlight >= DECODE_QUEUE_SIZE)
+	{
+		return false;
+	}
+	++jobsInFlight;
+	queuePush(requests, job);
+	wzSemaphorePost(requestSemaphore);
+	return true;
+}
+
+bool sound_TakeDecoded(DECODE_JOB *job)
+{
+	if (!queuePop(results, job))
+	{
+		return false;
+	}
+	--jobsInFlight;
+	return true;
+}
+
+void sound_WaitDecoded()
+{
+	ASSERT_OR_RETURN(, jobsInFlight > 0, "Nothing to wait for");
+	if (decodeThread == nullptr)
+	{
+		// Stopped, so everything queued has been decoded.
+		return;
+	}
+	// Results taken without waiting leave their posts behind, so this may return early, which only costs the caller
+	// another look at the results.
+	wzSemaphoreWait(resultSemaphore);
+}
@@ -0,0 +1,61 @@
+/*
+	This file is part of Warzone 2100.
+	Copyright (C) 2005-2017  Warzone 2100 Project
+
+	Warzone 2100 is free software; you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation; either version 2 of the License, or
+	(at your option) any later version.
+
+	Warzone 2100 is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with Warzone 2100; if not, write to the Free Software
+	Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301 USA
+*/
+/** @file
+ *  Decodes sound on a thread of its own, so the frame thread only hands over decoders and takes back PCM data.
+ *
+ *  Jobs go to the thread and come back through two lock-free single producer, single consumer queues. Only the
+ *  frame thread queues and takes jobs.
+ */
+
+#ifndef __INCLUDED_LIB_SOUND_DECODETHREAD_H__
+#define __INCLUDED_LIB_SOUND_DECODETHREAD_H__
+
+#include "lib/framework/frame.h"
+
+struct AUDIO_STREAM;
+struct OggVorbisDecoderState;
+struct TRACK;
+struct soundDataBuffer;
+
+struct DECODE_JOB
+{
+	OggVorbisDecoderState *decoder;   ///< Not used by anything else until the job is taken back.
+	size_t          bufferSize;       ///< Bytes to decode, 0 for all that is left.
+	TRACK          *track;            ///< What the data is for, one of these is set.
+	AUDIO_STREAM   *stream;
+	soundDataBuffer *result;          ///< The decoded data, NULL if decoding failed.
+	int64_t         decodeTime;       ///< Nanoseconds spent decoding.
+};
+
+void sound_StartDecodeThread();
+/// Stops the thread after it has decoded everything queued. The decoded jobs are left to be taken.
+void sound_StopDecodeThread();
+
+/// Hands job to the decode thread. Returns false if the thread is not running or has too many jobs, in which case
+/// the job can be run with sound_RunDecode instead.
+bool sound_QueueDecode(const DECODE_JOB &job);
+/// Takes a decoded job back, if there is one. Does not wait.
+bool sound_TakeDecoded(DECODE_JOB *job);
+/// Waits until a job may have been decoded. Only call while a job is queued.
+void sound_WaitDecoded();
+
+/// Decodes the job on the calling thread.
+void sound_RunDecode(DECODE_JOB *job);
+
+#endif // __INCLUDED_LIB_SOUND_DECODETHREAD_H__
@@ -18,7 +18,10 @@
 */
 
 #include "lib/framework/frame.h"
+#include "lib/framework/wzapp.h"
 #include <physfs.h>
+#include <algorithm>
+#include <vector>
 
 #include <vorbis/vorbisfile.h>
 #include <vorbis/codec.h>
@@ -31,11 +34,26 @@
 
 #include "oggvorbis.h"
 
+// Decoded buffers are kept for reuse in lists by size class, powers of two from 1 << SOUND_POOL_MIN_SHIFT bytes. Buffers
+// of whole tracks are released as soon as OpenAL has copied them, so the next track decoded can take the same memory.
+#define SOUND_POOL_MIN_SHIFT	12
+#define SOUND_POOL_CLASSES	14		// Up to 32 MiB, larger buffers are not kept.
+#define SOUND_POOL_MAX_KEPT	(16 * 1024 * 1024)
+
+static wz::mutex poolMutex;
+static std::vector<soundDataBuffer *> poolBuffers[SOUND_POOL_CLASSES];
+static size_t poolKept = 0;
+
 struct OggVorbisDecoderState
 {
-	// Internal identifier towards PhysicsFS
+	// Internal identifier towards PhysicsFS, or NULL when decoding from memory
 	PHYSFS_file *fileHandle;
 
+	// The file in memory, when not decoding from PhysicsFS
+	const char  *data;
+	size_t       dataSize;
+	size_t       dataPos;
+
 	// Wether to allow seeking or not
 	bool         allowSeeking;
 
@@ -77,6 +95,49 @@ static const char *wz_oggVorbis_getErrorStr(int error)
 	}
 }
 
+static size_t wz_oggVorbis_readMemory(void *ptr, size_t size, size_t nmemb, void *datasource)
+{
+	struct OggVorbisDecoderState *decoder = (struct OggVorbisDecoderState *)datasource;
+
+	size_t length = std::min(size * nmemb, decoder->dataSize - decoder->dataPos);
+	memcpy(ptr, decoder->data + decoder->dataPos, length);
+	decoder->dataPos += length;
+	return length;
+}
+
+static int wz_oggVorbis_seekMemory(void *datasource, ogg_int64_t offset, int whence)
+{
+	struct OggVorbisDecoderState *decoder = (struct OggVorbisDecoderState *)datasource;
+	ogg_int64_t newPos;
+
+	switch (whence)
+	{
+	case SEEK_SET:
+		newPos = offset;
+		break;
+	case SEEK_CUR:
+		newPos = decoder->dataPos + offset;
+		break;
+	case SEEK_END:
+		newPos = decoder->dataSize + offset;
+		break;
+	default:
+		return -1;
+	}
+
+	if (newPos < 0 || newPos > (ogg_int64_t)decoder->dataSize)
+	{
+		return -1;
+	}
+	decoder->dataPos = newPos;
+	return 0;
+}
+
+static long wz_oggVorbis_tellMemory(void *datasource)
+{
+	return ((struct OggVorbisDecoderState *)datasource)->dataPos;
+}
+
 static size_t wz_oggVorbis_read(void *ptr, size_t size, size_t nmemb, void *datasource)
 {
 	PHYSFS_file *fileHandle;
@@ -84,6 +145,10 @@ static size_t wz_oggVorbis_read(void *ptr, size_t size, size_t nmemb, void *data
 	ASSERT(datasource != nullptr, "NULL decoder passed!");
 
 	fileHandle = ((struct OggVorbisDecoderState *)datasource)->fileHandle;
+	if (fileHandle == nullptr)
+	{
+		return wz_oggVorbis_readMemory(ptr, size, nmemb, datasource);
+	}
 	ASSERT(fileHandle != nullptr, "Bad PhysicsFS file handle passed in");
 
 	return PHYSFS_read(fileHandle, ptr, 1, size * nmemb);
@@ -98,7 +163,6 @@ static int wz_oggVorbis_seek(void *datasource, ogg_int64_t offset, int whence)
 	ASSERT(datasource != nullptr, "NULL decoder passed!");
 
 	fileHandle = ((struct OggVorbisDecoderState *)datasource)->fileHandle;
-	ASSERT(fileHandle != nullptr, "Bad PhysicsFS file handle passed in");
 
 	allowSeeking = ((struct OggVorbisDecoderState *)datasource)->allowSeeking;
 
@@ -107,6 +171,11 @@ static int wz_oggVorbis_seek(void *datasource, ogg_int64_t offset, int whence)
 		return -1;
 	}
 
+	if (fileHandle == nullptr)
+	{
+		return wz_oggVorbis_seekMemory(datasource, offset, whence);
+	}
+
 	switch (whence)
 	{
 	// Seek to absolute position
@@ -169,7 +238,10 @@ static long wz_oggVorbis_tell(void *datasource)
 	ASSERT(datasource != nullptr, "NULL decoder passed!");
 
 	fileHandle = ((struct OggVorbisDecoderState *)datasource)->fileHandle;
-	ASSERT(fileHandle != nullptr, "Bad PhysicsFS file handle passed in");
+	if (fileHandle == nullptr)
+	{
+		return wz_oggVorbis_tellMemory(datasource);
+	}
 
 	return PHYSFS_tell(fileHandle);
 }
@@ -182,7 +254,7 @@ static const ov_callbacks wz_oggVorbis_callbacks =
 	wz_oggVorbis_tell
 };
 
-struct OggVorbisDecoderState *sound_CreateOggVorbisDecoder(PHYSFS_file *PHYSFS_fileHandle, bool allowSeeking)
+static struct OggVorbisDecoderState *sound_OpenOggVorbisDecoder(PHYSFS_file *PHYSFS_fileHandle, const char *data, size_t size, bool allowSeeking)
 {
 	int error;
 
@@ -194,9 +266,10 @@ struct OggVorbisDecoderState *sound_CreateOggVorbisDecoder(PHYSFS_file *PHYSFS_f
 		return nullptr;
 	}
 
-	ASSERT(PHYSFS_fileHandle != nullptr, "Bad PhysicsFS file handle passed in");
-
 	decoder->fileHandle = PHYSFS_fileHandle;
+	decoder->data = data;
+	decoder->dataSize = size;
+	decoder->dataPos = 0;
 	decoder->allowSeeking = allowSeeking;
 
 	error = ov_open_callbacks(decoder, &decoder->oggVorbis_stream, nullptr, 0, wz_oggVorbis_callbacks);
@@ -213,6 +286,20 @@ struct OggVorbisDecoderState *sound_CreateOggVorbisDecoder(PHYSFS_file *PHYSFS_f
 	return decoder;
 }
 
+struct OggVorbisDecoderState *sound_CreateOggVorbisDecoder(PHYSFS_file *PHYSFS_fileHandle, bool allowSeeking)
+{
+	ASSERT(PHYSFS_fileHandle != nullptr, "Bad PhysicsFS file handle passed in");
+
+	return sound_OpenOggVorbisDecoder(PHYSFS_fileHandle, nullptr, 0, allowSeeking);
+}
+
+struct OggVorbisDecoderState *sound_CreateOggVorbisMemoryDecoder(const char *data, size_t size)
+{
+	ASSERT(data != nullptr, "NULL data passed in");
+
+	return sound_OpenOggVorbisDecoder(nullptr, data, size, true);
+}
+
 void sound_DestroyOggVorbisDecoder(struct OggVorbisDecoderState *decoder)
 {
 	ASSERT(decoder != nullptr, "NULL decoder passed!");
@@ -255,6 +342,95 @@ static inline unsigned int getCurrentSample(struct OggVorbisDecoderState *decode
 	return samplePos;
 }
 
+/// The size class of a buffer with room for bufferSize bytes of data, SOUND_POOL_CLASSES if it is too large to keep.
+static unsigned poolClass(size_t bufferSize)
+{
+	const size_t size = bufferSize + sizeof(soundDataBuffer);
+	unsigned sizeClass = 0;
+	while (sizeClass < SOUND_POOL_CLASSES && ((size_t)1 << (sizeClass + SOUND_POOL_MIN_SHIFT)) < size)
+	{
+		++sizeClass;
+	}
+	return sizeClass;
+}
+
+static soundDataBuffer *allocSoundDataBuffer(size_t bufferSize)
+{
+	const unsigned sizeClass = poolClass(bufferSize);
+	soundDataBuffer *buffer = nullptr;
+
+	if (sizeClass < SOUND_POOL_CLASSES)
+	{
+		{
+			std::lock_guard<wz::mutex> lock(poolMutex);
+			if (!poolBuffers[sizeClass].empty())
+			{
+				buffer = poolBuffers[sizeClass].back();
+				poolBuffers[sizeClass].pop_back();
+				poolKept -= (size_t)1 << (sizeClass + SOUND_POOL_MIN_SHIFT);
+			}
+		}
+		if (buffer == nullptr)
+		{
+			buffer = (soundDataBuffer *)malloc((size_t)1 << (sizeClass + SOUND_POOL_MIN_SHIFT));
+		}
+	}
+	else
+	{
+		buffer = (soundDataBuffer *)malloc(bufferSize + sizeof(soundDataBuffer));
+	}
+	if (buffer == nullptr)
+	{
+		return nullptr;
+	}
+
+	buffer->data = (char *)(buffer + 1);
+	buffer->bufferSize = bufferSize;
+	return buffer;
+}
+
+void sound_FreeSoundDataBuffer(soundDataBuffer *buffer)
+{
+	if (buffer == nullptr)
+	{
+		return;
+	}
+
+	const unsigned sizeClass = poolClass(buffer->bufferSize);
+	if (sizeClass < SOUND_POOL_CLASSES)
+	{
+		const size_t size = (size_t)1 << (sizeClass + SOUND_POOL_MIN_SHIFT);
+		std::lock_guard<wz::mutex> lock(poolMutex);
+		if (poolKept + size <= SOUND_POOL_MAX_KEPT)
+		{
+			poolBuffers[sizeClass].push_back(buffer);
+			poolKept += size;
+			return;
+		}
+	}
+	free(buffer);
+}
+
+void sound_TrimSoundDataBuffers()
+{
+	std::lock_guard<wz::mutex> lock(poolMutex);
+	for (std::vector<soundDataBuffer *> &buffers : poolBuffers)
+	{
+		for (soundDataBuffer *buffer : buffers)
+		{
+			free(buffer);
+		}
+		buffers.clear();
+	}
+	poolKept = 0;
+}
+
+size_t sound_GetSoundDataPoolSize()
+{
+	std::lock_guard<wz::mutex> lock(poolMutex);
+	return poolKept;
+}
+
 soundDataBuffer *sound_DecodeOggVorbis(struct OggVorbisDecoderState *decoder, size_t bufferSize)
 {
 	size_t		size = 0;
@@ -283,15 +459,13 @@ soundDataBuffer *sound_DecodeOggVorbis(struct OggVorbisDecoderState *decoder, si
 		return nullptr;
 	}
 
-	buffer = (soundDataBuffer *)malloc(bufferSize + sizeof(soundDataBuffer));
+	buffer = allocSoundDataBuffer(bufferSize);
 	if (buffer == nullptr)
 	{
 		debug(LOG_ERROR, "couldn't allocate memory (%lu bytes requested)", (unsigned long) bufferSize + sizeof(soundDataBuffer));
 		return nullptr;
 	}
 
-	buffer->data = (char *)(buffer + 1);
-	buffer->bufferSize = bufferSize;
 	buffer->bitsPerSample = 16;
 
 	buffer->channelCount = decoder->VorbisInfo->channels;
@@ -307,7 +481,7 @@ soundDataBuffer *sound_DecodeOggVorbis(struct OggVorbisDecoderState *decoder, si
 		if (result < 0)
 		{
 			debug(LOG_ERROR, "error decoding from OggVorbis file; errorcode from ov_read: %s", wz_oggVorbis_getErrorStr(result));
-			free(buffer);
+			sound_FreeSoundDataBuffer(buffer);
 			return nullptr;
 		}
 		else
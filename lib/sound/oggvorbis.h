@@ -28,7 +28,7 @@ struct soundDataBuffer
 	// the size of the data contained in *data (NOTE: this is *NOT* the size of *data itself)
 	size_t size;
 
-	// the size of the buffer *data points to plus sizeof(soundDataBuffer)
+	// the size of the buffer *data points to
 	size_t bufferSize;
 
 	unsigned int bitsPerSample;
@@ -43,8 +43,19 @@ struct soundDataBuffer
 struct OggVorbisDecoderState;
 
 struct OggVorbisDecoderState *sound_CreateOggVorbisDecoder(PHYSFS_file *PHYSFS_fileHandle, bool allowSeeking);
+/// Decodes an Ogg Vorbis file already read into memory. The data must stay valid until the decoder is destroyed.
+struct OggVorbisDecoderState *sound_CreateOggVorbisMemoryDecoder(const char *data, size_t size);
 void sound_DestroyOggVorbisDecoder(struct OggVorbisDecoderState *decoder);
 
+/// Decodes up to bufferSize bytes, or all that is left if bufferSize is 0. Safe to call from any thread, with a
+/// decoder used by one thread at a time. Release the buffer with sound_FreeSoundDataBuffer.
 soundDataBuffer *sound_DecodeOggVorbis(struct OggVorbisDecoderState *decoder, size_t bufferSize);
 
+/// Releases a decoded buffer, keeping its memory for later buffers of about the same size. Safe to call from any thread.
+void sound_FreeSoundDataBuffer(soundDataBuffer *buffer);
+/// Frees the memory kept for later buffers.
+void sound_TrimSoundDataBuffers();
+/// Bytes kept for later buffers.
+size_t sound_GetSoundDataPoolSize();
+
 #endif // _LIBSOUND_OGGVORBIS_H_
@@ -38,14 +38,20 @@
 #include <physfs.h>
 #include <string.h>
 #include <math.h>
+#include <algorithm>
+#include <vector>
 
 #include "tracklib.h"
 #include "audio.h"
 #include "cdaudio.h"
+#include "decodethread.h"
 #include "oggvorbis.h"
 #include "openal_error.h"
 #include "mixer.h"
 
+// Decoded tracks are dropped, least recently played first, while they take more than this.
+#define SOUND_TRACK_MEMORY_CAP	(64 * 1024 * 1024)
+
 static ALuint current_queue_sample = -1;
 
 static bool openal_initialized = false;
@@ -63,6 +69,11 @@ struct AUDIO_STREAM
 
 	size_t                  bufferSize;
 
+	// The next buffer, decoded ahead on the decode thread
+	soundDataBuffer        *ready;
+	bool                    decoding;      // the decoder is being used by the decode thread
+	bool                    finished;      // everything has been decoded
+
 	// Linked list pointer
 	AUDIO_STREAM           *next;
 };
@@ -70,6 +81,8 @@ struct AUDIO_STREAM
 struct SAMPLE_LIST
 {
 	AUDIO_SAMPLE   *curr;
+	TRACK          *track;
+	bool            pending;       // waiting for its track to be decoded before playing
 	SAMPLE_LIST    *next;
 };
 
@@ -82,6 +95,11 @@ static ALfloat		sfx3d_volume = 1.0;
 
 static ALCdevice *device = nullptr;
 static ALCcontext *context = nullptr;
+static Vector3f listenerPos(0.f, 0.f, 0.f);
+
+static std::vector<TRACK *> decodedTracks;
+static uint64_t playCounter = 0;
+static SOUND_DECODE_STATS decodeStats;
 
 
 /** Removes the given sample from the "active_samples" linked list
@@ -109,6 +127,20 @@ static void sound_RemoveSample(SAMPLE_LIST *previous, SAMPLE_LIST *to_remove)
 	}
 }
 
+/** Whether the given source is waiting for its track to be decoded before playing
+ */
+static bool sound_SamplePending(ALuint source)
+{
+	for (SAMPLE_LIST *node = active_samples; node != nullptr; node = node->next)
+	{
+		if (node->curr->iSample == source)
+		{
+			return node->pending;
+		}
+	}
+	return false;
+}
+
 //*
 // =======================================================================================================================
 // =======================================================================================================================
@@ -210,10 +242,13 @@ bool sound_InitLibrary(void)
 	alDistanceModel(AL_NONE);
 	sound_GetError();
 
+	sound_StartDecodeThread();
+
 	return true;
 }
 
 static void sound_UpdateStreams(void);
+static void sound_CollectDecoded();
 
 void sound_ShutdownLibrary(void)
 {
@@ -233,6 +268,15 @@ void sound_ShutdownLibrary(void)
 	}
 	sound_UpdateStreams();
 
+	// Finish decoding while there is still a context to put the tracks decoded in
+	sound_StopDecodeThread();
+	sound_CollectDecoded();
+	sound_TrimSoundDataBuffers();
+
+	const SOUND_DECODE_STATS stats = sound_GetDecodeStats();
+	debug(LOG_SOUND, "Decoded %u times in %.2f ms, worst %.2f ms, %u stream underruns, %u tracks dropped, peak track memory %u KiB",
+	      stats.decodes, stats.decodeTime / 1e6, stats.worstDecodeTime / 1e6, stats.streamUnderruns, stats.evictions, (unsigned)(stats.peakTrackMemory / 1024));
+
 	alcGetError(device);	// clear error codes
 
 	/* On Linux since this caused some versions of OpenAL to hang on exit. - Per */
@@ -312,7 +356,8 @@ void sound_Update()
 		return;
 	}
 
-	// Update all streaming audio
+	// Play what has been decoded, and update all streaming audio
+	sound_CollectDecoded();
 	sound_UpdateStreams();
 
 	while (node != nullptr)
@@ -347,6 +392,14 @@ void sound_Update()
 			continue;
 		}
 
+		// Keep samples waiting for their tracks to be decoded
+		if (state == AL_INITIAL && node->pending)
+		{
+			previous = node;
+			node = node->next;
+			continue;
+		}
+
 		switch (state)
 		{
 		case AL_PLAYING:
@@ -409,7 +462,7 @@ bool sound_QueueSamplePlaying(void)
 		return false;
 	}
 
-	if (state == AL_PLAYING)
+	if (state == AL_PLAYING || (state == AL_INITIAL && sound_SamplePending(current_queue_sample)))
 	{
 		return true;
 	}
@@ -440,68 +493,184 @@ bool sound_QueueSamplePlaying(void)
 	return false;
 }
 
-/** Decodes an opened OggVorbis file into an OpenAL buffer
- *  \param psTrack pointer to object which will contain the final buffer
- *  \param PHYSFS_fileHandle file handle given by PhysicsFS to the opened file
- *  \return on success the psTrack pointer, otherwise it will be free'd and a NULL pointer is returned instead
+/** Whether any active sample plays the given track
  */
-static inline TRACK *sound_DecodeOggVorbisTrack(TRACK *psTrack, PHYSFS_file *PHYSFS_fileHandle)
+static bool sound_TrackInUse(const TRACK *psTrack)
 {
-	ALenum		format;
-	ALuint		buffer;
-	struct OggVorbisDecoderState *decoder;
-	soundDataBuffer	*soundBuffer;
-
-	if (!openal_initialized)
+	for (SAMPLE_LIST *node = active_samples; node != nullptr; node = node->next)
 	{
-		return nullptr;
+		if (node->track == psTrack)
+		{
+			return true;
+		}
 	}
+	return false;
+}
 
-	decoder = sound_CreateOggVorbisDecoder(PHYSFS_fileHandle, true);
-	if (decoder == nullptr)
+/** Drops the OpenAL buffer of a decoded track, it will be decoded again when next played
+ */
+static void sound_DropDecodedTrack(TRACK *psTrack)
+{
+	decodedTracks.erase(std::find(decodedTracks.begin(), decodedTracks.end(), psTrack));
+	decodeStats.trackMemory -= psTrack->decodedSize;
+	psTrack->decodedSize = 0;
+
+	alDeleteBuffers(1, &psTrack->iBufferName);
+	sound_GetError();
+	psTrack->iBufferName = 0;
+}
+
+/** Drops the least recently played decoded tracks not being played, until the decoded tracks fit in
+ *  SOUND_TRACK_MEMORY_CAP
+ */
+static void sound_EvictTracks()
+{
+	while (decodeStats.trackMemory > SOUND_TRACK_MEMORY_CAP)
 	{
-		debug(LOG_WARNING, "Failed to open audio file for decoding");
-		free(psTrack);
-		return nullptr;
+		TRACK *oldest = nullptr;
+		for (TRACK *psTrack : decodedTracks)
+		{
+			if ((oldest == nullptr || psTrack->lastPlayed < oldest->lastPlayed) && !sound_TrackInUse(psTrack))
+			{
+				oldest = psTrack;
+			}
+		}
+		if (oldest == nullptr)
+		{
+			return;  // Everything left is playing.
+		}
+		debug(LOG_SOUND, "Dropping decoded track %s (%u KiB)", oldest->fileName, (unsigned)(oldest->decodedSize / 1024));
+		sound_DropDecodedTrack(oldest);
+		++decodeStats.evictions;
 	}
+}
 
-	soundBuffer = sound_DecodeOggVorbis(decoder, 0);
-	sound_DestroyOggVorbisDecoder(decoder);
+/** Puts the decoded data in an OpenAL buffer and starts the samples waiting for it
+ *  \param psTrack the track decoded
+ *  \param soundBuffer the decoded data, NULL if decoding failed
+ */
+static void sound_TrackDecoded(TRACK *psTrack, soundDataBuffer *soundBuffer)
+{
+	psTrack->decoding = false;
 
 	if (soundBuffer == nullptr)
 	{
-		free(psTrack);
-		return nullptr;
+		debug(LOG_ERROR, "Failed to decode %s", psTrack->fileName);
+		psTrack->decodeFailed = true;
 	}
+	else
+	{
+		if (soundBuffer->size == 0)
+		{
+			debug(LOG_WARNING, "OggVorbis track %s is entirely empty after decoding", psTrack->fileName);
+		}
 
-	if (soundBuffer->size == 0)
+		// Determine PCM data format
+		ALenum format = (soundBuffer->channelCount == 1) ? AL_FORMAT_MONO16 : AL_FORMAT_STEREO16;
+
+		// Create an OpenAL buffer and fill it with the decoded data
+		alGenBuffers(1, &psTrack->iBufferName);
+		sound_GetError();
+		alBufferData(psTrack->iBufferName, format, soundBuffer->data, soundBuffer->size, soundBuffer->frequency);
+		sound_GetError();
+
+		psTrack->decodedSize = soundBuffer->size;
+		decodedTracks.push_back(psTrack);
+		decodeStats.trackMemory += psTrack->decodedSize;
+		decodeStats.peakTrackMemory = std::max(decodeStats.peakTrackMemory, decodeStats.trackMemory);
+
+		sound_FreeSoundDataBuffer(soundBuffer);
+	}
+
+	for (SAMPLE_LIST *node = active_samples; node != nullptr; node = node->next)
 	{
-		debug(LOG_WARNING, "sound_DecodeOggVorbisTrack: OggVorbis track is entirely empty after decoding");
-// NOTE: I'm not entirely sure if a track that's empty after decoding should be
-//       considered an error condition. Therefore I'll only error out on DEBUG
-//       builds. (Returning NULL here __will__ result in a program termination.)
-#ifdef DEBUG
-		free(soundBuffer);
-		free(psTrack);
-		return NULL;
-#endif
+		if (node->track != psTrack || !node->pending)
+		{
+			continue;
+		}
+		node->pending = false;
+
+		ALint state;
+		alGetSourcei(node->curr->iSample, AL_SOURCE_STATE, &state);
+		sound_GetError();
+		if (psTrack->iBufferName != 0 && state == AL_INITIAL)
+		{
+			alSourcei(node->curr->iSample, AL_BUFFER, psTrack->iBufferName);
+			alSourcePlay(node->curr->iSample);
+		}
+		else
+		{
+			// Stopped sources are cleaned up by sound_Update()
+			alSourceStop(node->curr->iSample);
+		}
+		sound_GetError();
 	}
 
-	// Determine PCM data format
-	format = (soundBuffer->channelCount == 1) ? AL_FORMAT_MONO16 : AL_FORMAT_STEREO16;
+	sound_EvictTracks();
+}
 
-	// Create an OpenAL buffer and fill it with the decoded data
-	alGenBuffers(1, &buffer);
-	sound_GetError();
-	alBufferData(buffer, format, soundBuffer->data, soundBuffer->size, soundBuffer->frequency);
-	sound_GetError();
+static void sound_FinishDecode(const DECODE_JOB &job)
+{
+	++decodeStats.decodes;
+	decodeStats.decodeTime += job.decodeTime;
+	decodeStats.worstDecodeTime = std::max(decodeStats.worstDecodeTime, job.decodeTime);
+
+	if (job.track != nullptr)
+	{
+		sound_DestroyOggVorbisDecoder(job.decoder);
+		sound_TrackDecoded(job.track, job.result);
+	}
+	else
+	{
+		job.stream->ready = job.result;
+		job.stream->decoding = false;
+	}
+}
+
+/** Handles everything the decode thread has finished decoding
+ */
+static void sound_CollectDecoded()
+{
+	DECODE_JOB job;
+
+	while (sound_TakeDecoded(&job))
+	{
+		sound_FinishDecode(job);
+	}
+}
+
+/** Decodes the job on the decode thread, or right away if the decode thread can't take it
+ */
+static void sound_Decode(DECODE_JOB job)
+{
+	if (!sound_QueueDecode(job))
+	{
+		sound_RunDecode(&job);
+		sound_FinishDecode(job);
+	}
+}
 
-	free(soundBuffer);
+/** Starts decoding a track, unless it is decoded or being decoded already
+ */
+static void sound_DecodeTrack(TRACK *psTrack)
+{
+	if (psTrack->iBufferName != 0 || psTrack->decoding || psTrack->decodeFailed)
+	{
+		return;
+	}
 
-	// save buffer name in track
-	psTrack->iBufferName = buffer;
+	DECODE_JOB job;
+	memset(&job, 0, sizeof(job));
+	job.decoder = sound_CreateOggVorbisMemoryDecoder(psTrack->compressed, psTrack->compressedSize);
+	if (job.decoder == nullptr)
+	{
+		sound_TrackDecoded(psTrack, nullptr);
+		return;
+	}
+	job.track = psTrack;
 
-	return psTrack;
+	psTrack->decoding = true;
+	sound_Decode(job);
 }
 
 //*
@@ -509,31 +678,41 @@ static inline TRACK *sound_DecodeOggVorbisTrack(TRACK *psTrack, PHYSFS_file *PHY
 // =======================================================================================================================
 //
 TRACK *sound_LoadTrackFromFile(const char *fileName)
+{
+	if (GetLastResourceFilename() == nullptr)
+	{
+		// This is a non fatal error.  We just can't find filename for some reason.
+		debug(LOG_WARNING, "sound_LoadTrackFromFile: missing resource filename?");
+	}
+	return sound_DecodeTrackFile(fileName, GetLastResourceFilename());
+}
+
+/** Reads a track and checks it can be decoded, without touching anything the main thread uses.
+ *  \param trackName the name the track is known by, usually the file name from the res file; may be NULL
+ */
+TRACK *sound_DecodeTrackFile(const char *fileName, const char *trackName)
 {
 	TRACK *pTrack;
 	PHYSFS_file *fileHandle;
 	size_t filename_size;
 	char *track_name;
+	struct OggVorbisDecoderState *decoder;
+
+	if (!openal_initialized)
+	{
+		return nullptr;
+	}
 
 	// Use PhysicsFS to open the file
 	fileHandle = PHYSFS_openRead(fileName);
 	debug(LOG_NEVER, "Reading...[directory: %s] %s", PHYSFS_getRealDir(fileName), fileName);
 	if (fileHandle == nullptr)
 	{
-		debug(LOG_ERROR, "sound_LoadTrackFromFile: PHYSFS_openRead(\"%s\") failed with error: %s\n", fileName, PHYSFS_getLastError());
+		debug(LOG_ERROR, "sound_DecodeTrackFile: PHYSFS_openRead(\"%s\") failed with error: %s\n", fileName, PHYSFS_getLastError());
 		return nullptr;
 	}
 
-	if (GetLastResourceFilename() == nullptr)
-	{
-		// This is a non fatal error.  We just can't find filename for some reason.
-		debug(LOG_WARNING, "sound_LoadTrackFromFile: missing resource filename?");
-		filename_size = 0;
-	}
-	else
-	{
-		filename_size = strlen(GetLastResourceFilename()) + 1;
-	}
+	filename_size = trackName != nullptr ? strlen(trackName) + 1 : 0;
 
 	// allocate track, plus the memory required to contain the filename
 	// one malloc call ensures only one free call is required
@@ -548,39 +727,97 @@ TRACK *sound_LoadTrackFromFile(const char *fileName)
 	// Initialize everyting (except for the filename) to zero
 	memset(pTrack, 0, sizeof(TRACK));
 
-	// Set filename pointer; if the filename (as returned by
-	// GetLastResourceFilename()) is a NULL pointer, then this will be a
+	// Set filename pointer; if the track name is a NULL pointer, then this will be a
 	// NULL pointer as well.
 	track_name = filename_size ? (char *)(pTrack + 1) : nullptr;
 
 	// Copy the filename into the struct, if we don't have a NULL pointer
 	if (filename_size != 0)
 	{
-		strcpy(track_name, GetLastResourceFilename());
+		strcpy(track_name, trackName);
 	}
 	pTrack->fileName = track_name;
 
-	// Now use sound_ReadTrackFromBuffer to decode the file's contents
-	pTrack = sound_DecodeOggVorbisTrack(pTrack, fileHandle);
-
+	// Keep the file to decode it when first played
+	PHYSFS_sint64 fileSize = PHYSFS_fileLength(fileHandle);
+	pTrack->compressed = fileSize > 0 ? (char *)malloc(fileSize) : nullptr;
+	if (pTrack->compressed == nullptr || PHYSFS_read(fileHandle, pTrack->compressed, 1, fileSize) != fileSize)
+	{
+		debug(LOG_ERROR, "sound_DecodeTrackFile: failed to read \"%s\": %s", fileName, PHYSFS_getLastError());
+		PHYSFS_close(fileHandle);
+		free(pTrack->compressed);
+		free(pTrack);
+		return nullptr;
+	}
+	pTrack->compressedSize = fileSize;
 	PHYSFS_close(fileHandle);
+
+	// Only check that it can be decoded, that only reads the headers
+	decoder = sound_CreateOggVorbisMemoryDecoder(pTrack->compressed, pTrack->compressedSize);
+	if (decoder == nullptr)
+	{
+		debug(LOG_WARNING, "Failed to open audio file for decoding");
+		free(pTrack->compressed);
+		free(pTrack);
+		return nullptr;
+	}
+	sound_DestroyOggVorbisDecoder(decoder);
+
 	return pTrack;
 }
 
 void sound_FreeTrack(TRACK *psTrack)
 {
-	alDeleteBuffers(1, &psTrack->iBufferName);
-	sound_GetError();
+	// The decode thread may be using the compressed data
+	while (psTrack->decoding)
+	{
+		sound_WaitDecoded();
+		sound_CollectDecoded();
+	}
+
+	if (psTrack->iBufferName != 0)
+	{
+		sound_DropDecodedTrack(psTrack);
+	}
+	free(psTrack->compressed);
+	psTrack->compressed = nullptr;
 }
 
-static void sound_AddActiveSample(AUDIO_SAMPLE *psSample)
+static SAMPLE_LIST *sound_AddActiveSample(TRACK *psTrack, AUDIO_SAMPLE *psSample)
 {
 	SAMPLE_LIST *tmp = (SAMPLE_LIST *) malloc(sizeof(SAMPLE_LIST));
 
 	// Prepend the given sample to our list of active samples
 	tmp->curr = psSample;
+	tmp->track = psTrack;
+	tmp->pending = false;
 	tmp->next = active_samples;
 	active_samples = tmp;
+
+	return tmp;
+}
+
+/** Plays the given sample, or has it wait until its track has been decoded
+ */
+static void sound_StartSample(SAMPLE_LIST *node)
+{
+	TRACK *psTrack = node->track;
+
+	psTrack->lastPlayed = ++playCounter;
+	if (psTrack->iBufferName == 0)
+	{
+		node->pending = true;
+		sound_DecodeTrack(psTrack);
+		return;
+	}
+
+	alSourcei(node->curr->iSample, AL_BUFFER, psTrack->iBufferName);
+
+	// Clear error codes
+	alGetError();
+
+	alSourcePlay(node->curr->iSample);
+	sound_GetError();
 }
 
 /** Routine gets rid of the psObj's sound sample and reference in active_samples.
@@ -612,13 +849,6 @@ void sound_RemoveActiveSample(AUDIO_SAMPLE *psSample)
 	}
 }
 
-static bool sound_SetupChannel(AUDIO_SAMPLE *psSample)
-{
-	sound_AddActiveSample(psSample);
-
-	return sound_TrackLooped(psSample->iTrack);
-}
-
 //*
 // =======================================================================================================================
 // =======================================================================================================================
@@ -628,8 +858,9 @@ bool sound_Play2DSample(TRACK *psTrack, AUDIO_SAMPLE *psSample, bool bQueued)
 	ALfloat zero[3] = { 0.0, 0.0, 0.0 };
 	ALfloat volume;
 	ALint error;
+	SAMPLE_LIST *node;
 
-	if (sfx_volume == 0.0)
+	if (sfx_volume == 0.0 || psTrack->decodeFailed)
 	{
 		return false;
 	}
@@ -662,9 +893,9 @@ bool sound_Play2DSample(TRACK *psTrack, AUDIO_SAMPLE *psSample, bool bQueued)
 	alSourcef(psSample->iSample, AL_GAIN, volume);
 	alSourcefv(psSample->iSample, AL_POSITION, zero);
 	alSourcefv(psSample->iSample, AL_VELOCITY, zero);
-	alSourcei(psSample->iSample, AL_BUFFER, psTrack->iBufferName);
 	alSourcei(psSample->iSample, AL_SOURCE_RELATIVE, AL_TRUE);
-	alSourcei(psSample->iSample, AL_LOOPING, (sound_SetupChannel(psSample)) ? AL_TRUE : AL_FALSE);
+	alSourcei(psSample->iSample, AL_LOOPING, sound_TrackLooped(psSample->iTrack) ? AL_TRUE : AL_FALSE);
+	node = sound_AddActiveSample(psTrack, psSample);
 
 	// NOTE: this is only useful for debugging.
 #ifdef DEBUG
@@ -673,11 +904,7 @@ bool sound_Play2DSample(TRACK *psTrack, AUDIO_SAMPLE *psSample, bool bQueued)
 	memcpy(psSample->filename, psTrack->fileName, strlen(psTrack->fileName));
 	psSample->filename[strlen(psTrack->fileName)] = '\0';
 #endif
-	// Clear error codes
-	alGetError();
-
-	alSourcePlay(psSample->iSample);
-	sound_GetError();
+	sound_StartSample(node);
 
 	if (bQueued)
 	{
@@ -700,8 +927,9 @@ bool sound_Play3DSample(TRACK *psTrack, AUDIO_SAMPLE *psSample)
 	ALfloat zero[3] = { 0.0, 0.0, 0.0 };
 	ALfloat volume;
 	ALint error;
+	SAMPLE_LIST *node;
 
-	if (sfx3d_volume == 0.0)
+	if (sfx3d_volume == 0.0 || psTrack->decodeFailed)
 	{
 		return false;
 	}
@@ -735,8 +963,8 @@ bool sound_Play3DSample(TRACK *psTrack, AUDIO_SAMPLE *psSample)
 
 	sound_SetObjectPosition(psSample);
 	alSourcefv(psSample->iSample, AL_VELOCITY, zero);
-	alSourcei(psSample->iSample, AL_BUFFER, psTrack->iBufferName);
-	alSourcei(psSample->iSample, AL_LOOPING, (sound_SetupChannel(psSample)) ? AL_TRUE : AL_FALSE);
+	alSourcei(psSample->iSample, AL_LOOPING, sound_TrackLooped(psSample->iTrack) ? AL_TRUE : AL_FALSE);
+	node = sound_AddActiveSample(psTrack, psSample);
 
 	// NOTE: this is only useful for debugging.
 #ifdef DEBUG
@@ -746,15 +974,90 @@ bool sound_Play3DSample(TRACK *psTrack, AUDIO_SAMPLE *psSample)
 	psSample->filename[strlen(psTrack->fileName)] = '\0';
 #endif
 
-	// Clear error codes
-	alGetError();
-
-	alSourcePlay(psSample->iSample);
-	sound_GetError();
+	sound_StartSample(node);
 
 	return true;
 }
 
+/** Decodes the next buffer of the given stream on the calling thread
+ */
+static soundDataBuffer *sound_DecodeStreamNow(AUDIO_STREAM *stream)
+{
+	DECODE_JOB job;
+	memset(&job, 0, sizeof(job));
+	job.decoder = stream->decoder;
+	job.bufferSize = stream->bufferSize;
+	job.stream = stream;
+
+	sound_RunDecode(&job);
+	sound_FinishDecode(job);
+
+	soundDataBuffer *soundBuffer = stream->ready;
+	stream->ready = nullptr;
+	return soundBuffer;
+}
+
+/** Starts decoding the next buffer of the given stream on the decode thread, unless it is decoded already
+ */
+static void sound_DecodeStreamAhead(AUDIO_STREAM *stream)
+{
+	if (stream->ready != nullptr || stream->decoding || stream->finished)
+	{
+		return;
+	}
+
+	DECODE_JOB job;
+	memset(&job, 0, sizeof(job));
+	job.decoder = stream->decoder;
+	job.bufferSize = stream->bufferSize;
+	job.stream = stream;
+
+	stream->decoding = true;
+	sound_Decode(job);
+}
+
+/** Waits until the decode thread is done with the decoder of the given stream
+ */
+static void sound_WaitForStream(AUDIO_STREAM *stream)
+{
+	while (stream->decoding)
+	{
+		sound_WaitDecoded();
+		sound_CollectDecoded();
+	}
+}
+
+/** Takes the next buffer of the given stream, decoding it if the decode thread hasn't yet
+ *  \return the decoded data, NULL or empty at the end of the stream
+ */
+static soundDataBuffer *sound_TakeStreamBuffer(AUDIO_STREAM *stream)
+{
+	if (stream->finished)
+	{
+		return nullptr;
+	}
+
+	if (stream->decoding)
+	{
+		++decodeStats.streamUnderruns;
+		sound_WaitForStream(stream);
+	}
+
+	soundDataBuffer *soundBuffer = stream->ready;
+	stream->ready = nullptr;
+	if (soundBuffer == nullptr)
+	{
+		++decodeStats.streamUnderruns;
+		soundBuffer = sound_DecodeStreamNow(stream);
+	}
+
+	if (soundBuffer == nullptr || soundBuffer->size == 0)
+	{
+		stream->finished = true;
+	}
+	return soundBuffer;
+}
+
 /** Plays the audio data from the given file
  *  \param fileHandle PhysicsFS file handle to stream the audio from
  *  \param volume the volume to play the audio at (in a range of 0.0 to 1.0)
@@ -835,6 +1138,9 @@ AUDIO_STREAM *sound_PlayStreamWithBuf(PHYSFS_file *fileHandle, float volume, voi
 
 	stream->volume = volume;
 	stream->bufferSize = streamBufferSize;
+	stream->ready = nullptr;
+	stream->decoding = false;
+	stream->finished = false;
 
 	alSourcef(stream->source, AL_GAIN, stream->volume);
 
@@ -850,7 +1156,7 @@ AUDIO_STREAM *sound_PlayStreamWithBuf(PHYSFS_file *fileHandle, float volume, voi
 	for (i = 0; i < buffer_count; ++i)
 	{
 		// Decode some audio data
-		soundDataBuffer *soundBuffer = sound_DecodeOggVorbis(stream->decoder, stream->bufferSize);
+		soundDataBuffer *soundBuffer = sound_DecodeStreamNow(stream);
 
 		// If we actually decoded some data
 		if (soundBuffer && soundBuffer->size > 0)
@@ -863,7 +1169,7 @@ AUDIO_STREAM *sound_PlayStreamWithBuf(PHYSFS_file *fileHandle, float volume, voi
 			sound_GetError();
 
 			// Clean up our memory
-			free(soundBuffer);
+			sound_FreeSoundDataBuffer(soundBuffer);
 		}
 		else
 		{
@@ -871,7 +1177,7 @@ AUDIO_STREAM *sound_PlayStreamWithBuf(PHYSFS_file *fileHandle, float volume, voi
 			// stream. So cleanup the excess stuff here.
 
 			// First remove the data buffer itself
-			free(soundBuffer);
+			sound_FreeSoundDataBuffer(soundBuffer);
 
 			// Then remove OpenAL's buffers
 			alDeleteBuffers(buffer_count - i, &buffers[i]);
@@ -912,6 +1218,8 @@ AUDIO_STREAM *sound_PlayStreamWithBuf(PHYSFS_file *fileHandle, float volume, voi
 	stream->onFinished = onFinished;
 	stream->user_data = user_data;
 
+	sound_DecodeStreamAhead(stream);
+
 	// Prepend this stream to the linked list
 	stream->next = active_streams;
 	active_streams = stream;
@@ -1061,8 +1369,8 @@ static bool sound_UpdateStream(AUDIO_STREAM *stream)
 		alSourceUnqueueBuffers(stream->source, 1, &buffer);
 		sound_GetError();
 
-		// Decode some data to stuff in our buffer
-		soundBuffer = sound_DecodeOggVorbis(stream->decoder, stream->bufferSize);
+		// Take the data decoded ahead to stuff in our buffer
+		soundBuffer = sound_TakeStreamBuffer(stream);
 
 		// If we actually decoded some data
 		if (soundBuffer && soundBuffer->size > 0)
@@ -1089,9 +1397,12 @@ static bool sound_UpdateStream(AUDIO_STREAM *stream)
 		}
 
 		// Now remove the data buffer itself
-		free(soundBuffer);
+		sound_FreeSoundDataBuffer(soundBuffer);
 	}
 
+	// Have the next buffer ready by the time one has been played
+	sound_DecodeStreamAhead(stream);
+
 	return true;
 }
 
@@ -1142,7 +1453,9 @@ static void sound_DestroyStream(AUDIO_STREAM *stream)
 	alDeleteSources(1, &stream->source);
 	sound_GetError();
 
-	// Destroy the sound decoder
+	// Destroy the sound decoder, and what it decoded ahead
+	sound_WaitForStream(stream);
+	sound_FreeSoundDataBuffer(stream->ready);
 	sound_DestroyOggVorbisDecoder(stream->decoder);
 
 	// Now close the file
@@ -1220,6 +1533,7 @@ void sound_StopSample(AUDIO_SAMPLE *psSample)
 
 void sound_SetPlayerPos(Vector3f pos)
 {
+	listenerPos = pos;
 	alListener3f(AL_POSITION, pos.x, pos.y, pos.z);
 	sound_GetError();
 }
@@ -1267,7 +1581,7 @@ void sound_SetObjectPosition(AUDIO_SAMPLE *psSample)
 {
 	//~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
 	// coordinates
-	float	listenerX, listenerY, listenerZ, dX, dY, dZ;
+	float	dX, dY, dZ;
 
 	// calculation results
 	float	distance, gain;
@@ -1279,12 +1593,10 @@ void sound_SetObjectPosition(AUDIO_SAMPLE *psSample)
 		return;
 	}
 
-	// compute distance
-	alGetListener3f(AL_POSITION, &listenerX, &listenerY, &listenerZ);
-	sound_GetError();
-	dX = psSample->x  - listenerX; // distances on all axis
-	dY = psSample->y - listenerY;
-	dZ = psSample->z - listenerZ;
+	// compute distance, from where sound_SetPlayerPos() put the listener
+	dX = psSample->x - listenerPos.x; // distances on all axis
+	dY = psSample->y - listenerPos.y;
+	dZ = psSample->z - listenerPos.z;
 	distance = sqrtf(dX * dX + dY * dY + dZ * dZ); // Pythagorean theorem
 
 	// compute gain
@@ -1324,6 +1636,11 @@ void sound_PauseSample(AUDIO_SAMPLE *psSample)
 //
 void sound_ResumeSample(AUDIO_SAMPLE *psSample)
 {
+	// Samples waiting for their tracks are started once decoded
+	if (sound_SamplePending(psSample->iSample))
+	{
+		return;
+	}
 	alSourcePlay(psSample->iSample);
 	sound_GetError();
 }
@@ -1362,7 +1679,7 @@ bool sound_SampleIsFinished(AUDIO_SAMPLE *psSample)
 
 	alGetSourcei(psSample->iSample, AL_SOURCE_STATE, &state);
 	sound_GetError(); // check for an error and clear the error state for later on in this function
-	if (state == AL_PLAYING || state == AL_PAUSED)
+	if (state == AL_PLAYING || state == AL_PAUSED || (state == AL_INITIAL && sound_SamplePending(psSample->iSample)))
 	{
 		return false;
 	}
@@ -1421,3 +1738,10 @@ void sound_SetEffectsVolume(float volume)
 		sfx3d_volume = 1.0;
 	}
 }
+
+SOUND_DECODE_STATS sound_GetDecodeStats()
+{
+	SOUND_DECODE_STATS stats = decodeStats;
+	stats.poolMemory = sound_GetSoundDataPoolSize();
+	return stats;
+}
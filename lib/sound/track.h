@@ -60,6 +60,9 @@ struct AUDIO_SAMPLE
 	SDWORD                  x, y, z;
 	float                   fVol;           // computed volume of sample
 	bool                    bFinishedPlaying;
+	bool                    b3D;            // if sample has a position, and takes one of the 3D voices
+	bool                    bCulled;        // if sample was stopped to give its voice to a louder one
+	UDWORD                  iStartTime;     // realTime when started
 	AUDIO_CALLBACK          pCallback;
 	SIMPLE_OBJECT          *psObj;
 	AUDIO_SAMPLE           *psPrev;
@@ -74,8 +77,26 @@ struct TRACK
 	SDWORD          iTime;                  // duration in milliseconds
 	UDWORD          iTimeLastFinished;      // time last finished in ms
 	UDWORD          iNumPlaying;
-	ALuint          iBufferName;            // OpenAL name of the buffer
+	ALuint          iBufferName;            // OpenAL name of the buffer, 0 until decoded
 	const char     *fileName;
+	char           *compressed;             // the Ogg Vorbis file, decoded when first played
+	size_t          compressedSize;
+	size_t          decodedSize;            // bytes of PCM data in the buffer
+	uint64_t        lastPlayed;             // when last played, to drop the least recently played buffers first
+	bool            decoding;               // queued for decoding
+	bool            decodeFailed;
+};
+
+struct SOUND_DECODE_STATS
+{
+	unsigned        decodes;                // tracks and stream buffers decoded
+	int64_t         decodeTime;             // nanoseconds spent decoding, on any thread
+	int64_t         worstDecodeTime;
+	unsigned        streamUnderruns;        // stream buffers the frame thread had to wait for or decode itself
+	unsigned        evictions;              // decoded tracks dropped to stay under the memory cap
+	size_t          trackMemory;            // bytes of decoded tracks
+	size_t          peakTrackMemory;
+	size_t          poolMemory;             // bytes kept for reuse by decoded buffers
 };
 
 /* functions
@@ -85,6 +106,7 @@ bool	sound_Init();
 bool	sound_Shutdown();
 
 TRACK 	*sound_LoadTrackFromFile(const char *fileName);
+TRACK 	*sound_DecodeTrackFile(const char *fileName, const char *trackName);
 unsigned int sound_SetTrackVals(const char *fileName, bool loop, unsigned int volume, unsigned int audibleRadius);
 void	sound_ReleaseTrack(TRACK *psTrack);
 
@@ -129,4 +151,6 @@ AUDIO_STREAM *sound_PlayStreamWithBuf(PHYSFS_file *fileHandle, float volume, voi
 float sound_GetStreamVolume(const AUDIO_STREAM *stream);
 void sound_SetStreamVolume(AUDIO_STREAM *stream, float volume);
 
+SOUND_DECODE_STATS sound_GetDecodeStats();
+
 #endif	// __INCLUDED_LIB_SOUND_TRACK_H__
@@ -24,6 +24,9 @@
  *
  */
 
+#include <unordered_set>
+#include <vector>
+
 #include "lib/framework/frame.h"
 
 #include "action.h"
@@ -36,6 +39,7 @@
 #include "projectile.h"
 #include "objmem.h"
 #include "order.h"
+#include "tickprofile.h"
 
 /* Weights used for target selection code,
  * target distance is used as 'common currency'
@@ -65,6 +69,8 @@
 
 #define TOO_CLOSE_PENALTY_F             20
 
+#define TARGET_LOOK_SKIP_TIME		(GAME_TICKS_PER_UPDATE * 2)	//Idle droids look for new targets this often, spread over ticks by droid id
+
 #define TARGET_DOOMED_PENALTY_F		10	// Targets that have a lot of damage incoming are less attractive
 #define TARGET_DOOMED_SLOW_RELOAD_T	21	// Weapon ROF threshold for above penalty. per minute.
 
@@ -80,6 +86,10 @@ PlayerMask alliancebits[MAX_PLAYER_SLOTS];
 /// A bitfield for the satellite uplink
 PlayerMask satuplinkbits;
 
+/// Weapon effect modifiers against droids, combined for propulsion type and body size
+static int aiDroidModifier[WE_NUMEFFECTS][PROPULSION_TYPE_NUM][SIZE_NUM];
+static uint32_t aiDroidModifierTime = UINT32_MAX;
+
 static int aiDroidRange(DROID *psDroid, int weapon_slot)
 {
 	int32_t longRange;
@@ -153,6 +163,7 @@ bool aiInitialise()
 		}
 	}
 	satuplinkbits = 0;
+	aiDroidModifierTime = UINT32_MAX;
 
 	return true;
 }
@@ -253,98 +264,151 @@ static BASE_OBJECT *aiSearchSensorTargets(BASE_OBJECT *psObj, int weapon_slot, W
 }
 
 /* Calculates attack priority for a certain target */
-static SDWORD targetAttackWeight(BASE_OBJECT *psTarget, BASE_OBJECT *psAttacker, SDWORD weapon_slot)
+/// Everything about an attacker that targetAttackWeight() needs, but which does not depend on the target
+struct ATTACKER_WEIGHT_INFO
 {
-	SDWORD			targetTypeBonus = 0, damageRatio = 0, attackWeight = 0, noTarget = -1;
-	UDWORD			weaponSlot;
-	DROID			*targetDroid = nullptr, *psAttackerDroid = nullptr, *psGroupDroid, *psDroid;
-	STRUCTURE		*targetStructure = nullptr;
-	WEAPON_EFFECT	weaponEffect;
-	WEAPON_STATS	*attackerWeapon;
-	bool			bEmpWeap = false, bCmdAttached = false, bTargetingCmd = false, bDirect = false;
+	BASE_OBJECT     *psAttacker = nullptr;
+	DROID           *psAttackerDroid = nullptr;     ///< psAttacker, if it is a droid
+	WEAPON_STATS    *attackerWeapon = nullptr;
+	WEAPON_EFFECT   weaponEffect = WE_NUMEFFECTS;
+	bool            bEmpWeap = false;
+	bool            bCmdAttached = false;
+	bool            bDirect = false;
+	bool            bSlowReload = false;            ///< Too slow to fire at targets that are probably doomed already
+	int             sensorRange = 0;
+	unsigned        minRange = 0;
+};
+
+/// Rebuild the combined droid modifier table, if not done yet this tick
+static void aiUpdateDroidModifiers()
+{
+	if (aiDroidModifierTime == gameTime)
+	{
+		return;
+	}
+	aiDroidModifierTime = gameTime;
 
-	if (psTarget == nullptr || psAttacker == nullptr || psTarget->died)
+	for (int effect = 0; effect < WE_NUMEFFECTS; ++effect)
 	{
-		return noTarget;
+		for (int propulsion = 0; propulsion < PROPULSION_TYPE_NUM; ++propulsion)
+		{
+			for (int size = 0; size < SIZE_NUM; ++size)
+			{
+				aiDroidModifier[effect][propulsion][size] = asWeaponModifier[effect][propulsion] + asWeaponModifierBody[effect][size];
+			}
+		}
 	}
-	ASSERT(psTarget != psAttacker, "targetAttackWeight: Wanted to evaluate the worth of attacking ourselves...");
+}
 
-	targetTypeBonus = 0;			//Sensors/ecm droids, non-military structures get lower priority
+/// Fill in the target independent part of the attack weight calculation. Returns false if psAttacker cannot attack at all.
+static bool targetAttackWeightInit(ATTACKER_WEIGHT_INFO *psInfo, BASE_OBJECT *psAttacker, SDWORD weapon_slot)
+{
+	*psInfo = ATTACKER_WEIGHT_INFO();
+	if (psAttacker == nullptr)
+	{
+		return false;
+	}
+	psInfo->psAttacker = psAttacker;
 
 	/* Get attacker weapon effect */
 	if (psAttacker->type == OBJ_DROID)
 	{
-		psAttackerDroid = (DROID *)psAttacker;
-
-		attackerWeapon = (WEAPON_STATS *)(asWeaponStats + psAttackerDroid->asWeaps[weapon_slot].nStat);
+		psInfo->psAttackerDroid = (DROID *)psAttacker;
+		psInfo->attackerWeapon = (WEAPON_STATS *)(asWeaponStats + psInfo->psAttackerDroid->asWeaps[weapon_slot].nStat);
 
 		//check if this droid is assigned to a commander
-		bCmdAttached = hasCommander(psAttackerDroid);
-
-		//find out if current target is targeting our commander
-		if (bCmdAttached)
-		{
-			if (psTarget->type == OBJ_DROID)
-			{
-				psDroid = (DROID *)psTarget;
-
-				//go through all enemy weapon slots
-				for (weaponSlot = 0; !bTargetingCmd &&
-				     weaponSlot < ((DROID *)psTarget)->numWeaps; weaponSlot++)
-				{
-					//see if this weapon is targeting our commander
-					if (psDroid->psActionTarget[weaponSlot] == (BASE_OBJECT *)psAttackerDroid->psGroup->psCommander)
-					{
-						bTargetingCmd = true;
-					}
-				}
-			}
-			else
-			{
-				if (psTarget->type == OBJ_STRUCTURE)
-				{
-					//go through all enemy weapons
-					for (weaponSlot = 0; !bTargetingCmd && weaponSlot < ((STRUCTURE *)psTarget)->numWeaps; weaponSlot++)
-					{
-						if (((STRUCTURE *)psTarget)->psTarget[weaponSlot] ==
-						    (BASE_OBJECT *)psAttackerDroid->psGroup->psCommander)
-						{
-							bTargetingCmd = true;
-						}
-					}
-				}
-			}
-		}
+		psInfo->bCmdAttached = hasCommander(psInfo->psAttackerDroid);
 	}
 	else if (psAttacker->type == OBJ_STRUCTURE)
 	{
-		attackerWeapon = ((WEAPON_STATS *)(asWeaponStats + ((STRUCTURE *)psAttacker)->asWeaps[weapon_slot].nStat));
+		psInfo->attackerWeapon = ((WEAPON_STATS *)(asWeaponStats + ((STRUCTURE *)psAttacker)->asWeaps[weapon_slot].nStat));
 	}
 	else	/* feature */
 	{
 		ASSERT(!"invalid attacker object type", "targetAttackWeight: Invalid attacker object type");
-		return noTarget;
+		return false;
 	}
 
-	bDirect = proj_Direct(attackerWeapon);
-	if (psAttacker->type == OBJ_DROID && psAttackerDroid->droidType == DROID_SENSOR)
+	psInfo->bDirect = proj_Direct(psInfo->attackerWeapon);
+	if (psInfo->psAttackerDroid != nullptr && psInfo->psAttackerDroid->droidType == DROID_SENSOR)
 	{
 		// Sensors are considered a direct weapon,
 		// but for computing expected damage it makes more sense to use indirect damage
-		bDirect = false;
+		psInfo->bDirect = false;
 	}
 
 	//Get weapon effect
-	weaponEffect = attackerWeapon->weaponEffect;
+	psInfo->weaponEffect = psInfo->attackerWeapon->weaponEffect;
 
 	//See if attacker is using an EMP weapon
-	bEmpWeap = (attackerWeapon->weaponSubClass == WSC_EMP);
+	psInfo->bEmpWeap = (psInfo->attackerWeapon->weaponSubClass == WSC_EMP);
+
+	psInfo->sensorRange = objSensorRange(psAttacker);
+	psInfo->minRange = psInfo->attackerWeapon->upgrade[psAttacker->player].minRange;
+	psInfo->bSlowReload = weaponROF(psInfo->attackerWeapon, psAttacker->player) < TARGET_DOOMED_SLOW_RELOAD_T;
+
+	aiUpdateDroidModifiers();
+	return true;
+}
+
+static SDWORD targetAttackWeight(const ATTACKER_WEIGHT_INFO &info, BASE_OBJECT *psTarget)
+{
+	SDWORD			targetTypeBonus = 0, damageRatio = 0, attackWeight = 0, noTarget = -1;
+	UDWORD			weaponSlot;
+	DROID			*targetDroid = nullptr, *psGroupDroid, *psDroid;
+	STRUCTURE		*targetStructure = nullptr;
+	BASE_OBJECT		*psAttacker = info.psAttacker;
+	DROID			*psAttackerDroid = info.psAttackerDroid;
+	bool			bTargetingCmd = false;
+
+	if (psTarget == nullptr || psAttacker == nullptr || psTarget->died)
+	{
+		return noTarget;
+	}
+	ASSERT(psTarget != psAttacker, "targetAttackWeight: Wanted to evaluate the worth of attacking ourselves...");
+
+	targetTypeBonus = 0;			//Sensors/ecm droids, non-military structures get lower priority
+
+	//find out if current target is targeting our commander
+	if (info.bCmdAttached)
+	{
+		if (psTarget->type == OBJ_DROID)
+		{
+			psDroid = (DROID *)psTarget;
+
+			//go through all enemy weapon slots
+			for (weaponSlot = 0; !bTargetingCmd &&
+			     weaponSlot < ((DROID *)psTarget)->numWeaps; weaponSlot++)
+			{
+				//see if this weapon is targeting our commander
+				if (psDroid->psActionTarget[weaponSlot] == (BASE_OBJECT *)psAttackerDroid->psGroup->psCommander)
+				{
+					bTargetingCmd = true;
+				}
+			}
+		}
+		else
+		{
+			if (psTarget->type == OBJ_STRUCTURE)
+			{
+				//go through all enemy weapons
+				for (weaponSlot = 0; !bTargetingCmd && weaponSlot < ((STRUCTURE *)psTarget)->numWeaps; weaponSlot++)
+				{
+					if (((STRUCTURE *)psTarget)->psTarget[weaponSlot] ==
+					    (BASE_OBJECT *)psAttackerDroid->psGroup->psCommander)
+					{
+						bTargetingCmd = true;
+					}
+				}
+			}
+		}
+	}
 
 	int dist = iHypot((psAttacker->pos - psTarget->pos).xy);
-	bool tooClose = (unsigned)dist <= attackerWeapon->upgrade[psAttacker->player].minRange;
+	bool tooClose = (unsigned)dist <= info.minRange;
 	if (tooClose)
 	{
-		dist = objSensorRange(psAttacker);  // If object is too close to fire at, consider it to be at maximum range.
+		dist = info.sensorRange;  // If object is too close to fire at, consider it to be at maximum range.
 	}
 
 	/* Calculate attack weight */
@@ -403,15 +467,14 @@ static SDWORD targetAttackWeight(BASE_OBJECT *psTarget, BASE_OBJECT *psAttacker,
 		}
 
 		/* Now calculate the overall weight */
-		attackWeight = asWeaponModifier[weaponEffect][(asPropulsionStats + targetDroid->asBits[COMP_PROPULSION])->propulsionType] // Our weapon's effect against target
-		               + asWeaponModifierBody[weaponEffect][(asBodyStats + targetDroid->asBits[COMP_BODY])->size]
-		               + WEIGHT_DIST_TILE_DROID * objSensorRange(psAttacker) / TILE_UNITS
+		attackWeight = aiDroidModifier[info.weaponEffect][(asPropulsionStats + targetDroid->asBits[COMP_PROPULSION])->propulsionType][(asBodyStats + targetDroid->asBits[COMP_BODY])->size] // Our weapon's effect against target
+		               + WEIGHT_DIST_TILE_DROID * info.sensorRange / TILE_UNITS
 		               - WEIGHT_DIST_TILE_DROID * dist / TILE_UNITS // farther droids are less attractive
 		               + WEIGHT_HEALTH_DROID * damageRatio / 100 // we prefer damaged droids
 		               + targetTypeBonus; // some droid types have higher priority
 
 		/* If attacking with EMP try to avoid targets that were already "EMPed" */
-		if (bEmpWeap &&
+		if (info.bEmpWeap &&
 		    (targetDroid->lastHitWeapon == WSC_EMP) &&
 		    ((gameTime - targetDroid->timeLastHit) < EMP_DISABLE_TIME))		//target still disabled
 		{
@@ -446,8 +509,8 @@ static SDWORD targetAttackWeight(BASE_OBJECT *psTarget, BASE_OBJECT *psAttacker,
 		}
 
 		/* Now calculate the overall weight */
-		attackWeight = asStructStrengthModifier[weaponEffect][targetStructure->pStructureType->strength] // Our weapon's effect against target
-		               + WEIGHT_DIST_TILE_STRUCT * objSensorRange(psAttacker) / TILE_UNITS
+		attackWeight = asStructStrengthModifier[info.weaponEffect][targetStructure->pStructureType->strength] // Our weapon's effect against target
+		               + WEIGHT_DIST_TILE_STRUCT * info.sensorRange / TILE_UNITS
 		               - WEIGHT_DIST_TILE_STRUCT * dist / TILE_UNITS // farther structs are less attractive
 		               + WEIGHT_HEALTH_STRUCT * damageRatio / 100 // we prefer damaged structures
 		               + targetTypeBonus; // some structure types have higher priority
@@ -459,7 +522,7 @@ static SDWORD targetAttackWeight(BASE_OBJECT *psTarget, BASE_OBJECT *psAttacker,
 		}
 
 		/* EMP should only attack structures if no enemy droids are around */
-		if (bEmpWeap)
+		if (info.bEmpWeap)
 		{
 			attackWeight /= EMP_STRUCT_PENALTY_F;
 		}
@@ -481,20 +544,20 @@ static SDWORD targetAttackWeight(BASE_OBJECT *psTarget, BASE_OBJECT *psAttacker,
 	}
 
 	/* Penalty for units that are already considered doomed (but the missile might miss!) */
-	if (aiObjectIsProbablyDoomed(psTarget, bDirect))
+	if (aiObjectIsProbablyDoomed(psTarget, info.bDirect))
 	{
 		/* indirect firing units have slow reload times, so give the target a chance to die,
 		 * and give a different unit a chance to get in range, too. */
-		if (weaponROF(attackerWeapon, psAttacker->player) < TARGET_DOOMED_SLOW_RELOAD_T)
+		if (info.bSlowReload)
 		{
-			debug(LOG_NEVER, "Not killing unit - doomed. My ROF: %i (%s)", weaponROF(attackerWeapon, psAttacker->player), getName(attackerWeapon));
+			debug(LOG_NEVER, "Not killing unit - doomed. My ROF: %i (%s)", weaponROF(info.attackerWeapon, psAttacker->player), getName(info.attackerWeapon));
 			return noTarget;
 		}
 		attackWeight /= TARGET_DOOMED_PENALTY_F;
 	}
 
 	/* Commander-related criterias */
-	if (bCmdAttached)	//attached to a commander and don't have a target assigned by some order
+	if (info.bCmdAttached)	//attached to a commander and don't have a target assigned by some order
 	{
 		ASSERT(psAttackerDroid->psGroup->psCommander != nullptr, "Commander is NULL");
 
@@ -523,6 +586,17 @@ static SDWORD targetAttackWeight(BASE_OBJECT *psTarget, BASE_OBJECT *psAttacker,
 	return std::max<int>(1, attackWeight);
 }
 
+static SDWORD targetAttackWeight(BASE_OBJECT *psTarget, BASE_OBJECT *psAttacker, SDWORD weapon_slot)
+{
+	ATTACKER_WEIGHT_INFO info;
+
+	if (psTarget == nullptr || psTarget->died || !targetAttackWeightInit(&info, psAttacker, weapon_slot))
+	{
+		return -1;
+	}
+	return targetAttackWeight(info, psTarget);
+}
+
 
 // Find the best nearest target for a droid.
 // If extraRange is higher than zero, then this is the range it accepts for movement to target.
@@ -565,6 +639,12 @@ int aiBestNearestTarget(DROID *psDroid, BASE_OBJECT **ppsObj, int weapon_slot, i
 	// Range was previously 9*TILE_UNITS. Increasing this doesn't seem to help much, though. Not sure why.
 	int droidRange = std::min(aiDroidRange(psDroid, weapon_slot) + extraRange, objSensorRange(psDroid) + 6 * TILE_UNITS);
 
+	// Collect all candidates first, then score them in one go, since most of the weight calculation only depends on us.
+	static std::vector<BASE_OBJECT *> candidates;  // static to avoid allocations.
+	static std::unordered_set<BASE_OBJECT *> candidateSet;
+	candidates.clear();
+	candidateSet.clear();
+
 	static GridList gridList;  // static to avoid allocations.
 	gridList = gridStartIterate(psDroid->pos.x, psDroid->pos.y, droidRange);
 	for (GridIterator gi = gridList.begin(); gi != gridList.end(); ++gi)
@@ -674,19 +754,32 @@ int aiBestNearestTarget(DROID *psDroid, BASE_OBJECT **ppsObj, int weapon_slot, i
 			/* Check if our weapon is most effective against this object */
 			if (psTarget != nullptr && psTarget == targetInQuestion)		//was assigned?
 			{
-				int newMod = targetAttackWeight(psTarget, (BASE_OBJECT *)psDroid, weapon_slot);
-
-				/* Remember this one if it's our best target so far */
-				if (newMod >= 0 && (newMod > bestMod || bestTarget == nullptr))
+				// Several friends often share the same target, but its weight does not change.
+				if (candidateSet.insert(psTarget).second)
 				{
-					bestMod = newMod;
-					tmpOrigin = ORIGIN_ALLY;
-					bestTarget = psTarget;
+					candidates.push_back(psTarget);
 				}
 			}
 		}
 	}
 
+	ATTACKER_WEIGHT_INFO attackerInfo;
+	if (!candidates.empty() && targetAttackWeightInit(&attackerInfo, (BASE_OBJECT *)psDroid, weapon_slot))
+	{
+		for (BASE_OBJECT *psCandidate : candidates)
+		{
+			int newMod = targetAttackWeight(attackerInfo, psCandidate);
+
+			/* Remember this one if it's our best target so far */
+			if (newMod >= 0 && (newMod > bestMod || bestTarget == nullptr))
+			{
+				bestMod = newMod;
+				tmpOrigin = ORIGIN_ALLY;
+				bestTarget = psCandidate;
+			}
+		}
+	}
+
 	if (bestTarget)
 	{
 		ASSERT(!bestTarget->died, "AI gave us a target that is already dead.");
@@ -803,6 +896,7 @@ static bool aiObjIsWall(BASE_OBJECT *psObj)
 /* See if there is a target in range */
 bool aiChooseTarget(BASE_OBJECT *psObj, BASE_OBJECT **ppsTarget, int weapon_slot, bool bUpdateTarget, TARGET_ORIGIN *targetOrigin)
 {
+	ProfileScope profileScope(PROFILE_AI);
 	BASE_OBJECT		*psTarget = nullptr;
 	DROID			*psCommander;
 	SDWORD			curTargetWeight = -1;
@@ -903,6 +997,9 @@ bool aiChooseTarget(BASE_OBJECT *psObj, BASE_OBJECT **ppsTarget, int weapon_slot
 				srange = objSensorRange(psObj);
 			}
 
+			ATTACKER_WEIGHT_INFO attackerInfo;
+			targetAttackWeightInit(&attackerInfo, psObj, weapon_slot);
+
 			static GridList gridList;  // static to avoid allocations.
 			gridList = gridStartIterate(psObj->pos.x, psObj->pos.y, srange);
 			for (GridIterator gi = gridList.begin(); gi != gridList.end(); ++gi)
@@ -914,7 +1011,7 @@ bool aiChooseTarget(BASE_OBJECT *psObj, BASE_OBJECT **ppsTarget, int weapon_slot
 				    && validTarget(psObj, psCurr, weapon_slot) && psCurr->visible[psObj->player] == UBYTE_MAX
 				    && aiStructHasRange((STRUCTURE *)psObj, psCurr, weapon_slot))
 				{
-					int newTargetValue = targetAttackWeight(psCurr, psObj, weapon_slot);
+					int newTargetValue = targetAttackWeight(attackerInfo, psCurr);
 					// See if in sensor range and visible
 					int distSq = objPosDiffSq(psCurr->pos, psObj->pos);
 					if (newTargetValue < targetValue || (newTargetValue == targetValue && distSq >= tarDist))
@@ -1061,6 +1158,7 @@ static bool updateAttackTarget(BASE_OBJECT *psAttacker, SDWORD weapon_slot)
 /* Do the AI for a droid */
 void aiUpdateDroid(DROID *psDroid)
 {
+	ProfileScope profileScope(PROFILE_AI);
 	bool		lookForTarget, updateTarget;
 
 	ASSERT(psDroid != nullptr, "Invalid droid pointer");
@@ -1162,7 +1260,8 @@ void aiUpdateDroid(DROID *psDroid)
 
 	/* Null target - see if there is an enemy to attack */
 
-	if (lookForTarget && !updateTarget)
+	if (lookForTarget && !updateTarget
+	    && (psDroid->id + gameTime) / TARGET_LOOK_SKIP_TIME != (psDroid->id + gameTime - deltaGameTime) / TARGET_LOOK_SKIP_TIME)
 	{
 		BASE_OBJECT *psTarget;
 		if (psDroid->droidType == DROID_SENSOR)
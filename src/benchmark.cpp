@@ -0,0 +1,323 @@
+/*
+	This file is part of Warzone 2100.
+	Copyright (C) 2005-2017  Warzone 2100 Project
+
+	Warzone 2100 is free software; you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation; either version 2 of the License, or
+	(at your option) any later version.
+
+	Warzone 2100 is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with Warzone 2100; if not, write to the Free Software
+	Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301 USA
+*/
+/** @file
+ *  Simulation benchmark, see benchmark.h.
+ */
+
+#include "lib/framework/frame.h"
+#include "lib/framework/wzapp.h"
+#include "lib/gamelib/gtime.h"
+#include "lib/ivis_opengl/textdraw.h"
+#include "lib/sequence/sequence.h"
+
+#include <QtCore/QElapsedTimer>
+#include <QtCore/QJsonDocument>
+#include <QtCore/QJsonObject>
+#include <algorithm>
+#include <atomic>
+#include <string>
+#include <vector>
+
+#include "benchmark.h"
+#include "clparse.h"
+#include "map.h"
+#include "lighting.h"
+#include "multiplay.h"
+#include "objmem.h"
+#include "tickprofile.h"
+#include "version.h"
+
+static std::atomic<bool> running(false);
+static unsigned ticksWanted = 0;
+static unsigned ticksDone = 0;
+static uint32_t startGameTime = 0;
+
+// All times are in nanoseconds.
+static QElapsedTimer benchmarkTimer;
+static int64_t tickTime = 0;
+static int64_t worstTickTime = 0;
+static int64_t sectionTime[PROFILE_SECTION_COUNT];
+static std::atomic<int64_t> pathThreadTime(0);
+
+template <typename T>
+static unsigned countObjects(T *const *lists)
+{
+	unsigned count = 0;
+	for (unsigned player = 0; player < MAX_PLAYERS; ++player)
+	{
+		for (T *psObj = lists[player]; psObj != nullptr; psObj = psObj->psNext)
+		{
+			++count;
+		}
+	}
+	return count;
+}
+
+void benchmarkStart(unsigned ticks)
+{
+	debug(LOG_INFO, "Benchmarking %u ticks", ticks);
+	ticksWanted = ticks;
+	ticksDone = 0;
+	startGameTime = gameTime;
+	tickTime = 0;
+	worstTickTime = 0;
+	memset(sectionTime, 0, sizeof(sectionTime));
+	pathThreadTime = 0;
+	benchmarkTimer.start();
+	gameTimeSetUnthrottled(true);
+	profileStart();
+	running = true;
+}
+
+void benchmarkFinish()
+{
+	if (!running)
+	{
+		return;
+	}
+	running = false;
+	profileStop();
+	gameTimeSetUnthrottled(false);
+
+	const double wallTime = benchmarkTimer.nsecsElapsed() / 1e6;
+	QJsonObject sections;
+	for (int i = 0; i < PROFILE_SECTION_COUNT; ++i)
+	{
+		sections[profileSectionName((PROFILE_SECTION)i)] = sectionTime[i] / 1e6;
+	}
+
+	// Times in milliseconds.
+	QJsonObject result;
+	result["version"] = version_getVersionString();
+	result["test"] = QString::fromStdString(wz_skirmish_test());
+	result["map"] = game.map;
+	result["ticks"] = (int)ticksDone;
+	result["gameTime"] = (int)(gameTime - startGameTime);
+	result["wallTime"] = wallTime;
+	result["tickTime"] = tickTime / 1e6;
+	result["worstTickTime"] = worstTickTime / 1e6;
+	result["ticksPerSecond"] = tickTime > 0 ? ticksDone * 1e9 / tickTime : 0.;
+	result["wallTicksPerSecond"] = wallTime > 0 ? ticksDone * 1e3 / wallTime : 0.;
+	result["pathThreadTime"] = pathThreadTime / 1e6;
+	result["droids"] = (int)countObjects(apsDroidLists);
+	result["structures"] = (int)countObjects(apsStructLists);
+	result["sections"] = sections;
+
+	fprintf(stdout, "%s", QJsonDocument(result).toJson().constData());
+	fflush(stdout);
+}
+
+bool benchmarkRunning()
+{
+	return running;
+}
+
+void benchmarkTickEnd(const PROFILE_TICK *tick)
+{
+	if (!running || tick == nullptr)
+	{
+		return;
+	}
+	for (int i = 0; i < PROFILE_SECTION_COUNT; ++i)
+	{
+		sectionTime[i] += tick->sectionTime[i];
+	}
+	tickTime += tick->duration;
+	worstTickTime = std::max(worstTickTime, tick->duration);
+	if (++ticksDone >= ticksWanted)
+	{
+		benchmarkFinish();
+		wzQuit();
+	}
+}
+
+int64_t benchmarkPathJobStart()
+{
+	return running ? benchmarkTimer.nsecsElapsed() : -1;
+}
+
+void benchmarkPathJob(int64_t jobStart)
+{
+	if (jobStart < 0 || !running)
+	{
+		return;
+	}
+	pathThreadTime += std::max<int64_t>(benchmarkTimer.nsecsElapsed() - jobStart, 0);
+}
+
+/// Strings like those on the screen in a game: labels, numbers, and some longer lines.
+static std::vector<std::string> benchmarkStrings()
+{
+	static const char *const labels[] = {"Power", "Research", "Build", "Manufacture", "Design", "Intelligence", "Commanders", "Options",
+	                                     "Machinegun Viper Wheels", "Heavy Cannon Python Tracks", "Factory Module", "Research Facility",
+	                                     "Structure under attack", "Unit lost", "Research completed", "Mission Objectives"};
+	std::vector<std::string> strings;
+	for (const char *label : labels)
+	{
+		strings.push_back(label);
+	}
+	for (unsigned i = 0; i < 200; ++i)
+	{
+		strings.push_back(std::to_string(i * 37));
+		strings.push_back(std::string(labels[i % ARRAY_SIZE(labels)]) + " " + std::to_string(i));
+	}
+	strings.push_back("The quick brown fox jumps over the lazy dog, then builds a factory and researches twin assault guns.");
+	return strings;
+}
+
+/// Time measuring strings, with empty and then filled text caches, and then drawing them to textures.
+static QJsonObject benchmarkTextFont(const std::vector<std::string> &strings, iV_fonts fontID)
+{
+	// Start with empty caches.
+	iV_TextShutdown();
+	iV_TextInit();
+
+	QElapsedTimer timer;
+	timer.start();
+	for (const std::string &string : strings)
+	{
+		iV_GetTextWidth(string.c_str(), fontID);
+	}
+	const int64_t coldTime = timer.nsecsElapsed();
+
+	timer.start();
+	for (const std::string &string : strings)
+	{
+		iV_GetTextWidth(string.c_str(), fontID);
+	}
+	const int64_t warmTime = timer.nsecsElapsed();
+
+	timer.start();
+	{
+		std::vector<WzText> texts(strings.size());
+		for (size_t i = 0; i < strings.size(); ++i)
+		{
+			texts[i].setText(strings[i], fontID);
+		}
+	}
+	const int64_t drawTime = timer.nsecsElapsed();
+
+	// Times in microseconds per string.
+	QJsonObject result;
+	result["coldMetrics"] = coldTime / 1e3 / strings.size();
+	result["warmMetrics"] = warmTime / 1e3 / strings.size();
+	result["textures"] = drawTime / 1e3 / strings.size();
+	return result;
+}
+
+void benchmarkText()
+{
+	const std::vector<std::string> strings = benchmarkStrings();
+	QJsonObject fonts;
+	fonts["regular"] = benchmarkTextFont(strings, font_regular);
+	fonts["large"] = benchmarkTextFont(strings, font_large);
+	fonts["small"] = benchmarkTextFont(strings, font_small);
+
+	QJsonObject result;
+	result["version"] = version_getVersionString();
+	result["strings"] = (int)strings.size();
+	result["fonts"] = fonts;
+
+	fprintf(stdout, "%s", QJsonDocument(result).toJson().constData());
+	fflush(stdout);
+}
+
+bool benchmarkVideo(const char *fileName)
+{
+	SEQ_BENCHMARK video;
+	if (!seq_Benchmark(fileName, &video))
+	{
+		debug(LOG_ERROR, "Could not decode %s", fileName);
+		return false;
+	}
+
+	// Times in seconds.
+	QJsonObject result;
+	result["version"] = version_getVersionString();
+	result["video"] = fileName;
+	result["width"] = video.width;
+	result["height"] = video.height;
+	result["frames"] = video.frames;
+	result["videoTime"] = video.videoSeconds;
+	result["wallTime"] = video.seconds;
+	result["decodeTime"] = video.decodeSeconds;
+	result["convertTime"] = video.convertSeconds;
+	result["framesPerSecond"] = video.seconds > 0 ? video.frames / video.seconds : 0.;
+	result["decodeFramesPerSecond"] = video.decodeSeconds > 0 ? video.frames / video.decodeSeconds : 0.;
+
+	fprintf(stdout, "%s", QJsonDocument(result).toJson().constData());
+	fflush(stdout);
+	return true;
+}
+
+void benchmarkLighting()
+{
+	const int size = 256;
+	const int runs = 20;
+
+	// Random heights and triangle flips, so every tile takes the same path as on a real map.
+	mapWidth = size;
+	mapHeight = size;
+	psMapTiles = (MAPTILE *)calloc(size * size, sizeof(MAPTILE));
+	srand(42);
+	for (int i = 0; i < size * size; ++i)
+	{
+		psMapTiles[i].height = rand() % TILE_MAX_HEIGHT;
+		psMapTiles[i].texture = rand() % 2 ? TILE_TRIFLIP : 0;
+	}
+	scrollMinX = 0;
+	scrollMinY = 0;
+	scrollMaxX = size;
+	scrollMaxY = size;
+	setTheSun(Vector3f(225.0f, -600.0f, 450.0f));  // As in init3DView.
+
+	int64_t totalTime = 0, bestTime = INT64_MAX;
+	for (int run = 0; run < runs; ++run)
+	{
+		QElapsedTimer timer;
+		timer.start();
+		initLighting(0, 0, size, size);
+		const int64_t time = timer.nsecsElapsed();
+		totalTime += time;
+		bestTime = std::min(bestTime, time);
+	}
+
+	uint32_t checksum = 0;
+	for (int i = 0; i < size * size; ++i)
+	{
+		checksum = checksum * 31 + psMapTiles[i].illumination;
+	}
+	free(psMapTiles);
+	psMapTiles = nullptr;
+	mapWidth = 0;
+	mapHeight = 0;
+
+	// Times in milliseconds per run. The checksum of the illumination shows whether a change altered the result.
+	QJsonObject result;
+	result["version"] = version_getVersionString();
+	result["width"] = size;
+	result["height"] = size;
+	result["runs"] = runs;
+	result["meanTime"] = totalTime / 1e6 / runs;
+	result["bestTime"] = bestTime / 1e6;
+	result["illuminationChecksum"] = QString::number(checksum, 16);
+
+	fprintf(stdout, "%s", QJsonDocument(result).toJson().constData());
+	fflush(stdout);
+}
@@ -0,0 +1,55 @@
+/*
+	This file is part of Warzone 2100.
+	Copyright (C) 2005-2017  Warzone 2100 Project
+
+	Warzone 2100 is free software; you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation; either version 2 of the License, or
+	(at your option) any later version.
+
+	Warzone 2100 is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with Warzone 2100; if not, write to the Free Software
+	Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301 USA
+*/
+/** @file
+ *  Simulation benchmark: runs a fixed number of game ticks as fast as possible, and reports where the time went,
+ *  using the tick profiler.
+ */
+
+#ifndef __INCLUDED_SRC_BENCHMARK_H__
+#define __INCLUDED_SRC_BENCHMARK_H__
+
+#include "lib/framework/types.h"
+
+struct PROFILE_TICK;
+
+/// Start benchmarking the next ticks game ticks, with unthrottled game time. Quits when done.
+void benchmarkStart(unsigned ticks);
+/// Report the results so far and stop benchmarking, if running.
+void benchmarkFinish();
+/// Whether a benchmark is running.
+bool benchmarkRunning();
+
+/// Call at the end of each game tick, with the profile of the tick. Finishes the benchmark after enough ticks.
+void benchmarkTickEnd(const PROFILE_TICK *tick);
+
+/// Returns a time stamp for benchmarkPathJob. Thread safe.
+int64_t benchmarkPathJobStart();
+/// Count the time since jobStart as spent on the path thread. Thread safe.
+void benchmarkPathJob(int64_t jobStart);
+
+/// Time text layout and rendering with empty and filled caches, and print the results as JSON. Needs the text module.
+void benchmarkText();
+/// Decode a video as fast as possible without showing or playing it, and print the frames per second as JSON. Needs
+/// no window, graphics or sound, only the search paths. Returns false if the video could not be decoded.
+bool benchmarkVideo(const char *fileName);
+/// Light the terrain of a generated 256x256 map of random heights several times, and print the times as JSON. Needs
+/// no window, graphics or loaded map.
+void benchmarkLighting();
+
+#endif // __INCLUDED_SRC_BENCHMARK_H__
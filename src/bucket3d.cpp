@@ -20,16 +20,18 @@
 /**
  * @file bucket3d.c
  *
- * Stores object render calls in a linked list renders after bucket sorting objects.
+ * Stores object render calls, and renders them after culling them and sorting them by depth and shape.
  */
 
 #include "lib/framework/frame.h"
 #include "lib/framework/vector.h"
 #include "lib/ivis_opengl/piematrix.h"
 #include "lib/ivis_opengl/pieclip.h"
+#include "lib/ivis_opengl/pietypes.h"
 
 #include "atmos.h"
 #include "bucket3d.h"
+#include "bucketsort.h"
 #include "component.h"
 #include "display3d.h"
 #include "effects.h"
@@ -37,64 +39,71 @@
 
 #include <algorithm>
 
-#define CLIP_LEFT	((SDWORD)0)
-#define CLIP_RIGHT	((SDWORD)pie_GetVideoBufferWidth())
-#define CLIP_TOP	((SDWORD)0)
-#define CLIP_BOTTOM ((SDWORD)pie_GetVideoBufferHeight())
-// Gerard - HACK Multiplied by 7 to fix clipping
-// someone needs to take a good look at the radius calculation
-#define SCALE_DEPTH (FP12_MULTIPLIER*7)
-
-struct BUCKET_TAG
+/// The objects added this frame, culled and sorted when rendered. Kept as separate arrays, so that culling runs over
+/// contiguous positions.
+struct BUCKET_LIST
 {
-	bool operator <(BUCKET_TAG const &b) const
+	void clear()
+	{
+		x.clear();
+		y.clear();
+		z.clear();
+		radius.clear();
+		depthBias.clear();
+		fixedDepth.clear();
+		shape.clear();
+		objectType.clear();
+		object.clear();
+	}
+
+	size_t size() const
 	{
-		return actualZ > b.actualZ;    // Sort in reverse z order.
+		return object.size();
 	}
 
-	RENDER_TYPE     objectType; //type of object held
-	void           *pObject;    //pointer to the object
-	int32_t         actualZ;
+	std::vector<float> x, y, z;            ///< Position relative to the camera, as given to pie_RotateProject.
+	std::vector<float> radius;             ///< Radius of the shape, or -1 to only cull objects behind the camera.
+	std::vector<int32_t> depthBias;        ///< Subtracted from the projected depth.
+	std::vector<int32_t> fixedDepth;       ///< Depth to sort by if visible, or -1 to sort by the projected depth.
+	std::vector<const iIMDShape *> shape;  ///< Objects at the same depth are grouped by shape.
+	std::vector<RENDER_TYPE> objectType;
+	std::vector<void *> object;
 };
 
-static std::vector<BUCKET_TAG> bucketArray;
+static BUCKET_LIST bucketList;
+// Scratch space for culling and sorting, kept to save allocating it every frame.
+static std::vector<int32_t> bucketDepth;
+static std::vector<uint64_t> bucketKeys, bucketKeysTemp;
+static std::vector<uint32_t> bucketOrder, bucketOrderTemp;
+
+static unsigned bucketCulled = 0;    ///< Objects culled so far this frame.
+static unsigned lastFrameDrawn = 0;
+static unsigned lastFrameCulled = 0;
 
-static SDWORD bucketCalculateZ(RENDER_TYPE objectType, void *pObject, const glm::mat4 &viewMatrix)
+/// Gets where objectType pObject is and how big it is, for culling, and the shape it is drawn with. Returns false
+/// for objects which are never drawn.
+static bool bucketGetBounds(RENDER_TYPE objectType, void *pObject, Vector3i *position, int32_t *radius, int32_t *depthBias, const iIMDShape **shape)
 {
-	SDWORD				z = 0, radius;
-	Vector2i				pixel;
-	Vector3i				position;
-	UDWORD				droidSize;
-	DROID				*psDroid;
-	BODY_STATS			*psBStats;
-	SIMPLE_OBJECT		*psSimpObj;
-	const iIMDShape		*pImd;
-	Spacetime               spacetime;
+	SIMPLE_OBJECT *psSimpObj;
+	const iIMDShape *pImd;
+
+	*radius = -1;
+	*depthBias = 0;
+	*shape = nullptr;
+	*position = Vector3i(0, 0, 0);
 
 	switch (objectType)
 	{
 	case RENDER_PARTICLE:
-		position.x = ((ATPART *)pObject)->position.x;
-		position.y = ((ATPART *)pObject)->position.y;
-		position.z = ((ATPART *)pObject)->position.z;
-
-		position.x = position.x - player.p.x;
-		position.z = -(position.z - player.p.z);
+		position->x = ((ATPART *)pObject)->position.x - player.p.x;
+		position->y = ((ATPART *)pObject)->position.y;
+		position->z = -(((ATPART *)pObject)->position.z - player.p.z);
 
 		/* 16 below is HACK!!! */
-		z = pie_RotateProject(&position, viewMatrix, &pixel) - 16;
-		if (z > 0)
-		{
-			//particle use the image radius
-			radius = ((ATPART *)pObject)->imd->radius;
-			radius *= SCALE_DEPTH;
-			radius /= z;
-			if ((pixel.x + radius < CLIP_LEFT) || (pixel.x - radius > CLIP_RIGHT)
-			    || (pixel.y + radius < CLIP_TOP) || (pixel.y - radius > CLIP_BOTTOM))
-			{
-				z = -1;
-			}
-		}
+		*depthBias = 16;
+		//particle use the image radius
+		*shape = ((ATPART *)pObject)->imd;
+		*radius = (*shape)->radius;
 		break;
 	case RENDER_PROJECTILE:
 		if (((PROJECTILE *)pObject)->psWStats->weaponSubClass == WSC_FLAME ||
@@ -102,223 +111,104 @@ static SDWORD bucketCalculateZ(RENDER_TYPE objectType, void *pObject, const glm:
 		    ((PROJECTILE *)pObject)->psWStats->weaponSubClass == WSC_EMP)
 		{
 			/* We don't do projectiles from these guys, cos there's an effect instead */
-			z = -1;
+			return false;
 		}
-		else
-		{
-
-			//the weapon stats holds the reference to which graphic to use
-			pImd = ((PROJECTILE *)pObject)->psWStats->pInFlightGraphic;
-
-			psSimpObj = (SIMPLE_OBJECT *) pObject;
-			position.x = psSimpObj->pos.x - player.p.x;
-			position.z = -(psSimpObj->pos.y - player.p.z);
 
-			position.y = psSimpObj->pos.z;
+		//the weapon stats holds the reference to which graphic to use
+		*shape = ((PROJECTILE *)pObject)->psWStats->pInFlightGraphic;
+		*radius = (*shape)->radius;
 
-			z = pie_RotateProject(&position, viewMatrix, &pixel);
-
-			if (z > 0)
-			{
-				//particle use the image radius
-				radius = pImd->radius;
-				radius *= SCALE_DEPTH;
-				radius /= z;
-				if ((pixel.x + radius < CLIP_LEFT) || (pixel.x - radius > CLIP_RIGHT)
-				    || (pixel.y + radius < CLIP_TOP) || (pixel.y - radius > CLIP_BOTTOM))
-				{
-					z = -1;
-				}
-			}
-		}
+		psSimpObj = (SIMPLE_OBJECT *) pObject;
+		position->x = psSimpObj->pos.x - player.p.x;
+		position->z = -(psSimpObj->pos.y - player.p.z);
+		position->y = psSimpObj->pos.z;
 		break;
 	case RENDER_STRUCTURE://not depth sorted
 		psSimpObj = (SIMPLE_OBJECT *) pObject;
-		position.x = psSimpObj->pos.x - player.p.x;
-		position.z = -(psSimpObj->pos.y - player.p.z);
+		position->x = psSimpObj->pos.x - player.p.x;
+		position->z = -(psSimpObj->pos.y - player.p.z);
 
-		if ((objectType == RENDER_STRUCTURE) &&
-		    ((((STRUCTURE *)pObject)->pStructureType->type == REF_DEFENSE) ||
-		     (((STRUCTURE *)pObject)->pStructureType->type == REF_WALL) ||
-		     (((STRUCTURE *)pObject)->pStructureType->type == REF_WALLCORNER)))
+		if ((((STRUCTURE *)pObject)->pStructureType->type == REF_DEFENSE) ||
+		    (((STRUCTURE *)pObject)->pStructureType->type == REF_WALL) ||
+		    (((STRUCTURE *)pObject)->pStructureType->type == REF_WALLCORNER))
 		{
-			position.y = psSimpObj->pos.z + 64;
-			radius = ((STRUCTURE *)pObject)->sDisplay.imd->radius; //walls guntowers and tank traps clip tightly
+			position->y = psSimpObj->pos.z + 64; //walls guntowers and tank traps clip tightly
 		}
 		else
 		{
-			position.y = psSimpObj->pos.z;
-			radius = (((STRUCTURE *)pObject)->sDisplay.imd->radius);
-		}
-
-		z = pie_RotateProject(&position, viewMatrix, &pixel);
-
-		if (z > 0)
-		{
-			//particle use the image radius
-			radius *= SCALE_DEPTH;
-			radius /= z;
-			if ((pixel.x + radius < CLIP_LEFT) || (pixel.x - radius > CLIP_RIGHT)
-			    || (pixel.y + radius < CLIP_TOP) || (pixel.y - radius > CLIP_BOTTOM))
-			{
-				z = -1;
-			}
+			position->y = psSimpObj->pos.z;
 		}
+		*shape = ((STRUCTURE *)pObject)->sDisplay.imd;
+		*radius = (*shape)->radius;
 		break;
 	case RENDER_FEATURE://not depth sorted
 		psSimpObj = (SIMPLE_OBJECT *) pObject;
-		position.x = psSimpObj->pos.x - player.p.x;
-		position.z = -(psSimpObj->pos.y - player.p.z);
+		position->x = psSimpObj->pos.x - player.p.x;
+		position->z = -(psSimpObj->pos.y - player.p.z);
+		position->y = psSimpObj->pos.z + 2;
 
-		position.y = psSimpObj->pos.z + 2;
-
-		z = pie_RotateProject(&position, viewMatrix, &pixel);
-
-		if (z > 0)
-		{
-			//particle use the image radius
-			radius = ((FEATURE *)pObject)->sDisplay.imd->radius;
-			radius *= SCALE_DEPTH;
-			radius /= z;
-			if ((pixel.x + radius < CLIP_LEFT) || (pixel.x - radius > CLIP_RIGHT)
-			    || (pixel.y + radius < CLIP_TOP) || (pixel.y - radius > CLIP_BOTTOM))
-			{
-				z = -1;
-			}
-		}
+		*shape = ((FEATURE *)pObject)->sDisplay.imd;
+		*radius = (*shape)->radius;
 		break;
 	case RENDER_DROID:
-		psDroid = (DROID *) pObject;
-
 		psSimpObj = (SIMPLE_OBJECT *) pObject;
-		position.x = psSimpObj->pos.x - player.p.x;
-		position.z = -(psSimpObj->pos.y - player.p.z);
-		position.y = psSimpObj->pos.z;
-
-		psBStats = asBodyStats + psDroid->asBits[COMP_BODY];
-		droidSize = psBStats->pIMD->radius;
-		z = pie_RotateProject(&position, viewMatrix, &pixel) - (droidSize * 2);
+		position->x = psSimpObj->pos.x - player.p.x;
+		position->z = -(psSimpObj->pos.y - player.p.z);
+		position->y = psSimpObj->pos.z;
 
-		if (z > 0)
-		{
-			//particle use the image radius
-			radius = droidSize;
-			radius *= SCALE_DEPTH;
-			radius /= z;
-			if ((pixel.x + radius < CLIP_LEFT) || (pixel.x - radius > CLIP_RIGHT)
-			    || (pixel.y + radius < CLIP_TOP) || (pixel.y - radius > CLIP_BOTTOM))
-			{
-				z = -1;
-			}
-		}
+		*shape = BODY_IMD(((DROID *)pObject), 0);
+		*radius = (asBodyStats + ((DROID *)pObject)->asBits[COMP_BODY])->pIMD->radius;
+		*depthBias = *radius * 2;
 		break;
 	case RENDER_PROXMSG:
 		if (((PROXIMITY_DISPLAY *)pObject)->type == POS_PROXDATA)
 		{
 			const PROXIMITY_DISPLAY *ptr = (PROXIMITY_DISPLAY *)pObject;
-			position.x = ((VIEW_PROXIMITY *)ptr->psMessage->pViewData->pData)->x - player.p.x;
-			position.z = -(((VIEW_PROXIMITY *)ptr->psMessage->pViewData->pData)->y - player.p.z);
-			position.y = ((VIEW_PROXIMITY *)ptr->psMessage->pViewData->pData)->z;
+			position->x = ((VIEW_PROXIMITY *)ptr->psMessage->pViewData->pData)->x - player.p.x;
+			position->z = -(((VIEW_PROXIMITY *)ptr->psMessage->pViewData->pData)->y - player.p.z);
+			position->y = ((VIEW_PROXIMITY *)ptr->psMessage->pViewData->pData)->z;
 		}
 		else if (((PROXIMITY_DISPLAY *)pObject)->type == POS_PROXOBJ)
 		{
 			const PROXIMITY_DISPLAY *ptr = (PROXIMITY_DISPLAY *)pObject;
-			position.x = ptr->psMessage->psObj->pos.x - player.p.x;
-			position.z = -(ptr->psMessage->psObj->pos.y - player.p.z);
-			position.y = ptr->psMessage->psObj->pos.z;
-		}
-		z = pie_RotateProject(&position, viewMatrix, &pixel);
-
-		if (z > 0)
-		{
-			//particle use the image radius
-			pImd = getImdFromIndex(MI_BLIP_ENEMY);//use MI_BLIP_ENEMY as all are same radius
-			radius = pImd->radius;
-			radius *= SCALE_DEPTH;
-			radius /= z;
-			if ((pixel.x + radius < CLIP_LEFT) || (pixel.x - radius > CLIP_RIGHT)
-			    || (pixel.y + radius < CLIP_TOP) || (pixel.y - radius > CLIP_BOTTOM))
-			{
-				z = -1;
-			}
+			position->x = ptr->psMessage->psObj->pos.x - player.p.x;
+			position->z = -(ptr->psMessage->psObj->pos.y - player.p.z);
+			position->y = ptr->psMessage->psObj->pos.z;
 		}
+		pImd = getImdFromIndex(MI_BLIP_ENEMY);//use MI_BLIP_ENEMY as all are same radius
+		*radius = pImd->radius;
 		break;
 	case RENDER_EFFECT:
-		position.x = ((EFFECT *)pObject)->position.x - player.p.x;
-		position.z = -(((EFFECT *)pObject)->position.z - player.p.z);
-		position.y = ((EFFECT *)pObject)->position.y;
+		position->x = ((EFFECT *)pObject)->position.x - player.p.x;
+		position->z = -(((EFFECT *)pObject)->position.z - player.p.z);
+		position->y = ((EFFECT *)pObject)->position.y;
 
 		/* 16 below is HACK!!! */
-		z = pie_RotateProject(&position, viewMatrix, &pixel) - 16;
-
-		if (z > 0)
+		*depthBias = 16;
+		*shape = ((EFFECT *)pObject)->imd;
+		if (*shape != nullptr)
 		{
-			//particle use the image radius
-			pImd = ((EFFECT *)pObject)->imd;
-			if (pImd != nullptr)
-			{
-				radius = pImd->radius;
-				radius *= SCALE_DEPTH;
-				radius /= z;
-				if ((pixel.x + radius < CLIP_LEFT) || (pixel.x - radius > CLIP_RIGHT)
-				    || (pixel.y + radius < CLIP_TOP) || (pixel.y - radius > CLIP_BOTTOM))
-				{
-					z = -1;
-				}
-			}
+			*radius = (*shape)->radius;
 		}
-
 		break;
-
 	case RENDER_DELIVPOINT:
-		position.x = ((FLAG_POSITION *)pObject)->coords.x - player.p.x;
-		position.z = -(((FLAG_POSITION *)pObject)->
-		               coords.y - player.p.z);
-		position.y = ((FLAG_POSITION *)pObject)->coords.z;
-
-		z = pie_RotateProject(&position, viewMatrix, &pixel);
-
-		if (z > 0)
-		{
-			//particle use the image radius
-			radius = pAssemblyPointIMDs[((FLAG_POSITION *)pObject)->factoryType][((FLAG_POSITION *)pObject)->factoryInc]->radius;
-			radius *= SCALE_DEPTH;
-			radius /= z;
-			if ((pixel.x + radius < CLIP_LEFT) || (pixel.x - radius > CLIP_RIGHT)
-			    || (pixel.y + radius < CLIP_TOP) || (pixel.y - radius > CLIP_BOTTOM))
-			{
-				z = -1;
-			}
-		}
+		position->x = ((FLAG_POSITION *)pObject)->coords.x - player.p.x;
+		position->z = -(((FLAG_POSITION *)pObject)->coords.y - player.p.z);
+		position->y = ((FLAG_POSITION *)pObject)->coords.z;
 
+		*shape = pAssemblyPointIMDs[((FLAG_POSITION *)pObject)->factoryType][((FLAG_POSITION *)pObject)->factoryInc];
+		*radius = (*shape)->radius;
 		break;
-
 	default:
 		break;
 	}
 
-	return z;
+	return true;
 }
 
-/* add an object to the current render list */
-void bucketAddTypeToList(RENDER_TYPE objectType, void *pObject, const glm::mat4 &viewMatrix)
+/// The depth to sort objectType pObject by, if it is visible, or -1 to sort by its projected depth.
+static int32_t bucketFixedDepth(RENDER_TYPE objectType, void *pObject, const iIMDShape *shape)
 {
-	const iIMDShape *pie;
-	BUCKET_TAG	newTag;
-	int32_t		z = bucketCalculateZ(objectType, pObject, viewMatrix);
-
-	if (z < 0)
-	{
-		/* Object will not be render - has been clipped! */
-		if (objectType == RENDER_DROID || objectType == RENDER_STRUCTURE)
-		{
-			/* Won't draw selection boxes */
-			((BASE_OBJECT *)pObject)->sDisplay.frameNumber = 0;
-		}
-
-		return;
-	}
-
 	switch (objectType)
 	{
 	case RENDER_EFFECT:
@@ -329,88 +219,125 @@ void bucketAddTypeToList(RENDER_TYPE objectType, void *pObject, const glm::mat4
 		case EFFECT_SMOKE:
 		case EFFECT_FIREWORK:
 			// Use calculated Z
-			break;
+			return -1;
 
 		case EFFECT_WAYPOINT:
-			pie = ((EFFECT *)pObject)->imd;
-			z = INT32_MAX - pie->texpage;
-			break;
+			return INT32_MAX - shape->texpage;
 
 		default:
-			z = INT32_MAX - 42;
-			break;
+			return INT32_MAX - 42;
 		}
-		break;
 	case RENDER_DROID:
-		pie = BODY_IMD(((DROID *)pObject), 0);
-		z = INT32_MAX - pie->texpage;
-		break;
 	case RENDER_STRUCTURE:
-		pie = ((STRUCTURE *)pObject)->sDisplay.imd;
-		z = INT32_MAX - pie->texpage;
-		break;
 	case RENDER_FEATURE:
-		pie = ((FEATURE *)pObject)->sDisplay.imd;
-		z = INT32_MAX - pie->texpage;
-		break;
 	case RENDER_DELIVPOINT:
-		pie = pAssemblyPointIMDs[((FLAG_POSITION *)pObject)->
-		                         factoryType][((FLAG_POSITION *)pObject)->factoryInc];
-		z = INT32_MAX - pie->texpage;
-		break;
+		return INT32_MAX - shape->texpage;
 	case RENDER_PARTICLE:
-		z = 0;
-		break;
+		return 0;
 	default:
 		// Use calculated Z
-		break;
+		return -1;
 	}
+}
 
-	//put the object data into the tag
-	newTag.objectType = objectType;
-	newTag.pObject = pObject;
-	newTag.actualZ = z;
+/* add an object to the current render list */
+void bucketAddTypeToList(RENDER_TYPE objectType, void *pObject)
+{
+	Vector3i position;
+	int32_t radius, depthBias;
+	const iIMDShape *shape;
+
+	if (!bucketGetBounds(objectType, pObject, &position, &radius, &depthBias, &shape))
+	{
+		++bucketCulled;
+		return;
+	}
 
-	//add tag to bucketArray
-	bucketArray.push_back(newTag);
+	// Culled along with the rest of the list, when rendering it.
+	bucketList.x.push_back(position.x);
+	bucketList.y.push_back(position.y);
+	bucketList.z.push_back(position.z);
+	bucketList.radius.push_back(radius);
+	bucketList.depthBias.push_back(depthBias);
+	bucketList.fixedDepth.push_back(bucketFixedDepth(objectType, pObject, shape));
+	bucketList.shape.push_back(shape);
+	bucketList.objectType.push_back(objectType);
+	bucketList.object.push_back(pObject);
 }
 
 /* render Objects in list */
 void bucketRenderCurrentList(const glm::mat4 &viewMatrix)
 {
-	std::sort(bucketArray.begin(), bucketArray.end());
+	const size_t n = bucketList.size();
+	bucketDepth.resize(n);
+	bucketCull(bucketList.x.data(), bucketList.y.data(), bucketList.z.data(), bucketList.radius.data(), bucketList.depthBias.data(), n,
+	           pie_PerspectiveGet() * viewMatrix, pie_GetVideoBufferWidth(), pie_GetVideoBufferHeight(), bucketDepth.data());
+
+	// Sort in reverse z order, and then by shape.
+	bucketKeys.clear();
+	bucketOrder.clear();
+	for (size_t i = 0; i < n; ++i)
+	{
+		if (bucketDepth[i] < 0)
+		{
+			/* Object will not be render - has been clipped! */
+			if (bucketList.objectType[i] == RENDER_DROID || bucketList.objectType[i] == RENDER_STRUCTURE)
+			{
+				/* Won't draw selection boxes */
+				((BASE_OBJECT *)bucketList.object[i])->sDisplay.frameNumber = 0;
+			}
+			++bucketCulled;
+			continue;
+		}
+		const int32_t z = bucketList.fixedDepth[i] >= 0 ? bucketList.fixedDepth[i] : bucketDepth[i];
+		const uint32_t shapeKey = (uint32_t)((uintptr_t)bucketList.shape[i] >> 4);
+		bucketKeys.push_back((uint64_t)(uint32_t)(INT32_MAX - z) << 32 | shapeKey);
+		bucketOrder.push_back(i);
+	}
+	bucketRadixSort(bucketKeys, bucketOrder, bucketKeysTemp, bucketOrderTemp);
 
-	for (std::vector<BUCKET_TAG>::const_iterator thisTag = bucketArray.begin(); thisTag != bucketArray.end(); ++thisTag)
+	for (uint32_t i : bucketOrder)
 	{
-		switch (thisTag->objectType)
+		void *pObject = bucketList.object[i];
+		switch (bucketList.objectType[i])
 		{
 		case RENDER_PARTICLE:
-			renderParticle((ATPART *)thisTag->pObject, viewMatrix);
+			renderParticle((ATPART *)pObject, viewMatrix);
 			break;
 		case RENDER_EFFECT:
-			renderEffect((EFFECT *)thisTag->pObject, viewMatrix);
+			renderEffect((EFFECT *)pObject, viewMatrix);
 			break;
 		case RENDER_DROID:
-			displayComponentObject((DROID *)thisTag->pObject, viewMatrix);
+			displayComponentObject((DROID *)pObject, viewMatrix);
 			break;
 		case RENDER_STRUCTURE:
-			renderStructure((STRUCTURE *)thisTag->pObject, viewMatrix);
+			renderStructure((STRUCTURE *)pObject, viewMatrix);
 			break;
 		case RENDER_FEATURE:
-			renderFeature((FEATURE *)thisTag->pObject, viewMatrix);
+			renderFeature((FEATURE *)pObject, viewMatrix);
 			break;
 		case RENDER_PROXMSG:
-			renderProximityMsg((PROXIMITY_DISPLAY *)thisTag->pObject, viewMatrix);
+			renderProximityMsg((PROXIMITY_DISPLAY *)pObject, viewMatrix);
 			break;
 		case RENDER_PROJECTILE:
-			renderProjectile((PROJECTILE *)thisTag->pObject, viewMatrix);
+			renderProjectile((PROJECTILE *)pObject, viewMatrix);
 			break;
 		case RENDER_DELIVPOINT:
-			renderDeliveryPoint((FLAG_POSITION *)thisTag->pObject, false, viewMatrix);
+			renderDeliveryPoint((FLAG_POSITION *)pObject, false, viewMatrix);
 			break;
 		}
 	}
 
-	//reset the bucket array as we go
-	bucketArray.resize(0);
+	lastFrameDrawn = bucketOrder.size();
+	lastFrameCulled = bucketCulled;
+	bucketCulled = 0;
+
+	//reset the bucket list as we go
+	bucketList.clear();
+}
+
+void bucketGetCounts(unsigned *pDrawn, unsigned *pCulled)
+{
+	*pDrawn = lastFrameDrawn;
+	*pCulled = lastFrameCulled;
 }
@@ -36,9 +36,12 @@ enum RENDER_TYPE
 //function prototypes
 
 /* add an object to the current render list */
-void bucketAddTypeToList(RENDER_TYPE objectType, void *object, const glm::mat4 &viewMatrix);
+void bucketAddTypeToList(RENDER_TYPE objectType, void *object);
 
 /* render Objects in list */
 void bucketRenderCurrentList(const glm::mat4 &viewMatrix);
 
+/// Gets how many objects were drawn and how many were culled, in the last list rendered.
+void bucketGetCounts(unsigned *pDrawn, unsigned *pCulled);
+
 #endif // __INCLUDED_SRC_BUCKET3D_H__
@@ -0,0 +1,102 @@
+/*
+	This file is part of Warzone 2100.
+	Copyright (C) 2005-2017  Warzone 2100 Project
+
+	Warzone 2100 is free software; you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation; either version 2 of the License, or
+	(at your option) any later version.
+
+	Warzone 2100 is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with Warzone 2100; if not, write to the Free Software
+	Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301 USA
+*/
+/** @file
+ *  Culling and sorting of the render list, see bucketsort.h.
+ */
+
+#include "lib/framework/frame.h"
+#include "lib/framework/fixedpoint.h"
+#include "lib/ivis_opengl/pietypes.h"
+
+#include "bucketsort.h"
+
+#include <algorithm>
+
+// Gerard - HACK Multiplied by 7 to fix clipping
+// someone needs to take a good look at the radius calculation
+#define SCALE_DEPTH (FP12_MULTIPLIER*7)
+
+#define HACK_SCALE_FACTOR (1.f / (3 * 330))  // As in pie_RotateProject.
+
+void bucketCull(const float *x, const float *y, const float *z, const float *radius, const int32_t *depthBias, size_t n,
+                const glm::mat4 &matrix, float width, float height, int32_t *depth)
+{
+	for (size_t i = 0; i < n; ++i)
+	{
+		const float w = matrix[0][3] * x[i] + matrix[1][3] * y[i] + matrix[2][3] * z[i] + matrix[3][3];
+		const float px = matrix[0][0] * x[i] + matrix[1][0] * y[i] + matrix[2][0] * z[i] + matrix[3][0];
+		const float py = matrix[0][1] * x[i] + matrix[1][1] * y[i] + matrix[2][1] * z[i] + matrix[3][1];
+		const int32_t d = (int32_t)w - depthBias[i];
+
+		// Points too near or behind the camera are put a long way off screen.
+		const bool behind = w < 256 * HACK_SCALE_FACTOR;
+		const float safeW = behind ? 1.f : w;
+		const int32_t sx = behind ? LONG_WAY : (int32_t)((.5f + .5f * (px / safeW)) * width);
+		const int32_t sy = behind ? LONG_WAY : (int32_t)((.5f - .5f * (py / safeW)) * height);
+
+		const int32_t r = (int32_t)radius[i] * SCALE_DEPTH / std::max(d, 1);
+		const bool offScreen = d > 0 && radius[i] >= 0 && (sx + r < 0 || sx - r > width || sy + r < 0 || sy - r > height);
+		depth[i] = offScreen ? -1 : d;
+	}
+}
+
+void bucketRadixSort(std::vector<uint64_t> &keys, std::vector<uint32_t> &values, std::vector<uint64_t> &keysTemp, std::vector<uint32_t> &valuesTemp)
+{
+	const size_t n = keys.size();
+	if (n <= 1)
+	{
+		return;
+	}
+	keysTemp.resize(n);
+	valuesTemp.resize(n);
+
+	size_t counts[8][256];
+	memset(counts, 0, sizeof(counts));
+	for (uint64_t key : keys)
+	{
+		for (unsigned byte = 0; byte < 8; ++byte)
+		{
+			++counts[byte][(key >> (8 * byte)) & 0xFF];
+		}
+	}
+
+	for (unsigned byte = 0; byte < 8; ++byte)
+	{
+		const unsigned shift = 8 * byte;
+		if (counts[byte][(keys[0] >> shift) & 0xFF] == n)
+		{
+			continue;  // Already in order by this byte.
+		}
+		size_t offsets[256];
+		size_t offset = 0;
+		for (unsigned digit = 0; digit < 256; ++digit)
+		{
+			offsets[digit] = offset;
+			offset += counts[byte][digit];
+		}
+		for (size_t i = 0; i < n; ++i)
+		{
+			const size_t to = offsets[(keys[i] >> shift) & 0xFF]++;
+			keysTemp[to] = keys[i];
+			valuesTemp[to] = values[i];
+		}
+		keys.swap(keysTemp);
+		values.swap(valuesTemp);
+	}
+}
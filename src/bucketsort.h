@@ -0,0 +1,40 @@
+/*
+	This file is part of Warzone 2100.
+	Copyright (C) 2005-2017  Warzone 2100 Project
+
+	Warzone 2100 is free software; you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation; either version 2 of the License, or
+	(at your option) any later version.
+
+	Warzone 2100 is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with Warzone 2100; if not, write to the Free Software
+	Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301 USA
+*/
+/** @file
+ *  Culling and sorting of the render list of bucket3d.cpp, without any graphics or game state, so tests can run them.
+ */
+
+#ifndef __INCLUDED_SRC_BUCKETSORT_H__
+#define __INCLUDED_SRC_BUCKETSORT_H__
+
+#include "lib/framework/vector.h"
+
+#include <vector>
+
+/// Projects the n positions with matrix, the perspective times the view matrix, and sets depth to their depths, less
+/// depthBias, or to -1 for those off a width by height screen. Does what pie_RotateProject and the clipping tests
+/// used with it do, for all the positions in one loop. A radius of -1 only culls positions behind the camera.
+void bucketCull(const float *x, const float *y, const float *z, const float *radius, const int32_t *depthBias, size_t n,
+                const glm::mat4 &matrix, float width, float height, int32_t *depth);
+
+/// Sorts keys in increasing order, moving values along with them, by a least significant byte first radix sort.
+/// Bytes which are the same in all the keys are skipped. keysTemp and valuesTemp are scratch space.
+void bucketRadixSort(std::vector<uint64_t> &keys, std::vector<uint32_t> &values, std::vector<uint64_t> &keysTemp, std::vector<uint32_t> &valuesTemp);
+
+#endif // __INCLUDED_SRC_BUCKETSORT_H__
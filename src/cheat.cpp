@@ -46,6 +46,9 @@ static CHEAT_ENTRY cheatCodes[] =
 	{"templates", listTemplates}, // print templates
 	{"jsload", jsAutogame}, // load an AI script for selectedPlayer
 	{"jsdebug", jsShowDebug}, // show scripting states
+	{"scriptprofile", kf_ScriptProfile}, // start measuring legacy script performance, or show and stop it
+	{"tickprofile", kf_ToggleTickProfile}, // show where the game tick time goes
+	{"tickprofile dump", kf_DumpTickProfile}, // write the tick profile as a chrome://tracing timeline
 	{"teach us", kf_TeachSelected}, // give experience to selected units
 	{"clone wars", []{ kf_CloneSelected(10); }}, // clone selected units
 	{"clone wars!", []{ kf_CloneSelected(40); }}, // clone selected units
@@ -82,6 +82,12 @@ typedef struct _poptContext
 static bool wz_autogame = false;
 static std::string wz_saveandquit;
 static std::string wz_test;
+static std::string wz_record;
+static std::string wz_replay;
+static unsigned wz_benchmark = 0;
+static bool wz_benchmark_text = false;
+static std::string wz_benchmark_video;
+static bool wz_benchmark_lighting = false;
 
 static void poptPrintHelp(poptContext ctx, FILE *output, bool show_all)
 {
@@ -227,6 +233,7 @@ typedef enum
 	CLI_DEBUG,
 	CLI_DEBUGFILE,
 	CLI_FLUSHDEBUGSTDERR,
+	CLI_DEBUGFORMAT,
 	CLI_FULLSCREEN,
 	CLI_GAME,
 	CLI_HELP,
@@ -252,6 +259,12 @@ typedef enum
 	CLI_AUTOGAME,
 	CLI_SAVEANDQUIT,
 	CLI_SKIRMISH,
+	CLI_RECORD,
+	CLI_REPLAY,
+	CLI_BENCHMARK,
+	CLI_BENCHMARK_TEXT,
+	CLI_BENCHMARK_VIDEO,
+	CLI_BENCHMARK_LIGHTING,
 } CLI_OPTIONS;
 
 static const struct poptOption *getOptionsTable()
@@ -263,6 +276,7 @@ static const struct poptOption *getOptionsTable()
 		{ "debug",      '\0', POPT_ARG_STRING, nullptr, CLI_DEBUG,      N_("Show debug for given level"),        N_("debug level"), false },
 		{ "debugfile",  '\0', POPT_ARG_STRING, nullptr, CLI_DEBUGFILE,  N_("Log debug output to file"),          N_("file"), false },
 		{ "flush-debug-stderr", '\0', POPT_ARG_NONE, nullptr, CLI_FLUSHDEBUGSTDERR, N_("Flush all debug output written to stderr"), nullptr, true },
+		{ "debugformat", '\0', POPT_ARG_STRING, nullptr, CLI_DEBUGFORMAT, N_("Format of debug output, text or json"), N_("format"), true },
 		{ "fullscreen", '\0', POPT_ARG_NONE,   nullptr, CLI_FULLSCREEN, N_("Play in fullscreen mode"),           nullptr, false },
 		{ "game",       '\0', POPT_ARG_STRING, nullptr, CLI_GAME,       N_("Load a specific game mode"),         N_("level name"), true },
 		{ "help",       'h',  POPT_ARG_NONE,   nullptr, CLI_HELP,       N_("Show options and exit"),             nullptr, false },
@@ -288,6 +302,12 @@ static const struct poptOption *getOptionsTable()
 		{ "autogame",   '\0', POPT_ARG_NONE,   nullptr, CLI_AUTOGAME,   N_("Run games automatically for testing"), nullptr, true },
 		{ "saveandquit", '\0', POPT_ARG_STRING, nullptr, CLI_SAVEANDQUIT, N_("Immediately save game and quit"), N_("save name"), true },
 		{ "skirmish",   '\0', POPT_ARG_STRING, nullptr, CLI_SKIRMISH,   N_("Start skirmish game with given settings file"), N_("test"), true },
+		{ "record",     '\0', POPT_ARG_STRING, nullptr, CLI_RECORD,     N_("Record a replay of the game"),       N_("file"), true },
+		{ "replay",     '\0', POPT_ARG_STRING, nullptr, CLI_REPLAY,     N_("Play back a recorded replay"),       N_("file"), true },
+		{ "benchmark",  '\0', POPT_ARG_STRING, nullptr, CLI_BENCHMARK,  N_("Run an automatic game for the given number of ticks, and print timings as JSON"), N_("ticks"), true },
+		{ "benchmark-text", '\0', POPT_ARG_NONE, nullptr, CLI_BENCHMARK_TEXT, N_("Time text layout with cold and warm caches, print timings as JSON, and quit"), nullptr, true },
+		{ "benchmark-video", '\0', POPT_ARG_STRING, nullptr, CLI_BENCHMARK_VIDEO, N_("Decode the given video as fast as possible without showing it, print frames per second as JSON, and quit"), N_("video"), true },
+		{ "benchmark-lighting", '\0', POPT_ARG_NONE, nullptr, CLI_BENCHMARK_LIGHTING, N_("Time lighting the terrain of a generated 256x256 map, print timings as JSON, and quit"), nullptr, true },
 		// Terminating entry
 		{ nullptr,         '\0', 0,               nullptr, 0,              nullptr,                                    nullptr, true },
 	};
@@ -384,6 +404,14 @@ bool ParseCommandLineEarly(int argc, const char **argv)
 			debugFlushStderr();
 			break;
 
+		case CLI_DEBUGFORMAT:
+			token = poptGetOptArg(poptCon);
+			if (token == nullptr || !debugSetFormat(token))
+			{
+				qFatal("Usage: --debugformat=<text|json>");
+			}
+			break;
+
 		case CLI_CONFIGDIR:
 			// retrieve the configuration directory
 			token = poptGetOptArg(poptCon);
@@ -434,6 +462,7 @@ bool ParseCommandLine(int argc, const char **argv)
 		case CLI_DEBUG:
 		case CLI_DEBUGFILE:
 		case CLI_FLUSHDEBUGSTDERR:
+		case CLI_DEBUGFORMAT:
 		case CLI_CONFIGDIR:
 		case CLI_HELP:
 		case CLI_HELP_ALL:
@@ -646,6 +675,50 @@ bool ParseCommandLine(int argc, const char **argv)
 			}
 			wz_test = token;
 			break;
+
+		case CLI_RECORD:
+			token = poptGetOptArg(poptCon);
+			if (token == nullptr)
+			{
+				qFatal("Bad replay file name");
+			}
+			wz_record = token;
+			break;
+
+		case CLI_REPLAY:
+			token = poptGetOptArg(poptCon);
+			if (token == nullptr)
+			{
+				qFatal("Bad replay file name");
+			}
+			wz_replay = token;
+			break;
+
+		case CLI_BENCHMARK:
+			token = poptGetOptArg(poptCon);
+			if (token == nullptr || sscanf(token, "%u", &wz_benchmark) != 1 || wz_benchmark == 0)
+			{
+				qFatal("Bad number of benchmark ticks");
+			}
+			wz_autogame = true;
+			break;
+
+		case CLI_BENCHMARK_TEXT:
+			wz_benchmark_text = true;
+			break;
+
+		case CLI_BENCHMARK_VIDEO:
+			token = poptGetOptArg(poptCon);
+			if (token == nullptr)
+			{
+				qFatal("Bad video file name");
+			}
+			wz_benchmark_video = token;
+			break;
+
+		case CLI_BENCHMARK_LIGHTING:
+			wz_benchmark_lighting = true;
+			break;
 		};
 	}
 
@@ -666,3 +739,33 @@ const std::string &wz_skirmish_test()
 {
 	return wz_test;
 }
+
+const std::string &wz_record_file()
+{
+	return wz_record;
+}
+
+const std::string &wz_replay_file()
+{
+	return wz_replay;
+}
+
+unsigned benchmark_ticks()
+{
+	return wz_benchmark;
+}
+
+bool benchmark_text()
+{
+	return wz_benchmark_text;
+}
+
+const std::string &benchmark_video()
+{
+	return wz_benchmark_video;
+}
+
+bool benchmark_lighting()
+{
+	return wz_benchmark_lighting;
+}
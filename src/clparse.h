@@ -31,5 +31,11 @@ bool ParseCommandLineEarly(int argc, const char **argv);
 bool autogame_enabled();
 const std::string &saveandquit_enabled();
 const std::string &wz_skirmish_test();
+const std::string &wz_record_file();
+const std::string &wz_replay_file();
+unsigned benchmark_ticks();
+bool benchmark_text();
+const std::string &benchmark_video();
+bool benchmark_lighting();
 
 #endif // __INCLUDED_SRC_CLPARSE_H__
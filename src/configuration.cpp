@@ -94,6 +94,8 @@ bool loadConfig()
 	scroll_speed_accel = ini.value("scroll", DEFAULTSCROLL).toInt();
 	setDrawShadows(ini.value("shadows", true).toBool());
 	war_setSoundEnabled(ini.value("sound", true).toBool());
+	war_setJsonSaves(ini.value("jsonSaves", false).toBool());
+	war_setAutosaveInterval(ini.value("autosaveInterval", 10).toInt());
 	setInvertMouseStatus(ini.value("mouseflip", true).toBool());
 	setRightClickOrders(ini.value("RightClickOrders", false).toBool());
 	setMiddleClickRotate(ini.value("MiddleClickRotate", false).toBool());
@@ -210,6 +212,8 @@ bool saveConfig()
 	ini.setValue("showFPS", (SDWORD)showFPS);
 	ini.setValue("shadows", (SDWORD)(getDrawShadows()));	// shadows
 	ini.setValue("sound", (SDWORD)war_getSoundEnabled());
+	ini.setValue("jsonSaves", (SDWORD)war_getJsonSaves());
+	ini.setValue("autosaveInterval", war_getAutosaveInterval());
 	ini.setValue("FMVmode", (SDWORD)(war_GetFMVmode()));		// sequences
 	ini.setValue("scanlines", (SDWORD)war_getScanlineMode());
 	ini.setValue("subtitles", (SDWORD)(seq_GetSubtitles()));		// subtitles
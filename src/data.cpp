@@ -28,6 +28,7 @@
 
 #include "lib/framework/frame.h"
 #include "lib/framework/frameresource.h"
+#include "lib/framework/jsonreader.h"
 #include "lib/framework/strres.h"
 #include "lib/framework/crc.h"
 #include "lib/gamelib/parser.h"
@@ -35,6 +36,7 @@
 #include "lib/ivis_opengl/png_util.h"
 #include "lib/script/script.h"
 #include "lib/sound/audio.h"
+#include "lib/sound/track.h"
 
 #include "qtscript.h"
 #include "data.h"
@@ -449,29 +451,58 @@ static void dataSMSGRelease(void *pData)
 	viewDataShutDown((const char *)pData);
 }
 
+/* Read and scan a JSON stats file, on a prefetch thread */
+static void *dataJsonDecode(const char *fileName, WZ_DECL_UNUSED const char *id)
+{
+	return JsonReader::decode(fileName);
+}
+
+static void dataJsonDiscard(void *pDecoded)
+{
+	JsonReader::discard((JsonReader::DECODED *)pDecoded);
+}
+
+/* Load a JSON stats file with its load function, which reads what dataJsonDecode scanned */
+template <RES_FILELOAD load>
+static bool dataJsonCommit(void *pDecoded, const char *fileName, void **ppData)
+{
+	JsonReader::commit((JsonReader::DECODED *)pDecoded);
+	return load(fileName, ppData);
+}
+
 /*!
- * Load an image from file
+ * Decode an image from file, on a prefetch thread
  */
-static bool dataImageLoad(const char *fileName, void **ppData)
+static void *dataImageDecode(const char *fileName, WZ_DECL_UNUSED const char *id)
 {
 	iV_Image *psSprite = (iV_Image *)malloc(sizeof(iV_Image));
-	if (!psSprite)
+	if (psSprite != nullptr && !iV_loadImage_PNG(fileName, psSprite))
 	{
-		return false;
+		free(psSprite);
+		return nullptr;
 	}
+	return psSprite;
+}
 
-	if (!iV_loadImage_PNG(fileName, psSprite))
+static bool dataImageCommit(void *pDecoded, WZ_DECL_UNUSED const char *fileName, void **ppData)
+{
+	if (pDecoded == nullptr)
 	{
 		debug(LOG_ERROR, "IMGPAGE load failed");
-		free(psSprite);
 		return false;
 	}
 
-	*ppData = psSprite;
+	*ppData = pDecoded;
 
 	return true;
 }
 
+static void dataImageDiscard(void *pDecoded)
+{
+	free(((iV_Image *)pDecoded)->bmp);
+	free(pDecoded);
+}
+
 
 // Tertiles (terrain tiles) loader.
 static bool dataTERTILESLoad(const char *fileName, void **ppData)
@@ -487,17 +518,29 @@ static bool dataTERTILESLoad(const char *fileName, void **ppData)
 	return true;
 }
 
-static bool dataIMGLoad(const char *fileName, void **ppData)
+/* Read the images of an image list file and arrange them on texture pages, on a prefetch thread */
+static void *dataIMGDecode(const char *fileName, WZ_DECL_UNUSED const char *id)
 {
-	*ppData = iV_LoadImageFile(fileName);
-	if (*ppData == nullptr)
+	return iV_DecodeImageFile(fileName);
+}
+
+/* Upload the texture pages of an image list file */
+static bool dataIMGCommit(void *pDecoded, const char *fileName, void **ppData)
+{
+	if (pDecoded == nullptr)
 	{
 		return false;
 	}
+	*ppData = iV_CommitImageFile((IMAGEFILE_DECODED *)pDecoded, fileName);
 
 	return true;
 }
 
+static void dataIMGDiscard(void *pDecoded)
+{
+	iV_DiscardImageFile((IMAGEFILE_DECODED *)pDecoded);
+}
+
 
 static void dataIMGRelease(void *pData)
 {
@@ -518,20 +561,24 @@ static void dataImageRelease(void *pData)
 }
 
 
-/* Load an audio file */
-static bool dataAudioLoad(const char *fileName, void **ppData)
+/* Read an audio file and check it can be decoded, on a prefetch thread */
+static void *dataAudioDecode(const char *fileName, const char *id)
 {
-	if (audio_Disabled() == true)
+	if (audio_Disabled())
 	{
-		*ppData = nullptr;
-		// No error occurred (sound is just disabled), so we return true
-		return true;
+		return nullptr;
 	}
 
-	// Load the track from a file
-	*ppData = sound_LoadTrackFromFile(fileName);
+	return sound_DecodeTrackFile(fileName, id);
+}
+
+/* Load an audio file */
+static bool dataAudioCommit(void *pDecoded, WZ_DECL_UNUSED const char *fileName, void **ppData)
+{
+	*ppData = pDecoded;
 
-	return *ppData != nullptr;
+	// No error occurred if sound is just disabled
+	return audio_Disabled() || pDecoded != nullptr;
 }
 
 /* Load an audio file */
@@ -733,26 +780,10 @@ struct RES_TYPE_MIN_FILE
 
 static const RES_TYPE_MIN_FILE FileResourceTypes[] =
 {
-	{"SFEAT", bufferSFEATLoad, dataSFEATRelease},                  //feature stats file
 	{"STEMPL", bufferSTEMPLLoad, dataSTEMPLRelease},               //template and associated files
-	{"WAV", dataAudioLoad, (RES_FREE)sound_ReleaseTrack},
-	{"SWEAPON", bufferSWEAPONLoad, dataReleaseStats},
 	{"SBPIMD", bufferSBPIMDLoad, dataReleaseStats},
-	{"SBRAIN", bufferSBRAINLoad, dataReleaseStats},
-	{"SSENSOR", bufferSSENSORLoad, dataReleaseStats},
-	{"SECM", bufferSECMLoad, dataReleaseStats},
-	{"SREPAIR", bufferSREPAIRLoad, dataReleaseStats},
-	{"SCONSTR", bufferSCONSTRLoad, dataReleaseStats},
-	{"SPROP", bufferSPROPLoad, dataReleaseStats},
-	{"SPROPTYPES", bufferSPROPTYPESLoad, dataReleaseStats},
-	{"STERRTABLE", bufferSTERRTABLELoad, dataReleaseStats},
-	{"SBODY", bufferSBODYLoad, dataReleaseStats},
-	{"SWEAPMOD", bufferSWEAPMODLoad, dataReleaseStats},
-	{"SPROPSND", bufferSPROPSNDLoad, dataReleaseStats},
 	{"AUDIOCFG", dataAudioCfgLoad, nullptr},
-	{"IMGPAGE", dataImageLoad, dataImageRelease},
 	{"TERTILES", dataTERTILESLoad, nullptr},
-	{"IMG", dataIMGLoad, dataIMGRelease},
 	{"TEXPAGE", nullptr, nullptr}, // ignored
 	{"TCMASK", nullptr, nullptr}, // ignored
 	{"SCRIPT", dataScriptLoad, dataScriptRelease},
@@ -761,8 +792,38 @@ static const RES_TYPE_MIN_FILE FileResourceTypes[] =
 	{"RESEARCHMSG", dataResearchMsgLoad, dataSMSGRelease },
 	{"SSTRMOD", bufferSSTRMODLoad, nullptr},
 	{"JAVASCRIPT", jsLoad, nullptr},
-	{"SSTRUCT", bufferSSTRUCTLoad, dataSSTRUCTRelease},            //structure stats and associated files
-	{"RESCH", bufferRESCHLoad, dataRESCHRelease},                  //research stats files
+};
+
+// Types whose files can be decoded on the prefetch threads, with only the commit left to the main thread
+struct RES_TYPE_MIN_DECODE
+{
+	const char *aType;                      ///< points to the string defining the type (e.g. SCRIPT) - NULL indicates end of list
+	RES_DECODE decode;                      ///< routine to decode a file of this type on any thread
+	RES_COMMIT commit;                      ///< routine to finish loading a decoded file on the main thread
+	RES_FREE discard;                       ///< routine to free a decoded file that isn't committed
+	RES_FREE release;                       ///< routine to release the data (NULL indicates none)
+};
+
+static const RES_TYPE_MIN_DECODE DecodeResourceTypes[] =
+{
+	{"SFEAT", dataJsonDecode, dataJsonCommit<bufferSFEATLoad>, dataJsonDiscard, dataSFEATRelease},                  //feature stats file
+	{"WAV", dataAudioDecode, dataAudioCommit, (RES_FREE)sound_ReleaseTrack, (RES_FREE)sound_ReleaseTrack},
+	{"SWEAPON", dataJsonDecode, dataJsonCommit<bufferSWEAPONLoad>, dataJsonDiscard, dataReleaseStats},
+	{"SBRAIN", dataJsonDecode, dataJsonCommit<bufferSBRAINLoad>, dataJsonDiscard, dataReleaseStats},
+	{"SSENSOR", dataJsonDecode, dataJsonCommit<bufferSSENSORLoad>, dataJsonDiscard, dataReleaseStats},
+	{"SECM", dataJsonDecode, dataJsonCommit<bufferSECMLoad>, dataJsonDiscard, dataReleaseStats},
+	{"SREPAIR", dataJsonDecode, dataJsonCommit<bufferSREPAIRLoad>, dataJsonDiscard, dataReleaseStats},
+	{"SCONSTR", dataJsonDecode, dataJsonCommit<bufferSCONSTRLoad>, dataJsonDiscard, dataReleaseStats},
+	{"SPROP", dataJsonDecode, dataJsonCommit<bufferSPROPLoad>, dataJsonDiscard, dataReleaseStats},
+	{"SPROPTYPES", dataJsonDecode, dataJsonCommit<bufferSPROPTYPESLoad>, dataJsonDiscard, dataReleaseStats},
+	{"STERRTABLE", dataJsonDecode, dataJsonCommit<bufferSTERRTABLELoad>, dataJsonDiscard, dataReleaseStats},
+	{"SBODY", dataJsonDecode, dataJsonCommit<bufferSBODYLoad>, dataJsonDiscard, dataReleaseStats},
+	{"SWEAPMOD", dataJsonDecode, dataJsonCommit<bufferSWEAPMODLoad>, dataJsonDiscard, dataReleaseStats},
+	{"SPROPSND", dataJsonDecode, dataJsonCommit<bufferSPROPSNDLoad>, dataJsonDiscard, dataReleaseStats},
+	{"IMGPAGE", dataImageDecode, dataImageCommit, dataImageDiscard, dataImageRelease},
+	{"IMG", dataIMGDecode, dataIMGCommit, dataIMGDiscard, dataIMGRelease},
+	{"SSTRUCT", dataJsonDecode, dataJsonCommit<bufferSSTRUCTLoad>, dataJsonDiscard, dataSSTRUCTRelease},            //structure stats and associated files
+	{"RESCH", dataJsonDecode, dataJsonCommit<bufferRESCHLoad>, dataJsonDiscard, dataRESCHRelease},                  //research stats files
 };
 
 /* Pass all the data loading functions to the framework library */
@@ -803,5 +864,20 @@ bool dataInitLoadFuncs()
 		}
 	}
 
+	// iterate through decode and commit functions
+	{
+		const RES_TYPE_MIN_DECODE *CurrentType;
+		// Points just past the last item in the list
+		const RES_TYPE_MIN_DECODE *const EndType = &DecodeResourceTypes[sizeof(DecodeResourceTypes) / sizeof(RES_TYPE_MIN_DECODE)];
+
+		for (CurrentType = DecodeResourceTypes; CurrentType != EndType; ++CurrentType)
+		{
+			if (!resAddDecodeLoad(CurrentType->aType, CurrentType->decode, CurrentType->commit, CurrentType->discard, CurrentType->release))
+			{
+				return false; // error whilst adding a decode load
+			}
+		}
+	}
+
 	return true;
 }
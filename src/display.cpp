@@ -1950,10 +1950,12 @@ void	dealWithLMB()
 			MAPTILE *psTile = mapTile(mouseTileX, mouseTileY);
 			uint8_t aux = auxTile(mouseTileX, mouseTileY, selectedPlayer);
 
-			console("%s tile %d, %d [%d, %d] continent(l%d, h%d) level %g illum %d %s %s w=%d s=%d j=%d",
+			console("%s tile %d, %d [%d, %d] continent(l%d, w%d, h%d) level %g illum %d %s %s w=%d s=%d j=%d",
 			        tileIsExplored(psTile) ? "Explored" : "Unexplored",
 			        mouseTileX, mouseTileY, world_coord(mouseTileX), world_coord(mouseTileY),
-			        (int)psTile->limitedContinent, (int)psTile->hoverContinent, psTile->level, (int)psTile->illumination,
+			        mapContinent(Vector2i(mouseTileX, mouseTileY), PROPULSION_TYPE_WHEELED),
+			        mapContinent(Vector2i(mouseTileX, mouseTileY), PROPULSION_TYPE_PROPELLOR),
+			        mapContinent(Vector2i(mouseTileX, mouseTileY), PROPULSION_TYPE_HOVER), psTile->level, (int)psTile->illumination,
 			        aux & AUXBITS_DANGER ? "danger" : "", aux & AUXBITS_THREAT ? "threat" : "",
 			        (int)psTile->watchers[selectedPlayer], (int)psTile->sensors[selectedPlayer], (int)psTile->jammers[selectedPlayer]);
 		}
@@ -79,6 +79,7 @@
 #include "advvis.h"
 #include "cmddroid.h"
 #include "terrain.h"
+#include "tickprofile.h"
 
 /********************  Prototypes  ********************/
 
@@ -207,6 +208,10 @@ bool showSAMPLES = false;
  *  default OFF, turn ON via console command 'showorders'
  */
 bool showORDERS = false;
+/**  Show where the time of the last game ticks went
+ *  default OFF, turn ON via console command 'tickprofile'
+ */
+bool showTICKPROFILE = false;
 
 /** When we have a connection issue, we will flash a message on screen
 */
@@ -575,6 +580,25 @@ static void NetworkDisplayImage(WIDGET *psWidget, UDWORD xOffset, UDWORD yOffset
 
 		iV_SetTextColour(WZCOL_TEXT_BRIGHT);
 		iV_DrawText(players, x - width, y + height, font_regular);
+
+		if (status == CONNECTIONSTATUS_WAITING_FOR_PLAYER)
+		{
+			// How long we are waiting, and how the game time is adapting to it.
+			const GAME_TIME_STATS stats = gameTimeGetStats();
+			const std::string lines[] =
+			{
+				astringf("waited %u ms for %c (usually %+d ms late)", stats.lastStallTime, "0123456789ABCDEFGHIJKLMNOPQRSTUV"[NetPlay.players[stats.stallPlayer].position], stats.playerLateness[stats.stallPlayer]),
+				astringf("%u stalls, %.1f s in total", stats.stalls, stats.stallTime / 1000.f),
+				astringf("latency %u ms, wanted %u ms", stats.latency, stats.wantedLatency),
+				astringf("%u catch-ups, last %u ticks", stats.catchUps, stats.lastCatchUpTicks),
+			};
+			int lineY = y + height;
+			for (const std::string &line : lines)
+			{
+				lineY += iV_GetTextLineSize(font_small);
+				iV_DrawText(line.c_str(), x - (int)iV_GetTextWidth(line.c_str(), font_small) - 10, lineY, font_small);
+			}
+		}
 	}
 
 	iV_DrawImage(IntImages, ImageID, x, y);
@@ -785,17 +809,19 @@ void draw3DScene()
 	if (showSAMPLES)		//Displays the number of sound samples we currently have
 	{
 		unsigned int width, height;
-		const char *Qbuf, *Lbuf, *Abuf;
+		const char *Qbuf, *Lbuf, *Abuf, *Cbuf;
 
 		sasprintf((char **)&Qbuf, "Que: %04u", audio_GetSampleQueueCount());
 		sasprintf((char **)&Lbuf, "Lst: %04u", audio_GetSampleListCount());
 		sasprintf((char **)&Abuf, "Act: %04u", sound_GetActiveSamplesCount());
+		sasprintf((char **)&Cbuf, "Cul: %04u", audio_GetCulledVoiceCount());
 		width = iV_GetTextWidth(Qbuf, font_regular) + 11;
 		height = iV_GetTextHeight(Qbuf, font_regular);
 
 		iV_DrawText(Qbuf, pie_GetVideoBufferWidth() - width, height + 2, font_regular);
 		iV_DrawText(Lbuf, pie_GetVideoBufferWidth() - width, height + 48, font_regular);
 		iV_DrawText(Abuf, pie_GetVideoBufferWidth() - width, height + 59, font_regular);
+		iV_DrawText(Cbuf, pie_GetVideoBufferWidth() - width, height + 70, font_regular);
 	}
 	if (showFPS)
 	{
@@ -812,6 +838,10 @@ void draw3DScene()
 		height = iV_GetTextHeight(DROIDDOING, font_regular);
 		iV_DrawText(DROIDDOING, 0, pie_GetVideoBufferHeight() - height, font_regular);
 	}
+	if (showTICKPROFILE)
+	{
+		profileDisplay(10, 40);
+	}
 
 	setupConnectionStatusForm();
 
@@ -1015,6 +1045,7 @@ static void drawTiles(iView *player)
 
 	/* This is done here as effects can light the terrain - pause mode problems though */
 	wzPerfBegin(PERF_EFFECTS, "3D scene - effects");
+	clearLights();
 	processEffects(viewMatrix);
 	atmosUpdateSystem();
 	avUpdateTiles();
@@ -1210,7 +1241,7 @@ static void display3DProjectiles(const glm::mat4 &viewMatrix)
 			    psObj->psWStats->weaponSubClass == WSC_ENERGY ||
 			    psObj->psWStats->weaponSubClass == WSC_EMP)
 			{
-				bucketAddTypeToList(RENDER_PROJECTILE, psObj, viewMatrix);
+				bucketAddTypeToList(RENDER_PROJECTILE, psObj);
 			}
 			else
 			{
@@ -55,6 +55,7 @@ struct iView
 extern bool showFPS;
 extern bool showSAMPLES;
 extern bool showORDERS;
+extern bool showTICKPROFILE;
 extern bool showLevelName;
 
 float getViewDistance();
@@ -415,7 +415,7 @@ void processEffects(const glm::mat4 &viewMatrix)
 			}
 			if (psEffect->group != EFFECT_FREED && clipXY(psEffect->position.x, psEffect->position.z))
 			{
-				bucketAddTypeToList(RENDER_EFFECT, psEffect, viewMatrix);
+				bucketAddTypeToList(RENDER_EFFECT, psEffect);
 			}
 		}
 		++it;
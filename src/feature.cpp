@@ -23,7 +23,7 @@
  * Load feature stats
  */
 #include "lib/framework/frame.h"
-#include "lib/framework/wzconfig.h"
+#include "lib/framework/jsonreader.h"
 
 #include "lib/gamelib/gtime.h"
 #include "lib/sound/audio.h"
@@ -68,7 +68,7 @@ void featureInitVars()
 /* Load the feature stats */
 bool loadFeatureStats(const char *pFileName)
 {
-	WzConfig ini(pFileName, WzConfig::ReadOnlyAndRequired);
+	JsonReader ini(pFileName);
 	QStringList list = ini.childGroups();
 	asFeatureStats = new FEATURE_STATS[list.size()];
 	numFeatureStats = list.size();
@@ -77,9 +77,9 @@ bool loadFeatureStats(const char *pFileName)
 		ini.beginGroup(list[i]);
 		asFeatureStats[i] = FEATURE_STATS(REF_FEATURE_START + i);
 		FEATURE_STATS *p = &asFeatureStats[i];
-		p->name = ini.value("name").toString();
+		p->name = ini.value(JSON_KEY("name")).toString();
 		p->id = list[i];
-		QString subType = ini.value("type").toString();
+		QString subType = ini.value(JSON_KEY("type")).toString();
 		if (subType == "TANK WRECK")
 		{
 			p->subType = FEAT_TANK;
@@ -120,15 +120,15 @@ bool loadFeatureStats(const char *pFileName)
 		{
 			ASSERT(false, "Unknown feature type: %s", subType.toUtf8().constData());
 		}
-		p->psImd = modelGet(ini.value("model").toString());
-		p->baseWidth = ini.value("width", 1).toInt();
-		p->baseBreadth = ini.value("breadth", 1).toInt();
-		p->tileDraw = ini.value("tileDraw", 1).toInt();
-		p->allowLOS = ini.value("lineOfSight", 1).toInt();
-		p->visibleAtStart = ini.value("startVisible", 1).toInt();
-		p->damageable = ini.value("damageable", 1).toInt();
-		p->body = ini.value("hitpoints", 1).toInt();
-		p->armourValue = ini.value("armour", 1).toInt();
+		p->psImd = modelGet(ini.value(JSON_KEY("model")).toString());
+		p->baseWidth = ini.value(JSON_KEY("width"), 1).toInt();
+		p->baseBreadth = ini.value(JSON_KEY("breadth"), 1).toInt();
+		p->tileDraw = ini.value(JSON_KEY("tileDraw"), 1).toInt();
+		p->allowLOS = ini.value(JSON_KEY("lineOfSight"), 1).toInt();
+		p->visibleAtStart = ini.value(JSON_KEY("startVisible"), 1).toInt();
+		p->damageable = ini.value(JSON_KEY("damageable"), 1).toInt();
+		p->body = ini.value(JSON_KEY("hitpoints"), 1).toInt();
+		p->armourValue = ini.value(JSON_KEY("armour"), 1).toInt();
 
 		//and the oil resource - assumes only one!
 		if (asFeatureStats[i].subType == FEAT_OIL_RESOURCE)
@@ -503,6 +503,7 @@ bool destroyFeature(FEATURE *psDel, unsigned impactTime)
 						auxClearBlocking(b.map.x + width, b.map.y + breadth, AIR_BLOCKED);  // Shouldn't remain blocking for air units, however.
 						psTile->texture = TileNumber_texture(psTile->texture) | BLOCKING_RUBBLE_TILE;
 					}
+					mapContinentsTileChanged(b.map.x + width, b.map.y + breadth);
 				}
 			}
 		}
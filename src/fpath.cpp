@@ -34,6 +34,8 @@
 #include "lib/framework/wzapp.h"
 
 #include "objects.h"
+#include "benchmark.h"
+#include "tickprofile.h"
 #include "map.h"
 #include "multiplay.h"
 #include "astar.h"
@@ -91,7 +93,9 @@ static int fpathThreadFunc(void *)
 		pathJobs.pop_front();
 
 		wzMutexUnlock(fpathMutex);
+		int64_t jobStart = benchmarkPathJobStart();
 		job();
+		benchmarkPathJob(jobStart);
 		wzMutexLock(fpathMutex);
 
 		waitingForResult = false;
@@ -415,6 +419,7 @@ queuePathfinding:
 // Find a route for an DROID to a location in world coordinates
 FPATH_RETVAL fpathDroidRoute(DROID *psDroid, SDWORD tX, SDWORD tY, FPATH_MOVETYPE moveType)
 {
+	ProfileScope profileScope(PROFILE_PATHING);
 	bool acceptNearest;
 	PROPULSION_STATS *psPropStats = getPropulsionStats(psDroid);
 
@@ -631,28 +636,9 @@ bool fpathCheck(Position orig, Position dest, PROPULSION_TYPE propulsion)
 		return false;
 	}
 
-	MAPTILE *origTile = worldTile(findNonblockingPosition(orig, propulsion).xy);
-	MAPTILE *destTile = worldTile(findNonblockingPosition(dest, propulsion).xy);
-
 	ASSERT_OR_RETURN(false, propulsion != PROPULSION_TYPE_NUM, "Bad propulsion type");
-	ASSERT_OR_RETURN(false, origTile != nullptr && destTile != nullptr, "Bad tile parameter");
-
-	switch (propulsion)
-	{
-	case PROPULSION_TYPE_PROPELLOR:
-	case PROPULSION_TYPE_WHEELED:
-	case PROPULSION_TYPE_TRACKED:
-	case PROPULSION_TYPE_LEGGED:
-	case PROPULSION_TYPE_HALF_TRACKED:
-		return origTile->limitedContinent == destTile->limitedContinent;
-	case PROPULSION_TYPE_HOVER:
-		return origTile->hoverContinent == destTile->hoverContinent;
-	case PROPULSION_TYPE_LIFT:
-		return true;	// assume no map uses skyscrapers to isolate areas
-	default:
-		break;
-	}
 
-	ASSERT(false, "Should never get here, unknown propulsion !");
-	return false;	// should never get here
+	const Vector2i origTile = map_coord(findNonblockingPosition(orig, propulsion).xy);
+	const Vector2i destTile = map_coord(findNonblockingPosition(dest, propulsion).xy);
+	return mapSameContinent(origTile, destTile, propulsion);
 }
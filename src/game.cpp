@@ -18,6 +18,7 @@
 	Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301 USA
 */
 #include "lib/framework/wzapp.h"
+#include <QtCore/QElapsedTimer>
 #include <QtCore/QMap>
 
 /* Standard library headers */
@@ -30,6 +31,7 @@
 #include "lib/framework/wzconfig.h"
 #include "lib/framework/file.h"
 #include "lib/framework/physfs_ext.h"
+#include "lib/framework/savearchive.h"
 #include "lib/framework/strres.h"
 #include "lib/framework/opengl.h"
 
@@ -1664,6 +1666,7 @@ bool loadMissionExtras(const char *pGameToLoad, SWORD levelType)
 	fileExten = strlen(pGameToLoad) - 3;
 	aFileName[fileExten - 1] = '\0';
 	strcat(aFileName, "/");
+	saveArchiveOpen(aFileName);
 
 	if (saveGameVersion >= VERSION_11)
 	{
@@ -1778,6 +1781,13 @@ bool loadGame(const char *pGameToLoad, bool keepObjects, bool freeMem, bool User
 	DROID           *psCurr;
 	UWORD           missionScrollMinX = 0, missionScrollMinY = 0,
 	                missionScrollMaxX = 0, missionScrollMaxY = 0;
+	QElapsedTimer	loadTimer;
+	bool			fromArchive;
+
+	loadTimer.start();
+	sstrcpy(aFileName, pGameToLoad);
+	aFileName[strlen(aFileName) - 4] = '\0';
+	fromArchive = saveArchiveOpen(aFileName);
 
 	/* Stop the game clock */
 	gameTimeStop();
@@ -2589,6 +2599,10 @@ bool loadGame(const char *pGameToLoad, bool keepObjects, bool freeMem, bool User
 	resetMissionWidgets();
 
 	debug(LOG_NEVER, "Done loading");
+	if (UserSaveGame)
+	{
+		debug(LOG_SAVE, "Loaded %s from %s in %.1f ms", pGameToLoad, fromArchive ? "an archive" : "JSON files", loadTimer.nsecsElapsed() / 1e6);
+	}
 
 	return true;
 
@@ -2610,12 +2624,15 @@ error:
 }
 // -----------------------------------------------------------------------------------------
 
-bool saveGame(const char *aFileName, GAME_TYPE saveType)
+bool saveGame(const char *aFileName, GAME_TYPE saveType, bool background)
 {
 	UDWORD			fileExtension;
 	DROID			*psDroid, *psNext;
 	char			CurrentFileName[PATH_MAX] = {'\0'};
+	const bool		archive = !war_getJsonSaves();
+	QElapsedTimer	saveTimer;
 
+	saveTimer.start();
 	triggerEvent(TRIGGER_GAME_SAVING);
 
 	ASSERT_OR_RETURN(false, aFileName && strlen(aFileName) > 4, "Bad savegame filename");
@@ -2639,6 +2656,17 @@ bool saveGame(const char *aFileName, GAME_TYPE saveType)
 	//create dir will fail if directory already exists but don't care!
 	(void) PHYSFS_mkdir(CurrentFileName);
 
+	// Collect the files into one archive, unless saving them as JSON, when an old archive must not hide them.
+	saveArchiveClose();
+	if (archive)
+	{
+		saveArchiveBegin(CurrentFileName);
+	}
+	else
+	{
+		PHYSFS_delete((std::string(CurrentFileName) + "/" SAVE_ARCHIVE_NAME).c_str());
+	}
+
 	writeMainFile(std::string(CurrentFileName) + "/main.json", saveType);
 
 	//save the map file
@@ -2898,12 +2926,26 @@ bool saveGame(const char *aFileName, GAME_TYPE saveType)
 	// strip the last filename
 	CurrentFileName[fileExtension - 1] = '\0';
 
+	if (archive && background)
+	{
+		saveArchiveEndInBackground();
+	}
+	else if (archive && !saveArchiveEnd())
+	{
+		debug(LOG_ERROR, "saveGame: writing the archive in \"%s\" failed", CurrentFileName);
+		goto error;
+	}
+	debug(LOG_SAVE, "Saved %s as %s in %.1f ms%s", aFileName, archive ? "an archive" : "JSON files", saveTimer.nsecsElapsed() / 1e6,
+	      archive && background ? ", writing it in the background" : "");
+
 	/* Start the game clock */
 	triggerEvent(TRIGGER_GAME_SAVED);
 	gameTimeStart();
 	return true;
 
 error:
+	saveArchiveAbort();
+
 	/* Start the game clock */
 	gameTimeStart();
 
@@ -3029,6 +3071,7 @@ static bool gameLoad(const char *fileName)
 		PHYSFS_close(fileHandle);
 		//remove the file extension
 		CurrentFileName[strlen(CurrentFileName) - 4] = '\0';
+		saveArchiveOpen(CurrentFileName);
 		loadMainFile(std::string(CurrentFileName) + "/main.json");
 		return retVal;
 	}
@@ -4509,7 +4552,7 @@ static void writeSaveObject(WzConfig &ini, BASE_OBJECT *psObj)
 
 static bool loadSaveDroid(const char *pFileName, DROID **ppsCurrentDroidLists)
 {
-	if (!PHYSFS_exists(pFileName))
+	if (!fileExists(pFileName))
 	{
 		debug(LOG_SAVE, "No %s found -- use fallback method", pFileName);
 		return false;	// try to use fallback method
@@ -5047,7 +5090,7 @@ static UDWORD getResearchIdFromName(const char *pName)
 /* code for versions after version 20 of a save structure */
 static bool loadSaveStructure2(const char *pFileName, STRUCTURE **ppList)
 {
-	if (!PHYSFS_exists(pFileName))
+	if (!fileExists(pFileName))
 	{
 		debug(LOG_SAVE, "No %s found -- use fallback method", pFileName);
 		return false;	// try to use fallback method
@@ -5679,7 +5722,7 @@ bool loadSaveFeature(char *pFileData, UDWORD filesize)
 
 bool loadSaveFeature2(const char *pFileName)
 {
-	if (!PHYSFS_exists(pFileName))
+	if (!fileExists(pFileName))
 	{
 		debug(LOG_SAVE, "No %s found -- use fallback method", pFileName);
 		return false;
@@ -6580,6 +6623,7 @@ bool loadScriptState(char *pFileName)
 	char	jsFilename[PATH_MAX];
 
 	pFileName[strlen(pFileName) - 4] = '\0';
+	saveArchiveOpen(pFileName);
 
 	// The below belongs to the new javascript stuff
 	sstrcpy(jsFilename, pFileName);
@@ -120,7 +120,8 @@ bool loadScriptState(char *pFileName);
 /// Load the terrain types
 bool loadTerrainTypeMap(const char *pFileData, UDWORD filesize);
 
-bool saveGame(const char *aFileName, GAME_TYPE saveType);
+/// With background, the game only stops while the savegame is collected, and the archive is written on a thread.
+bool saveGame(const char *aFileName, GAME_TYPE saveType, bool background = false);
 
 // Get the campaign number for loadGameInit game
 UDWORD getCampaign(const char *fileName);
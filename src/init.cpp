@@ -47,7 +47,9 @@
 
 #include "advvis.h"
 #include "atmos.h"
+#include "benchmark.h"
 #include "challenge.h"
+#include "clparse.h"
 #include "cluster.h"
 #include "cmddroid.h"
 #include "configuration.h"
@@ -722,6 +724,11 @@ bool systemInitialise()
 	// Initialize the iVis text rendering module
 	wzSceneBegin("Main menu loop");
 	iV_TextInit();
+	if (benchmark_text())
+	{
+		benchmarkText();
+		wzQuit();
+	}
 
 	pie_InitRadar();
 
@@ -1111,7 +1118,7 @@ bool stageTwoInitialise()
 	// Setup game queues.
 	// Don't ask why this doesn't go in stage three. In fact, don't even ask me what stage one/two/three is supposed to mean, it seems about as descriptive as stage doStuff, stage doMoreStuff and stage doEvenMoreStuff...
 	debug(LOG_MAIN, "Init game queues, I am %d.", selectedPlayer);
-	sendQueuedDroidInfo();  // Discard any pending orders which could later get flushed into the game queue.
+	resetQueuedDroidInfo();  // Discard any pending orders which could later get flushed into the game queue.
 	for (i = 0; i < MAX_PLAYERS; ++i)
 	{
 		NETinitQueue(NETgameQueue(i));
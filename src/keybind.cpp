@@ -57,6 +57,7 @@
 #include "multimenu.h"
 #include "atmos.h"
 #include "advvis.h"
+#include "bucket3d.h"
 
 #include "intorder.h"
 #include "lib/widget/listwidget.h"
@@ -82,6 +83,7 @@
 #include "template.h"
 #include "qtscript.h"
 #include "multigifts.h"
+#include "tickprofile.h"
 
 /*
 	KeyBind.c
@@ -613,8 +615,10 @@ void kf_ToggleOrders()	// Displays orders & action of currently selected unit.
 /* Writes out the frame rate */
 void	kf_FrameRate()
 {
-	CONPRINTF(ConsoleString, (ConsoleString, "FPS %d; PIEs %d; polys %d",
-	                          frameRate(), loopPieCount, loopPolyCount));
+	unsigned bucketDrawn, bucketCulled;
+	bucketGetCounts(&bucketDrawn, &bucketCulled);
+	CONPRINTF(ConsoleString, (ConsoleString, "FPS %d; PIEs %d; polys %d; draws %d; state changes %d; objects drawn %u, culled %u",
+	                          frameRate(), loopPieCount, loopPolyCount, loopDrawCount, loopStateCount, bucketDrawn, bucketCulled));
 	if (runningMultiplayer())
 	{
 		CONPRINTF(ConsoleString, (ConsoleString, "NETWORK:  Bytes: s-%d r-%d  Uncompressed Bytes: s-%d r-%d  Packets: s-%d r-%d",
@@ -748,6 +752,62 @@ void	kf_TileInfo()
 	addConsoleMessage("Tile info dumped into log", DEFAULT_JUSTIFY, SYSTEM_MESSAGE);
 }
 
+/* Start measuring where the legacy script interpreter spends its time, or show what was measured and stop */
+void	kf_ScriptProfile()
+{
+	if (!interpProfiling())
+	{
+		interpSetProfiling(true);
+		addConsoleMessage("Script profile started, use scriptprofile again to show it", DEFAULT_JUSTIFY, SYSTEM_MESSAGE);
+		return;
+	}
+
+	const std::vector<INTERP_PROFILE> profile = interpGetProfile();
+	size_t shown = 0;
+
+	for (const INTERP_PROFILE &entry : profile)
+	{
+		debug(LOG_INFO, "%s %s: calls=%u time=%lluns worst=%lluns instructions=%llu", entry.trigger ? "trigger" : "event",
+		      entry.name.c_str(), entry.calls, (unsigned long long)entry.time, (unsigned long long)entry.worst,
+		      (unsigned long long)entry.instructions);
+		if (shown++ < 5)
+		{
+			console("%s: %u calls, %.3fms total, %.3fms worst", entry.name.c_str(), entry.calls,
+			        entry.time / 1000000.0, entry.worst / 1000000.0);
+		}
+	}
+	interpSetProfiling(false);
+	addConsoleMessage("Script profile dumped into log and stopped", DEFAULT_JUSTIFY, SYSTEM_MESSAGE);
+}
+
+void	kf_ToggleTickProfile()
+{
+	showTICKPROFILE = !showTICKPROFILE;
+	if (showTICKPROFILE)
+	{
+		profileStart();
+	}
+	else
+	{
+		profileStop();
+	}
+	CONPRINTF(ConsoleString, (ConsoleString, "Tick profile displayed is %s", showTICKPROFILE ? "Enabled" : "Disabled"));
+}
+
+/* Writes the kept ticks of the tick profile as a Chrome trace */
+void	kf_DumpTickProfile()
+{
+	if (!profileRunning())
+	{
+		addConsoleMessage("Tick profile is not running, use tickprofile first", DEFAULT_JUSTIFY, SYSTEM_MESSAGE);
+		return;
+	}
+	if (profileWriteTrace("tickprofile.json"))
+	{
+		addConsoleMessage("Tick profile written to tickprofile.json", DEFAULT_JUSTIFY, SYSTEM_MESSAGE);
+	}
+}
+
 /* Toggles fog on/off */
 void	kf_ToggleFog()
 {
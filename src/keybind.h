@@ -246,6 +246,9 @@ void kf_ToggleRadarTerrain();            //radar terrain
 void kf_ToggleRadarAllyEnemy();          //enemy/ally color toggle
 
 void kf_TileInfo();
+void kf_ScriptProfile();
+void kf_ToggleTickProfile();
+void kf_DumpTickProfile();
 
 void kf_NoAssert();
 
@@ -33,8 +33,10 @@
 #include "lib/framework/crc.h"
 #include "lib/framework/physfs_ext.h"
 #include "lib/framework/rational.h"
+#include "lib/framework/savearchive.h"
 #include "lib/gamelib/gtime.h"
 #include "lib/exceptionhandler/dumpinfo.h"
+#include "benchmark.h"
 #include "clparse.h"
 #include "init.h"
 #include "objects.h"
@@ -1011,6 +1013,7 @@ bool levLoadData(char const *name, Sha256 const *hash, char *pSaveName, GAME_TYP
 			return false;
 		}
 	}
+	saveArchiveClose();  // Everything has been loaded from the savegame.
 
 	if (!stageThreeInitialise())
 	{
@@ -1053,6 +1056,10 @@ bool levLoadData(char const *name, Sha256 const *hash, char *pSaveName, GAME_TYP
 			jsAutogameSpecific("multiplay/skirmish/semperfi.js", selectedPlayer);
 		}
 	}
+	if (benchmark_ticks() != 0)
+	{
+		benchmarkStart(benchmark_ticks());
+	}
 
 	return true;
 }
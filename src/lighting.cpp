@@ -26,6 +26,7 @@
 
 #include "lib/framework/frame.h"
 #include "lib/framework/math_ext.h"
+#include "lib/framework/wzapp.h"
 
 #include "lib/ivis_opengl/piestate.h"
 #include "lib/ivis_opengl/piematrix.h"
@@ -34,6 +35,10 @@
 
 #include "lib/gamelib/gtime.h"
 
+#include <QtCore/QElapsedTimer>
+#include <algorithm>
+#include <vector>
+
 #include "map.h"
 #include "lighting.h"
 #include "display3d.h"
@@ -55,7 +60,6 @@ static Vector3f theSun;
 
 /*	Module function Prototypes */
 static UDWORD calcDistToTile(UDWORD tileX, UDWORD tileY, Vector3i *pos);
-static void calcTileIllum(UDWORD tileX, UDWORD tileY);
 
 void setTheSun(Vector3f newSun)
 {
@@ -73,6 +77,16 @@ Vector3f getTheSun()
  */
 /*****************************************************************************/
 
+/// Threads lighting the terrain, besides the thread asking for it
+#define LIGHTING_WORKER_THREADS 3
+
+/// Illumination of the vertex at the top left of a tile, from the sum of the normals around it
+static uint8_t vertexIllumination(const Vector3f &normalSum)
+{
+	const int dotProduct = glm::dot(normalise(normalSum), theSun);
+	return clip(abs(dotProduct) / 16, 1, 254);
+}
+
 //By passing in params - it means that if the scroll limits are changed mid-mission
 //we can re-do over the area that hasn't been seen
 void initLighting(UDWORD x1, UDWORD y1, UDWORD x2, UDWORD y2)
@@ -84,14 +98,57 @@ void initLighting(UDWORD x1, UDWORD y1, UDWORD x2, UDWORD y2)
 		return;
 	}
 
-	for (unsigned i = x1; i < x2; i++)
+	QElapsedTimer timer;
+	timer.start();
+
+	// The vertices not at the edge of the map are lit by the normals of the triangles around them, from the tiles
+	// up and left of them, up, left and the tile itself. So find the normals of those tiles first, a row at a time.
+	const int vertexX1 = std::max<int>(x1, 1), vertexX2 = std::min<int>(x2, mapWidth - 1);
+	const int vertexY1 = std::max<int>(y1, 1), vertexY2 = std::min<int>(y2, mapHeight - 1);
+	const int normalsWidth = std::max(vertexX2 - vertexX1 + 1, 0);
+	const int normalsHeight = std::max(vertexY2 - vertexY1 + 1, 0);
+
+	// Not flipped, the first triangle of a tile has the corners (0, 0), (1, 0), (1, 1), and the second (0, 0), (1, 1), (0, 1).
+	// Flipped, the first has (0, 0), (1, 0), (0, 1), and the second (1, 0), (1, 1), (0, 1). flipped is 1 or 0.
+	std::vector<Vector3f> firstNormals(normalsWidth * normalsHeight);
+	std::vector<Vector3f> secondNormals(normalsWidth * normalsHeight);
+	std::vector<float> flipped(normalsWidth * normalsHeight);
+	if (normalsWidth > 1 && normalsHeight > 1)
 	{
-		for (unsigned j = y1; j < y2; j++)
+		wzParallelFor(normalsHeight, LIGHTING_WORKER_THREADS, [&](int row)
 		{
-			MAPTILE	*psTile = mapTile(i, j);
+			const int tileY = vertexY1 - 1 + row;
+			const MAPTILE *psRow = mapTile(vertexX1 - 1, tileY);
+			const MAPTILE *psNextRow = mapTile(vertexX1 - 1, tileY + 1);
+			for (int n = row * normalsWidth, i = 0; i < normalsWidth; ++i, ++n)
+			{
+				const int tileX = vertexX1 - 1 + i;
+				const Vector3f c00(world_coord(tileX), world_coord(tileY), psRow[i].height);
+				const Vector3f c10(world_coord(tileX + 1), world_coord(tileY), psRow[i + 1].height);
+				const Vector3f c01(world_coord(tileX), world_coord(tileY + 1), psNextRow[i].height);
+				const Vector3f c11(world_coord(tileX + 1), world_coord(tileY + 1), psNextRow[i + 1].height);
+				const bool flip = TRI_FLIPPED(&psRow[i]);
+
+				firstNormals[n] = pie_SurfaceNormal3fv(c00, c10, flip ? c01 : c11);
+				secondNormals[n] = pie_SurfaceNormal3fv(flip ? c10 : c00, c11, c01);
+				flipped[n] = flip;
+			}
+		});
+	}
 
+	wzParallelFor(y2 - y1, LIGHTING_WORKER_THREADS, [&](int row)
+	{
+		const int j = y1 + row;
+		const bool edgeRow = j == 0 || j >= mapHeight - 1;
+		// The normals of the tiles up left and up of the vertex (0 and 1), and of the tile itself and left of it (2 and 3).
+		const int upRow = (j - vertexY1) * normalsWidth;
+		const int downRow = upRow + normalsWidth;
+		MAPTILE *psTile = mapTile(x1, j);
+
+		for (unsigned i = x1; i < x2; i++, psTile++)
+		{
 			// always make the edge tiles dark
-			if (i == 0 || j == 0 || i >= mapWidth - 1 || j >= mapHeight - 1)
+			if (edgeRow || i == 0 || i >= mapWidth - 1)
 			{
 				psTile->illumination = 16;
 
@@ -103,136 +160,50 @@ void initLighting(UDWORD x1, UDWORD y1, UDWORD x2, UDWORD y2)
 			}
 			else
 			{
-				calcTileIllum(i, j);
+				// Each tile adds both its triangles on its side of the vertex, or only the one touching it, in the
+				// same order the normals were always added in. Multiplying by 1 or 0 keeps this free of branches.
+				// Vectorising is left to the compiler, intrinsics would need a version for each instruction set.
+				const int n0 = upRow + (int)i - vertexX1, n1 = n0 + 1, n3 = downRow + (int)i - vertexX1, n2 = n3 + 1;
+				Vector3f sum(0.0f, 0.0f, 0.0f);
+				sum += (1 - flipped[n0]) * firstNormals[n0];
+				sum += secondNormals[n0];
+				sum += flipped[n1] * firstNormals[n1];
+				sum += secondNormals[n1];
+				sum += firstNormals[n2];
+				sum += (1 - flipped[n2]) * secondNormals[n2];
+				sum += firstNormals[n3];
+				sum += flipped[n3] * secondNormals[n3];
+				psTile->illumination = vertexIllumination(sum);
 			}
 			// Basically darkens down the tiles that are outside the scroll
 			// limits - thereby emphasising the cannot-go-there-ness of them
 			if ((SDWORD)i < scrollMinX + 4 || (SDWORD)i > scrollMaxX - 4
-			    || (SDWORD)j < scrollMinY + 4 || (SDWORD)j > scrollMaxY - 4)
+			    || j < scrollMinY + 4 || j > scrollMaxY - 4)
 			{
 				psTile->illumination /= 3;
 			}
 		}
-	}
-}
-
-
-static void normalsOnTile(unsigned int tileX, unsigned int tileY, unsigned int quadrant, unsigned int *numNormals, Vector3f normals[])
-{
-	Vector2i tiles[2][2];
-	MAPTILE *psTiles[2][2];
-	Vector3f corners[2][2];
-
-	for (unsigned j = 0; j < 2; ++j)
-		for (unsigned i = 0; i < 2; ++i)
-		{
-			tiles[i][j] = Vector2i(tileX + i, tileY + j);
-			/* Get a pointer to our tile */
-			/* And to the ones to the east, south and southeast of it */
-			psTiles[i][j] = mapTile(tiles[i][j]);
-			corners[i][j] = Vector3f(world_coord(tiles[i][j]), psTiles[i][j]->height);
-		}
-
-	int flipped = TRI_FLIPPED(psTiles[0][0]) ? 10 : 0;
+	});
 
-	switch (quadrant + flipped)
-	{
-	// Not flipped.
-	case 0:
-	case 2:
-		/* Otherwise, it's not flipped and so two triangles*/
-		normals[(*numNormals)++] = pie_SurfaceNormal3fv(corners[0][0], corners[1][0], corners[1][1]);
-		normals[(*numNormals)++] = pie_SurfaceNormal3fv(corners[0][0], corners[1][1], corners[0][1]);
-		break;
-	case 1:
-		normals[(*numNormals)++] = pie_SurfaceNormal3fv(corners[0][0], corners[1][1], corners[0][1]);
-		break;
-	case 3:
-		normals[(*numNormals)++] = pie_SurfaceNormal3fv(corners[0][0], corners[1][0], corners[1][1]);
-		break;
-	// Flipped.
-	case 10:
-		/* Is it flipped? In this case one triangle  */
-		normals[(*numNormals)++] = pie_SurfaceNormal3fv(corners[1][0], corners[1][1], corners[0][1]);
-		break;
-	case 12:
-		normals[(*numNormals)++] = pie_SurfaceNormal3fv(corners[0][0], corners[1][0], corners[0][1]);
-		break;
-	case 11:
-	case 13:
-		/* Is it flipped? In this case two triangles  */
-		normals[(*numNormals)++] = pie_SurfaceNormal3fv(corners[0][0], corners[1][0], corners[0][1]);
-		normals[(*numNormals)++] = pie_SurfaceNormal3fv(corners[1][0], corners[1][1], corners[0][1]);
-		break;
-	default:
-		ASSERT(false, "Invalid quadrant in lighting code");
-	} // end switch
+	debug(LOG_TERRAIN, "Lit %ux%u tiles in %.2f ms", x2 - x1, y2 - y1, timer.nsecsElapsed() / 1e6);
 }
 
+/// What the lights this frame add to each tile, and the tiles they touched, from lightsX1, lightsY1 to before lightsX2, lightsY2
+static std::vector<PIELIGHT> lights;
+static int lightsX1 = 0, lightsY1 = 0, lightsX2 = 0, lightsY2 = 0;
+/// The map size lights was sized for
+static int lightsWidth = 0, lightsHeight = 0;
 
-static void calcTileIllum(UDWORD tileX, UDWORD tileY)
+/// Resize and clear lights, if the map has changed size since it was sized.
+static void fitLightsToMap()
 {
-	/* The number or normals that we got is in numNormals*/
-	Vector3f finalVector(0.0f, 0.0f, 0.0f);
-	unsigned int i, val;
-	int dotProduct;
-
-	unsigned int numNormals = 0; // How many normals have we got?
-	Vector3f normals[8]; // Maximum 8 possible normals
-
-	/* Quadrants look like:-
-
-				  *
-				  *
-			0	  *    1
-				  *
-				  *
-		**********V**********
-				  *
-				  *
-			3	  *	   2
-				  *
-				  *
-	*/
-
-	/* Do quadrant 0 - tile that's above and left*/
-	normalsOnTile(tileX - 1, tileY - 1, 0, &numNormals, normals);
-
-	/* Do quadrant 1 - tile that's above and right*/
-	normalsOnTile(tileX, tileY - 1, 1, &numNormals, normals);
-
-	/* Do quadrant 2 - tile that's down and right*/
-	normalsOnTile(tileX, tileY, 2, &numNormals, normals);
-
-	/* Do quadrant 3 - tile that's down and left*/
-	normalsOnTile(tileX - 1, tileY, 3, &numNormals, normals);
-
-	for (i = 0; i < numNormals; i++)
-	{
-		finalVector = finalVector + normals[i];
-	}
-
-	dotProduct = glm::dot(normalise(finalVector), theSun);
-
-	val = abs(dotProduct) / 16;
-	if (val == 0)
-	{
-		val = 1;
-	}
-	if (val > 254)
+	if (lightsWidth != mapWidth || lightsHeight != mapHeight)
 	{
-		val = 254;
+		lights.assign((size_t)mapWidth * mapHeight, PIELIGHT());
+		lightsWidth = mapWidth;
+		lightsHeight = mapHeight;
+		lightsX1 = lightsY1 = lightsX2 = lightsY2 = 0;
 	}
-	mapTile(tileX, tileY)->illumination = val;
-}
-
-static void colourTile(SDWORD xIndex, SDWORD yIndex, PIELIGHT light_colour, double fraction)
-{
-	PIELIGHT colour = getTileColour(xIndex, yIndex);
-	colour.byte.r = MIN(255, colour.byte.r + light_colour.byte.r * fraction);
-	colour.byte.g = MIN(255, colour.byte.g + light_colour.byte.g * fraction);
-	colour.byte.b = MIN(255, colour.byte.b + light_colour.byte.b * fraction);
-	setTileColour(xIndex, yIndex, colour);
 }
 
 void processLight(LIGHT *psLight)
@@ -263,9 +234,26 @@ void processLight(LIGHT *psLight)
 	endY = MIN(endY, mapHeight - 1);
 	startY = MIN(startY, endY);
 
-	for (int i = startX; i <= endX; i++)
+	fitLightsToMap();
+	if (lightsX1 == lightsX2)
+	{
+		lightsX1 = startX;
+		lightsY1 = startY;
+		lightsX2 = endX + 1;
+		lightsY2 = endY + 1;
+	}
+	else
+	{
+		lightsX1 = MIN(lightsX1, startX);
+		lightsY1 = MIN(lightsY1, startY);
+		lightsX2 = MAX(lightsX2, endX + 1);
+		lightsY2 = MAX(lightsY2, endY + 1);
+	}
+
+	for (int j = startY; j <= endY; j++)
 	{
-		for (int j = startY; j <= endY; j++)
+		PIELIGHT *light = &lights[j * lightsWidth + startX];
+		for (int i = startX; i <= endX; i++, light++)
 		{
 			int distToCorner = calcDistToTile(i, j, &psLight->position);
 
@@ -274,12 +262,35 @@ void processLight(LIGHT *psLight)
 			{
 				/* Find how close we are to it */
 				double ratio = (100.0 - PERCENT(distToCorner, psLight->range)) / 100.0;
-				colourTile(i, j, psLight->colour, ratio);
+				// The tile colours are whole numbers, so adding the lights up first, each rounded down, is the same
+				// as adding them to the tile colour one by one.
+				light->byte.r = MIN(255, light->byte.r + (int)(psLight->colour.byte.r * ratio));
+				light->byte.g = MIN(255, light->byte.g + (int)(psLight->colour.byte.g * ratio));
+				light->byte.b = MIN(255, light->byte.b + (int)(psLight->colour.byte.b * ratio));
 			}
 		}
 	}
 }
 
+PIELIGHT getTileLight(int x, int y)
+{
+	fitLightsToMap();
+	if (x < lightsX1 || y < lightsY1 || x >= lightsX2 || y >= lightsY2)
+	{
+		return PIELIGHT();
+	}
+	return lights[y * lightsWidth + x];
+}
+
+void clearLights()
+{
+	fitLightsToMap();
+	for (int j = lightsY1; j < lightsY2; ++j)
+	{
+		std::fill_n(&lights[j * lightsWidth + lightsX1], lightsX2 - lightsX1, PIELIGHT());
+	}
+	lightsX1 = lightsY1 = lightsX2 = lightsY2 = 0;
+}
 
 static UDWORD calcDistToTile(UDWORD tileX, UDWORD tileY, Vector3i *pos)
 {
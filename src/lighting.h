@@ -33,7 +33,12 @@ struct LIGHT
 void setTheSun(Vector3f newSun);
 Vector3f getTheSun();
 
+/// Add a light to the terrain this frame, without changing the tile colours.
 void processLight(LIGHT *psLight);
+/// What the lights this frame add to the colour of the tile.
+PIELIGHT getTileLight(int x, int y);
+/// Remove the lights of the last frame.
+void clearLights();
 void initLighting(UDWORD x1, UDWORD y1, UDWORD x2, UDWORD y2);
 void lightValueForTile(UDWORD tileX, UDWORD tileY);
 void doBuildingLights();
@@ -31,6 +31,7 @@
 
 #include "lib/framework/frame.h"
 #include "lib/framework/input.h"
+#include "lib/framework/savearchive.h"
 #include "lib/framework/stdio_ext.h"
 #include "lib/widget/button.h"
 #include "lib/widget/editbox.h"
@@ -359,6 +360,7 @@ void deleteSaveGame(char *saveGameName)
 
 	ASSERT(strlen(saveGameName) < MAX_STR_LENGTH, "deleteSaveGame; save game name too long");
 
+	saveArchiveClose();  // In case it is the archive of this savegame.
 	PHYSFS_delete(saveGameName);
 	saveGameName[strlen(saveGameName) - 4] = '\0'; // strip extension
 
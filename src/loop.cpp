@@ -43,6 +43,10 @@
 #include "lib/netplay/netplay.h"
 
 #include "loop.h"
+#include "benchmark.h"
+#include "clparse.h"
+#include "main.h"
+#include "tickprofile.h"
 #include "objects.h"
 #include "display.h"
 #include "map.h"
@@ -95,6 +99,8 @@
 
 #include <numeric>
 
+/// Milliseconds of game state updates between rendered frames, when the game time is unthrottled (replays and benchmarks)
+#define UNTHROTTLED_RENDER_INTERVAL 250
 
 static void fireWaitingCallbacks();
 
@@ -103,6 +109,8 @@ static void fireWaitingCallbacks();
  */
 unsigned int loopPieCount;
 unsigned int loopPolyCount;
+unsigned int loopDrawCount;
+unsigned int loopStateCount;
 
 /*
  * local variables
@@ -340,7 +348,7 @@ static GAMECODE renderLoop()
 
 	wzSetCursor(cursor);
 
-	pie_GetResetCounts(&loopPieCount, &loopPolyCount);
+	pie_GetResetCounts(&loopPieCount, &loopPolyCount, &loopDrawCount, &loopStateCount);
 
 	if (!quitting)
 	{
@@ -543,6 +551,8 @@ static void countUpdate(bool synch)
 
 static void gameStateUpdate()
 {
+	profileTickStart();
+
 	syncDebug("map = \"%s\", pseudorandom 32-bit integer = 0x%08X, allocated = %d %d %d %d %d %d %d %d %d %d, position = %d %d %d %d %d %d %d %d %d %d", game.map, gameRandU32(),
 	          NetPlay.players[0].allocated, NetPlay.players[1].allocated, NetPlay.players[2].allocated, NetPlay.players[3].allocated, NetPlay.players[4].allocated, NetPlay.players[5].allocated, NetPlay.players[6].allocated, NetPlay.players[7].allocated, NetPlay.players[8].allocated, NetPlay.players[9].allocated,
 	          NetPlay.players[0].position, NetPlay.players[1].position, NetPlay.players[2].position, NetPlay.players[3].position, NetPlay.players[4].position, NetPlay.players[5].position, NetPlay.players[6].position, NetPlay.players[7].position, NetPlay.players[8].position, NetPlay.players[9].position
@@ -563,6 +573,7 @@ static void gameStateUpdate()
 	sendPlayerGameTime();
 	NETflush();  // Make sure the game time tick message is really sent over the network.
 
+	profileSwitch(PROFILE_SCRIPTS);
 	if (!paused && !scriptPaused())
 	{
 		/* Update the event system */
@@ -578,9 +589,11 @@ static void gameStateUpdate()
 	}
 
 	// Update abandoned structures
+	profileSwitch(PROFILE_OTHER);
 	handleAbandonedStructures();
 
 	// Update the visibility change stuff
+	profileSwitch(PROFILE_VISIBILITY);
 	visUpdateLevel();
 
 	// Put all droids/structures/features into the grid.
@@ -590,24 +603,30 @@ static void gameStateUpdate()
 	processVisibility();
 
 	// Update the map.
+	profileSwitch(PROFILE_MAP);
 	mapUpdate();
 
 	//update the findpath system
+	profileSwitch(PROFILE_PATHING);
 	fpathUpdate();
 
 	// update the cluster system
+	profileSwitch(PROFILE_AI);
 	clusterUpdate();
 
 	// update the command droids
 	cmdDroidUpdate();
 
+	profileSwitch(PROFILE_SCRIPTS);
 	fireWaitingCallbacks(); //Now is the good time to fire waiting callbacks (since interpreter is off now)
 
 	for (unsigned i = 0; i < MAX_PLAYERS; i++)
 	{
 		//update the current power available for a player
+		profileSwitch(PROFILE_OTHER);
 		updatePlayerPower(i);
 
+		profileSwitch(PROFILE_DROIDS);
 		DROID *psNext;
 		for (DROID *psCurr = apsDroidLists[i]; psCurr != nullptr; psCurr = psNext)
 		{
@@ -625,6 +644,7 @@ static void gameStateUpdate()
 		}
 
 		// FIXME: These for-loops are code duplicationo
+		profileSwitch(PROFILE_STRUCTURES);
 		STRUCTURE *psNBuilding;
 		for (STRUCTURE *psCBuilding = apsStructLists[i]; psCBuilding != nullptr; psCBuilding = psNBuilding)
 		{
@@ -640,10 +660,13 @@ static void gameStateUpdate()
 		}
 	}
 
+	profileSwitch(PROFILE_OTHER);
 	missionTimerUpdate();
 
+	profileSwitch(PROFILE_PROJECTILES);
 	proj_UpdateAll();
 
+	profileSwitch(PROFILE_FEATURES);
 	FEATURE *psNFeat;
 	for (FEATURE *psCFeat = apsFeatureLists[0]; psCFeat; psCFeat = psNFeat)
 	{
@@ -652,6 +675,7 @@ static void gameStateUpdate()
 	}
 
 	// Clean up dead droid pointers in UI.
+	profileSwitch(PROFILE_OTHER);
 	hciUpdate();
 
 	// Free dead droid memory.
@@ -668,6 +692,40 @@ static void gameStateUpdate()
 	{
 		jsDebugUpdate();
 	}
+
+	benchmarkTickEnd(profileTickEnd());
+}
+
+/// Saves single player games as Autosave every war_getAutosaveInterval() minutes of game time. The game only stops
+/// while the savegame is collected, its archive is written in the background.
+static void autoSaveUpdate()
+{
+	static uint32_t nextAutosaveTime = 0;
+	static uint32_t lastGameTime = 0;
+
+	const uint32_t interval = war_getAutosaveInterval() * 60 * GAME_TICKS_PER_SEC;
+	if (interval == 0 || NetPlay.bComms || benchmarkRunning() || !wz_replay_file().empty() || !wz_record_file().empty()
+	    || testPlayerHasLost() || testPlayerHasWon())
+	{
+		return;
+	}
+	if (nextAutosaveTime == 0 || gameTime < lastGameTime || gameTime - lastGameTime > interval)
+	{
+		nextAutosaveTime = gameTime + interval;  // Started or loaded another game.
+	}
+	lastGameTime = gameTime;
+	if (gameTime < nextAutosaveTime)
+	{
+		return;
+	}
+	nextAutosaveTime = gameTime + interval;
+
+	char fileName[PATH_MAX];
+	ssprintf(fileName, "%s%s/Autosave.gam", SaveGamePath, bMultiPlayer ? "skirmish" : "campaign");
+	if (!saveGame(fileName, GTYPE_SAVE_MIDMISSION, true))
+	{
+		debug(LOG_ERROR, "Autosave to %s failed", fileName);
+	}
 }
 
 /* The main game loop */
@@ -679,6 +737,7 @@ GAMECODE gameLoop()
 	static bool previousUpdateWasRender = false;
 	const Rational renderFraction(2, 5);  // Minimum fraction of time spent rendering.
 	const Rational updateFraction = Rational(1) - renderFraction;
+	const unsigned loopStartTime = wzGetTicks();
 
 	countUpdate(false); // kick off with correct counts
 
@@ -689,7 +748,8 @@ GAMECODE gameLoop()
 		recvMessage();
 
 		// Update gameTime and graphicsTime, and corresponding deltas. Note that gameTime and graphicsTime pause, if we aren't getting our GAME_GAME_TIME messages.
-		gameTimeUpdate(renderBudget > 0 || previousUpdateWasRender);
+		// Replays and benchmarks tick as fast as possible, only rendering every UNTHROTTLED_RENDER_INTERVAL.
+		gameTimeUpdate(gameTimeIsUnthrottled() ? wzGetTicks() - loopStartTime < UNTHROTTLED_RENDER_INTERVAL : renderBudget > 0 || previousUpdateWasRender);
 
 		if (deltaGameTime == 0)
 		{
@@ -711,6 +771,8 @@ GAMECODE gameLoop()
 		ASSERT(deltaGraphicsTime == 0, "Shouldn't update graphics and game state at once.");
 	}
 
+	autoSaveUpdate();  // Between game ticks.
+
 	if (realTime - lastFlushTime >= 400u)
 	{
 		lastFlushTime = realTime;
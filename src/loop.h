@@ -55,6 +55,8 @@ extern LEVEL_TYPE nextMissionType;
 
 extern unsigned int loopPieCount;
 extern unsigned int loopPolyCount;
+extern unsigned int loopDrawCount;
+extern unsigned int loopStateCount;
 
 GAMECODE gameLoop();
 void videoLoop();
@@ -51,6 +51,7 @@
 #include "lib/sound/audio.h"
 #include "lib/sound/cdaudio.h"
 
+#include "benchmark.h"
 #include "clparse.h"
 #include "challenge.h"
 #include "configuration.h"
@@ -937,6 +938,9 @@ int realmain(int argc, char *argv[])
 		debug(LOG_WZ, "Using %s debug file", buf);
 	}
 
+	// All callbacks are registered, so from now on the debug output can be written by its own thread.
+	debugStartThread();
+
 	// NOTE: it is now safe to use debug() calls to make sure output gets captured.
 	check_Physfs();
 	debug(LOG_WZ, "Warzone 2100 - %s", version_getFormattedVersionString());
@@ -1021,6 +1025,17 @@ int realmain(int argc, char *argv[])
 		}
 	}
 
+	// The video and lighting benchmarks run headless, before there is a window.
+	if (!benchmark_video().empty())
+	{
+		return benchmarkVideo(benchmark_video().c_str()) ? EXIT_SUCCESS : EXIT_FAILURE;
+	}
+	if (benchmark_lighting())
+	{
+		benchmarkLighting();
+		return EXIT_SUCCESS;
+	}
+
 	if (!wzMainScreenSetup(war_getAntialiasing(), war_getFullscreen(), war_GetVsync()))
 	{
 		return EXIT_FAILURE;
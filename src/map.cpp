@@ -23,9 +23,15 @@
  * Utility functions for the map data structure.
  *
  */
+#include <QtCore/QElapsedTimer>
 #include <time.h>
+#include <algorithm>
+#include <string>
+#include <unordered_map>
+#include <vector>
 
 #include "lib/framework/frame.h"
+#include "lib/framework/crc.h"
 #include "lib/framework/endian_hack.h"
 #include "lib/framework/file.h"
 #include "lib/framework/physfs_ext.h"
@@ -63,6 +69,41 @@ struct floodtile
 };
 static struct floodtile *floodbucket = nullptr;
 static int bucketcounter;
+
+/// Threat an object was last counted as on a player's danger map
+struct THREAT_STAMP
+{
+	std::vector<TILEPOS> tiles;             ///< Watched tiles of the object when it was counted
+	uint8_t mode = 0;                       ///< SHOOT_ON_GROUND and/or SHOOT_IN_AIR
+	uint32_t epoch = 0;                     ///< Last threat update the object was seen in
+};
+
+/// Incremental danger map bookkeeping for a single player
+struct DANGER_STATE
+{
+	std::unordered_map<uint32_t, THREAT_STAMP> threatStamps;  ///< Hostile objects counted on the threat map, by id
+	std::vector<uint16_t> threatCount;      ///< Number of hostile objects able to shoot at ground units on each tile
+	std::vector<uint16_t> aaThreatCount;    ///< Number of hostile objects able to shoot at VTOLs on each tile
+	uint32_t threatEpoch = 0;
+	std::vector<int> pendingTiles;          ///< Tiles whose blocking bits changed since the last store, main thread only
+	bool pendingOverflow = false;           ///< Too many pending tiles, need a complete flood fill
+	std::vector<int> changedTiles;          ///< Tiles changed since the last flood fill, handed to the danger thread
+	bool changedOverflow = false;
+	std::vector<int> readTiles;             ///< Tiles examined by the last flood fill
+	std::vector<int> restoreTiles;          ///< Tiles examined by the flood fill before that, which may have changed back
+	std::vector<bool> readMask;             ///< Whether each tile is in readTiles
+	bool valid = false;                     ///< Whether the danger map holds the result of a previous flood fill
+	bool refilled = false;                  ///< Whether the last call to dangerFloodFill() actually flooded
+	uint8_t *aux = nullptr;                 ///< The player's danger map, swapped into the danger slot while in use
+};
+static DANGER_STATE dangerState[MAX_PLAYERS];
+
+static void dangerStateReset(DANGER_STATE &state)
+{
+	free(state.aux);
+	state = DANGER_STATE();
+}
+#define DANGER_MAX_PENDING 4096
 static UDWORD lastDangerUpdate = 0;
 static int lastDangerPlayer = -1;
 
@@ -134,6 +175,20 @@ static bool *mapDecals;           // array that tells us what tile is a decal
 /* Look up table that returns the terrain type of a given tile texture */
 UBYTE terrainTypes[MAX_TILE_TEXTURES];
 
+/// Checksums of the tileset files the ground types and decals were loaded from, see mapCacheKey
+static std::string tilesetFileSums;
+
+/// Load a file of the tileset, adding its checksum to tilesetFileSums.
+static bool loadTilesetFile(const char *pFileName, char *pFileBuffer, UDWORD bufferSize, UDWORD *pSize)
+{
+	if (!loadFileToBuffer(pFileName, pFileBuffer, bufferSize, pSize))
+	{
+		return false;
+	}
+	tilesetFileSums.append((const char *)sha256Sum(pFileBuffer, *pSize).bytes, Sha256::Bytes);
+	return true;
+}
+
 static void init_tileNames(int type)
 {
 	char	*pFileData = nullptr;
@@ -147,7 +202,7 @@ static void init_tileNames(int type)
 	{
 	case ARIZONA:
 		{
-			if (!loadFileToBuffer("tileset/arizona_enum.txt", pFileData, FILE_LOAD_BUFFER_SIZE, &fileSize))
+			if (!loadTilesetFile("tileset/arizona_enum.txt", pFileData, FILE_LOAD_BUFFER_SIZE, &fileSize))
 			{
 				debug(LOG_FATAL, "tileset/arizona_enum.txt not found.  Aborting.");
 				abort();
@@ -165,7 +220,7 @@ static void init_tileNames(int type)
 		}
 	case URBAN:
 		{
-			if (!loadFileToBuffer("tileset/urban_enum.txt", pFileData, FILE_LOAD_BUFFER_SIZE, &fileSize))
+			if (!loadTilesetFile("tileset/urban_enum.txt", pFileData, FILE_LOAD_BUFFER_SIZE, &fileSize))
 			{
 				debug(LOG_FATAL, "tileset/urban_enum.txt not found.  Aborting.");
 				abort();
@@ -183,7 +238,7 @@ static void init_tileNames(int type)
 		}
 	case ROCKIE:
 		{
-			if (!loadFileToBuffer("tileset/rockie_enum.txt", pFileData, FILE_LOAD_BUFFER_SIZE, &fileSize))
+			if (!loadTilesetFile("tileset/rockie_enum.txt", pFileData, FILE_LOAD_BUFFER_SIZE, &fileSize))
 			{
 				debug(LOG_FATAL, "tileset/rockie_enum.txt not found.  Aborting.");
 				abort();
@@ -244,12 +299,13 @@ static bool mapLoadGroundTypes()
 	pFileData = fileLoadBuffer;
 
 	debug(LOG_TERRAIN, "tileset: %s", tilesetDir);
+	tilesetFileSums.clear();
 	// For Arizona
 	if (strcmp(tilesetDir, "texpages/tertilesc1hw") == 0)
 	{
 fallback:
 		init_tileNames(ARIZONA);
-		if (!loadFileToBuffer("tileset/tertilesc1hwGtype.txt", pFileData, FILE_LOAD_BUFFER_SIZE, &fileSize))
+		if (!loadTilesetFile("tileset/tertilesc1hwGtype.txt", pFileData, FILE_LOAD_BUFFER_SIZE, &fileSize))
 		{
 			debug(LOG_FATAL, "tileset/tertilesc1hwGtype.txt not found, aborting.");
 			abort();
@@ -288,7 +344,7 @@ fallback:
 	else if (strcmp(tilesetDir, "texpages/tertilesc2hw") == 0)
 	{
 		init_tileNames(URBAN);
-		if (!loadFileToBuffer("tileset/tertilesc2hwGtype.txt", pFileData, FILE_LOAD_BUFFER_SIZE, &fileSize))
+		if (!loadTilesetFile("tileset/tertilesc2hwGtype.txt", pFileData, FILE_LOAD_BUFFER_SIZE, &fileSize))
 		{
 			debug(LOG_POPUP, "tileset/tertilesc2hwGtype.txt not found, using default terrain ground types.");
 			goto fallback;
@@ -327,7 +383,7 @@ fallback:
 	else if (strcmp(tilesetDir, "texpages/tertilesc3hw") == 0)
 	{
 		init_tileNames(ROCKIE);
-		if (!loadFileToBuffer("tileset/tertilesc3hwGtype.txt", pFileData, FILE_LOAD_BUFFER_SIZE, &fileSize))
+		if (!loadTilesetFile("tileset/tertilesc3hwGtype.txt", pFileData, FILE_LOAD_BUFFER_SIZE, &fileSize))
 		{
 			debug(LOG_POPUP, "tileset/tertilesc3hwGtype.txt not found, using default terrain ground types.");
 			goto fallback;
@@ -384,7 +440,7 @@ static void SetGroundForTile(const char *filename, const char *nametype)
 	uint32_t	fileSize = 0;
 
 	pFileData = fileLoadBuffer;
-	if (!loadFileToBuffer(filename, pFileData, FILE_LOAD_BUFFER_SIZE, &fileSize))
+	if (!loadTilesetFile(filename, pFileData, FILE_LOAD_BUFFER_SIZE, &fileSize))
 	{
 		debug(LOG_FATAL, "%s not found, aborting.", filename);
 		abort();
@@ -577,7 +633,7 @@ static void SetDecals(const char *filename, const char *decal_type)
 
 	pFileData = fileLoadBuffer;
 
-	if (!loadFileToBuffer(filename, pFileData, FILE_LOAD_BUFFER_SIZE, &fileSize))
+	if (!loadTilesetFile(filename, pFileData, FILE_LOAD_BUFFER_SIZE, &fileSize))
 	{
 		debug(LOG_POPUP, "%s not found, aborting.", filename);
 		abort();
@@ -732,6 +788,192 @@ static void generateRiverbed()
 
 }
 
+/// Reads a file loaded into memory, like the PHYSFS_read functions read a file.
+struct MEMORY_READER
+{
+	MEMORY_READER(const char *data, UDWORD size) : data((const uint8_t *)data), size(size), pos(0) {}
+
+	bool read(void *dest, UDWORD length)
+	{
+		if (size - pos < length)
+		{
+			return false;
+		}
+		memcpy(dest, data + pos, length);
+		pos += length;
+		return true;
+	}
+	bool readU8(uint8_t *val)
+	{
+		return read(val, 1);
+	}
+	bool readULE16(uint16_t *val)
+	{
+		uint8_t bytes[2];
+		if (!read(bytes, sizeof(bytes)))
+		{
+			return false;
+		}
+		*val = bytes[0] | bytes[1] << 8;
+		return true;
+	}
+	bool readULE32(uint32_t *val)
+	{
+		uint8_t bytes[4];
+		if (!read(bytes, sizeof(bytes)))
+		{
+			return false;
+		}
+		*val = bytes[0] | bytes[1] << 8 | bytes[2] << 16 | (uint32_t)bytes[3] << 24;
+		return true;
+	}
+	bool readUBE32(uint32_t *val)
+	{
+		uint8_t bytes[4];
+		if (!read(bytes, sizeof(bytes)))
+		{
+			return false;
+		}
+		*val = (uint32_t)bytes[0] << 24 | bytes[1] << 16 | bytes[2] << 8 | bytes[3];
+		return true;
+	}
+
+	const uint8_t *data;
+	UDWORD size;
+	UDWORD pos;
+};
+
+// Binary cache of what is worked out from a map file when loading it, in the write directory
+#define MAP_CACHE_DIR		"cache/maps/"
+#define MAP_CACHE_MAGIC		0x504d5a57	// "WZMP"
+#define MAP_CACHE_VERSION	2
+
+/// Start of a map cache file. It is followed by an array for each cached tile member: the heights with the riverbed,
+/// the ground types and the tile bits with the decals, and then the parents of the tiles in each kind of continents.
+struct MAP_CACHE_HEADER
+{
+	uint32_t magic;
+	uint32_t version;
+	uint32_t width;
+	uint32_t height;
+	uint8_t key[Sha256::Bytes];  ///< See mapCacheKey
+};
+
+/// Bytes per tile in a map cache file after the header
+#define MAP_CACHE_TILE_SIZE (sizeof(int32_t) + 2 * sizeof(uint8_t) + CONTINENT_KINDS * sizeof(int32_t))
+
+/// What a cache must have been made from to be used: the map file, and the tileset files and terrain types it was
+/// loaded with.
+static Sha256 mapCacheKey(const char *fileData, UDWORD fileSize)
+{
+	std::string key((const char *)sha256Sum(fileData, fileSize).bytes, Sha256::Bytes);
+	key += tilesetDir;
+	key += tilesetFileSums;
+	key.append((const char *)terrainTypes, sizeof(terrainTypes));
+	return sha256Sum(key.data(), key.size());
+}
+
+static std::string mapCacheName(const char *filename)
+{
+	std::string name = filename;
+	std::replace(name.begin(), name.end(), '/', '_');
+	return MAP_CACHE_DIR + name + ".bin";
+}
+
+/// Copy a member of every tile from or to an array in a cache file, a member at a time so the arrays can be bulk copied.
+template <typename Stored, typename Member>
+static void mapCacheRead(const char *&pos, Member MAPTILE::*member)
+{
+	for (int i = 0; i < mapWidth * mapHeight; ++i, pos += sizeof(Stored))
+	{
+		Stored value;
+		memcpy(&value, pos, sizeof(Stored));
+		psMapTiles[i].*member = value;
+	}
+}
+
+template <typename Stored, typename Member>
+static void mapCacheWrite(std::string &out, Member MAPTILE::*member)
+{
+	for (int i = 0; i < mapWidth * mapHeight; ++i)
+	{
+		const Stored value = psMapTiles[i].*member;
+		out.append((const char *)&value, sizeof(Stored));
+	}
+}
+
+/**
+ * Set the heights, continents, ground types and decals of the tiles from the cache of the map file, read in one go.
+ * \return false, changing nothing, if there is no cache made from the same map file, tileset and terrain types
+ */
+static bool mapLoadCache(const char *filename, const Sha256 &key)
+{
+	const std::string cacheName = mapCacheName(filename);
+	char *pCacheData = nullptr;
+	UDWORD size = 0;
+
+	if (!PHYSFS_exists(cacheName.c_str()) || !loadFile(cacheName.c_str(), &pCacheData, &size))
+	{
+		return false;
+	}
+	MAP_CACHE_HEADER header;
+	bool valid = size == sizeof(header) + mapWidth * mapHeight * MAP_CACHE_TILE_SIZE;
+	if (valid)
+	{
+		memcpy(&header, pCacheData, sizeof(header));
+		valid = header.magic == MAP_CACHE_MAGIC && header.version == MAP_CACHE_VERSION && header.width == mapWidth
+		        && header.height == mapHeight && memcmp(header.key, key.bytes, Sha256::Bytes) == 0;
+	}
+	if (valid)
+	{
+		const char *pos = pCacheData + sizeof(header);
+		mapCacheRead<int32_t>(pos, &MAPTILE::height);
+		mapCacheRead<uint8_t>(pos, &MAPTILE::ground);
+		mapCacheRead<uint8_t>(pos, &MAPTILE::tileInfoBits);
+		for (int kind = 0; kind < CONTINENT_KINDS; ++kind)
+		{
+			for (int i = 0; i < mapWidth * mapHeight; ++i, pos += sizeof(int32_t))
+			{
+				memcpy(&psMapTiles[i].continentParent[kind], pos, sizeof(int32_t));
+			}
+		}
+	}
+	free(pCacheData);
+	return valid;
+}
+
+/// Write what was worked out from the map file to its cache.
+static void mapSaveCache(const char *filename, const Sha256 &key)
+{
+	const std::string cacheName = mapCacheName(filename);
+	MAP_CACHE_HEADER header = {MAP_CACHE_MAGIC, MAP_CACHE_VERSION, (uint32_t)mapWidth, (uint32_t)mapHeight, {}};
+	memcpy(header.key, key.bytes, Sha256::Bytes);
+	std::string out((const char *)&header, sizeof(header));
+	mapCacheWrite<int32_t>(out, &MAPTILE::height);
+	mapCacheWrite<uint8_t>(out, &MAPTILE::ground);
+	mapCacheWrite<uint8_t>(out, &MAPTILE::tileInfoBits);
+	for (int kind = 0; kind < CONTINENT_KINDS; ++kind)
+	{
+		for (int i = 0; i < mapWidth * mapHeight; ++i)
+		{
+			out.append((const char *)&psMapTiles[i].continentParent[kind], sizeof(int32_t));
+		}
+	}
+
+	(void) PHYSFS_mkdir(MAP_CACHE_DIR);
+	PHYSFS_file *fileHandle = PHYSFS_openWrite(cacheName.c_str());
+	if (fileHandle == nullptr)
+	{
+		debug(LOG_MAP, "Could not write map cache %s: %s", cacheName.c_str(), PHYSFS_getLastError());
+		return;
+	}
+	if (PHYSFS_write(fileHandle, out.data(), 1, out.size()) != out.size())
+	{
+		debug(LOG_MAP, "Could not write map cache %s: %s", cacheName.c_str(), PHYSFS_getLastError());
+	}
+	PHYSFS_close(fileHandle);
+}
+
 /* Initialise the map structure */
 bool mapLoad(char *filename, bool preview)
 {
@@ -739,21 +981,26 @@ bool mapLoad(char *filename, bool preview)
 	char		aFileType[4];
 	UDWORD		version;
 	UDWORD		i, x, y;
-	PHYSFS_file	*fp = PHYSFS_openRead(filename);
-	MersenneTwister mt(12345);  // 12345 = random seed.
+	char		*fileData = nullptr;
+	UDWORD		fileSize = 0;
+	Sha256		cacheKey;
+	bool		fromCache = false;
+	QElapsedTimer	timer;
 
-	if (!fp)
+	timer.start();
+	if (!fileExists(filename) || !loadFile(filename, &fileData, &fileSize))
 	{
 		debug(LOG_ERROR, "%s not found", filename);
 		return false;
 	}
-	else if (PHYSFS_read(fp, aFileType, 4, 1) != 1
-	         || !PHYSFS_readULE32(fp, &version)
-	         || !PHYSFS_readULE32(fp, &width)
-	         || !PHYSFS_readULE32(fp, &height)
-	         || aFileType[0] != 'm'
-	         || aFileType[1] != 'a'
-	         || aFileType[2] != 'p')
+	MEMORY_READER fp(fileData, fileSize);
+	if (!fp.read(aFileType, 4)
+	    || !fp.readULE32(&version)
+	    || !fp.readULE32(&width)
+	    || !fp.readULE32(&height)
+	    || aFileType[0] != 'm'
+	    || aFileType[1] != 'a'
+	    || aFileType[2] != 'p')
 	{
 		debug(LOG_ERROR, "Bad header in %s", filename);
 		goto failure;
@@ -796,8 +1043,8 @@ bool mapLoad(char *filename, bool preview)
 		tilesetDir = strdup("texpages/tertilesc1hw");
 	}
 
-	// load the ground types
-	if (!mapLoadGroundTypes())
+	// load the ground types, which the map preview does not use
+	if (!preview && !mapLoadGroundTypes())
 	{
 		goto failure;
 	}
@@ -810,7 +1057,7 @@ bool mapLoad(char *filename, bool preview)
 		UWORD	texture;
 		UBYTE	height;
 
-		if (!PHYSFS_readULE16(fp, &texture) || !PHYSFS_readULE8(fp, &height))
+		if (!fp.readULE16(&texture) || !fp.readU8(&height))
 		{
 			debug(LOG_ERROR, "%s: Error during savegame load", filename);
 			goto failure;
@@ -834,7 +1081,7 @@ bool mapLoad(char *filename, bool preview)
 		goto ok;
 	}
 
-	if (!PHYSFS_readULE32(fp, &version) || !PHYSFS_readULE32(fp, &numGw) || version != 1)
+	if (!fp.readULE32(&version) || !fp.readULE32(&numGw) || version != 1)
 	{
 		debug(LOG_ERROR, "Bad gateway in %s", filename);
 		goto failure;
@@ -844,7 +1091,7 @@ bool mapLoad(char *filename, bool preview)
 	{
 		UBYTE	x0, y0, x1, y1;
 
-		if (!PHYSFS_readULE8(fp, &x0) || !PHYSFS_readULE8(fp, &y0) || !PHYSFS_readULE8(fp, &x1) || !PHYSFS_readULE8(fp, &y1))
+		if (!fp.readU8(&x0) || !fp.readU8(&y0) || !fp.readU8(&x1) || !fp.readU8(&y1))
 		{
 			debug(LOG_ERROR, "%s: Failed to read gateway info", filename);
 			goto failure;
@@ -855,11 +1102,6 @@ bool mapLoad(char *filename, bool preview)
 		}
 	}
 
-	if (!mapSetGroundTypes())
-	{
-		goto failure;
-	}
-
 	for (y = 0; y < mapHeight; y++)
 	{
 		for (x = 0; x < mapWidth; x++)
@@ -868,7 +1110,19 @@ bool mapLoad(char *filename, bool preview)
 			mapTile(x, y)->waterLevel = mapTile(x, y)->height - world_coord(1) / 3;
 		}
 	}
-	generateRiverbed();
+
+	// The ground types, riverbed and continents only depend on the map file, tileset and terrain types, so they
+	// are worked out once, and then read from the cache.
+	cacheKey = mapCacheKey(fileData, fileSize);
+	fromCache = mapLoadCache(filename, cacheKey);
+	if (!fromCache)
+	{
+		if (!mapSetGroundTypes())
+		{
+			goto failure;
+		}
+		generateRiverbed();
+	}
 
 	/* set up the scroll mins and maxs - set values to valid ones for any new map */
 	scrollMinX = scrollMinY = 0;
@@ -915,13 +1169,18 @@ bool mapLoad(char *filename, bool preview)
 	}
 
 	/* Set continents. This should ideally be done in advance by the map editor. */
-	mapFloodFillContinents();
+	if (!fromCache)
+	{
+		mapCalcContinents();
+		mapSaveCache(filename, cacheKey);
+	}
+	debug(LOG_MAP, "Loaded %s%s in %.1f ms", filename, fromCache ? " from cache" : "", timer.nsecsElapsed() / 1e6);
 ok:
-	PHYSFS_close(fp);
+	free(fileData);
 	return true;
 
 failure:
-	PHYSFS_close(fp);
+	free(fileData);
 	return false;
 }
 
@@ -1051,6 +1310,10 @@ bool mapShutdown()
 
 	map = nullptr;
 	floodbucket = nullptr;
+	for (auto &state : dangerState)
+	{
+		dangerStateReset(state);
+	}
 	psGroundTypes = nullptr;
 	mapDecals = nullptr;
 	psMapTiles = nullptr;
@@ -1524,48 +1787,28 @@ void getTileMaxMin(int x, int y, int *pMax, int *pMin)
 /* This will save out the visibility data */
 bool writeVisibilityData(const char *fileName)
 {
-	unsigned int i;
-	VIS_SAVEHEADER fileHeader;
+	const int planes = (game.maxPlayers + 7) / 8;
+	std::vector<uint8_t> data;
+	data.reserve(8 + mapWidth * mapHeight * planes);
 
-	PHYSFS_file *fileHandle = openSaveFile(fileName);
-	if (!fileHandle)
-	{
-		return false;
-	}
-
-	fileHeader.aFileType[0] = 'v';
-	fileHeader.aFileType[1] = 'i';
-	fileHeader.aFileType[2] = 's';
-	fileHeader.aFileType[3] = 'd';
-
-	fileHeader.version = CURRENT_VERSION_NUM;
-
-	// Write out the current file header
-	if (PHYSFS_write(fileHandle, fileHeader.aFileType, sizeof(fileHeader.aFileType), 1) != 1
-	    || !PHYSFS_writeUBE32(fileHandle, fileHeader.version))
-	{
-		debug(LOG_ERROR, "writeVisibilityData: could not write header to %s; PHYSFS error: %s", fileName, PHYSFS_getLastError());
-		PHYSFS_close(fileHandle);
-		return false;
-	}
-
-	int planes = (game.maxPlayers + 7) / 8;
+	// The file header: type and big endian version
+	const uint32_t version = CURRENT_VERSION_NUM;
+	const uint8_t header[8] = {'v', 'i', 's', 'd', uint8_t(version >> 24), uint8_t(version >> 16), uint8_t(version >> 8), uint8_t(version)};
+	data.insert(data.end(), header, header + sizeof(header));
 
 	for (unsigned plane = 0; plane < planes; ++plane)
 	{
-		for (i = 0; i < mapWidth * mapHeight; ++i)
+		for (unsigned i = 0; i < mapWidth * mapHeight; ++i)
 		{
-			if (!PHYSFS_writeUBE8(fileHandle, psMapTiles[i].tileExploredBits >> (plane * 8)))
-			{
-				debug(LOG_ERROR, "writeVisibilityData: could not write to %s; PHYSFS error: %s", fileName, PHYSFS_getLastError());
-				PHYSFS_close(fileHandle);
-				return false;
-			}
+			data.push_back(psMapTiles[i].tileExploredBits >> (plane * 8));
 		}
 	}
 
-	// Everything is just fine!
-	PHYSFS_close(fileHandle);
+	if (!saveFile(fileName, (const char *)data.data(), data.size()))
+	{
+		debug(LOG_ERROR, "writeVisibilityData: could not write %s", fileName);
+		return false;
+	}
 	return true;
 }
 
@@ -1574,22 +1817,26 @@ bool writeVisibilityData(const char *fileName)
 bool readVisibilityData(const char *fileName)
 {
 	VIS_SAVEHEADER fileHeader;
-	unsigned int expectedFileSize, fileSize;
-	unsigned int i;
+	char *fileData;
+	UDWORD fileSize;
 
-	PHYSFS_file *fileHandle = openLoadFile(fileName, false);
-	if (!fileHandle)
+	if (!fileExists(fileName))
 	{
 		// Failure to open the file is no failure to read it
 		return true;
 	}
+	if (!loadFile(fileName, &fileData, &fileSize))
+	{
+		return false;
+	}
+	MEMORY_READER reader(fileData, fileSize);
 
 	// Read the header from the file
-	if (PHYSFS_read(fileHandle, fileHeader.aFileType, sizeof(fileHeader.aFileType), 1) != 1
-	    || !PHYSFS_readUBE32(fileHandle, &fileHeader.version))
+	if (!reader.read(fileHeader.aFileType, sizeof(fileHeader.aFileType))
+	    || !reader.readUBE32(&fileHeader.version))
 	{
-		debug(LOG_ERROR, "readVisibilityData: error while reading header from file: %s", PHYSFS_getLastError());
-		PHYSFS_close(fileHandle);
+		debug(LOG_ERROR, "readVisibilityData: error while reading header from %s", fileName);
+		free(fileData);
 		return false;
 	}
 
@@ -1605,46 +1852,37 @@ bool readVisibilityData(const char *fileName)
 		      fileHeader.aFileType[2],
 		      fileHeader.aFileType[3]);
 
-		PHYSFS_close(fileHandle);
+		free(fileData);
 		return false;
 	}
 
 	int planes = (game.maxPlayers + 7) / 8;
 
 	// Validate the filesize
-	expectedFileSize = sizeof(fileHeader.aFileType) + sizeof(fileHeader.version) + mapWidth * mapHeight * planes;
-	fileSize = PHYSFS_fileLength(fileHandle);
+	const unsigned expectedFileSize = sizeof(fileHeader.aFileType) + sizeof(fileHeader.version) + mapWidth * mapHeight * planes;
 	if (fileSize != expectedFileSize)
 	{
-		PHYSFS_close(fileHandle);
+		free(fileData);
 		ASSERT(!"readVisibilityData: unexpected filesize", "readVisibilityData: unexpected filesize; should be %u, but is %u", expectedFileSize, fileSize);
 
 		return false;
 	}
 
 	// For every tile...
-	for (i = 0; i < mapWidth * mapHeight; i++)
+	const uint8_t *val = reader.data + reader.pos;
+	for (unsigned i = 0; i < mapWidth * mapHeight; i++)
 	{
 		psMapTiles[i].tileExploredBits = 0;
 	}
 	for (unsigned plane = 0; plane < planes; ++plane)
 	{
-		for (i = 0; i < mapWidth * mapHeight; i++)
+		for (unsigned i = 0; i < mapWidth * mapHeight; i++)
 		{
-			/* Get the visibility data */
-			uint8_t val = 0;
-			if (!PHYSFS_readUBE8(fileHandle, &val))
-			{
-				debug(LOG_ERROR, "readVisibilityData: could not read from %s; PHYSFS error: %s", fileName, PHYSFS_getLastError());
-				PHYSFS_close(fileHandle);
-				return false;
-			}
-			psMapTiles[i].tileExploredBits |= val << (plane * 8);
+			psMapTiles[i].tileExploredBits |= *val++ << (plane * 8);
 		}
 	}
 
-	// Close the file
-	PHYSFS_close(fileHandle);
+	free(fileData);
 
 	/* Hopefully everything's just fine by now */
 	return true;
@@ -1665,80 +1903,175 @@ static const Vector2i aDirOffset[] =
 	Vector2i(1, 1),
 };
 
-// Flood fill a "continent".
-// TODO take into account scroll limits and update continents on scroll limit changes
-static void mapFloodFill(int x, int y, int continent, uint8_t blockedBits, uint16_t MAPTILE::*varContinent)
-{
-	std::vector<Vector2i> open;
-	open.push_back(Vector2i(x, y));
-	mapTile(x, y)->*varContinent = continent;  // Set continent value
+/// Blocking bits of each kind of continents which its propulsion cannot pass
+static const uint8_t continentBlockedBits[CONTINENT_KINDS] = {WATER_BLOCKED | FEATURE_BLOCKED, LAND_BLOCKED | FEATURE_BLOCKED, FEATURE_BLOCKED};
 
-	while (!open.empty())
+/// Terrain blocking bits of a tile for the continents, like those set when loading the map, without features
+static uint8_t continentBlockingBits(int x, int y)
+{
+	// rely on the fact that all border tiles are inaccessible
+	if (x < 1 || y < 1 || x > mapWidth - 2 || y > mapHeight - 2)
+	{
+		return AUXBITS_ALL;
+	}
+	const MAPTILE *psTile = mapTile(x, y);
+	uint8_t bits = terrainType(psTile) == TER_WATER ? WATER_BLOCKED : LAND_BLOCKED;
+	if (terrainType(psTile) == TER_CLIFFFACE)
 	{
-		// Pop the first open node off the list for this iteration
-		Vector2i pos = open.back();
-		open.pop_back();
+		bits |= FEATURE_BLOCKED;
+	}
+	return bits;
+}
 
-		// Add accessible neighbouring tiles to the open list
-		for (int i = 0; i < NUM_DIR; ++i)
+static inline int32_t &continentParent(int tile, int kind)
+{
+	return psMapTiles[tile].continentParent[kind];
+}
+
+/// The root tile of the continent of a passable tile
+static int continentFind(int tile, int kind)
+{
+	while (continentParent(tile, kind) >= 0)
+	{
+		const int parent = continentParent(tile, kind);
+		if (continentParent(parent, kind) >= 0)
 		{
-			// rely on the fact that all border tiles are inaccessible to avoid checking explicitly
-			Vector2i npos = pos + aDirOffset[i];
+			continentParent(tile, kind) = continentParent(parent, kind);  // halve the path on the way
+		}
+		tile = parent;
+	}
+	return tile;
+}
 
-			if (npos.x < 1 || npos.y < 1 || npos.x > mapWidth - 2 || npos.y > mapHeight - 2)
+/// Join the continents of two passable tiles, putting the lower tree under the higher one
+static void continentUnion(int tileA, int tileB, int kind)
+{
+	int rootA = continentFind(tileA, kind);
+	int rootB = continentFind(tileB, kind);
+	if (rootA == rootB)
+	{
+		return;
+	}
+	// roots hold -1 - the rank of their tree
+	if (continentParent(rootA, kind) > continentParent(rootB, kind))
+	{
+		std::swap(rootA, rootB);
+	}
+	if (continentParent(rootA, kind) == continentParent(rootB, kind))
+	{
+		--continentParent(rootA, kind);
+	}
+	continentParent(rootB, kind) = rootA;
+}
+
+/// Work out a kind of continents, joining each passable tile with the passable tiles before it.
+static void continentsBuild(int kind)
+{
+	for (int tile = 0; tile < mapWidth * mapHeight; ++tile)
+	{
+		continentParent(tile, kind) = CONTINENT_BLOCKED;
+	}
+	for (int y = 1; y < mapHeight - 1; y++)
+	{
+		for (int x = 1; x < mapWidth - 1; x++)
+		{
+			const int tile = x + y * mapWidth;
+			if (continentBlockingBits(x, y) & continentBlockedBits[kind])
 			{
 				continue;
 			}
-			MAPTILE *psTile = mapTile(npos);
-
-			if (!(blockTile(npos.x, npos.y, AUX_MAP) & blockedBits) && psTile->*varContinent == 0)
+			continentParent(tile, kind) = -1;
+			// left, up left, up and up right, the border tiles around are never passable
+			for (int neighbour : {tile - 1, tile - mapWidth - 1, tile - mapWidth, tile - mapWidth + 1})
 			{
-				open.push_back(npos);               // add to open list
-				psTile->*varContinent = continent;  // Set continent value
+				if (continentParent(neighbour, kind) != CONTINENT_BLOCKED)
+				{
+					continentUnion(tile, neighbour, kind);
+				}
 			}
 		}
 	}
-}
-
-void mapFloodFillContinents()
-{
-	int x, y, limitedContinents = 0, hoverContinents = 0;
-
-	/* Clear continents */
-	for (y = 0; y < mapHeight; y++)
+	// Point every tile straight at its root, so finding continents is quick until the terrain changes.
+	int count = 0;
+	for (int tile = 0; tile < mapWidth * mapHeight; ++tile)
 	{
-		for (x = 0; x < mapWidth; x++)
+		if (continentParent(tile, kind) >= 0)
 		{
-			MAPTILE *psTile = mapTile(x, y);
-
-			psTile->limitedContinent = 0;
-			psTile->hoverContinent = 0;
+			continentParent(tile, kind) = continentFind(tile, kind);
+		}
+		else if (continentParent(tile, kind) != CONTINENT_BLOCKED)
+		{
+			++count;
 		}
 	}
+	debug(LOG_MAP, "Found %d continents for blocking bits %x", count, continentBlockedBits[kind]);
+}
 
-	/* Iterate over the whole map, looking for unset continents */
-	for (y = 1; y < mapHeight - 2; y++)
+void mapCalcContinents()
+{
+	for (int kind = 0; kind < CONTINENT_KINDS; ++kind)
 	{
-		for (x = 1; x < mapWidth - 2; x++)
-		{
-			MAPTILE *psTile = mapTile(x, y);
+		continentsBuild(kind);
+	}
+}
 
-			if (psTile->limitedContinent == 0 && !fpathBlockingTile(x, y, PROPULSION_TYPE_WHEELED))
-			{
-				mapFloodFill(x, y, 1 + limitedContinents++, WATER_BLOCKED | FEATURE_BLOCKED, &MAPTILE::limitedContinent);
-			}
-			else if (psTile->limitedContinent == 0 && !fpathBlockingTile(x, y, PROPULSION_TYPE_PROPELLOR))
-			{
-				mapFloodFill(x, y, 1 + limitedContinents++, LAND_BLOCKED | FEATURE_BLOCKED, &MAPTILE::limitedContinent);
-			}
+void mapContinentsTileChanged(int x, int y)
+{
+	ASSERT_OR_RETURN(, tileOnMap(x, y), "Tile (%d, %d) not on map", x, y);
+	const uint8_t bits = continentBlockingBits(x, y);
+	const int tile = x + y * mapWidth;
 
-			if (psTile->hoverContinent == 0 && !fpathBlockingTile(x, y, PROPULSION_TYPE_HOVER))
+	for (int kind = 0; kind < CONTINENT_KINDS; ++kind)
+	{
+		const bool blocked = (bits & continentBlockedBits[kind]) != 0;
+		if (blocked == (continentParent(tile, kind) == CONTINENT_BLOCKED))
+		{
+			continue;
+		}
+		if (blocked)
+		{
+			// A union-find forest cannot split a continent, so work them out again.
+			continentsBuild(kind);
+			continue;
+		}
+		// Joining is cheap: the tile joins the continents of the tiles around it.
+		continentParent(tile, kind) = -1;
+		for (int dir = 0; dir < NUM_DIR; ++dir)
+		{
+			const Vector2i pos = Vector2i(x, y) + aDirOffset[dir];
+			if (tileOnMap(pos) && continentParent(pos.x + pos.y * mapWidth, kind) != CONTINENT_BLOCKED)
 			{
-				mapFloodFill(x, y, 1 + hoverContinents++, FEATURE_BLOCKED, &MAPTILE::hoverContinent);
+				continentUnion(tile, pos.x + pos.y * mapWidth, kind);
 			}
 		}
 	}
-	debug(LOG_MAP, "Found %d limited and %d hover continents", limitedContinents, hoverContinents);
+}
+
+int mapContinent(Vector2i pos, PROPULSION_TYPE propulsion)
+{
+	ASSERT_OR_RETURN(-1, tileOnMap(pos), "Tile (%d, %d) not on map", pos.x, pos.y);
+	int kind;
+	switch (propulsion)
+	{
+	case PROPULSION_TYPE_LIFT:
+		return 0;  // assume no map uses skyscrapers to isolate areas
+	case PROPULSION_TYPE_PROPELLOR:
+		kind = CONTINENT_WATER;
+		break;
+	case PROPULSION_TYPE_HOVER:
+		kind = CONTINENT_HOVER;
+		break;
+	default:
+		kind = CONTINENT_LAND;
+		break;
+	}
+	const int tile = pos.x + pos.y * mapWidth;
+	return continentParent(tile, kind) != CONTINENT_BLOCKED ? continentFind(tile, kind) : -1;
+}
+
+bool mapSameContinent(Vector2i posA, Vector2i posB, PROPULSION_TYPE propulsion)
+{
+	return mapContinent(posA, propulsion) == mapContinent(posB, propulsion);
 }
 
 void tileSetFire(int32_t x, int32_t y, uint32_t duration)
@@ -1776,25 +2109,94 @@ bool fireOnLocation(unsigned int x, unsigned int y)
 	return psTile != nullptr && TileIsBurning(psTile);
 }
 
+/// Record that the blocking or passability bits of a tile changed, so that danger maps depending on it are refreshed
+void dangerMapTileChanged(int x, int y)
+{
+	if (dangerThread == nullptr)
+	{
+		return;  // Danger maps are only maintained incrementally while the danger thread runs.
+	}
+	const int tile = x + y * mapWidth;
+	for (auto &state : dangerState)
+	{
+		if (state.pendingOverflow)
+		{
+			continue;
+		}
+		if (state.pendingTiles.size() >= DANGER_MAX_PENDING)
+		{
+			// Too many changes to track individually, just do a complete flood fill next time.
+			state.pendingOverflow = true;
+			state.pendingTiles.clear();
+			continue;
+		}
+		state.pendingTiles.push_back(tile);
+	}
+}
+
+/// Mark a tile as examined by the current flood fill of the given player
+static inline void dangerMarkRead(DANGER_STATE &state, int tile)
+{
+	if (!state.readMask[tile])
+	{
+		state.readMask[tile] = true;
+		state.readTiles.push_back(tile);
+	}
+}
+
 // This function runs in a separate thread!
-static int dangerFloodFill(int player)
+static void dangerFloodFill(int player, DANGER_STATE &state)
 {
-	int i;
 	Vector2i pos = getPlayerStartPosition(player);
 	Vector2i npos;
 	uint8_t aux, block;
-	int x, y;
 	bool start = true;	// hack to disregard the blocking status of any building exactly on the starting position
 
-	// Set our danger bits
-	for (y = 0; y < mapHeight; y++)
+	state.restoreTiles.clear();
+	state.refilled = false;
+	if (state.valid)
 	{
-		for (x = 0; x < mapWidth; x++)
+		// The flood fill only depends on the bits of tiles it examined. If none of those changed, the previous
+		// result (still in the danger map) is exactly what a new flood fill would produce.
+		bool affected = state.changedOverflow;
+		for (int tile : state.changedTiles)
 		{
-			auxSet(x, y, MAX_PLAYERS + AUX_DANGERMAP, AUXBITS_DANGER);
-			auxClear(x, y, MAX_PLAYERS + AUX_DANGERMAP, AUXBITS_TEMPORARY);
+			if (state.readMask[tile])
+			{
+				affected = true;
+				break;
+			}
 		}
+		if (!affected)
+		{
+			return;
+		}
+
+		// Reset our danger bits. Only tiles examined by the previous flood fill can have been cleared.
+		for (int tile : state.readTiles)
+		{
+			psAuxMap[MAX_PLAYERS + AUX_DANGERMAP][tile] |= AUXBITS_DANGER;
+			state.readMask[tile] = false;
+		}
+		state.restoreTiles.swap(state.readTiles);
+	}
+	else
+	{
+		// Set our danger bits
+		for (int y = 0; y < mapHeight; y++)
+		{
+			for (int x = 0; x < mapWidth; x++)
+			{
+				auxSet(x, y, MAX_PLAYERS + AUX_DANGERMAP, AUXBITS_DANGER);
+				auxClear(x, y, MAX_PLAYERS + AUX_DANGERMAP, AUXBITS_TEMPORARY);
+			}
+		}
+		state.readMask.assign(mapWidth * mapHeight, false);
 	}
+	state.readTiles.clear();
+	state.valid = true;
+	state.refilled = true;
+	state.changedOverflow = false;
 
 	pos.x = map_coord(pos.x);
 	pos.y = map_coord(pos.y);
@@ -1802,8 +2204,10 @@ static int dangerFloodFill(int player)
 
 	do
 	{
+		dangerMarkRead(state, pos.x + pos.y * mapWidth);
+
 		// Add accessible neighbouring tiles to the open list
-		for (i = 0; i < NUM_DIR; i++)
+		for (int i = 0; i < NUM_DIR; i++)
 		{
 			npos.x = pos.x + aDirOffset[i].x;
 			npos.y = pos.y + aDirOffset[i].y;
@@ -1811,6 +2215,7 @@ static int dangerFloodFill(int player)
 			{
 				continue;
 			}
+			dangerMarkRead(state, npos.x + npos.y * mapWidth);
 			aux = auxTile(npos.x, npos.y, MAX_PLAYERS + AUX_DANGERMAP);
 			block = blockTile(pos.x, pos.y, AUX_DANGERMAP);
 			if (!(aux & AUXBITS_TEMPORARY) && !(aux & AUXBITS_THREAT) && (aux & AUXBITS_DANGER))
@@ -1846,6 +2251,18 @@ static int dangerFloodFill(int player)
 		}
 	}
 	while (bucketcounter);
+
+	// The temporary bits are only set on examined tiles, clear them for the next flood fill
+	for (int tile : state.readTiles)
+	{
+		psAuxMap[MAX_PLAYERS + AUX_DANGERMAP][tile] &= ~AUXBITS_TEMPORARY;
+	}
+}
+
+// This function runs in a separate thread!
+static int dangerFloodFill(int player)
+{
+	dangerFloodFill(player, dangerState[player]);
 	return 0;
 }
 
@@ -1861,42 +2278,178 @@ static int dangerThreadFunc(WZ_DECL_UNUSED void *data)
 	return 0;
 }
 
-static inline void threatUpdateTarget(int player, BASE_OBJECT *psObj, bool ground, bool air)
+/// Swap the player's danger map into the danger slot, bring its tiles changed since the last flood fill up to date with
+/// the aux and block maps, and hand those tiles over to the flood fill
+static void dangerMapStore(int player)
 {
-	int i;
+	DANGER_STATE &state = dangerState[player];
+	const int mask = AUXBITS_THREAT | AUXBITS_AATHREAT | AUXBITS_DANGER;
 
-	if (psObj->visible[player] || psObj->born == 2)
+	std::swap(psAuxMap[MAX_PLAYERS + AUX_DANGERMAP], state.aux);
+	uint8_t *aux = psAuxMap[MAX_PLAYERS + AUX_DANGERMAP];
+	if (aux == nullptr || state.pendingOverflow)
 	{
-		for (i = 0; i < psObj->numWatchedTiles; i++)
+		if (aux == nullptr)
 		{
-			const TILEPOS pos = psObj->watchedTiles[i];
+			aux = psAuxMap[MAX_PLAYERS + AUX_DANGERMAP] = (uint8_t *)malloc(mapWidth * mapHeight * sizeof(*aux));
+		}
+		auxMapStore(player, AUX_DANGERMAP);
+	}
+	else
+	{
+		// Every change to the aux and block maps is pending for every player, so the shared block slot only needs
+		// the tiles changed since this player's last store too. The danger bits only change in the danger map.
+		for (int tile : state.pendingTiles)
+		{
+			psBlockMap[AUX_DANGERMAP][tile] = psBlockMap[0][tile];
+			aux[tile] = (aux[tile] & mask) | (psAuxMap[player][tile] & ~mask);
+		}
+	}
+	state.changedTiles.swap(state.pendingTiles);
+	state.pendingTiles.clear();
+	state.changedOverflow = state.changedOverflow || state.pendingOverflow;
+	state.pendingOverflow = false;
+}
+
+/// Copy the danger and threat bits back from the danger slot, only looking at tiles that may have changed
+static void dangerMapRestore(int player)
+{
+	DANGER_STATE &state = dangerState[player];
+	const int mask = AUXBITS_THREAT | AUXBITS_AATHREAT | AUXBITS_DANGER;
+
+	for (const std::vector<int> *tiles : {&state.changedTiles, &state.restoreTiles, &state.readTiles})
+	{
+		if (tiles == &state.readTiles && !state.refilled)
+		{
+			continue;
+		}
+		for (int tile : *tiles)
+		{
+			const uint8_t original = psAuxMap[player][tile];
+			const uint8_t cached = psAuxMap[MAX_PLAYERS + AUX_DANGERMAP][tile];
+			psAuxMap[player][tile] = original ^ ((original ^ cached) & mask);
+		}
+	}
+	state.changedTiles.clear();
+	state.restoreTiles.clear();
+	std::swap(psAuxMap[MAX_PLAYERS + AUX_DANGERMAP], state.aux);
+}
+
+#ifdef DEBUG
+/// Check that dangerMapStore left the danger slot and the shared block slot as a complete auxMapStore would have
+static void dangerMapCheckStore(int player)
+{
+	const int mask = AUXBITS_THREAT | AUXBITS_AATHREAT | AUXBITS_DANGER;
+	int wrong = 0;
+	for (int tile = 0; tile < mapWidth * mapHeight; ++tile)
+	{
+		wrong += ((psAuxMap[MAX_PLAYERS + AUX_DANGERMAP][tile] ^ psAuxMap[player][tile]) & ~mask) != 0
+		         || psBlockMap[AUX_DANGERMAP][tile] != psBlockMap[0][tile];
+	}
+	ASSERT(wrong == 0, "Danger slot of player %d differs from a complete store on %d tiles", player, wrong);
+}
+
+/// Check that the danger bits dangerMapRestore left in the player's aux map are what a complete flood fill of the
+/// stored map gives. Must be called before the next dangerMapStore, while the block slot still holds what was stored.
+static void dangerMapCheckRestore(int player)
+{
+	uint8_t *const slot = psAuxMap[MAX_PLAYERS + AUX_DANGERMAP];
+	psAuxMap[MAX_PLAYERS + AUX_DANGERMAP] = (uint8_t *)malloc(mapWidth * mapHeight);
+	memcpy(psAuxMap[MAX_PLAYERS + AUX_DANGERMAP], dangerState[player].aux, mapWidth * mapHeight);
+	DANGER_STATE scratch;
+	dangerFloodFill(player, scratch);
+	int wrong = 0;
+	for (int tile = 0; tile < mapWidth * mapHeight; ++tile)
+	{
+		wrong += ((psAuxMap[player][tile] ^ psAuxMap[MAX_PLAYERS + AUX_DANGERMAP][tile]) & AUXBITS_DANGER) != 0;
+	}
+	ASSERT(wrong == 0, "Danger map of player %d differs from a complete flood fill on %d tiles", player, wrong);
+	free(psAuxMap[MAX_PLAYERS + AUX_DANGERMAP]);
+	psAuxMap[MAX_PLAYERS + AUX_DANGERMAP] = slot;
+}
+#endif
+
+/// Add (delta = 1) or remove (delta = -1) an object's threat on the given player's danger map
+static void threatStampTiles(int player, const THREAT_STAMP &stamp, int delta)
+{
+	DANGER_STATE &state = dangerState[player];
+	const bool ground = stamp.mode & SHOOT_ON_GROUND;
+	const bool air = stamp.mode & SHOOT_IN_AIR;
+
+	for (const TILEPOS &pos : stamp.tiles)
+	{
+		const int tile = pos.x + pos.y * mapWidth;
+		int changed = 0;
 
-			if (ground)
+		if (ground)
+		{
+			uint16_t &count = state.threatCount[tile];
+			if ((delta > 0 && count++ == 0) || (delta < 0 && --count == 0))
 			{
-				auxSet(pos.x, pos.y, MAX_PLAYERS + AUX_DANGERMAP, AUXBITS_THREAT);	// set ground threat for this tile
+				changed |= AUXBITS_THREAT;
 			}
-			if (air)
+		}
+		if (air)
+		{
+			uint16_t &count = state.aaThreatCount[tile];
+			if ((delta > 0 && count++ == 0) || (delta < 0 && --count == 0))
 			{
-				auxSet(pos.x, pos.y, MAX_PLAYERS + AUX_DANGERMAP, AUXBITS_AATHREAT);	// set air threat for this tile
+				changed |= AUXBITS_AATHREAT;
 			}
 		}
+		if (changed)
+		{
+			psAuxMap[MAX_PLAYERS + AUX_DANGERMAP][tile] ^= changed;
+			state.changedTiles.push_back(tile);
+		}
 	}
 }
 
-static void threatUpdate(int player)
+static inline void threatUpdateTarget(int player, BASE_OBJECT *psObj, uint8_t mode, uint32_t epoch)
 {
-	int i, weapon, x, y;
+	if (!psObj->visible[player] && psObj->born != 2)
+	{
+		return;  // Not a threat we know of, any previous stamp is removed when sweeping.
+	}
 
-	// Step 1: Clear our threat bits
-	for (y = 0; y < mapHeight; y++)
+	THREAT_STAMP &stamp = dangerState[player].threatStamps[psObj->id];
+	stamp.epoch = epoch;
+	if (stamp.mode == mode && stamp.tiles.size() == psObj->numWatchedTiles
+	    && (psObj->numWatchedTiles == 0 || memcmp(stamp.tiles.data(), psObj->watchedTiles, psObj->numWatchedTiles * sizeof(*psObj->watchedTiles)) == 0))
 	{
-		for (x = 0; x < mapWidth; x++)
+		return;  // Nothing changed since we last looked.
+	}
+	threatStampTiles(player, stamp, -1);
+	stamp.mode = mode;
+	stamp.tiles.assign(psObj->watchedTiles, psObj->watchedTiles + psObj->numWatchedTiles);
+	threatStampTiles(player, stamp, 1);
+}
+
+/// Forget all threats on the given player's danger map, and clear the threat bits in the danger slot
+static void threatReset(int player)
+{
+	DANGER_STATE &state = dangerState[player];
+
+	state.threatStamps.clear();
+	state.threatCount.assign(mapWidth * mapHeight, 0);
+	state.aaThreatCount.assign(mapWidth * mapHeight, 0);
+	for (int y = 0; y < mapHeight; y++)
+	{
+		for (int x = 0; x < mapWidth; x++)
 		{
 			auxClear(x, y, MAX_PLAYERS + AUX_DANGERMAP, AUXBITS_THREAT | AUXBITS_AATHREAT);
 		}
 	}
+}
+
+/// Bring the threat bits in the danger slot up to date, only touching tiles of objects whose threat changed
+static void threatUpdate(int player)
+{
+	DANGER_STATE &state = dangerState[player];
+	const uint32_t epoch = ++state.threatEpoch;
+	int i, weapon;
 
-	// Step 2: Set threat bits
+	// Step 1: Add or update threats of all hostile objects
 	for (i = 0; i < MAX_PLAYERS; i++)
 	{
 		DROID *psDroid;
@@ -1925,9 +2478,10 @@ static void threatUpdate(int player)
 			{
 				mode |= SHOOT_ON_GROUND;		// assume it only shoots at ground targets for now
 			}
+			mode &= SHOOT_ON_GROUND | SHOOT_IN_AIR;
 			if (mode > 0)
 			{
-				threatUpdateTarget(player, (BASE_OBJECT *)psDroid, mode & SHOOT_ON_GROUND, mode & SHOOT_IN_AIR);
+				threatUpdateTarget(player, (BASE_OBJECT *)psDroid, mode, epoch);
 			}
 		}
 
@@ -1943,12 +2497,27 @@ static void threatUpdate(int player)
 			{
 				mode |= SHOOT_ON_GROUND;		// assume it only shoots at ground targets for now
 			}
+			mode &= SHOOT_ON_GROUND | SHOOT_IN_AIR;
 			if (mode > 0)
 			{
-				threatUpdateTarget(player, (BASE_OBJECT *)psStruct, mode & SHOOT_ON_GROUND, mode & SHOOT_IN_AIR);
+				threatUpdateTarget(player, (BASE_OBJECT *)psStruct, mode, epoch);
 			}
 		}
 	}
+
+	// Step 2: Remove threats of objects that died, became friendly, invisible or harmless
+	for (auto it = state.threatStamps.begin(); it != state.threatStamps.end();)
+	{
+		if (it->second.epoch != epoch)
+		{
+			threatStampTiles(player, it->second, -1);
+			it = state.threatStamps.erase(it);
+		}
+		else
+		{
+			++it;
+		}
+	}
 }
 
 void mapInit()
@@ -1964,17 +2533,27 @@ void mapInit()
 	// Initialize danger maps
 	for (player = 0; player < MAX_PLAYERS; player++)
 	{
-		auxMapStore(player, AUX_DANGERMAP);
+		dangerStateReset(dangerState[player]);
+		dangerMapStore(player);
+		threatReset(player);
 		threatUpdate(player);
 		dangerFloodFill(player);
 		auxMapRestore(player, AUX_DANGERMAP, AUXBITS_DANGER | AUXBITS_THREAT | AUXBITS_AATHREAT);
+		dangerState[player].changedTiles.clear();
+		dangerState[player].restoreTiles.clear();
+		dangerMapRestore(player);
 	}
 
 	// Start thread
 	ASSERT(dangerSemaphore == nullptr && dangerThread == nullptr, "Map data not cleaned up before starting!");
 	if (game.type == SKIRMISH)
 	{
+		// The thread starts on the first player, so swap that player's danger map in for it, like mapUpdate does.
 		lastDangerPlayer = 0;
+		dangerMapStore(lastDangerPlayer);
+#ifdef DEBUG
+		dangerMapCheckStore(lastDangerPlayer);
+#endif
 		dangerSemaphore = wzSemaphoreCreate(0);
 		dangerDoneSemaphore = wzSemaphoreCreate(0);
 		dangerThread = wzThreadCreate(dangerThreadFunc, nullptr);
@@ -2009,9 +2588,15 @@ void mapUpdate()
 		// Lock if previous job not done yet
 		wzSemaphoreWait(dangerDoneSemaphore);
 
-		auxMapRestore(lastDangerPlayer, AUX_DANGERMAP, AUXBITS_THREAT | AUXBITS_AATHREAT | AUXBITS_DANGER);
+		dangerMapRestore(lastDangerPlayer);
+#ifdef DEBUG
+		dangerMapCheckRestore(lastDangerPlayer);
+#endif
 		lastDangerPlayer = (lastDangerPlayer + 1) % game.maxPlayers;
-		auxMapStore(lastDangerPlayer, AUX_DANGERMAP);
+		dangerMapStore(lastDangerPlayer);
+#ifdef DEBUG
+		dangerMapCheckStore(lastDangerPlayer);
+#endif
 		threatUpdate(lastDangerPlayer);
 		wzSemaphorePost(dangerSemaphore);
 	}
@@ -89,6 +89,18 @@ struct GROUND_TYPE
 };
 
 /* Information stored with each tile */
+/// Kinds of continents, the areas connected for the propulsion types, see mapContinent
+enum CONTINENT_KIND
+{
+	CONTINENT_LAND,   ///< For land propulsion types
+	CONTINENT_WATER,  ///< For propellors
+	CONTINENT_HOVER,  ///< For hover propulsion
+	CONTINENT_KINDS
+};
+
+/// Parent in the continent forest of tiles which are not in a continent, see MAPTILE::continentParent
+#define CONTINENT_BLOCKED INT32_MIN
+
 struct MAPTILE
 {
 	uint8_t			tileInfoBits;
@@ -101,8 +113,7 @@ struct MAPTILE
 	float                   level;                  ///< The visibility level of the top left of the tile, for this client.
 	BASE_OBJECT		*psObject;		// Any object sitting on the location (e.g. building)
 	PIELIGHT		colour;
-	uint16_t		limitedContinent;	///< For land or sea limited propulsion types
-	uint16_t		hoverContinent;		///< For hover type propulsions
+	int32_t                 continentParent[CONTINENT_KINDS];  ///< For each kind of continent, the next tile towards the root of this tile's continent, -1 - the rank of the tree for roots, or CONTINENT_BLOCKED
 	uint8_t			ground;			///< The ground type used for the terrain renderer
 	uint16_t                fireEndTime;            ///< The (uint16_t)(gameTime / GAME_TICKS_PER_UPDATE) that BITS_ON_FIRE should be cleared.
 	int32_t                 waterLevel;             ///< At what height is the water for this tile
@@ -142,6 +153,9 @@ extern char *tilesetDir;
 extern uint8_t *psBlockMap[AUX_MAX];
 extern uint8_t *psAuxMap[MAX_PLAYERS + AUX_MAX];	// yes, we waste one element... eyes wide open... makes API nicer
 
+/// Notify the danger maps that the blocking or passability bits of a tile changed
+void dangerMapTileChanged(int x, int y);
+
 /// Find aux bitfield for a given tile
 WZ_DECL_ALWAYS_INLINE static inline uint8_t auxTile(int x, int y, int player)
 {
@@ -186,6 +200,7 @@ WZ_DECL_ALWAYS_INLINE static inline void auxSetAll(int x, int y, int state)
 {
 	int i;
 
+	dangerMapTileChanged(x, y);
 	for (i = 0; i < MAX_PLAYERS; i++)
 	{
 		psAuxMap[i][x + y * mapWidth] |= state;
@@ -197,6 +212,7 @@ WZ_DECL_ALWAYS_INLINE static inline void auxSetAllied(int x, int y, int player,
 {
 	int i;
 
+	dangerMapTileChanged(x, y);
 	for (i = 0; i < MAX_PLAYERS; i++)
 	{
 		if (alliancebits[player] & (1 << i))
@@ -211,6 +227,7 @@ WZ_DECL_ALWAYS_INLINE static inline void auxSetEnemy(int x, int y, int player, i
 {
 	int i;
 
+	dangerMapTileChanged(x, y);
 	for (i = 0; i < MAX_PLAYERS; i++)
 	{
 		if (!(alliancebits[player] & (1 << i)))
@@ -231,6 +248,7 @@ WZ_DECL_ALWAYS_INLINE static inline void auxClearAll(int x, int y, int state)
 {
 	int i;
 
+	dangerMapTileChanged(x, y);
 	for (i = 0; i < MAX_PLAYERS; i++)
 	{
 		psAuxMap[i][x + y * mapWidth] &= ~state;
@@ -240,12 +258,14 @@ WZ_DECL_ALWAYS_INLINE static inline void auxClearAll(int x, int y, int state)
 /// Set blocking bits. Always set identically for all players. States not set are retained.
 WZ_DECL_ALWAYS_INLINE static inline void auxSetBlocking(int x, int y, int state)
 {
+	dangerMapTileChanged(x, y);
 	psBlockMap[0][x + y * mapWidth] |= state;
 }
 
 /// Clear blocking bits. Always set identically for all players. States not cleared are retained.
 WZ_DECL_ALWAYS_INLINE static inline void auxClearBlocking(int x, int y, int state)
 {
+	dangerMapTileChanged(x, y);
 	psBlockMap[0][x + y * mapWidth] &= ~state;
 }
 
@@ -550,7 +570,15 @@ bool writeVisibilityData(const char *fileName);
 //scroll min and max values
 extern SDWORD scrollMinX, scrollMaxX, scrollMinY, scrollMaxY;
 
-void mapFloodFillContinents();
+/// Work out the continents: the tiles connected by the tiles a propulsion can pass. Only the terrain counts, not
+/// structures or features, which the path finding goes around.
+void mapCalcContinents();
+/// Update the continents after the terrain type of a tile changed.
+void mapContinentsTileChanged(int x, int y);
+/// The continent of a tile for the propulsion, or -1 if it cannot pass the tile. Finding it may shorten the forest.
+int mapContinent(Vector2i pos, PROPULSION_TYPE propulsion);
+/// Whether the propulsion may get from one tile to the other.
+bool mapSameContinent(Vector2i posA, Vector2i posB, PROPULSION_TYPE propulsion);
 
 void mapTest();
 
@@ -66,8 +66,8 @@ struct QueuedDroidInfo
 		}
 		return droidId < z.droidId;
 	}
-	/// Returns 0 if order is the same, non-zero otherwise.
-	int orderCompare(QueuedDroidInfo const &z) const
+	/// Returns 0 if order is the same, non-zero otherwise. Ignores the target (but not its type), if not withTarget.
+	int orderCompare(QueuedDroidInfo const &z, bool withTarget = true) const
 	{
 		if (player != z.player)
 		{
@@ -85,26 +85,16 @@ struct QueuedDroidInfo
 			{
 				return order < z.order ? -1 : 1;
 			}
-			if (subType == ObjOrder)
+			if (subType == ObjOrder && destType != z.destType)
 			{
-				if (destId != z.destId)
-				{
-					return destId < z.destId ? -1 : 1;
-				}
-				if (destType != z.destType)
-				{
-					return destType < z.destType ? -1 : 1;
-				}
+				return destType < z.destType ? -1 : 1;
 			}
-			else
+			if (withTarget)
 			{
-				if (pos.x != z.pos.x)
+				int targetComp = targetCompare(z);
+				if (targetComp != 0)
 				{
-					return pos.x < z.pos.x ? -1 : 1;
-				}
-				if (pos.y != z.pos.y)
-				{
-					return pos.y < z.pos.y ? -1 : 1;
+					return targetComp;
 				}
 			}
 			if (order == DORDER_BUILD || order == DORDER_LINEBUILD)
@@ -154,6 +144,32 @@ struct QueuedDroidInfo
 		}
 		return 0;
 	}
+	/// Compares only the target, assuming that the order is the same.
+	int targetCompare(QueuedDroidInfo const &z) const
+	{
+		switch (subType)
+		{
+		case ObjOrder:
+			if (destId != z.destId)
+			{
+				return destId < z.destId ? -1 : 1;
+			}
+			break;
+		case LocOrder:
+			if (pos.x != z.pos.x)
+			{
+				return pos.x < z.pos.x ? -1 : 1;
+			}
+			if (pos.y != z.pos.y)
+			{
+				return pos.y < z.pos.y ? -1 : 1;
+			}
+			break;
+		case SecondaryOrder:
+			break;
+		}
+		return 0;
+	}
 
 	uint8_t     player;
 	uint32_t    droidId;
@@ -176,6 +192,43 @@ struct QueuedDroidInfo
 
 static std::vector<QueuedDroidInfo> queuedOrders;
 
+#define ORDER_TEMPLATES 32  ///< Number of recently sent orders remembered for each player
+
+/// Recently sent orders, without droid and target, so that sending the same order again only takes its index.
+/// The sender and every receiver of the orders of a player update their copy in the same way, in the same order.
+struct OrderTemplates
+{
+	QueuedDroidInfo templates[ORDER_TEMPLATES];
+	unsigned used = 0;
+	unsigned next = 0;  ///< Slot to overwrite next.
+
+	void reset()
+	{
+		used = 0;
+		next = 0;
+	}
+	int find(QueuedDroidInfo const &info) const
+	{
+		for (unsigned i = 0; i < used; ++i)
+		{
+			if (templates[i].orderCompare(info, false) == 0)
+			{
+				return i;
+			}
+		}
+		return -1;
+	}
+	void add(QueuedDroidInfo const &info)
+	{
+		templates[next] = info;
+		next = (next + 1) % ORDER_TEMPLATES;
+		used = std::min(used + 1, (unsigned)ORDER_TEMPLATES);
+	}
+};
+
+static OrderTemplates sentOrderTemplates[MAX_PLAYERS];  ///< By the queue sent on, since selectedPlayer may change
+static OrderTemplates receivedOrderTemplates[MAX_PLAYERS];
+
 
 // ////////////////////////////////////////////////////////////////////////////
 // Local Prototypes
@@ -461,8 +514,8 @@ bool recvDroid(NETQUEUE queue)
 }
 
 
-/// Does not read/write info->droidId!
-static void NETQueuedDroidInfo(QueuedDroidInfo *info)
+/// Does not read/write info->droidId, nor the target!
+static void NETQueuedDroidInfoTemplate(QueuedDroidInfo *info)
 {
 	NETuint8_t(&info->player);
 	NETenum(&info->subType);
@@ -473,13 +526,8 @@ static void NETQueuedDroidInfo(QueuedDroidInfo *info)
 		NETenum(&info->order);
 		if (info->subType == ObjOrder)
 		{
-			NETuint32_t(&info->destId);
 			NETenum(&info->destType);
 		}
-		else
-		{
-			NETauto(&info->pos);
-		}
 		if (info->order == DORDER_BUILD || info->order == DORDER_LINEBUILD)
 		{
 			NETuint32_t(&info->structRef);
@@ -502,38 +550,152 @@ static void NETQueuedDroidInfo(QueuedDroidInfo *info)
 	}
 }
 
+/// Reads/writes the target, as the difference from the previous target, since nearby targets have similar IDs and positions.
+static void NETQueuedDroidInfoTarget(QueuedDroidInfo *info, QueuedDroidInfo const &prev)
+{
+	switch (info->subType)
+	{
+	case ObjOrder:
+		{
+			int32_t deltaDestId = info->destId - prev.destId;
+			NETint32_t(&deltaDestId);
+			info->destId = prev.destId + deltaDestId;
+			break;
+		}
+	case LocOrder:
+		{
+			Vector2i deltaPos = info->pos - prev.pos;
+			NETauto(&deltaPos);
+			info->pos = prev.pos + deltaPos;
+			break;
+		}
+	case SecondaryOrder:
+		break;
+	}
+}
+
+/// Droids given the same order, possibly with a different target for each droid.
+struct QueuedDroidInfoGroup
+{
+	std::vector<QueuedDroidInfo>::iterator begin, end;
+	bool sameTarget;
+};
+
+void resetQueuedDroidInfo()
+{
+	queuedOrders.clear();
+	for (OrderTemplates &templates : sentOrderTemplates)
+	{
+		templates.reset();
+	}
+	for (OrderTemplates &templates : receivedOrderTemplates)
+	{
+		templates.reset();
+	}
+}
+
 // Actually send the droid info.
 void sendQueuedDroidInfo()
 {
-	// Sort queued orders, to group the same order to multiple droids.
-	std::sort(queuedOrders.begin(), queuedOrders.end());
+	if (queuedOrders.empty())
+	{
+		return;
+	}
+
+	// Sort queued orders, to group the same order to multiple droids, keeping the orders given to each droid in the order they were given.
+	std::stable_sort(queuedOrders.begin(), queuedOrders.end(), [](QueuedDroidInfo const &a, QueuedDroidInfo const &b) {
+		int orComp = a.orderCompare(b, false);
+		return orComp != 0 ? orComp < 0 : a.droidId < b.droidId;
+	});
 
+	std::vector<QueuedDroidInfoGroup> groups;
 	std::vector<QueuedDroidInfo>::iterator eqBegin, eqEnd;
 	for (eqBegin = queuedOrders.begin(); eqBegin != queuedOrders.end(); eqBegin = eqEnd)
 	{
-		// Find end of range of orders which differ only by the droid ID.
-		for (eqEnd = eqBegin + 1; eqEnd != queuedOrders.end() && eqEnd->orderCompare(*eqBegin) == 0; ++eqEnd)
+		// Find end of range of orders which differ only by the droid ID and target.
+		for (eqEnd = eqBegin + 1; eqEnd != queuedOrders.end() && eqEnd->orderCompare(*eqBegin, false) == 0; ++eqEnd)
 		{}
 
-		NETbeginEncode(NETgameQueue(selectedPlayer), GAME_DROIDINFO);
-		NETQueuedDroidInfo(&*eqBegin);
+		std::vector<QueuedDroidInfo> targets(eqBegin, eqEnd);
+		std::sort(targets.begin(), targets.end(), [](QueuedDroidInfo const &a, QueuedDroidInfo const &b) { return a.targetCompare(b) < 0; });
+		size_t numTargets = std::unique(targets.begin(), targets.end(), [](QueuedDroidInfo const &a, QueuedDroidInfo const &b) { return a.targetCompare(b) == 0; }) - targets.begin();
 
-		uint32_t num = eqEnd - eqBegin;
+		// Grouping by target would reorder the orders of a droid given several in the range, such as queued waypoints.
+		// The range is sorted by droid, so any droid given several orders has them next to each other.
+		const bool oneOrderPerDroid = std::adjacent_find(eqBegin, eqEnd, [](QueuedDroidInfo const &a, QueuedDroidInfo const &b) { return a.droidId == b.droidId; }) == eqEnd;
+
+		if (oneOrderPerDroid && (numTargets == 1 || numTargets * 2 <= size_t(eqEnd - eqBegin)))
+		{
+			// Few targets, each shared by several droids, so send each target once.
+			std::stable_sort(eqBegin, eqEnd, [](QueuedDroidInfo const &a, QueuedDroidInfo const &b) { return a.targetCompare(b) < 0; });
+			std::vector<QueuedDroidInfo>::iterator targetBegin, targetEnd;
+			for (targetBegin = eqBegin; targetBegin != eqEnd; targetBegin = targetEnd)
+			{
+				for (targetEnd = targetBegin + 1; targetEnd != eqEnd && targetEnd->targetCompare(*targetBegin) == 0; ++targetEnd)
+				{}
+				groups.push_back({targetBegin, targetEnd, true});
+			}
+		}
+		else
+		{
+			// Mostly different targets, so send the target with each droid.
+			groups.push_back({eqBegin, eqEnd, false});
+		}
+	}
+
+	const unsigned bytesBefore = NETgetMessageStatistic(GAME_DROIDINFO, true);
+
+	const NETQUEUE queue = NETgameQueue(selectedPlayer);
+	OrderTemplates &sentTemplates = sentOrderTemplates[queue.index];
+	NETbeginEncode(queue, GAME_DROIDINFO);
+	uint32_t numGroups = groups.size();
+	NETuint32_t(&numGroups);
+	for (QueuedDroidInfoGroup const &group : groups)
+	{
+		QueuedDroidInfo orderTemplate = *group.begin;
+		orderTemplate.droidId = 0;
+		orderTemplate.destId = 0;
+		orderTemplate.pos = Vector2i(0, 0);
+
+		// Refer to the same order sent earlier, if any, otherwise send it in full.
+		uint32_t templateRef = sentTemplates.find(orderTemplate) + 1;
+		NETuint32_t(&templateRef);
+		if (templateRef == 0)
+		{
+			NETQueuedDroidInfoTemplate(&orderTemplate);
+			sentTemplates.add(orderTemplate);
+		}
+
+		bool sameTarget = group.sameTarget;
+		NETbool(&sameTarget);
+		QueuedDroidInfo prevTarget = orderTemplate;
+		if (sameTarget)
+		{
+			NETQueuedDroidInfoTarget(&*group.begin, prevTarget);
+		}
+
+		uint32_t num = group.end - group.begin;
 		NETuint32_t(&num);
 
 		uint32_t prevDroidId = 0;
-		for (unsigned n = 0; n < num; ++n)
+		for (std::vector<QueuedDroidInfo>::iterator i = group.begin; i != group.end; ++i)
 		{
-			uint32_t droidId = (eqBegin + n)->droidId;
-
 			// Encode deltas between droid IDs, since the deltas are smaller than the actual droid IDs, and will encode to less bytes on average.
-			uint32_t deltaDroidId = droidId - prevDroidId;
+			uint32_t deltaDroidId = i->droidId - prevDroidId;
 			NETuint32_t(&deltaDroidId);
+			prevDroidId = i->droidId;
 
-			prevDroidId = droidId;
+			if (!sameTarget)
+			{
+				NETQueuedDroidInfoTarget(&*i, prevTarget);
+				prevTarget = *i;
+			}
 		}
-		NETend();
 	}
+	NETend();
+
+	debug(LOG_NET, "Sent %u droid orders in %u groups, using %u bytes", (unsigned)queuedOrders.size(), numGroups,
+	      NETgetMessageStatistic(GAME_DROIDINFO, true) - bytesBefore);
 
 	// Sent the orders. Don't send them again.
 	queuedOrders.clear();
@@ -610,15 +772,108 @@ void sendDroidInfo(DROID *psDroid, DroidOrder const &order, bool add)
 	orderDroidAddPending(psDroid, &sOrder);
 }
 
+/// Logs the order to the sync debug log.
+static void syncDebugDroidInfo(QueuedDroidInfo const &info)
+{
+	switch (info.subType)
+	{
+	case ObjOrder:       syncDebug("Order=%s,%d(%d)", getDroidOrderName(info.order), info.destId, info.destType); break;
+	case LocOrder:       syncDebug("Order=%s,(%d,%d)", getDroidOrderName(info.order), info.pos.x, info.pos.y); break;
+	case SecondaryOrder: syncDebug("SecondaryOrder=%d,%08X", (int)info.secOrder, (int)info.secState); break;
+	}
+}
+
+/// Gives a received order to info.droidId.
+static void recvDroidOrder(NETQUEUE queue, QueuedDroidInfo const &info, DROID_ORDER_DATA *sOrder)
+{
+	DROID *psDroid = IdToDroid(info.droidId, info.player);
+	if (!psDroid)
+	{
+		debug(LOG_NEVER, "Packet from %d refers to non-existent droid %u, [%s : p%d]",
+		      queue.index, info.droidId, isHumanPlayer(info.player) ? "Human" : "AI", info.player);
+		syncDebug("Droid %d missing", info.droidId);
+		return;  // Can't find the droid, so skip this droid.
+	}
+	if (!canGiveOrdersFor(queue.index, psDroid->player))
+	{
+		debug(LOG_WARNING, "Droid order (by %d) for wrong player (%d).", queue.index, psDroid->player);
+		syncDebug("Wrong player.");
+		return;
+	}
+
+	CHECK_DROID(psDroid);
+
+	syncDebugDroid(psDroid, '<');
+
+	switch (info.subType)
+	{
+	case ObjOrder:
+	case LocOrder:
+		/*
+		* If the current order not is a command order and we are not a
+		* commander yet are in the commander group remove us from it.
+		*/
+		if (hasCommander(psDroid))
+		{
+			psDroid->psGroup->remove(psDroid);
+		}
+
+		if (sOrder->psObj != TargetMissing)  // Only do order if the target didn't die.
+		{
+			if (!info.add)
+			{
+				orderDroidListEraseRange(psDroid, 0, psDroid->listSize + 1);  // Clear all non-pending orders, plus the first pending order (which is probably the order we just received).
+				orderDroidBase(psDroid, sOrder);  // Execute the order immediately (even if in the middle of another order.
+			}
+			else
+			{
+				orderDroidAdd(psDroid, sOrder);   // Add the order to the (non-pending) list. Will probably overwrite the corresponding pending order, assuming all pending orders were written to the list.
+			}
+		}
+		break;
+	case SecondaryOrder:
+		// Set the droids secondary order
+		turnOffMultiMsg(true);
+		secondarySetState(psDroid, info.secOrder, info.secState);
+		turnOffMultiMsg(false);
+		break;
+	}
+
+	syncDebugDroid(psDroid, '>');
+
+	CHECK_DROID(psDroid);
+}
+
 // ////////////////////////////////////////////////////////////////////////////
 // receive droid information form other players.
 bool recvDroidInfo(NETQUEUE queue)
 {
+	OrderTemplates &templates = receivedOrderTemplates[queue.index];
+
 	NETbeginDecode(queue, GAME_DROIDINFO);
+	uint32_t numGroups = 0;
+	NETuint32_t(&numGroups);
+	for (unsigned group = 0; group < numGroups; ++group)
 	{
 		QueuedDroidInfo info;
 		memset(&info, 0x00, sizeof(info));
-		NETQueuedDroidInfo(&info);
+
+		uint32_t templateRef = 0;
+		NETuint32_t(&templateRef);
+		if (templateRef == 0)
+		{
+			NETQueuedDroidInfoTemplate(&info);
+			templates.add(info);
+		}
+		else if (templateRef <= templates.used)
+		{
+			info = templates.templates[templateRef - 1];
+		}
+		else
+		{
+			debug(LOG_ERROR, "Packet from %d refers to unknown order %u", queue.index, templateRef);
+			break;
+		}
 
 		STRUCTURE_STATS *psStats = nullptr;
 		if (info.subType == LocOrder && (info.order == DORDER_BUILD || info.order == DORDER_LINEBUILD))
@@ -634,15 +889,17 @@ bool recvDroidInfo(NETQUEUE queue)
 			}
 		}
 
-		switch (info.subType)
+		bool sameTarget = false;
+		NETbool(&sameTarget);
+		QueuedDroidInfo prevTarget = info;
+		DROID_ORDER_DATA sOrder;
+		if (sameTarget)
 		{
-		case ObjOrder:       syncDebug("Order=%s,%d(%d)", getDroidOrderName(info.order), info.destId, info.destType); break;
-		case LocOrder:       syncDebug("Order=%s,(%d,%d)", getDroidOrderName(info.order), info.pos.x, info.pos.y); break;
-		case SecondaryOrder: syncDebug("SecondaryOrder=%d,%08X", (int)info.secOrder, (int)info.secState); break;
+			NETQueuedDroidInfoTarget(&info, prevTarget);
+			syncDebugDroidInfo(info);
+			sOrder = infoToOrderData(info, psStats);
 		}
 
-		DROID_ORDER_DATA sOrder = infoToOrderData(info, psStats);
-
 		uint32_t num = 0;
 		NETuint32_t(&num);
 
@@ -653,62 +910,15 @@ bool recvDroidInfo(NETQUEUE queue)
 			NETuint32_t(&deltaDroidId);
 			info.droidId += deltaDroidId;
 
-			DROID *psDroid = IdToDroid(info.droidId, info.player);
-			if (!psDroid)
-			{
-				debug(LOG_NEVER, "Packet from %d refers to non-existent droid %u, [%s : p%d]",
-				      queue.index, info.droidId, isHumanPlayer(info.player) ? "Human" : "AI", info.player);
-				syncDebug("Droid %d missing", info.droidId);
-				continue;  // Can't find the droid, so skip this droid.
-			}
-			if (!canGiveOrdersFor(queue.index, psDroid->player))
-			{
-				debug(LOG_WARNING, "Droid order (by %d) for wrong player (%d).", queue.index, psDroid->player);
-				syncDebug("Wrong player.");
-				continue;
-			}
-
-			CHECK_DROID(psDroid);
-
-			syncDebugDroid(psDroid, '<');
-
-			switch (info.subType)
+			if (!sameTarget)
 			{
-			case ObjOrder:
-			case LocOrder:
-				/*
-				* If the current order not is a command order and we are not a
-				* commander yet are in the commander group remove us from it.
-				*/
-				if (hasCommander(psDroid))
-				{
-					psDroid->psGroup->remove(psDroid);
-				}
-
-				if (sOrder.psObj != TargetMissing)  // Only do order if the target didn't die.
-				{
-					if (!info.add)
-					{
-						orderDroidListEraseRange(psDroid, 0, psDroid->listSize + 1);  // Clear all non-pending orders, plus the first pending order (which is probably the order we just received).
-						orderDroidBase(psDroid, &sOrder);  // Execute the order immediately (even if in the middle of another order.
-					}
-					else
-					{
-						orderDroidAdd(psDroid, &sOrder);   // Add the order to the (non-pending) list. Will probably overwrite the corresponding pending order, assuming all pending orders were written to the list.
-					}
-				}
-				break;
-			case SecondaryOrder:
-				// Set the droids secondary order
-				turnOffMultiMsg(true);
-				secondarySetState(psDroid, info.secOrder, info.secState);
-				turnOffMultiMsg(false);
-				break;
+				NETQueuedDroidInfoTarget(&info, prevTarget);
+				prevTarget = info;
+				syncDebugDroidInfo(info);
+				sOrder = infoToOrderData(info, psStats);
 			}
 
-			syncDebugDroid(psDroid, '>');
-
-			CHECK_DROID(psDroid);
+			recvDroidOrder(queue, info, &sOrder);
 		}
 	}
 	NETend();
@@ -46,6 +46,7 @@
 
 #include "lib/gamelib/gtime.h"
 #include "lib/netplay/netplay.h"
+#include "lib/netplay/netreplay.h"
 #include "lib/script/script.h"
 #include "lib/widget/editbox.h"
 #include "lib/widget/button.h"
@@ -81,6 +82,7 @@
 #include "modding.h"
 #include "qtscript.h"
 #include "random.h"
+#include "version.h"
 
 #include "multiplay.h"
 #include "multiint.h"
@@ -2574,6 +2576,29 @@ void addPlayerBox(bool players)
 	}
 }
 
+/// Describe the game being started, so that a replay can be checked against the settings it is played back with.
+static std::string replaySettings()
+{
+	return astringf("%s\n%s\n%s\n%d", version_getVersionString(), wz_skirmish_test().c_str(), game.map, (int)game.maxPlayers);
+}
+
+/// Start recording and/or playing back a replay, if asked to on the command line. Only the host can play back a replay.
+static void startReplay(uint32_t *randomSeed, bool isHost)
+{
+	if (isHost && !wz_replay_file().empty())
+	{
+		std::string settings;
+		if (NETreplayLoadStart(wz_replay_file().c_str(), &settings, randomSeed) && settings != replaySettings())
+		{
+			debug(LOG_ERROR, "Replay was recorded with different settings, expect it to go out of sync:\n%s", settings.c_str());
+		}
+	}
+	if (!wz_record_file().empty())
+	{
+		NETreplaySaveStart(wz_record_file().c_str(), replaySettings(), *randomSeed);
+	}
+}
+
 /*
  * Notify all players of host launching the game
  */
@@ -2581,6 +2606,8 @@ static void SendFireUp()
 {
 	uint32_t randomSeed = rand();  // Pick a random random seed for the synchronised random number generator.
 
+	startReplay(&randomSeed, true);  // A replay brings its own random seed.
+
 	NETbeginEncode(NETbroadcastQueue(), NET_FIREUP);
 	NETuint32_t(&randomSeed);
 	NETend();
@@ -3509,6 +3536,7 @@ void frontendMultiMessages()
 				NETuint32_t(&randomSeed);
 				NETend();
 
+				startReplay(&randomSeed, false);
 				gameSRand(randomSeed);  // Set the seed for the synchronised random number generator, using the seed given by the host.
 
 				debug(LOG_NET, "& local Options Received (MP game)");
@@ -40,6 +40,7 @@
 #include "lib/widget/widget.h"
 #include "lib/gamelib/gtime.h"
 #include "lib/netplay/netplay.h"
+#include "lib/netplay/netreplay.h"
 #include "hci.h"
 #include "configuration.h"			// lobby cfg.
 #include "clparse.h"
@@ -502,6 +503,9 @@ bool multiGameShutdown()
 	{
 		wzYieldCurrentThread();  // TODO Make a wzDelay() function?
 	}
+	NETreplaySaveStop();
+	NETreplayLoadStop();
+
 	// close game
 	NETclose();
 	NETremRedirects();
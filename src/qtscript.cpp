@@ -44,6 +44,7 @@
 #include "lib/framework/file.h"
 #include "lib/gamelib/gtime.h"
 #include "lib/netplay/netplay.h"
+#include "tickprofile.h"
 #include "multiplay.h"
 #include "levels.h"
 #include "map.h"
@@ -175,7 +176,9 @@ static QScriptValue callFunction(QScriptEngine *engine, const QString &function,
 	}
 	QElapsedTimer timer;
 	timer.start();
+	profileEnter(PROFILE_SCRIPTS);
 	QScriptValue result = value.call(QScriptValue(), args);
+	profileLeave();
 	int ticks = timer.nsecsElapsed() / 1000;
 	MONITOR *monitor = monitors.value(engine); // pick right one for this engine
 	MONITOR_BIN m;
@@ -48,6 +48,7 @@
 #include "lib/framework/wzconfig.h"
 #include "lib/netplay/netplay.h"
 
+#include "bucket3d.h"
 #include "difficulty.h"
 #include "multiplay.h"
 #include "objects.h"
@@ -204,6 +205,12 @@ static void fillMainModel(QStandardItemModel &m)
 	KEYVAL("difficultyLevel", difficulty_type.at(getDifficultyLevel()));
 	KEYVAL("loopPieCount", QString::number(loopPieCount));
 	KEYVAL("loopPolyCount", QString::number(loopPolyCount));
+	KEYVAL("loopDrawCount", QString::number(loopDrawCount));
+	KEYVAL("loopStateCount", QString::number(loopStateCount));
+	unsigned bucketDrawn, bucketCulled;
+	bucketGetCounts(&bucketDrawn, &bucketCulled);
+	KEYVAL("bucketDrawn", QString::number(bucketDrawn));
+	KEYVAL("bucketCulled", QString::number(bucketCulled));
 	KEYVAL("allowDesign", B2Q(allowDesign));
 	KEYVAL("includeRedundantDesigns", B2Q(includeRedundantDesigns));
 
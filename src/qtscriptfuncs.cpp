@@ -24,6 +24,7 @@
 
 #include "lib/framework/wzapp.h"
 #include "lib/framework/wzconfig.h"
+#include "lib/framework/file.h"
 #include "lib/framework/fixedpoint.h"
 #include "lib/sound/audio.h"
 #include "lib/netplay/netplay.h"
@@ -36,6 +37,7 @@
 #include <QtGui/QStandardItemModel>
 
 #include "action.h"
+#include "benchmark.h"
 #include "clparse.h"
 #include "combat.h"
 #include "console.h"
@@ -904,7 +906,7 @@ bool loadLabels(const char *filename)
 {
 	int groupidx = -1;
 
-	if (!PHYSFS_exists(filename))
+	if (!fileExists(filename))
 	{
 		debug(LOG_SAVE, "No %s found -- not adding any labels", filename);
 		return false;
@@ -2840,6 +2842,7 @@ static QScriptValue js_gameOverMessage(QScriptContext *context, QScriptEngine *e
 	if (autogame_enabled())
 	{
 		debug(LOG_WARNING, "Autogame completed successfully!");
+		benchmarkFinish();  // The game ended before the benchmark did, report what we have.
 		exit(0);
 	}
 	return QScriptValue();
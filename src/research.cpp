@@ -28,6 +28,7 @@
 #include <QtCore/QJsonArray>
 
 #include "lib/framework/frame.h"
+#include "lib/framework/jsonreader.h"
 #include "lib/framework/wzconfig.h"
 #include "lib/netplay/netplay.h"
 #include "lib/ivis_opengl/imd.h"
@@ -105,7 +106,7 @@ bool researchInitVars()
 /** Load the research stats */
 bool loadResearch(const QString& filename)
 {
-	WzConfig ini(filename, WzConfig::ReadOnlyAndRequired);
+	JsonReader ini(filename);
 	QStringList list = ini.childGroups();
 	PLAYER_RESEARCH dummy;
 	memset(&dummy, 0, sizeof(dummy));
@@ -122,7 +123,7 @@ bool loadResearch(const QString& filename)
 		ini.beginGroup(list[inc]);
 		RESEARCH research;
 		research.index = inc;
-		research.name = ini.value("name").toString();
+		research.name = ini.value(JSON_KEY("name")).toString();
 		research.id = list[inc];
 
 		//check the name hasn't been used already
@@ -130,10 +131,10 @@ bool loadResearch(const QString& filename)
 
 		research.ref = REF_RESEARCH_START + inc;
 
-		research.results = ini.json("results", QJsonArray());
+		research.results = ini.json(JSON_KEY("results"), QJsonArray());
 
 		//set subGroup icon
-		QString subGroup = ini.value("subgroupIconID", "").toString();
+		QString subGroup = ini.value(JSON_KEY("subgroupIconID"), "").toString();
 		if (subGroup.compare("") != 0)
 		{
 			research.subGroup = setIconID(subGroup.toUtf8().data(), getName(&research));
@@ -144,11 +145,11 @@ bool loadResearch(const QString& filename)
 		}
 
 		//set key topic
-		unsigned int keyTopic = ini.value("keyTopic", 0).toUInt();
+		unsigned int keyTopic = ini.value(JSON_KEY("keyTopic"), 0).toUInt();
 		ASSERT(keyTopic <= 1, "Invalid keyTopic for research topic - '%s' ", getName(&research));
 		if (keyTopic <= 1)
 		{
-			research.keyTopic = ini.value("keyTopic", 0).toUInt();
+			research.keyTopic = ini.value(JSON_KEY("keyTopic"), 0).toUInt();
 		}
 		else
 		{
@@ -156,7 +157,7 @@ bool loadResearch(const QString& filename)
 		}
 
 		//set tech code
-		UBYTE techCode = ini.value("techCode", 0).toUInt();
+		UBYTE techCode = ini.value(JSON_KEY("techCode"), 0).toUInt();
 		ASSERT(techCode <= 1, "Invalid tech code for research topic - '%s' ", getName(&research));
 		if (techCode == 0)
 		{
@@ -168,7 +169,7 @@ bool loadResearch(const QString& filename)
 		}
 
 		//set the iconID
-		QString iconID = ini.value("iconID", "").toString();
+		QString iconID = ini.value(JSON_KEY("iconID"), "").toString();
 		if (iconID.compare("") != 0)
 		{
 			research.iconID = setIconID(iconID.toUtf8().data(), getName(&research));
@@ -179,7 +180,7 @@ bool loadResearch(const QString& filename)
 		}
 
 		//get the IMDs used in the interface
-		QString statID = ini.value("statID", "").toString();
+		QString statID = ini.value(JSON_KEY("statID"), "").toString();
 		research.psStat = nullptr;
 		if (statID.compare("") != 0)
 		{
@@ -188,21 +189,21 @@ bool loadResearch(const QString& filename)
 			ASSERT_OR_RETURN(false, research.psStat, "Could not find stats for %s research %s", statID.toUtf8().constData(), getName(&research));
 		}
 
-		QString imdName = ini.value("imdName", "").toString();
+		QString imdName = ini.value(JSON_KEY("imdName"), "").toString();
 		if (imdName.compare("") != 0)
 		{
 			research.pIMD = modelGet(imdName);
 			ASSERT(research.pIMD != nullptr, "Cannot find the research PIE '%s' for record '%s'", imdName.toUtf8().data(), getName(&research));
 		}
 
-		QString imdName2 = ini.value("imdName2", "").toString();
+		QString imdName2 = ini.value(JSON_KEY("imdName2"), "").toString();
 		if (imdName2.compare("") != 0)
 		{
 			research.pIMD2 = modelGet(imdName2);
 			ASSERT(research.pIMD2 != nullptr, "Cannot find the 2nd research '%s' PIE for record '%s'", imdName2.toUtf8().data(), getName(&research));
 		}
 
-		QString msgName = ini.value("msgName", "").toString();
+		QString msgName = ini.value(JSON_KEY("msgName"), "").toString();
 		if (msgName.compare("") != 0)
 		{
 			//check its a major tech code
@@ -214,20 +215,20 @@ bool loadResearch(const QString& filename)
 		}
 
 		//set the researchPoints
-		unsigned int resPoints = ini.value("researchPoints", 0).toUInt();
+		unsigned int resPoints = ini.value(JSON_KEY("researchPoints"), 0).toUInt();
 		ASSERT_OR_RETURN(false, resPoints <= UWORD_MAX, "Research Points too high for research topic - '%s' ", getName(&research));
 		research.researchPoints = resPoints;
 
 		//set the research power
-		unsigned int resPower = ini.value("researchPower", 0).toUInt();
+		unsigned int resPower = ini.value(JSON_KEY("researchPower"), 0).toUInt();
 		ASSERT_OR_RETURN(false, resPower <= UWORD_MAX, "Research Power too high for research topic - '%s' ", getName(&research));
 		research.researchPower = resPower;
 
 		//rememeber research pre-requisites for futher checking
-		preResearch[inc] = ini.value("requiredResearch").toStringList();
+		preResearch[inc] = ini.value(JSON_KEY("requiredResearch")).toStringList();
 
 		//set components results
-		QStringList compResults = ini.value("resultComponents").toStringList();
+		QStringList compResults = ini.value(JSON_KEY("resultComponents")).toStringList();
 		for (int j = 0; j < compResults.size(); j++)
 		{
 			QString compID = compResults[j].trimmed();
@@ -243,7 +244,7 @@ bool loadResearch(const QString& filename)
 		}
 
 		//set replaced components
-		QStringList replacedComp = ini.value("replacedComponents").toStringList();
+		QStringList replacedComp = ini.value(JSON_KEY("replacedComponents")).toStringList();
 		for (int j = 0; j < replacedComp.size(); j++)
 		{
 			//read pair of components oldComponent:newComponent
@@ -274,7 +275,7 @@ bool loadResearch(const QString& filename)
 		}
 
 		//set redundant components
-		QStringList redComp = ini.value("redComponents").toStringList();
+		QStringList redComp = ini.value(JSON_KEY("redComponents")).toStringList();
 		for (int j = 0; j < redComp.size(); j++)
 		{
 			QString compID = redComp[j].trimmed();
@@ -290,7 +291,7 @@ bool loadResearch(const QString& filename)
 		}
 
 		//set result structures
-		QStringList resStruct = ini.value("resultStructures").toStringList();
+		QStringList resStruct = ini.value(JSON_KEY("resultStructures")).toStringList();
 		for (int j = 0; j < resStruct.size(); j++)
 		{
 			QString strucID = resStruct[j].trimmed();
@@ -303,7 +304,7 @@ bool loadResearch(const QString& filename)
 		}
 
 		//set required structures
-		QStringList reqStruct = ini.value("requiredStructures").toStringList();
+		QStringList reqStruct = ini.value(JSON_KEY("requiredStructures")).toStringList();
 		for (int j = 0; j < reqStruct.size(); j++)
 		{
 			QString strucID = reqStruct[j].trimmed();
@@ -316,7 +317,7 @@ bool loadResearch(const QString& filename)
 		}
 
 		//set redundant structures
-		QStringList redStruct = ini.value("redStructures").toStringList();
+		QStringList redStruct = ini.value(JSON_KEY("redStructures")).toStringList();
 		for (int j = 0; j < redStruct.size(); j++)
 		{
 			QString strucID = redStruct[j].trimmed();
@@ -256,21 +256,20 @@ bool statsAllocConstruct(UDWORD	numStats)
 *		Load stats functions
 *******************************************************************************/
 
-static iIMDShape *statsGetIMD(WzConfig &json, BASE_STATS *psStats, const QString& key, const QString& key2 = QString())
+static iIMDShape *statsGetIMD(JsonReader &json, BASE_STATS *psStats, const JsonKey &key, const JsonKey *key2 = nullptr)
 {
 	iIMDShape *retval = nullptr;
-	if (json.contains(key))
+	JsonValue value = json.value(key);
+	if (!value.isUndefined())
 	{
-		QJsonValue value = json.json(key);
 		if (value.isObject())
 		{
-			ASSERT(!key2.isEmpty(), "Cannot look up a JSON object with an empty key!");
-			QJsonObject obj = value.toObject();
-			if (!obj.contains(key2))
+			ASSERT_OR_RETURN(nullptr, key2 != nullptr, "Cannot look up a JSON object with an empty key!");
+			value = value.member(*key2);
+			if (value.isUndefined())
 			{
 				return nullptr;
 			}
-			value = obj[key2];
 		}
 		retval = modelGet(value.toString());
 		ASSERT(retval != nullptr, "Cannot find the PIE model %s for stat %s in %s",
@@ -279,26 +278,26 @@ static iIMDShape *statsGetIMD(WzConfig &json, BASE_STATS *psStats, const QString
 	return retval;
 }
 
-void loadStats(WzConfig &json, BASE_STATS *psStats, int index)
+void loadStats(JsonReader &json, BASE_STATS *psStats, int index)
 {
 	psStats->id = json.group();
-	psStats->name = json.value("name").toString();
+	psStats->name = json.value(JSON_KEY("name")).toString();
 	psStats->index = index;
 	ASSERT(!lookupStatPtr.contains(psStats->id), "Duplicate ID found! (%s)", psStats->id.toUtf8().constData());
 	lookupStatPtr.insert(psStats->id, psStats);
 }
 
-static void loadCompStats(WzConfig &json, COMPONENT_STATS *psStats, int index)
+static void loadCompStats(JsonReader &json, COMPONENT_STATS *psStats, int index)
 {
 	loadStats(json, psStats, index);
-	psStats->buildPower = json.value("buildPower", 0).toUInt();
-	psStats->buildPoints = json.value("buildPoints", 0).toUInt();
-	psStats->designable = json.value("designable", false).toBool();
-	psStats->weight = json.value("weight", 0).toUInt();
-	psStats->pBase->hitpoints = json.value("hitpoints", 0).toUInt();
-	psStats->pBase->hitpointPct = json.value("hitpointPct", 100).toUInt();
-
-	QString dtype = json.value("droidType", "DROID").toString();
+	psStats->buildPower = json.value(JSON_KEY("buildPower"), 0).toUInt();
+	psStats->buildPoints = json.value(JSON_KEY("buildPoints"), 0).toUInt();
+	psStats->designable = json.value(JSON_KEY("designable"), false).toBool();
+	psStats->weight = json.value(JSON_KEY("weight"), 0).toUInt();
+	psStats->pBase->hitpoints = json.value(JSON_KEY("hitpoints"), 0).toUInt();
+	psStats->pBase->hitpointPct = json.value(JSON_KEY("hitpointPct"), 100).toUInt();
+
+	QString dtype = json.value(JSON_KEY("droidType"), "DROID").toString();
 	psStats->droidTypeOverride = DROID_ANY;
 	if (dtype.compare("PERSON") == 0)
 	{
@@ -353,7 +352,7 @@ static void loadCompStats(WzConfig &json, COMPONENT_STATS *psStats, int index)
 /*Load the weapon stats from the file exported from Access*/
 bool loadWeaponStats(const char *pFileName)
 {
-	WzConfig ini(pFileName, WzConfig::ReadOnlyAndRequired);
+	JsonReader ini(pFileName);
 	QStringList list = ini.childGroups();
 	statsAllocWeapons(list.size());
 	// Hack to make sure ZNULLWEAPON is always first in list
@@ -369,21 +368,21 @@ bool loadWeaponStats(const char *pFileName)
 		loadCompStats(ini, psStats, i);
 		psStats->compType = COMP_WEAPON;
 
-		psStats->radiusLife = ini.value("radiusLife", 0).toUInt();
-
-		psStats->base.maxRange = ini.value("longRange").toUInt();
-		psStats->base.minRange = ini.value("minRange", 0).toUInt();
-		psStats->base.hitChance = ini.value("longHit", 100).toUInt();
-		psStats->base.firePause = ini.value("firePause").toUInt();
-		psStats->base.numRounds = ini.value("numRounds").toUInt();
-		psStats->base.reloadTime = ini.value("reloadTime").toUInt();
-		psStats->base.damage = ini.value("damage").toUInt();
-		psStats->base.minimumDamage = ini.value("minimumDamage", 0).toInt();
-		psStats->base.radius = ini.value("radius", 0).toUInt();
-		psStats->base.radiusDamage = ini.value("radiusDamage", 0).toUInt();
-		psStats->base.periodicalDamageTime = ini.value("periodicalDamageTime", 0).toUInt();
-		psStats->base.periodicalDamage = ini.value("periodicalDamage", 0).toUInt();
-		psStats->base.periodicalDamageRadius = ini.value("periodicalDamageRadius", 0).toUInt();
+		psStats->radiusLife = ini.value(JSON_KEY("radiusLife"), 0).toUInt();
+
+		psStats->base.maxRange = ini.value(JSON_KEY("longRange")).toUInt();
+		psStats->base.minRange = ini.value(JSON_KEY("minRange"), 0).toUInt();
+		psStats->base.hitChance = ini.value(JSON_KEY("longHit"), 100).toUInt();
+		psStats->base.firePause = ini.value(JSON_KEY("firePause")).toUInt();
+		psStats->base.numRounds = ini.value(JSON_KEY("numRounds")).toUInt();
+		psStats->base.reloadTime = ini.value(JSON_KEY("reloadTime")).toUInt();
+		psStats->base.damage = ini.value(JSON_KEY("damage")).toUInt();
+		psStats->base.minimumDamage = ini.value(JSON_KEY("minimumDamage"), 0).toInt();
+		psStats->base.radius = ini.value(JSON_KEY("radius"), 0).toUInt();
+		psStats->base.radiusDamage = ini.value(JSON_KEY("radiusDamage"), 0).toUInt();
+		psStats->base.periodicalDamageTime = ini.value(JSON_KEY("periodicalDamageTime"), 0).toUInt();
+		psStats->base.periodicalDamage = ini.value(JSON_KEY("periodicalDamage"), 0).toUInt();
+		psStats->base.periodicalDamageRadius = ini.value(JSON_KEY("periodicalDamageRadius"), 0).toUInt();
 		// multiply time stats
 		psStats->base.firePause *= WEAPON_TIME;
 		psStats->base.periodicalDamageTime *= WEAPON_TIME;
@@ -395,18 +394,18 @@ bool loadWeaponStats(const char *pFileName)
 			psStats->upgrade[j] = psStats->base;
 		}
 
-		psStats->numExplosions = ini.value("numExplosions").toUInt();
-		psStats->flightSpeed = ini.value("flightSpeed", 1).toUInt();
-		psStats->rotate = ini.value("rotate").toUInt();
-		psStats->minElevation = ini.value("minElevation").toInt();
-		psStats->maxElevation = ini.value("maxElevation").toInt();
-		psStats->recoilValue = ini.value("recoilValue").toUInt();
-		psStats->effectSize = ini.value("effectSize").toUInt();
-		flags = ini.value("flags", 0).toStringList();
-		psStats->vtolAttackRuns = ini.value("numAttackRuns", 0).toUInt();
-		psStats->penetrate = ini.value("penetrate", false).toBool();
+		psStats->numExplosions = ini.value(JSON_KEY("numExplosions")).toUInt();
+		psStats->flightSpeed = ini.value(JSON_KEY("flightSpeed"), 1).toUInt();
+		psStats->rotate = ini.value(JSON_KEY("rotate")).toUInt();
+		psStats->minElevation = ini.value(JSON_KEY("minElevation")).toInt();
+		psStats->maxElevation = ini.value(JSON_KEY("maxElevation")).toInt();
+		psStats->recoilValue = ini.value(JSON_KEY("recoilValue")).toUInt();
+		psStats->effectSize = ini.value(JSON_KEY("effectSize")).toUInt();
+		flags = ini.value(JSON_KEY("flags"), 0).toStringList();
+		psStats->vtolAttackRuns = ini.value(JSON_KEY("numAttackRuns"), 0).toUInt();
+		psStats->penetrate = ini.value(JSON_KEY("penetrate"), false).toBool();
 		// weapon size limitation
-		int weaponSize = ini.value("weaponSize", WEAPON_SIZE_ANY).toInt();
+		int weaponSize = ini.value(JSON_KEY("weaponSize"), WEAPON_SIZE_ANY).toInt();
 		ASSERT(weaponSize <= WEAPON_SIZE_ANY, "Bad weapon size for %s", list[i].toUtf8().constData());
 		psStats->weaponSize = (WEAPON_SIZE)weaponSize;
 
@@ -415,28 +414,28 @@ bool loadWeaponStats(const char *pFileName)
 		psStats->ref = REF_WEAPON_START + i;
 
 		//get the IMD for the component
-		psStats->pIMD = statsGetIMD(ini, psStats, "model");
-		psStats->pMountGraphic = statsGetIMD(ini, psStats, "mountModel");
+		psStats->pIMD = statsGetIMD(ini, psStats, JSON_KEY("model"));
+		psStats->pMountGraphic = statsGetIMD(ini, psStats, JSON_KEY("mountModel"));
 		if (GetGameMode() == GS_NORMAL)
 		{
-			psStats->pMuzzleGraphic = statsGetIMD(ini, psStats, "muzzleGfx");
-			psStats->pInFlightGraphic = statsGetIMD(ini, psStats, "flightGfx");
-			psStats->pTargetHitGraphic = statsGetIMD(ini, psStats, "hitGfx");
-			psStats->pTargetMissGraphic = statsGetIMD(ini, psStats, "missGfx");
-			psStats->pWaterHitGraphic = statsGetIMD(ini, psStats, "waterGfx");
-			psStats->pTrailGraphic = statsGetIMD(ini, psStats, "trailGfx");
+			psStats->pMuzzleGraphic = statsGetIMD(ini, psStats, JSON_KEY("muzzleGfx"));
+			psStats->pInFlightGraphic = statsGetIMD(ini, psStats, JSON_KEY("flightGfx"));
+			psStats->pTargetHitGraphic = statsGetIMD(ini, psStats, JSON_KEY("hitGfx"));
+			psStats->pTargetMissGraphic = statsGetIMD(ini, psStats, JSON_KEY("missGfx"));
+			psStats->pWaterHitGraphic = statsGetIMD(ini, psStats, JSON_KEY("waterGfx"));
+			psStats->pTrailGraphic = statsGetIMD(ini, psStats, JSON_KEY("trailGfx"));
 		}
-		psStats->fireOnMove = ini.value("fireOnMove", true).toBool();
+		psStats->fireOnMove = ini.value(JSON_KEY("fireOnMove"), true).toBool();
 
 		//set the weapon class
-		if (!getWeaponClass(ini.value("weaponClass").toString(), &psStats->weaponClass))
+		if (!getWeaponClass(ini.value(JSON_KEY("weaponClass")).toString(), &psStats->weaponClass))
 		{
 			debug(LOG_ERROR, "Invalid weapon class for weapon %s - assuming KINETIC", getName(psStats));
 			psStats->weaponClass = WC_KINETIC;
 		}
 
 		//set the subClass
-		if (!getWeaponSubClass(ini.value("weaponSubClass").toString().toUtf8().data(), &psStats->weaponSubClass))
+		if (!getWeaponSubClass(ini.value(JSON_KEY("weaponSubClass")).toString().toUtf8().data(), &psStats->weaponSubClass))
 		{
 			return false;
 		}
@@ -456,14 +455,14 @@ bool loadWeaponStats(const char *pFileName)
 		}
 
 		//set the weapon effect
-		if (!getWeaponEffect(ini.value("weaponEffect").toString().toUtf8().constData(), &psStats->weaponEffect))
+		if (!getWeaponEffect(ini.value(JSON_KEY("weaponEffect")).toString().toUtf8().constData(), &psStats->weaponEffect))
 		{
 			debug(LOG_FATAL, "loadWepaonStats: Invalid weapon effect for weapon %s", getName(psStats));
 			return false;
 		}
 
 		//set periodical damage weapon class
-		QString periodicalDamageWeaponClass = ini.value("periodicalDamageWeaponClass", "").toString();
+		QString periodicalDamageWeaponClass = ini.value(JSON_KEY("periodicalDamageWeaponClass"), "").toString();
 		if (periodicalDamageWeaponClass.compare("") == 0)
 		{
 			//was not setted in ini - use default value
@@ -476,7 +475,7 @@ bool loadWeaponStats(const char *pFileName)
 		}
 
 		//set periodical damage weapon subclass
-		QString periodicalDamageWeaponSubClass = ini.value("periodicalDamageWeaponSubClass", "").toString();
+		QString periodicalDamageWeaponSubClass = ini.value(JSON_KEY("periodicalDamageWeaponSubClass"), "").toString();
 		if (periodicalDamageWeaponSubClass.compare("") == 0)
 		{
 			//was not setted in ini - use default value
@@ -489,7 +488,7 @@ bool loadWeaponStats(const char *pFileName)
 		}
 
 		//set periodical damage weapon effect
-		QString periodicalDamageWeaponEffect = ini.value("periodicalDamageWeaponEffect", "").toString();
+		QString periodicalDamageWeaponEffect = ini.value(JSON_KEY("periodicalDamageWeaponEffect"), "").toString();
 		if (periodicalDamageWeaponEffect.compare("") == 0)
 		{
 			//was not setted in ini - use default value
@@ -502,19 +501,19 @@ bool loadWeaponStats(const char *pFileName)
 		}
 
 		//set the movement model
-		if (!getMovementModel(ini.value("movement").toString().toUtf8().constData(), &psStats->movementModel))
+		if (!getMovementModel(ini.value(JSON_KEY("movement")).toString().toUtf8().constData(), &psStats->movementModel))
 		{
 			return false;
 		}
 
 		// set the face Player value
-		psStats->facePlayer = ini.value("facePlayer", false).toBool();
+		psStats->facePlayer = ini.value(JSON_KEY("facePlayer"), false).toBool();
 
 		// set the In flight face Player value
-		psStats->faceInFlight = ini.value("faceInFlight", false).toBool();
+		psStats->faceInFlight = ini.value(JSON_KEY("faceInFlight"), false).toBool();
 
 		//set the light world value
-		psStats->lightWorld = ini.value("lightWorld", false).toBool();
+		psStats->lightWorld = ini.value(JSON_KEY("lightWorld"), false).toBool();
 
 		// interpret flags
 		psStats->surfaceToAir = SHOOT_ON_GROUND; // default
@@ -533,8 +532,8 @@ bool loadWeaponStats(const char *pFileName)
 
 		// load sounds
 		int weaponSoundID, explosionSoundID;
-		QString szWeaponWav = ini.value("weaponWav", "-1").toString();
-		QString szExplosionWav = ini.value("explosionWav", "-1").toString();
+		QString szWeaponWav = ini.value(JSON_KEY("weaponWav"), "-1").toString();
+		QString szExplosionWav = ini.value(JSON_KEY("explosionWav"), "-1").toString();
 		bool result = statsGetAudioIDFromString(list[i], szWeaponWav, &weaponSoundID);
 		ASSERT_OR_RETURN(false, result, "Weapon sound %s not found for %s", szWeaponWav.toUtf8().constData(), getName(psStats));
 		result = statsGetAudioIDFromString(list[i], szExplosionWav, &explosionSoundID);
@@ -559,7 +558,7 @@ bool loadWeaponStats(const char *pFileName)
 
 bool loadBodyStats(const char *pFileName)
 {
-	WzConfig ini(pFileName, WzConfig::ReadOnlyAndRequired);
+	JsonReader ini(pFileName);
 	QStringList list = ini.childGroups();
 	statsAllocBody(list.size());
 	// Hack to make sure ZNULLBODY is always first in list
@@ -574,23 +573,23 @@ bool loadBodyStats(const char *pFileName)
 		loadCompStats(ini, psStats, i);
 		psStats->compType = COMP_BODY;
 
-		psStats->weaponSlots = ini.value("weaponSlots").toInt();
-		psStats->bodyClass = ini.value("class").toString();
-		psStats->base.thermal = ini.value("armourHeat").toInt();
-		psStats->base.armour = ini.value("armourKinetic").toInt();
-		psStats->base.power = ini.value("powerOutput").toInt();
-		psStats->base.resistance = ini.value("resistance", 30).toInt();
+		psStats->weaponSlots = ini.value(JSON_KEY("weaponSlots")).toInt();
+		psStats->bodyClass = ini.value(JSON_KEY("class")).toString();
+		psStats->base.thermal = ini.value(JSON_KEY("armourHeat")).toInt();
+		psStats->base.armour = ini.value(JSON_KEY("armourKinetic")).toInt();
+		psStats->base.power = ini.value(JSON_KEY("powerOutput")).toInt();
+		psStats->base.resistance = ini.value(JSON_KEY("resistance"), 30).toInt();
 		for (int j = 0; j < MAX_PLAYERS; j++)
 		{
 			psStats->upgrade[j] = psStats->base;
 		}
 		psStats->ref = REF_BODY_START + i;
-		if (!getBodySize(ini.value("size").toString().toUtf8().constData(), &psStats->size))
+		if (!getBodySize(ini.value(JSON_KEY("size")).toString().toUtf8().constData(), &psStats->size))
 		{
 			ASSERT(false, "Unknown body size for %s", getName(psStats));
 			return false;
 		}
-		psStats->pIMD = statsGetIMD(ini, psStats, "model");
+		psStats->pIMD = statsGetIMD(ini, psStats, JSON_KEY("model"));
 
 		ini.endGroup();
 
@@ -623,12 +622,12 @@ bool loadBodyStats(const char *pFileName)
 		int numStats;
 
 		ini.beginGroup(list[i]);
-		if (!ini.contains("propulsionExtraModels"))
+		if (!ini.contains(JSON_KEY("propulsionExtraModels")))
 		{
 			ini.endGroup();
 			continue;
 		}
-		ini.beginGroup("propulsionExtraModels");
+		ini.beginGroup(JSON_KEY("propulsionExtraModels"));
 		//get the body stats
 		for (numStats = 0; numStats < numBodyStats; ++numStats)
 		{
@@ -660,10 +659,11 @@ bool loadBodyStats(const char *pFileName)
 				return false;
 			}
 			//allocate the left and right propulsion IMDs + movement and standing still animations
-			psBodyStat->ppIMDList[numStats * NUM_PROP_SIDES + LEFT_PROP] = statsGetIMD(ini, psBodyStat, keys[j], "left");
-			psBodyStat->ppIMDList[numStats * NUM_PROP_SIDES + RIGHT_PROP] = statsGetIMD(ini, psBodyStat, keys[j], "right");
-			psBodyStat->ppMoveIMDList[numStats] = statsGetIMD(ini, psBodyStat, keys[j], "moving");
-			psBodyStat->ppStillIMDList[numStats] = statsGetIMD(ini, psBodyStat, keys[j], "still");
+			const JsonKey key(keys[j]);
+			psBodyStat->ppIMDList[numStats * NUM_PROP_SIDES + LEFT_PROP] = statsGetIMD(ini, psBodyStat, key, &JSON_KEY("left"));
+			psBodyStat->ppIMDList[numStats * NUM_PROP_SIDES + RIGHT_PROP] = statsGetIMD(ini, psBodyStat, key, &JSON_KEY("right"));
+			psBodyStat->ppMoveIMDList[numStats] = statsGetIMD(ini, psBodyStat, key, &JSON_KEY("moving"));
+			psBodyStat->ppStillIMDList[numStats] = statsGetIMD(ini, psBodyStat, key, &JSON_KEY("still"));
 		}
 		ini.endGroup();
 		ini.endGroup();
@@ -675,7 +675,7 @@ bool loadBodyStats(const char *pFileName)
 /*Load the Brain stats from the file exported from Access*/
 bool loadBrainStats(const char *pFileName)
 {
-	WzConfig ini(pFileName, WzConfig::ReadOnlyAndRequired);
+	JsonReader ini(pFileName);
 	QStringList list = ini.childGroups();
 	statsAllocBrain(list.size());
 	// Hack to make sure ZNULLBRAIN is always first in list
@@ -690,16 +690,14 @@ bool loadBrainStats(const char *pFileName)
 		loadCompStats(ini, psStats, i);
 		psStats->compType = COMP_BRAIN;
 
-		psStats->weight = ini.value("weight", 0).toInt();
-		psStats->base.maxDroids = ini.value("maxDroids").toInt();
-		psStats->base.maxDroidsMult = ini.value("maxDroidsMult").toInt();
-		QVariant rankNames = ini.value("ranks");
-		for (const QVariant &v : rankNames.toList())
+		psStats->weight = ini.value(JSON_KEY("weight"), 0).toInt();
+		psStats->base.maxDroids = ini.value(JSON_KEY("maxDroids")).toInt();
+		psStats->base.maxDroidsMult = ini.value(JSON_KEY("maxDroidsMult")).toInt();
+		for (const JsonValue &v : ini.value(JSON_KEY("ranks")).toList())
 		{
 			psStats->rankNames.push_back(v.toString().toStdString());
 		}
-		QVariant rankThresholds = ini.value("thresholds");
-		for (const QVariant &v : rankThresholds.toList())
+		for (const JsonValue &v : ini.value(JSON_KEY("thresholds")).toList())
 		{
 			psStats->base.rankThresholds.push_back(v.toInt());
 		}
@@ -712,13 +710,13 @@ bool loadBrainStats(const char *pFileName)
 
 		// check weapon attached
 		psStats->psWeaponStat = nullptr;
-		if (ini.contains("turret"))
+		if (ini.contains(JSON_KEY("turret")))
 		{
-			int weapon = getCompFromName(COMP_WEAPON, ini.value("turret").toString());
+			int weapon = getCompFromName(COMP_WEAPON, ini.value(JSON_KEY("turret")).toString());
 			ASSERT_OR_RETURN(false, weapon >= 0, "Unable to find weapon for brain %s", getName(psStats));
 			psStats->psWeaponStat = asWeaponStats + weapon;
 		}
-		psStats->designable = ini.value("designable", false).toBool();
+		psStats->designable = ini.value(JSON_KEY("designable"), false).toBool();
 		ini.endGroup();
 	}
 	return true;
@@ -768,7 +766,7 @@ bool getPropulsionType(const char *typeName, PROPULSION_TYPE *type)
 /*Load the Propulsion stats from the file exported from Access*/
 bool loadPropulsionStats(const char *pFileName)
 {
-	WzConfig ini(pFileName, WzConfig::ReadOnlyAndRequired);
+	JsonReader ini(pFileName);
 	QStringList list = ini.childGroups();
 	statsAllocPropulsion(list.size());
 	// Hack to make sure ZNULLPROP is always first in list
@@ -783,22 +781,22 @@ bool loadPropulsionStats(const char *pFileName)
 		loadCompStats(ini, psStats, i);
 		psStats->compType = COMP_PROPULSION;
 
-		psStats->base.hitpointPctOfBody = ini.value("hitpointPctOfBody", 0).toInt();
-		psStats->maxSpeed = ini.value("speed").toInt();
+		psStats->base.hitpointPctOfBody = ini.value(JSON_KEY("hitpointPctOfBody"), 0).toInt();
+		psStats->maxSpeed = ini.value(JSON_KEY("speed")).toInt();
 		psStats->ref = REF_PROPULSION_START + i;
-		psStats->turnSpeed = ini.value("turnSpeed", DEG(1) / 3).toInt();
-		psStats->spinSpeed = ini.value("spinSpeed", DEG(3) / 4).toInt();
-		psStats->spinAngle = ini.value("spinAngle", 180).toInt();
-		psStats->acceleration = ini.value("acceleration", 250).toInt();
-		psStats->deceleration = ini.value("deceleration", 800).toInt();
-		psStats->skidDeceleration = ini.value("skidDeceleration", 600).toInt();
+		psStats->turnSpeed = ini.value(JSON_KEY("turnSpeed"), DEG(1) / 3).toInt();
+		psStats->spinSpeed = ini.value(JSON_KEY("spinSpeed"), DEG(3) / 4).toInt();
+		psStats->spinAngle = ini.value(JSON_KEY("spinAngle"), 180).toInt();
+		psStats->acceleration = ini.value(JSON_KEY("acceleration"), 250).toInt();
+		psStats->deceleration = ini.value(JSON_KEY("deceleration"), 800).toInt();
+		psStats->skidDeceleration = ini.value(JSON_KEY("skidDeceleration"), 600).toInt();
 		psStats->pIMD = nullptr;
-		psStats->pIMD = statsGetIMD(ini, psStats, "model");
+		psStats->pIMD = statsGetIMD(ini, psStats, JSON_KEY("model"));
 		for (int j = 0; j < MAX_PLAYERS; j++)
 		{
 			psStats->upgrade[j] = psStats->base;
 		}
-		if (!getPropulsionType(ini.value("type").toString().toUtf8().constData(), &psStats->propulsionType))
+		if (!getPropulsionType(ini.value(JSON_KEY("type")).toString().toUtf8().constData(), &psStats->propulsionType))
 		{
 			debug(LOG_FATAL, "loadPropulsionStats: Invalid Propulsion type for %s", getName(psStats));
 			return false;
@@ -840,7 +838,7 @@ bool loadPropulsionStats(const char *pFileName)
 /*Load the Sensor stats from the file exported from Access*/
 bool loadSensorStats(const char *pFileName)
 {
-	WzConfig ini(pFileName, WzConfig::ReadOnlyAndRequired);
+	JsonReader ini(pFileName);
 	QStringList list = ini.childGroups();
 	statsAllocSensor(list.size());
 	// Hack to make sure ZNULLSENSOR is always first in list
@@ -855,7 +853,7 @@ bool loadSensorStats(const char *pFileName)
 		loadCompStats(ini, psStats, i);
 		psStats->compType = COMP_SENSOR;
 
-		psStats->base.range = ini.value("range").toInt();
+		psStats->base.range = ini.value(JSON_KEY("range")).toInt();
 		for (int j = 0; j < MAX_PLAYERS; j++)
 		{
 			psStats->upgrade[j] = psStats->base;
@@ -863,7 +861,7 @@ bool loadSensorStats(const char *pFileName)
 
 		psStats->ref = REF_SENSOR_START + i;
 
-		QString location = ini.value("location").toString();
+		QString location = ini.value(JSON_KEY("location")).toString();
 		if (location.compare("DEFAULT") == 0)
 		{
 			psStats->location = LOC_DEFAULT;
@@ -876,7 +874,7 @@ bool loadSensorStats(const char *pFileName)
 		{
 			ASSERT(false, "Invalid Sensor location");
 		}
-		QString type = ini.value("type").toString();
+		QString type = ini.value(JSON_KEY("type")).toString();
 		if (type.compare("STANDARD") == 0)
 		{
 			psStats->type = STANDARD_SENSOR;
@@ -907,8 +905,8 @@ bool loadSensorStats(const char *pFileName)
 		}
 
 		//get the IMD for the component
-		psStats->pIMD = statsGetIMD(ini, psStats, "sensorModel");
-		psStats->pMountGraphic = statsGetIMD(ini, psStats, "mountModel");
+		psStats->pIMD = statsGetIMD(ini, psStats, JSON_KEY("sensorModel"));
+		psStats->pMountGraphic = statsGetIMD(ini, psStats, JSON_KEY("mountModel"));
 
 		ini.endGroup();
 
@@ -926,7 +924,7 @@ bool loadSensorStats(const char *pFileName)
 /*Load the ECM stats from the file exported from Access*/
 bool loadECMStats(const char *pFileName)
 {
-	WzConfig ini(pFileName, WzConfig::ReadOnlyAndRequired);
+	JsonReader ini(pFileName);
 	QStringList list = ini.childGroups();
 	statsAllocECM(list.size());
 	// Hack to make sure ZNULLECM is always first in list
@@ -941,7 +939,7 @@ bool loadECMStats(const char *pFileName)
 		loadCompStats(ini, psStats, i);
 		psStats->compType = COMP_ECM;
 
-		psStats->base.range = ini.value("range").toInt();
+		psStats->base.range = ini.value(JSON_KEY("range")).toInt();
 		for (int j = 0; j < MAX_PLAYERS; j++)
 		{
 			psStats->upgrade[j] = psStats->base;
@@ -949,7 +947,7 @@ bool loadECMStats(const char *pFileName)
 
 		psStats->ref = REF_ECM_START + i;
 
-		QString location = ini.value("location").toString();
+		QString location = ini.value(JSON_KEY("location")).toString();
 		if (location.compare("DEFAULT") == 0)
 		{
 			psStats->location = LOC_DEFAULT;
@@ -964,8 +962,8 @@ bool loadECMStats(const char *pFileName)
 		}
 
 		//get the IMD for the component
-		psStats->pIMD = statsGetIMD(ini, psStats, "sensorModel");
-		psStats->pMountGraphic = statsGetIMD(ini, psStats, "mountModel");
+		psStats->pIMD = statsGetIMD(ini, psStats, JSON_KEY("sensorModel"));
+		psStats->pMountGraphic = statsGetIMD(ini, psStats, JSON_KEY("mountModel"));
 
 		ini.endGroup();
 
@@ -982,7 +980,7 @@ bool loadECMStats(const char *pFileName)
 /*Load the Repair stats from the file exported from Access*/
 bool loadRepairStats(const char *pFileName)
 {
-	WzConfig ini(pFileName, WzConfig::ReadOnlyAndRequired);
+	JsonReader ini(pFileName);
 	QStringList list = ini.childGroups();
 	statsAllocRepair(list.size());
 	// Hack to make sure ZNULLREPAIR is always first in list
@@ -997,16 +995,16 @@ bool loadRepairStats(const char *pFileName)
 		loadCompStats(ini, psStats, i);
 		psStats->compType = COMP_REPAIRUNIT;
 
-		psStats->base.repairPoints = ini.value("repairPoints").toInt();
+		psStats->base.repairPoints = ini.value(JSON_KEY("repairPoints")).toInt();
 		for (int j = 0; j < MAX_PLAYERS; j++)
 		{
 			psStats->upgrade[j] = psStats->base;
 		}
-		psStats->time = ini.value("time", 0).toInt() * WEAPON_TIME;
+		psStats->time = ini.value(JSON_KEY("time"), 0).toInt() * WEAPON_TIME;
 
 		psStats->ref = REF_REPAIR_START + i;
 
-		QString location = ini.value("location").toString();
+		QString location = ini.value(JSON_KEY("location")).toString();
 		if (location.compare("DEFAULT") == 0)
 		{
 			psStats->location = LOC_DEFAULT;
@@ -1024,8 +1022,8 @@ bool loadRepairStats(const char *pFileName)
 		ASSERT_OR_RETURN(false, psStats->time > 0, "Repair delay cannot be zero for %s", getName(psStats));
 
 		//get the IMD for the component
-		psStats->pIMD = statsGetIMD(ini, psStats, "model");
-		psStats->pMountGraphic = statsGetIMD(ini, psStats, "mountModel");
+		psStats->pIMD = statsGetIMD(ini, psStats, JSON_KEY("model"));
+		psStats->pMountGraphic = statsGetIMD(ini, psStats, JSON_KEY("mountModel"));
 
 		ini.endGroup();
 
@@ -1042,7 +1040,7 @@ bool loadRepairStats(const char *pFileName)
 /*Load the Construct stats from the file exported from Access*/
 bool loadConstructStats(const char *pFileName)
 {
-	WzConfig ini(pFileName, WzConfig::ReadOnlyAndRequired);
+	JsonReader ini(pFileName);
 	QStringList list = ini.childGroups();
 	statsAllocConstruct(list.size());
 	// Hack to make sure ZNULLCONSTRUCT is always first in list
@@ -1057,7 +1055,7 @@ bool loadConstructStats(const char *pFileName)
 		loadCompStats(ini, psStats, i);
 		psStats->compType = COMP_CONSTRUCT;
 
-		psStats->base.constructPoints = ini.value("constructPoints").toInt();
+		psStats->base.constructPoints = ini.value(JSON_KEY("constructPoints")).toInt();
 		for (int j = 0; j < MAX_PLAYERS; j++)
 		{
 			psStats->upgrade[j] = psStats->base;
@@ -1065,8 +1063,8 @@ bool loadConstructStats(const char *pFileName)
 		psStats->ref = REF_CONSTRUCT_START + i;
 
 		//get the IMD for the component
-		psStats->pIMD = statsGetIMD(ini, psStats, "sensorModel");
-		psStats->pMountGraphic = statsGetIMD(ini, psStats, "mountModel");
+		psStats->pIMD = statsGetIMD(ini, psStats, JSON_KEY("sensorModel"));
+		psStats->pMountGraphic = statsGetIMD(ini, psStats, JSON_KEY("mountModel"));
 
 		ini.endGroup();
 
@@ -1092,13 +1090,13 @@ bool loadPropulsionTypes(const char *pFileName)
 	//allocate storage for the stats
 	asPropulsionTypes = (PROPULSION_TYPES *)malloc(sizeof(PROPULSION_TYPES) * NumTypes);
 	memset(asPropulsionTypes, 0, (sizeof(PROPULSION_TYPES)*NumTypes));
-	WzConfig ini(pFileName, WzConfig::ReadOnlyAndRequired);
+	JsonReader ini(pFileName);
 	QStringList list = ini.childGroups();
 
 	for (int i = 0; i < NumTypes; ++i)
 	{
 		ini.beginGroup(list[i]);
-		multiplier = ini.value("multiplier").toInt();
+		multiplier = ini.value(JSON_KEY("multiplier")).toInt();
 
 		//set the pointer for this record based on the name
 		if (!getPropulsionType(list[i].toUtf8().constData(), &type))
@@ -1109,7 +1107,7 @@ bool loadPropulsionTypes(const char *pFileName)
 
 		pPropType = asPropulsionTypes + type;
 
-		QString flightName = ini.value("flightName").toString();
+		QString flightName = ini.value(JSON_KEY("flightName")).toString();
 		if (flightName.compare("GROUND") == 0)
 		{
 			pPropType->travel = GROUND;
@@ -1150,20 +1148,20 @@ bool loadPropulsionTypes(const char *pFileName)
 bool loadTerrainTable(const char *pFileName)
 {
 	asTerrainTable = (int *)malloc(sizeof(*asTerrainTable) * PROPULSION_TYPE_NUM * TER_MAX);
-	WzConfig ini(pFileName, WzConfig::ReadOnlyAndRequired);
+	JsonReader ini(pFileName);
 	QStringList list = ini.childGroups();
 	for (int i = 0; i < list.size(); ++i)
 	{
 		ini.beginGroup(list[i]);
-		int terrainType = ini.value("id").toInt();
-		ini.beginGroup("speedFactor");
-		asTerrainTable[terrainType * PROPULSION_TYPE_NUM + PROPULSION_TYPE_WHEELED] = ini.value("wheeled", 100).toUInt();
-		asTerrainTable[terrainType * PROPULSION_TYPE_NUM + PROPULSION_TYPE_TRACKED] = ini.value("tracked", 100).toUInt();
-		asTerrainTable[terrainType * PROPULSION_TYPE_NUM + PROPULSION_TYPE_LEGGED] = ini.value("legged", 100).toUInt();
-		asTerrainTable[terrainType * PROPULSION_TYPE_NUM + PROPULSION_TYPE_HOVER] = ini.value("hover", 100).toUInt();
-		asTerrainTable[terrainType * PROPULSION_TYPE_NUM + PROPULSION_TYPE_LIFT] = ini.value("lift", 100).toUInt();
-		asTerrainTable[terrainType * PROPULSION_TYPE_NUM + PROPULSION_TYPE_PROPELLOR] = ini.value("propellor", 100).toUInt();
-		asTerrainTable[terrainType * PROPULSION_TYPE_NUM + PROPULSION_TYPE_HALF_TRACKED] = ini.value("half-tracked", 100).toUInt();
+		int terrainType = ini.value(JSON_KEY("id")).toInt();
+		ini.beginGroup(JSON_KEY("speedFactor"));
+		asTerrainTable[terrainType * PROPULSION_TYPE_NUM + PROPULSION_TYPE_WHEELED] = ini.value(JSON_KEY("wheeled"), 100).toUInt();
+		asTerrainTable[terrainType * PROPULSION_TYPE_NUM + PROPULSION_TYPE_TRACKED] = ini.value(JSON_KEY("tracked"), 100).toUInt();
+		asTerrainTable[terrainType * PROPULSION_TYPE_NUM + PROPULSION_TYPE_LEGGED] = ini.value(JSON_KEY("legged"), 100).toUInt();
+		asTerrainTable[terrainType * PROPULSION_TYPE_NUM + PROPULSION_TYPE_HOVER] = ini.value(JSON_KEY("hover"), 100).toUInt();
+		asTerrainTable[terrainType * PROPULSION_TYPE_NUM + PROPULSION_TYPE_LIFT] = ini.value(JSON_KEY("lift"), 100).toUInt();
+		asTerrainTable[terrainType * PROPULSION_TYPE_NUM + PROPULSION_TYPE_PROPELLOR] = ini.value(JSON_KEY("propellor"), 100).toUInt();
+		asTerrainTable[terrainType * PROPULSION_TYPE_NUM + PROPULSION_TYPE_HALF_TRACKED] = ini.value(JSON_KEY("half-tracked"), 100).toUInt();
 		ini.endGroup();
 		ini.endGroup();
 	}
@@ -1203,7 +1201,7 @@ bool loadWeaponModifiers(const char *pFileName)
 			asWeaponModifierBody[i][j] = 100;
 		}
 	}
-	WzConfig ini(pFileName, WzConfig::ReadOnlyAndRequired);
+	JsonReader ini(pFileName);
 	QStringList list = ini.childGroups();
 	for (int i = 0; i < list.size(); i++)
 	{
@@ -1251,32 +1249,32 @@ bool loadPropulsionSounds(const char *pFileName)
 
 	ASSERT(asPropulsionTypes != nullptr, "loadPropulsionSounds: Propulsion type stats not loaded");
 
-	WzConfig ini(pFileName, WzConfig::ReadOnlyAndRequired);
+	JsonReader ini(pFileName);
 	QStringList list = ini.childGroups();
 	for (i = 0; i < list.size(); ++i)
 	{
 		ini.beginGroup(list[i]);
-		if (!statsGetAudioIDFromString(list[i], ini.value("szStart").toString(), &startID))
+		if (!statsGetAudioIDFromString(list[i], ini.value(JSON_KEY("szStart")).toString(), &startID))
 		{
 			return false;
 		}
-		if (!statsGetAudioIDFromString(list[i], ini.value("szIdle").toString(), &idleID))
+		if (!statsGetAudioIDFromString(list[i], ini.value(JSON_KEY("szIdle")).toString(), &idleID))
 		{
 			return false;
 		}
-		if (!statsGetAudioIDFromString(list[i], ini.value("szMoveOff").toString(), &moveOffID))
+		if (!statsGetAudioIDFromString(list[i], ini.value(JSON_KEY("szMoveOff")).toString(), &moveOffID))
 		{
 			return false;
 		}
-		if (!statsGetAudioIDFromString(list[i], ini.value("szMove").toString(), &moveID))
+		if (!statsGetAudioIDFromString(list[i], ini.value(JSON_KEY("szMove")).toString(), &moveID))
 		{
 			return false;
 		}
-		if (!statsGetAudioIDFromString(list[i], ini.value("szHiss").toString(), &hissID))
+		if (!statsGetAudioIDFromString(list[i], ini.value(JSON_KEY("szHiss")).toString(), &hissID))
 		{
 			return false;
 		}
-		if (!statsGetAudioIDFromString(list[i], ini.value("szShutDown").toString(), &shutDownID))
+		if (!statsGetAudioIDFromString(list[i], ini.value(JSON_KEY("szShutDown")).toString(), &shutDownID))
 		{
 			return false;
 		}
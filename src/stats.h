@@ -23,6 +23,7 @@
 #ifndef __INCLUDED_SRC_STATS_H__
 #define __INCLUDED_SRC_STATS_H__
 
+#include "lib/framework/jsonreader.h"
 #include "lib/framework/wzconfig.h"
 
 #include <utility>
@@ -124,7 +125,7 @@ bool statsAllocConstruct(UDWORD numEntries);
 /*******************************************************************************
 *		Load stats functions
 *******************************************************************************/
-void loadStats(WzConfig &json, BASE_STATS *psStats, int index);
+void loadStats(JsonReader &json, BASE_STATS *psStats, int index);
 
 /* Return the number of newlines in a file buffer */
 UDWORD numCR(const char *pFileBuffer, UDWORD fileSize);
@@ -431,7 +431,7 @@ bool loadStructureStats(const QString& filename)
 		structStrength.insert(map_STRUCT_STRENGTH[i].string, map_STRUCT_STRENGTH[i].value);
 	}
 
-	WzConfig ini(filename, WzConfig::ReadOnlyAndRequired);
+	JsonReader ini(filename);
 	QStringList list = ini.childGroups();
 	asStructureStats = new STRUCTURE_STATS[list.size()];
 	numStructureStats = list.size();
@@ -444,25 +444,25 @@ bool loadStructureStats(const QString& filename)
 		psStats->ref = REF_STRUCTURE_START + inc;
 
 		// set structure type
-		QString type = ini.value("type", "").toString();
+		QString type = ini.value(JSON_KEY("type"), "").toString();
 		ASSERT_OR_RETURN(false, structType.contains(type), "Invalid type '%s' of structure '%s'", type.toUtf8().constData(), getID(psStats));
 		psStats->type = structType[type];
 
 		// save indexes of special structures for futher use
 		initModuleStats(inc, psStats->type);  // This function looks like a hack. But slightly less hacky than before.
 
-		psStats->base.research = ini.value("researchPoints", 0).toInt();
-		psStats->base.moduleResearch = ini.value("moduleResearchPoints", 0).toInt();
-		psStats->base.production = ini.value("productionPoints", 0).toInt();
-		psStats->base.moduleProduction = ini.value("moduleProductionPoints", 0).toInt();
-		psStats->base.repair = ini.value("repairPoints", 0).toInt();
-		psStats->base.power = ini.value("powerPoints", 0).toInt();
-		psStats->base.modulePower = ini.value("modulePowerPoints", 0).toInt();
-		psStats->base.rearm = ini.value("rearmPoints", 0).toInt();
-		psStats->base.resistance = ini.value("resistance", 0).toUInt();
-		psStats->base.hitpoints = ini.value("hitpoints", 1).toUInt();
-		psStats->base.armour = ini.value("armour", 0).toUInt();
-		psStats->base.thermal = ini.value("thermal", 0).toUInt();
+		psStats->base.research = ini.value(JSON_KEY("researchPoints"), 0).toInt();
+		psStats->base.moduleResearch = ini.value(JSON_KEY("moduleResearchPoints"), 0).toInt();
+		psStats->base.production = ini.value(JSON_KEY("productionPoints"), 0).toInt();
+		psStats->base.moduleProduction = ini.value(JSON_KEY("moduleProductionPoints"), 0).toInt();
+		psStats->base.repair = ini.value(JSON_KEY("repairPoints"), 0).toInt();
+		psStats->base.power = ini.value(JSON_KEY("powerPoints"), 0).toInt();
+		psStats->base.modulePower = ini.value(JSON_KEY("modulePowerPoints"), 0).toInt();
+		psStats->base.rearm = ini.value(JSON_KEY("rearmPoints"), 0).toInt();
+		psStats->base.resistance = ini.value(JSON_KEY("resistance"), 0).toUInt();
+		psStats->base.hitpoints = ini.value(JSON_KEY("hitpoints"), 1).toUInt();
+		psStats->base.armour = ini.value(JSON_KEY("armour"), 0).toUInt();
+		psStats->base.thermal = ini.value(JSON_KEY("thermal"), 0).toUInt();
 		for (int i = 0; i < MAX_PLAYERS; i++)
 		{
 			psStats->upgrade[i].research = psStats->base.research;
@@ -473,14 +473,14 @@ bool loadStructureStats(const QString& filename)
 			psStats->upgrade[i].production = psStats->base.production;
 			psStats->upgrade[i].moduleProduction = psStats->base.moduleProduction;
 			psStats->upgrade[i].rearm = psStats->base.rearm;
-			psStats->upgrade[i].resistance = ini.value("resistance", 0).toUInt();
-			psStats->upgrade[i].hitpoints = ini.value("hitpoints", 1).toUInt();
-			psStats->upgrade[i].armour = ini.value("armour", 0).toUInt();
-			psStats->upgrade[i].thermal = ini.value("thermal", 0).toUInt();
+			psStats->upgrade[i].resistance = ini.value(JSON_KEY("resistance"), 0).toUInt();
+			psStats->upgrade[i].hitpoints = ini.value(JSON_KEY("hitpoints"), 1).toUInt();
+			psStats->upgrade[i].armour = ini.value(JSON_KEY("armour"), 0).toUInt();
+			psStats->upgrade[i].thermal = ini.value(JSON_KEY("thermal"), 0).toUInt();
 		}
 
 		psStats->flags = 0;
-		QStringList flags = ini.value("flags").toStringList();
+		QStringList flags = ini.value(JSON_KEY("flags")).toStringList();
 		for (int i = 0; i < flags.size(); i++)
 		{
 			if (flags[i] == "Connected")
@@ -490,24 +490,24 @@ bool loadStructureStats(const QString& filename)
 		}
 
 		// set structure strength
-		QString strength = ini.value("strength", "").toString();
+		QString strength = ini.value(JSON_KEY("strength"), "").toString();
 		ASSERT_OR_RETURN(false, structStrength.contains(strength), "Invalid strength '%s' of structure '%s'", strength.toUtf8().constData(), getID(psStats));
 		psStats->strength = structStrength[strength];
 
 		// set baseWidth
-		psStats->baseWidth = ini.value("width", 0).toUInt();
+		psStats->baseWidth = ini.value(JSON_KEY("width"), 0).toUInt();
 		ASSERT_OR_RETURN(false, psStats->baseWidth <= 100, "Invalid width '%d' for structure '%s'", psStats->baseWidth, getID(psStats));
 
 		// set baseBreadth
-		psStats->baseBreadth = ini.value("breadth", 0).toUInt();
+		psStats->baseBreadth = ini.value(JSON_KEY("breadth"), 0).toUInt();
 		ASSERT_OR_RETURN(false, psStats->baseBreadth < 100, "Invalid breadth '%d' for structure '%s'", psStats->baseBreadth, getID(psStats));
 
-		psStats->height = ini.value("height").toUInt();
-		psStats->powerToBuild = ini.value("buildPower").toUInt();
-		psStats->buildPoints = ini.value("buildPoints").toUInt();
+		psStats->height = ini.value(JSON_KEY("height")).toUInt();
+		psStats->powerToBuild = ini.value(JSON_KEY("buildPower")).toUInt();
+		psStats->buildPoints = ini.value(JSON_KEY("buildPoints")).toUInt();
 
 		// set structure models
-		QStringList models = ini.value("structureModel").toStringList();
+		QStringList models = ini.value(JSON_KEY("structureModel")).toStringList();
 		for (int j = 0; j < models.size(); j++)
 		{
 			iIMDShape *imd = modelGet(models[j].trimmed());
@@ -516,7 +516,7 @@ bool loadStructureStats(const QString& filename)
 		}
 
 		// set base model
-		QString baseModel = ini.value("baseModel", "").toString();
+		QString baseModel = ini.value(JSON_KEY("baseModel"), "").toString();
 		if (baseModel.compare("") != 0)
 		{
 			iIMDShape *imd = modelGet(baseModel);
@@ -524,17 +524,17 @@ bool loadStructureStats(const QString& filename)
 			psStats->pBaseIMD = imd;
 		}
 
-		int ecm = getCompFromName(COMP_ECM, ini.value("ecmID", "ZNULLECM").toString());
+		int ecm = getCompFromName(COMP_ECM, ini.value(JSON_KEY("ecmID"), "ZNULLECM").toString());
 		ASSERT(ecm >= 0, "Invalid ECM found for '%s'", getID(psStats));
 		psStats->pECM = asECMStats + ecm;
 
-		int sensor = getCompFromName(COMP_SENSOR, ini.value("sensorID", "ZNULLSENSOR").toString());
+		int sensor = getCompFromName(COMP_SENSOR, ini.value(JSON_KEY("sensorID"), "ZNULLSENSOR").toString());
 		ASSERT(sensor >= 0, "Invalid sensor found for structure '%s'", getID(psStats));
 		psStats->pSensor = asSensorStats + sensor;
 
 		// set list of weapons
 		std::fill_n(psStats->psWeapStat, MAX_WEAPONS, (WEAPON_STATS *)nullptr);
-		QStringList weapons = ini.value("weapons").toStringList();
+		QStringList weapons = ini.value(JSON_KEY("weapons")).toStringList();
 		ASSERT_OR_RETURN(false, weapons.size() <= MAX_WEAPONS, "Too many weapons are attached to structure '%s'. Maximum is %d", getID(psStats), MAX_WEAPONS);
 		psStats->numWeaps = weapons.size();
 		for (int j = 0; j < psStats->numWeaps; j++)
@@ -33,6 +33,7 @@
 
 #include "lib/framework/frame.h"
 #include "lib/framework/opengl.h"
+#include "lib/framework/wzapp.h"
 #include "lib/ivis_opengl/ivisdef.h"
 #include "lib/ivis_opengl/imd.h"
 #include "lib/ivis_opengl/piefunc.h"
@@ -43,6 +44,8 @@
 #include "lib/ivis_opengl/screen.h"
 #include "lib/ivis_opengl/piematrix.h"
 #include <glm/gtx/transform.hpp>
+#include <algorithm>
+#include <vector>
 
 #include "terrain.h"
 #include "map.h"
@@ -50,6 +53,7 @@
 #include "display3d.h"
 #include "hci.h"
 #include "loop.h"
+#include "lighting.h"
 
 /**
  * A sector contains all information to draw a square piece of the map.
@@ -94,6 +98,8 @@ static int lightmapWidth;
 static int lightmapHeight;
 /// Lightmap image
 static GLubyte *lightmapPixmap;
+/// What each lightmap texel was computed from, see updateLightMap
+static std::vector<uint64_t> lightmapSource;
 /// Ticks per lightmap refresh
 static const unsigned int LIGHTMAP_REFRESH = 80;
 
@@ -119,6 +125,18 @@ static int xSectors, ySectors;
 /// Did we initialise the terrain renderer yet?
 static bool terrainInitialised = false;
 
+/// Threads building sector geometry, besides the thread asking for it
+#define TERRAIN_WORKER_THREADS 3
+
+/// Geometry of a sector, built off the GL thread, waiting to be uploaded
+struct SectorStaging
+{
+	std::vector<RenderVertex> geometry;
+	std::vector<RenderVertex> water;
+	std::vector<DecalVertex> decals;
+	int decalSize;
+};
+
 /// Helper to specify the offset in a VBO
 #define BUFFER_OFFSET(i) ((char *)NULL + (i))
 
@@ -482,52 +500,71 @@ static void setSectorDecals(int x, int y, DecalVertex *decaldata, int *decalSize
 }
 
 /**
- * Update the sector for when the terrain is changed.
+ * Build the geometry and decals of a sector into staging, without touching OpenGL.
  */
-static void updateSectorGeometry(int x, int y)
+static void buildSectorGeometry(int x, int y, SectorStaging *staging)
 {
-	RenderVertex *geometry;
-	RenderVertex *water;
-	DecalVertex *decaldata;
+	const Sector &sector = sectors[x * ySectors + y];
 	int geometrySize = 0;
 	int waterSize = 0;
-	int decalSize = 0;
 
-	geometry  = (RenderVertex *)malloc(sizeof(RenderVertex) * sectors[x * ySectors + y].geometrySize);
-	water     = (RenderVertex *)malloc(sizeof(RenderVertex) * sectors[x * ySectors + y].waterSize);
+	staging->geometry.resize(sector.geometrySize);
+	staging->water.resize(sector.waterSize);
+	setSectorGeometry(x, y, staging->geometry.data(), staging->water.data(), &geometrySize, &waterSize);
 
-	setSectorGeometry(x, y, geometry, water, &geometrySize, &waterSize);
-	ASSERT(geometrySize == sectors[x * ySectors + y].geometrySize, "something went seriously wrong updating the terrain");
-	ASSERT(waterSize    == sectors[x * ySectors + y].waterSize   , "something went seriously wrong updating the terrain");
+	// Room for a decal on every tile, in case decals were added.
+	staging->decalSize = 0;
+	staging->decals.resize(sectorSize * sectorSize * 12);
+	setSectorDecals(x, y, staging->decals.data(), &staging->decalSize);
+}
+
+/**
+ * Upload the geometry of a sector built by buildSectorGeometry.
+ */
+static void uploadSectorGeometry(int x, int y, const SectorStaging &staging)
+{
+	const Sector &sector = sectors[x * ySectors + y];
 
 	glBindBuffer(GL_ARRAY_BUFFER, geometryVBO);
-	glBufferSubData(GL_ARRAY_BUFFER, sizeof(RenderVertex)*sectors[x * ySectors + y].geometryOffset,
-	                sizeof(RenderVertex)*sectors[x * ySectors + y].geometrySize, geometry);
+	glBufferSubData(GL_ARRAY_BUFFER, sizeof(RenderVertex)*sector.geometryOffset,
+	                sizeof(RenderVertex)*sector.geometrySize, staging.geometry.data());
 	glBindBuffer(GL_ARRAY_BUFFER, waterVBO);
-	glBufferSubData(GL_ARRAY_BUFFER, sizeof(RenderVertex)*sectors[x * ySectors + y].waterOffset,
-	                sizeof(RenderVertex)*sectors[x * ySectors + y].waterSize, water);
+	glBufferSubData(GL_ARRAY_BUFFER, sizeof(RenderVertex)*sector.waterOffset,
+	                sizeof(RenderVertex)*sector.waterSize, staging.water.data());
 
-	free(geometry);
-	free(water);
-
-	if (sectors[x * ySectors + y].decalSize <= 0)
+	if (sector.decalSize <= 0)
 	{
 		// Nothing to do here, and glBufferSubData(GL_ARRAY_BUFFER, 0, 0, *) crashes in my graphics driver. Probably shouldn't crash...
+		glBindBuffer(GL_ARRAY_BUFFER, 0);
 		return;
 	}
 
-	decaldata = (DecalVertex *)malloc(sizeof(DecalVertex) * sectors[x * ySectors + y].decalSize);
-	setSectorDecals(x, y, decaldata, &decalSize);
-	ASSERT(decalSize == sectors[x * ySectors + y].decalSize   , "the amount of decals has changed");
-
+	ASSERT(staging.decalSize == sector.decalSize, "the amount of decals has changed");
 	glBindBuffer(GL_ARRAY_BUFFER, decalVBO);
-	glBufferSubData(GL_ARRAY_BUFFER, sizeof(DecalVertex)*sectors[x * ySectors + y].decalOffset,
-	                sizeof(DecalVertex)*sectors[x * ySectors + y].decalSize, decaldata);
-	glBindBuffer(GL_ARRAY_BUFFER, 0);
+	glBufferSubData(GL_ARRAY_BUFFER, sizeof(DecalVertex)*sector.decalOffset,
+	                sizeof(DecalVertex)*std::min(staging.decalSize, sector.decalSize), staging.decals.data());
+	glBindBuffer(GL_ARRAY_BUFFER, 0);  // HACK Must unbind GL_ARRAY_BUFFER (don't know if it has to be unbound everywhere), otherwise text rendering may mysteriously crash.
+}
 
-	free(decaldata);
+/**
+ * Update the sectors for when the terrain is changed. The geometry is built on worker threads, and uploaded here.
+ */
+static void updateSectorGeometry(const std::vector<int> &sectorIndices)
+{
+	static std::vector<SectorStaging> staging;  // Kept to reuse the buffers.
 
-	glBindBuffer(GL_ARRAY_BUFFER, 0);  // HACK Must unbind GL_ARRAY_BUFFER (don't know if it has to be unbound everywhere), otherwise text rendering may mysteriously crash.
+	if (staging.size() < sectorIndices.size())
+	{
+		staging.resize(sectorIndices.size());
+	}
+	wzParallelFor(sectorIndices.size(), TERRAIN_WORKER_THREADS, [&sectorIndices](int i)
+	{
+		buildSectorGeometry(sectorIndices[i] / ySectors, sectorIndices[i] % ySectors, &staging[i]);
+	});
+	for (size_t i = 0; i < sectorIndices.size(); ++i)
+	{
+		uploadSectorGeometry(sectorIndices[i] / ySectors, sectorIndices[i] % ySectors, staging[i]);
+	}
 }
 
 /**
@@ -663,20 +700,30 @@ bool initTerrain()
 	waterIndex = (GLuint *)malloc(sizeof(GLuint) * xSectors * ySectors * sectorSize * sectorSize * 12);
 	waterSize = 0;
 	waterIndexSize = 0;
+	// Every sector has the same amount of geometry, so the sectors can be filled in in parallel
 	for (x = 0; x < xSectors; x++)
 	{
 		for (y = 0; y < ySectors; y++)
 		{
 			sectors[x * ySectors + y].dirty = false;
 			sectors[x * ySectors + y].geometryOffset = geometrySize;
-			sectors[x * ySectors + y].geometrySize = 0;
+			sectors[x * ySectors + y].geometrySize = (sectorSize + 1) * (sectorSize + 1) * 2;
 			sectors[x * ySectors + y].waterOffset = waterSize;
-			sectors[x * ySectors + y].waterSize = 0;
-
-			setSectorGeometry(x, y, geometry, water, &geometrySize, &waterSize);
-
-			sectors[x * ySectors + y].geometrySize = geometrySize - sectors[x * ySectors + y].geometryOffset;
-			sectors[x * ySectors + y].waterSize = waterSize - sectors[x * ySectors + y].waterOffset;
+			sectors[x * ySectors + y].waterSize = (sectorSize + 1) * (sectorSize + 1) * 2;
+			geometrySize += sectors[x * ySectors + y].geometrySize;
+			waterSize += sectors[x * ySectors + y].waterSize;
+		}
+	}
+	wzParallelFor(xSectors * ySectors, TERRAIN_WORKER_THREADS, [geometry, water](int i)
+	{
+		int sectorGeometrySize = sectors[i].geometryOffset;
+		int sectorWaterSize = sectors[i].waterOffset;
+		setSectorGeometry(i / ySectors, i % ySectors, geometry, water, &sectorGeometrySize, &sectorWaterSize);
+	});
+	for (x = 0; x < xSectors; x++)
+	{
+		for (y = 0; y < ySectors; y++)
+		{
 			// and do the index buffers
 			sectors[x * ySectors + y].geometryIndexOffset = geometryIndexSize;
 			sectors[x * ySectors + y].geometryIndexSize = 0;
@@ -881,19 +928,29 @@ bool initTerrain()
 	free(textureIndex);
 	glBindBuffer(GL_ARRAY_BUFFER, 0);
 
-	// and finally the decals
+	// and finally the decals, found for each sector in parallel, then put together
+	std::vector<std::vector<DecalVertex>> sectorDecals(xSectors * ySectors);
+	wzParallelFor(xSectors * ySectors, TERRAIN_WORKER_THREADS, [&sectorDecals](int i)
+	{
+		int sectorDecalSize = 0;
+		sectorDecals[i].resize(sectorSize * sectorSize * 12);
+		setSectorDecals(i / ySectors, i % ySectors, sectorDecals[i].data(), &sectorDecalSize);
+		sectorDecals[i].resize(sectorDecalSize);
+	});
 	decaldata = (DecalVertex *)malloc(sizeof(DecalVertex) * mapWidth * mapHeight * 12);
 	decalSize = 0;
 	for (x = 0; x < xSectors; x++)
 	{
 		for (y = 0; y < ySectors; y++)
 		{
+			const std::vector<DecalVertex> &decals = sectorDecals[x * ySectors + y];
 			sectors[x * ySectors + y].decalOffset = decalSize;
-			sectors[x * ySectors + y].decalSize = 0;
-			setSectorDecals(x, y, decaldata, &decalSize);
-			sectors[x * ySectors + y].decalSize = decalSize - sectors[x * ySectors + y].decalOffset;
+			sectors[x * ySectors + y].decalSize = decals.size();
+			std::copy(decals.begin(), decals.end(), decaldata + decalSize);
+			decalSize += decals.size();
 		}
 	}
+	sectorDecals.clear();
 	debug(LOG_TERRAIN, "%i decals found", decalSize / 12);
 	glGenBuffers(1, &decalVBO);
 	glBindBuffer(GL_ARRAY_BUFFER, decalVBO);
@@ -919,6 +976,7 @@ bool initTerrain()
 		abort();
 		return false;
 	}
+	lightmapSource.assign(mapWidth * mapHeight, 0);
 
 	glGenTextures(1, &lightmap_tex_num);
 	glBindTexture(GL_TEXTURE_2D, lightmap_tex_num);
@@ -971,20 +1029,47 @@ void shutdownTerrain()
 	glDeleteTextures(1, &lightmap_tex_num);
 	free(lightmapPixmap);
 	lightmapPixmap = nullptr;
+	lightmapSource.clear();
 
 	terrainInitialised = false;
 }
 
-static void updateLightMap()
+/**
+ * Update the lightmap texels of the tiles which changed since the last update, and get the rows of the texels which
+ * changed, from firstRow to before endRow. The rows are empty if nothing changed.
+ */
+static void updateLightMap(int *firstRow, int *endRow)
 {
+	const bool fog = pie_GetFogStatus();
+	const float playerX = map_coordf(player.p.x);
+	const float playerY = map_coordf(player.p.z);
+
+	*firstRow = mapHeight;
+	*endRow = 0;
 	for (int j = 0; j < mapHeight; ++j)
 	{
 		for (int i = 0; i < mapWidth; ++i)
 		{
 			MAPTILE *psTile = mapTile(i, j);
+			const bool gateway = psTile->tileInfoBits & BITS_GATEWAY && showGateways;
+
+			// Marked tiles blink, and without fog the tiles fade out at the edges of the view, so those are done every time.
+			// The rest only change when their colour or gateway state does.
+			const bool everyTime = psTile->tileInfoBits & BITS_MARKED || !fog;
 			PIELIGHT colour = psTile->colour;
+			const PIELIGHT light = getTileLight(i, j);
+			colour.byte.r = MIN(255, colour.byte.r + light.byte.r);
+			colour.byte.g = MIN(255, colour.byte.g + light.byte.g);
+			colour.byte.b = MIN(255, colour.byte.b + light.byte.b);
 
-			if (psTile->tileInfoBits & BITS_GATEWAY && showGateways)
+			const uint64_t source = everyTime ? 0 : colour.rgba | (uint64_t)gateway << 32 | (uint64_t)1 << 33;
+			if (source != 0 && source == lightmapSource[i + j * mapWidth])
+			{
+				continue;
+			}
+			lightmapSource[i + j * mapWidth] = source;
+
+			if (gateway)
 			{
 				colour.byte.g = 255;
 			}
@@ -994,16 +1079,9 @@ static void updateLightMap()
 				colour.byte.r = MAX(m, 255 - m);
 			}
 
-			lightmapPixmap[(i + j * lightmapWidth) * 3 + 0] = colour.byte.r;
-			lightmapPixmap[(i + j * lightmapWidth) * 3 + 1] = colour.byte.g;
-			lightmapPixmap[(i + j * lightmapWidth) * 3 + 2] = colour.byte.b;
-
-			if (!pie_GetFogStatus())
+			if (!fog)
 			{
 				// fade to black at the edges of the visible terrain area
-				const float playerX = map_coordf(player.p.x);
-				const float playerY = map_coordf(player.p.z);
-
 				const float distA = i - (playerX - visibleTiles.x / 2);
 				const float distB = (playerX + visibleTiles.x / 2) - i;
 				const float distC = j - (playerY - visibleTiles.y / 2);
@@ -1029,23 +1107,36 @@ static void updateLightMap()
 				darken = (distToEdge) / 2.0f;
 				if (darken <= 0)
 				{
-					lightmapPixmap[(i + j * lightmapWidth) * 3 + 0] = 0;
-					lightmapPixmap[(i + j * lightmapWidth) * 3 + 1] = 0;
-					lightmapPixmap[(i + j * lightmapWidth) * 3 + 2] = 0;
+					colour.byte.r = 0;
+					colour.byte.g = 0;
+					colour.byte.b = 0;
 				}
 				else if (darken < 1)
 				{
-					lightmapPixmap[(i + j * lightmapWidth) * 3 + 0] *= darken;
-					lightmapPixmap[(i + j * lightmapWidth) * 3 + 1] *= darken;
-					lightmapPixmap[(i + j * lightmapWidth) * 3 + 2] *= darken;
+					colour.byte.r *= darken;
+					colour.byte.g *= darken;
+					colour.byte.b *= darken;
 				}
 			}
+
+			GLubyte *texel = &lightmapPixmap[(i + j * lightmapWidth) * 3];
+			if (texel[0] != colour.byte.r || texel[1] != colour.byte.g || texel[2] != colour.byte.b)
+			{
+				texel[0] = colour.byte.r;
+				texel[1] = colour.byte.g;
+				texel[2] = colour.byte.b;
+				*firstRow = std::min(*firstRow, j);
+				*endRow = j + 1;
+			}
 		}
 	}
 }
 
 static void cullTerrain()
 {
+	static std::vector<int> dirtySectors;
+
+	dirtySectors.clear();
 	for (int x = 0; x < xSectors; x++)
 	{
 		for (int y = 0; y < ySectors; y++)
@@ -1063,12 +1154,16 @@ static void cullTerrain()
 				sectors[x * ySectors + y].draw = true;
 				if (sectors[x * ySectors + y].dirty)
 				{
-					updateSectorGeometry(x, y);
+					dirtySectors.push_back(x * ySectors + y);
 					sectors[x * ySectors + y].dirty = false;
 				}
 			}
 		}
 	}
+	if (!dirtySectors.empty())
+	{
+		updateSectorGeometry(dirtySectors);
+	}
 }
 
 static void drawDepthOnly(const glm::mat4 &ModelViewProjection, const glm::vec4 &paramsXLight, const glm::vec4 &paramsYLight)
@@ -1275,11 +1370,16 @@ void drawTerrain(const glm::mat4 &mvp)
 	// we limit the framerate of the lightmap, because updating a texture is an expensive operation
 	if (realTime - lightmapLastUpdate >= LIGHTMAP_REFRESH)
 	{
+		int firstRow, endRow;
 		lightmapLastUpdate = realTime;
-		updateLightMap();
+		updateLightMap(&firstRow, &endRow);
 
-		glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
-		glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, lightmapWidth, lightmapHeight, GL_RGB, GL_UNSIGNED_BYTE, lightmapPixmap);
+		// only upload the rows which changed
+		if (firstRow < endRow)
+		{
+			glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+			glTexSubImage2D(GL_TEXTURE_2D, 0, 0, firstRow, lightmapWidth, endRow - firstRow, GL_RGB, GL_UNSIGNED_BYTE, lightmapPixmap + firstRow * lightmapWidth * 3);
+		}
 	}
 
 	///////////////////////////////////
@@ -0,0 +1,293 @@
+/*
+	This file is part of Warzone 2100.
+	Copyright (C) 2005-2017  Warzone 2100 Project
+
+	Warzone 2100 is free software; you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation; either version 2 of the License, or
+	(at your option) any later version.
+
+	Warzone 2100 is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with Warzone 2100; if not, write to the Free Software
+	Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301 USA
+*/
+/** @file
+ *  Tick profiler, see tickprofile.h.
+ */
+
+#include "lib/framework/frame.h"
+#include "lib/framework/file.h"
+#include "lib/gamelib/gtime.h"
+#include "lib/ivis_opengl/pieblitfunc.h"
+#include "lib/ivis_opengl/piepalette.h"
+#include "lib/ivis_opengl/textdraw.h"
+
+#include <QtCore/QElapsedTimer>
+
+#include "tickprofile.h"
+
+/// Spans kept per tick, there can be several for every droid and structure
+#define PROFILE_MAX_SPANS 4096
+/// How deeply sections can nest, deeper sections are counted as part of the enclosing one
+#define PROFILE_STACK_SIZE 8
+/// Milliseconds of tick time shown by the full height of the overlay
+#define PROFILE_GRAPH_MS 50
+#define PROFILE_GRAPH_HEIGHT 100
+#define PROFILE_BAR_WIDTH 3
+
+struct OPEN_SECTION
+{
+	PROFILE_SECTION section;
+	int64_t start;
+};
+
+static const char *sectionNames[PROFILE_SECTION_COUNT] =
+{
+	"other", "scripts", "visibility", "map", "pathing", "ai", "droids", "structures", "projectiles", "features"
+};
+
+static unsigned profileUsers = 0;
+static QElapsedTimer profileTimer;
+
+// Ring buffer of the last ticks.
+static PROFILE_TICK profileTicks[PROFILE_TICKS];
+static unsigned profileNextTick = 0;
+static unsigned profileTickCount = 0;
+
+static PROFILE_TICK *currentTick = nullptr;  ///< The tick being profiled, nullptr outside ticks.
+static PROFILE_SECTION currentSection = PROFILE_OTHER;
+static int64_t lapStart = 0;
+static OPEN_SECTION sectionStack[PROFILE_STACK_SIZE];  ///< Index 0 is the top level section.
+static unsigned sectionDepth = 0;
+
+/// Attribute the time since the last lap to the current section.
+static void profileLap(int64_t now)
+{
+	currentTick->sectionTime[currentSection] += now - lapStart;
+	lapStart = now;
+}
+
+static void profileAddSpan(const OPEN_SECTION &open, unsigned depth, int64_t now)
+{
+	if (currentTick->spans.size() >= PROFILE_MAX_SPANS)
+	{
+		++currentTick->droppedSpans;
+		return;
+	}
+	PROFILE_SPAN span;
+	span.start = open.start - currentTick->start;
+	span.duration = now - open.start;
+	span.section = open.section;
+	span.depth = depth;
+	currentTick->spans.push_back(span);
+}
+
+/// Returns the kept tick with the given index, 0 being the oldest.
+static const PROFILE_TICK &profileGetTick(unsigned index)
+{
+	return profileTicks[(profileNextTick + PROFILE_TICKS - profileTickCount + index) % PROFILE_TICKS];
+}
+
+void profileStart()
+{
+	if (profileUsers++ != 0)
+	{
+		return;
+	}
+	if (!profileTimer.isValid())
+	{
+		profileTimer.start();
+	}
+	profileTickCount = 0;
+}
+
+void profileStop()
+{
+	ASSERT_OR_RETURN(, profileUsers > 0, "profileStop without profileStart");
+	if (--profileUsers == 0)
+	{
+		currentTick = nullptr;
+	}
+}
+
+bool profileRunning()
+{
+	return profileUsers > 0;
+}
+
+void profileTickStart()
+{
+	if (profileUsers == 0)
+	{
+		return;
+	}
+	currentTick = &profileTicks[profileNextTick];
+	currentTick->gameTime = gameTime;
+	currentTick->start = lapStart = profileTimer.nsecsElapsed();
+	currentTick->duration = 0;
+	memset(currentTick->sectionTime, 0, sizeof(currentTick->sectionTime));
+	currentTick->spans.clear();
+	currentTick->droppedSpans = 0;
+
+	currentSection = PROFILE_OTHER;
+	sectionStack[0].section = PROFILE_OTHER;
+	sectionStack[0].start = lapStart;
+	sectionDepth = 0;
+}
+
+const PROFILE_TICK *profileTickEnd()
+{
+	if (currentTick == nullptr)
+	{
+		return nullptr;
+	}
+	const int64_t now = profileTimer.nsecsElapsed();
+	profileLap(now);
+	ASSERT(sectionDepth == 0, "Tick ended inside %u nested sections", sectionDepth);
+	for (unsigned depth = std::min<unsigned>(sectionDepth, PROFILE_STACK_SIZE - 1) + 1; depth-- > 0;)
+	{
+		profileAddSpan(sectionStack[depth], depth, now);
+	}
+	currentTick->duration = now - currentTick->start;
+
+	profileNextTick = (profileNextTick + 1) % PROFILE_TICKS;
+	profileTickCount = std::min(profileTickCount + 1, (unsigned)PROFILE_TICKS);
+
+	const PROFILE_TICK *finished = currentTick;
+	currentTick = nullptr;
+	return finished;
+}
+
+void profileSwitch(PROFILE_SECTION section)
+{
+	if (currentTick == nullptr)
+	{
+		return;
+	}
+	ASSERT_OR_RETURN(, sectionDepth == 0, "Switching to %s inside a nested section", sectionNames[section]);
+	const int64_t now = profileTimer.nsecsElapsed();
+	profileLap(now);
+	profileAddSpan(sectionStack[0], 0, now);
+	sectionStack[0].section = section;
+	sectionStack[0].start = now;
+	currentSection = section;
+}
+
+void profileEnter(PROFILE_SECTION section)
+{
+	if (currentTick == nullptr)
+	{
+		return;
+	}
+	if (++sectionDepth < PROFILE_STACK_SIZE)
+	{
+		const int64_t now = profileTimer.nsecsElapsed();
+		profileLap(now);
+		sectionStack[sectionDepth].section = section;
+		sectionStack[sectionDepth].start = now;
+		currentSection = section;
+	}
+}
+
+void profileLeave()
+{
+	if (currentTick == nullptr)
+	{
+		return;
+	}
+	ASSERT_OR_RETURN(, sectionDepth > 0, "profileLeave without profileEnter");
+	if (sectionDepth < PROFILE_STACK_SIZE)
+	{
+		const int64_t now = profileTimer.nsecsElapsed();
+		profileLap(now);
+		profileAddSpan(sectionStack[sectionDepth], sectionDepth, now);
+		currentSection = sectionStack[sectionDepth - 1].section;
+	}
+	--sectionDepth;
+}
+
+const char *profileSectionName(PROFILE_SECTION section)
+{
+	return sectionNames[section];
+}
+
+bool profileWriteTrace(const char *filename)
+{
+	// Timestamps in microseconds.
+	std::string trace = "{\"traceEvents\":[\n";
+	for (unsigned i = 0; i < profileTickCount; ++i)
+	{
+		const PROFILE_TICK &tick = profileGetTick(i);
+		trace += astringf("%s{\"name\":\"tick\",\"cat\":\"tick\",\"ph\":\"X\",\"pid\":1,\"tid\":1,\"ts\":%.3f,\"dur\":%.3f,\"args\":{\"gameTime\":%u,\"droppedSpans\":%u}}",
+		                  i == 0 ? "" : ",\n", tick.start / 1e3, tick.duration / 1e3, tick.gameTime, tick.droppedSpans);
+		for (const PROFILE_SPAN &span : tick.spans)
+		{
+			trace += astringf(",\n{\"name\":\"%s\",\"cat\":\"section\",\"ph\":\"X\",\"pid\":1,\"tid\":1,\"ts\":%.3f,\"dur\":%.3f}",
+			                  sectionNames[span.section], (tick.start + span.start) / 1e3, span.duration / 1e3);
+		}
+	}
+	trace += "\n]}\n";
+	return saveFile(filename, trace.data(), trace.size());
+}
+
+void profileDisplay(int x, int y)
+{
+	static const PIELIGHT sectionColours[PROFILE_SECTION_COUNT] =
+	{
+		pal_Colour(128, 128, 128),  // other
+		pal_Colour(255, 220, 0),    // scripts
+		pal_Colour(0, 160, 255),    // visibility
+		pal_Colour(0, 80, 160),     // map
+		pal_Colour(255, 0, 255),    // pathing
+		pal_Colour(255, 40, 40),    // ai
+		pal_Colour(40, 220, 40),    // droids
+		pal_Colour(0, 120, 40),     // structures
+		pal_Colour(255, 140, 0),    // projectiles
+		pal_Colour(160, 100, 60),   // features
+	};
+	const int width = PROFILE_TICKS * PROFILE_BAR_WIDTH;
+	const int bottom = y + PROFILE_GRAPH_HEIGHT;
+	const double pixelsPerNs = PROFILE_GRAPH_HEIGHT / (PROFILE_GRAPH_MS * 1e6);
+
+	pie_UniTransBoxFill(x, y, x + width, bottom, pal_RGBA(0, 0, 0, 128));
+
+	int64_t totalTime[PROFILE_SECTION_COUNT] = {};
+	int64_t worstTick = 0;
+	for (unsigned i = 0; i < profileTickCount; ++i)
+	{
+		const PROFILE_TICK &tick = profileGetTick(i);
+		const int barX = x + (PROFILE_TICKS - profileTickCount + i) * PROFILE_BAR_WIDTH;
+		int64_t stacked = 0;
+		int barBottom = bottom;
+		for (int section = 0; section < PROFILE_SECTION_COUNT; ++section)
+		{
+			totalTime[section] += tick.sectionTime[section];
+			stacked += tick.sectionTime[section];
+			const int barTop = std::max((int)(bottom - stacked * pixelsPerNs), y);
+			if (barTop < barBottom)
+			{
+				pie_BoxFill(barX, barTop, barX + PROFILE_BAR_WIDTH - 1, barBottom, sectionColours[section]);
+				barBottom = barTop;
+			}
+		}
+		worstTick = std::max(worstTick, tick.duration);
+	}
+
+	// Legend, with the average time of each section.
+	const int lineHeight = iV_GetTextLineSize(font_small);
+	int lineY = bottom + lineHeight;
+	iV_SetTextColour(WZCOL_TEXT_BRIGHT);
+	iV_DrawText(astringf("%d ms / %u ticks, worst %.1f ms", PROFILE_GRAPH_MS, profileTickCount, worstTick / 1e6).c_str(), x, lineY, font_small);
+	for (int section = 0; section < PROFILE_SECTION_COUNT; ++section)
+	{
+		lineY += lineHeight;
+		pie_BoxFill(x, lineY - lineHeight / 2 - 3, x + 6, lineY - lineHeight / 2 + 3, sectionColours[section]);
+		const double average = profileTickCount != 0 ? totalTime[section] / 1e6 / profileTickCount : 0.;
+		iV_DrawText(astringf("%s %.2f ms", sectionNames[section], average).c_str(), x + 10, lineY, font_small);
+	}
+}
@@ -0,0 +1,109 @@
+/*
+	This file is part of Warzone 2100.
+	Copyright (C) 2005-2017  Warzone 2100 Project
+
+	Warzone 2100 is free software; you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation; either version 2 of the License, or
+	(at your option) any later version.
+
+	Warzone 2100 is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with Warzone 2100; if not, write to the Free Software
+	Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301 USA
+*/
+/** @file
+ *  Tick profiler: times the sections of each game state update, and keeps the last PROFILE_TICKS ticks.
+ *
+ *  The time of each tick is attributed to whichever section is current. gameStateUpdate switches between the
+ *  top level sections, and code that runs from several places (AI, scripts, pathing) enters and leaves its own
+ *  section, best through a ProfileScope.
+ */
+
+#ifndef __INCLUDED_SRC_TICKPROFILE_H__
+#define __INCLUDED_SRC_TICKPROFILE_H__
+
+#include "lib/framework/types.h"
+
+#include <vector>
+
+/// Number of ticks kept, ten seconds of game time
+#define PROFILE_TICKS 100
+
+enum PROFILE_SECTION
+{
+	PROFILE_OTHER,
+	PROFILE_SCRIPTS,
+	PROFILE_VISIBILITY,
+	PROFILE_MAP,
+	PROFILE_PATHING,      ///< Handing path jobs to and from the path thread, not the path finding itself
+	PROFILE_AI,
+	PROFILE_DROIDS,
+	PROFILE_STRUCTURES,
+	PROFILE_PROJECTILES,
+	PROFILE_FEATURES,
+	PROFILE_SECTION_COUNT
+};
+
+/// A section as it appears in the timeline of a tick, including any sections nested in it.
+struct PROFILE_SPAN
+{
+	uint32_t start;        ///< Nanoseconds since the start of the tick
+	uint32_t duration;     ///< Nanoseconds
+	uint8_t section;       ///< PROFILE_SECTION
+	uint8_t depth;         ///< 0 for top level sections
+};
+
+struct PROFILE_TICK
+{
+	uint32_t gameTime = 0;
+	int64_t start = 0;                                  ///< Nanoseconds since profiling was first started
+	int64_t duration = 0;                               ///< Nanoseconds
+	int64_t sectionTime[PROFILE_SECTION_COUNT] = {};    ///< Nanoseconds spent in each section, excluding nested sections
+	std::vector<PROFILE_SPAN> spans;
+	unsigned droppedSpans = 0;                          ///< Spans not kept, because the tick had too many
+};
+
+/// Start profiling the ticks. Calls nest, profiling continues until each profileStart has had its profileStop.
+void profileStart();
+void profileStop();
+bool profileRunning();
+
+/// Call at the start of each game tick.
+void profileTickStart();
+/// Call at the end of each game tick. Returns the finished tick, or nullptr if not profiling.
+const PROFILE_TICK *profileTickEnd();
+/// Attribute the time from now on to the given top level section.
+void profileSwitch(PROFILE_SECTION section);
+/// Attribute the time from now on to the given section, until profileLeave.
+void profileEnter(PROFILE_SECTION section);
+/// Go back to the section that was current before the matching profileEnter.
+void profileLeave();
+
+/// Enters a section for as long as it exists.
+class ProfileScope
+{
+public:
+	explicit ProfileScope(PROFILE_SECTION section)
+	{
+		profileEnter(section);
+	}
+	~ProfileScope()
+	{
+		profileLeave();
+	}
+};
+
+const char *profileSectionName(PROFILE_SECTION section);
+
+/// Write the kept ticks in the Chrome trace event format, which chrome://tracing can show as a timeline.
+bool profileWriteTrace(const char *filename);
+
+/// Draw the kept ticks, as a bar per tick with the sections stacked in it.
+void profileDisplay(int x, int y);
+
+#endif // __INCLUDED_SRC_TICKPROFILE_H__
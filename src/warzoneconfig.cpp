@@ -48,6 +48,8 @@ struct WARZONE_GLOBALS
 	bool pauseOnFocusLoss = true;
 	bool ColouredCursor = true;
 	bool MusicEnabled = true;
+	bool jsonSaves = false;
+	int autosaveInterval = 10;
 };
 
 static WARZONE_GLOBALS warGlobs;
@@ -206,6 +208,26 @@ bool war_getSoundEnabled()
 	return warGlobs.soundEnabled;
 }
 
+void war_setJsonSaves(bool jsonSaves)
+{
+	warGlobs.jsonSaves = jsonSaves;
+}
+
+bool war_getJsonSaves()
+{
+	return warGlobs.jsonSaves;
+}
+
+void war_setAutosaveInterval(int minutes)
+{
+	warGlobs.autosaveInterval = minutes > 0 ? minutes : 0;
+}
+
+int war_getAutosaveInterval()
+{
+	return warGlobs.autosaveInterval;
+}
+
 bool war_GetMusicEnabled()
 {
 	return warGlobs.MusicEnabled;
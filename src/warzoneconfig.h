@@ -92,4 +92,16 @@ void war_setSoundEnabled(bool soundEnabled);
  */
 bool war_getSoundEnabled();
 
+/**
+ * Save games as a directory of separate JSON files, rather than as one archive
+ */
+void war_setJsonSaves(bool jsonSaves);
+bool war_getJsonSaves();
+
+/**
+ * Minutes of game time between autosaves of single player games, 0 for no autosaves
+ */
+void war_setAutosaveInterval(int minutes);
+int war_getAutosaveInterval();
+
 #endif // __INCLUDED_SRC_WARZONECONFIG_H__
@@ -0,0 +1,33 @@
+#!/bin/bash
+
+# Runs fixed skirmish setups for a number of game ticks, as fast as possible, and
+# writes the timings of each run as JSON to tmp/benchmark-<setup>.json.
+
+TICKS=${TICKS:-3000}
+
+rm -rf tmp
+mkdir -p tmp
+
+trap ctrl_c INT
+
+function ctrl_c() {
+	echo " * Caught ctrl+c - aborting!"
+	exit 1
+}
+
+function benchmark
+{
+	echo
+	echo " ==== $1 : $2 ===="
+	src/warzone2100 --window --configdir=tmp --resolution=640x480 --noshadows --nosound --skirmish=$1.json --benchmark=$TICKS > tmp/benchmark-$1.json || exit 1
+	cat tmp/benchmark-$1.json
+}
+
+echo
+echo "Running Warzone2100 simulation benchmarks, $TICKS ticks each"
+echo -n "Time is: "
+date -R
+
+benchmark bench_ais "Ten AIs"
+benchmark bench_battle "Two thousand droid battle"
+benchmark targeting "Target selection benchmark"
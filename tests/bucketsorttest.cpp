@@ -0,0 +1,108 @@
+#include "lib/framework/frame.h"
+#include "src/bucketsort.h"
+
+#include <algorithm>
+#include <stdio.h>
+#include <stdlib.h>
+
+#define WIDTH 640
+#define HEIGHT 480
+
+static bool checkCull()
+{
+	// A camera looking along z, which projects (x, y, z) to (x / z, y / z) with depth z.
+	glm::mat4 matrix(1.f);
+	matrix[2][3] = 1.f;
+	matrix[3][3] = 0.f;
+
+	struct
+	{
+		float x, y, z, radius;
+		int32_t depthBias;
+		int32_t depth;
+		const char *what;
+	} cases[] =
+	{
+		{0, 0, 1000, 10, 0, 1000, "in front"},
+		{0, 0, 1000, 10, 16, 984, "in front, biased"},
+		{5000, 0, 1000, 10, 0, -1, "off the right"},
+		{-5000, 0, 1000, 10, 0, -1, "off the left"},
+		{0, 5000, 1000, 10, 0, -1, "off the top"},
+		{0, -5000, 1000, 10, 0, -1, "off the bottom"},
+		{5000, 0, 1000, -1, 0, 1000, "off the right, not culled by radius"},
+		{1100, 0, 1000, 1000, 0, 1000, "off the right, but big enough to show"},
+		{0, 0, -100, 10, 0, -100, "behind"},
+	};
+	const size_t n = sizeof(cases) / sizeof(cases[0]);
+
+	std::vector<float> x, y, z, radius;
+	std::vector<int32_t> depthBias, depth(n);
+	for (size_t i = 0; i < n; ++i)
+	{
+		x.push_back(cases[i].x);
+		y.push_back(cases[i].y);
+		z.push_back(cases[i].z);
+		radius.push_back(cases[i].radius);
+		depthBias.push_back(cases[i].depthBias);
+	}
+	bucketCull(x.data(), y.data(), z.data(), radius.data(), depthBias.data(), n, matrix, WIDTH, HEIGHT, depth.data());
+
+	bool ok = true;
+	for (size_t i = 0; i < n; ++i)
+	{
+		if (depth[i] != cases[i].depth)
+		{
+			fprintf(stderr, "bucketsorttest: Culling %s: depth %d, expected %d\n", cases[i].what, (int)depth[i], (int)cases[i].depth);
+			ok = false;
+		}
+	}
+	return ok;
+}
+
+static bool checkSort(size_t n, uint64_t keyMask)
+{
+	std::vector<uint64_t> keys, keysTemp;
+	std::vector<uint32_t> values, valuesTemp;
+	std::vector<std::pair<uint64_t, uint32_t>> expected;
+	for (size_t i = 0; i < n; ++i)
+	{
+		const uint64_t key = ((uint64_t)rand() << 48 ^ (uint64_t)rand() << 32 ^ (uint64_t)rand() << 16 ^ rand()) & keyMask;
+		keys.push_back(key);
+		values.push_back(i);
+		expected.push_back(std::make_pair(key, (uint32_t)i));
+	}
+	// The sort must be stable, like drawing objects with the same key in the order they were added.
+	std::stable_sort(expected.begin(), expected.end(), [](const std::pair<uint64_t, uint32_t> &a, const std::pair<uint64_t, uint32_t> &b) {
+		return a.first < b.first;
+	});
+
+	bucketRadixSort(keys, values, keysTemp, valuesTemp);
+
+	for (size_t i = 0; i < n; ++i)
+	{
+		if (keys[i] != expected[i].first || values[i] != expected[i].second)
+		{
+			fprintf(stderr, "bucketsorttest: Sorting %u keys with mask %016llx: wrong at %u\n", (unsigned)n, (unsigned long long)keyMask, (unsigned)i);
+			return false;
+		}
+	}
+	return true;
+}
+
+int main(void)
+{
+	bool ok = checkCull();
+
+	srand(42);
+	const uint64_t masks[] = {~0ull, 0xFFFFFFFF00000000ull, 0x00000000FFFFFFFFull, 0x0F0000000000F000ull, 0};
+	const size_t sizes[] = {0, 1, 2, 3, 100, 5000};
+	for (uint64_t mask : masks)
+	{
+		for (size_t n : sizes)
+		{
+			ok = checkSort(n, mask) && ok;
+		}
+	}
+
+	return ok ? 0 : 1;
+}
@@ -51,3 +51,4 @@ cam FASTPLAY "Fastplay"
 skirmish highground "Basic skirmish"
 skirmish miza "All AIs"
 skirmish miza_challenge "Best AI vs 7 old timers"
+skirmish targeting "Target selection benchmark"
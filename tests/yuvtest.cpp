@@ -0,0 +1,44 @@
+#include "lib/framework/frame.h"
+#include "lib/sequence/yuv.h"
+
+#include <stdio.h>
+
+int main(void)
+{
+#ifdef SEQ_SSE2
+	// Every Y in one row, for every U and V.
+	unsigned char y[256], u[128], v[128];
+	uint32_t out[256];
+	for (int i = 0; i < 256; ++i)
+	{
+		y[i] = i;
+	}
+	for (int U = 0; U < 256; ++U)
+	{
+		for (int V = 0; V < 256; ++V)
+		{
+			memset(u, U, sizeof(u));
+			memset(v, V, sizeof(v));
+			const int converted = convertRowSSE2(y, u, v, out, 256);
+			if (converted != 256)
+			{
+				fprintf(stderr, "yuvtest: convertRowSSE2 converted %d of 256 pixels\n", converted);
+				return 1;
+			}
+			for (int Y = 0; Y < 256; ++Y)
+			{
+				const uint32_t expected = yuvToRGBA(Y, U - 128, V - 128);
+				if (out[Y] != expected)
+				{
+					fprintf(stderr, "yuvtest: Y %d, U %d, V %d: convertRowSSE2 gave %08x, yuvToRGBA %08x\n", Y, U, V, out[Y], expected);
+					return 1;
+				}
+			}
+		}
+	}
+	return 0;
+#else
+	fprintf(stderr, "yuvtest: No SSE2, nothing to check\n");
+	return 77;  // Skipped
+#endif
+}